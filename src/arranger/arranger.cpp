@@ -14,8 +14,13 @@
 #include <arpa/inet.h>
 #include <csignal>
 #include <cmath>
+#include <algorithm>
 #include "log.h"
 #include "file_gc.h"
+#include "admission.h"
+#include "cgroup.h"
+#include "record_filter.h"
+#include "timer.h"
 #include "source_invoke.h"
 #include "arranger.h"
 #include "communication/channel_factory.h"
@@ -23,7 +28,9 @@
 #include "obaccess/ob_access.h"
 #include "metric/status_thread.h"
 #include "metric/sys_metric.h"
-#include "obaccess/clog_meta_routine.h"
+#include "metric/metric_registry.h"
+#include "clog_meta_hub.h"
+#include "reader_pool.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -36,6 +43,10 @@ int Arranger::init()
     return OMS_FAILED;
   }
 
+  if (_s_conf.check_clog_enable.val()) {
+    ClogMetaShm::remove_stale();
+  }
+
   int ret = ChannelFactory::instance().init(_s_conf);
   if (ret != OMS_OK) {
     OMS_STREAM_ERROR << "Failed to init channel factory";
@@ -47,8 +58,15 @@ int Arranger::init()
     return ret;
   }
   _accepter.set_read_callback([this](const Peer& peer, const Message& msg) { return on_handshake(peer, msg); });
-  _accepter.set_routine_callback([this] { gc_pid_routine(); });
+  _accepter.set_routine_callback([this] {
+    gc_pid_routine();
+    expire_handshakes();
+    _handshakes.admit_waiting();
+    ReaderPool::instance().replenish();
+  });
   _accepter.set_close_callback([this](const Peer& peer) { on_close(peer); });
+
+  _handshakes.start(_s_conf.handshake_worker_count.val());
   return OMS_OK;
 }
 
@@ -58,6 +76,16 @@ int Arranger::run_foreground()
   if (ret != OMS_OK) {
     return ret;
   }
+  if (_s_conf.metric_http_port.val() != 0) {
+    ret = _metric_server.init(_accepter.get_event_base(), _s_conf.metric_http_port.val());
+    if (ret != OMS_OK) {
+      return ret;
+    }
+    _metric_server.register_handler("/metrics", [this](const std::string&, HttpResponse& response) {
+      on_metrics(response);
+    });
+  }
+  ObMetaCache::instance().register_metrics();
   StatusThread status_thread(logproxy::g_metric, logproxy::g_proc_metric);
   status_thread.register_gauge("NREADER", [this] { return _client_peers.size(); });
   status_thread.register_gauge("NCHANNEL", [this] { return _accepter.channel_count(); });
@@ -82,6 +110,10 @@ EventResult Arranger::on_handshake(const Peer& peer, const Message& msg)
     OMS_STREAM_WARN << "Unknown message type: " << (int)msg.type();
     return EventResult::ER_CLOSE_CHANNEL;
   }
+  if (_handshakes.contains(peer.id())) {
+    OMS_STREAM_WARN << "Handshake again before the last one is done, peer: " << peer.to_string();
+    return EventResult::ER_CLOSE_CHANNEL;
+  }
 
   auto& handshake = (ClientHandshakeRequestMessage&)msg;
   OMS_STREAM_INFO << "Handshake request from peer: " << peer.to_string() << ", msg: " << handshake.to_string();
@@ -90,51 +122,122 @@ EventResult Arranger::on_handshake(const Peer& peer, const Message& msg)
   client.packet_version = msg.version();
 
   std::string errmsg;
-  OblogConfig oblog_config(client.configuration);
-  if (resolve(oblog_config, errmsg) != OMS_OK) {
+  auto pending = std::make_shared<PendingHandshake>(
+      client, Timer::now() + (uint64_t)_s_conf.handshake_timeout_s.val() * 1000000);
+  if (resolve(pending->oblog_config, errmsg) != OMS_OK) {
     response_error(peer, msg.version(), ErrorCode::NO_AUTH, errmsg);
     return EventResult::ER_CLOSE_CHANNEL;
   }
-
-  OMS_STREAM_INFO << "ObConfig from peer: " << peer.to_string() << " after resolve: " << oblog_config.debug_str();
-
-  if (auth(oblog_config, errmsg) != OMS_OK) {
-    response_error(peer, msg.version(), ErrorCode::NO_AUTH, errmsg);
+  // refuse invalid filters before any oblogreader started for them
+  RecordFilter filter;
+  if (filter.init(pending->oblog_config.table_columns.val(), pending->oblog_config.row_filters.val(), errmsg) !=
+      OMS_OK) {
+    response_error(peer, msg.version(), ErrorCode::E_PARSE, errmsg);
     return EventResult::ER_CLOSE_CHANNEL;
   }
 
-  // resolve sys user
-  if (!oblog_config.sys_user.empty()) {
-    oblog_config.user.set(oblog_config.sys_user.val());
-  } else {
-    oblog_config.user.set(Config::instance().ob_sys_username.val());
-  }
+  OMS_STREAM_INFO << "ObConfig from peer: " << peer.to_string()
+                  << " after resolve: " << pending->oblog_config.debug_str();
 
   if (check_quota() != OMS_OK) {
     // close connect directly to make client reconnect
     return EventResult::ER_CLOSE_CHANNEL;
   }
 
-  if (check_clog(oblog_config, errmsg) != OMS_OK) {
-    response_error(peer, msg.version(), ErrorCode::NO_AUTH, errmsg);
+  // auth and clog checks may wait for observers, never run them in event loop
+  std::string reason;
+  if (_handshakes.submit(pending, reason) != OMS_OK) {
+    OMS_STREAM_WARN << reason << ", reject peer: " << peer.to_string();
+    response_error(peer, msg.version(), E_INNER, reason);
     return EventResult::ER_CLOSE_CHANNEL;
   }
+  if (!pending->admitted) {
+    OMS_STREAM_INFO << "Handshake waits for admission, peer: " << peer.to_string() << ", " << reason;
+  }
+  return EventResult::ER_SUCCESS;
+}
+
+void Arranger::verify_handshake(const PendingHandshakePtr& handshake)
+{
+  OblogConfig& oblog_config = handshake->oblog_config;
+  if (Timer::now() > handshake->deadline_us) {
+    // expired while queuing, the client has been told already
+    return;
+  }
+
+  if (auth(oblog_config, handshake->errmsg) != OMS_OK) {
+    handshake->ret = OMS_FAILED;
+    handshake->code = ErrorCode::NO_AUTH;
+  } else {
+    // resolve sys user
+    if (!oblog_config.sys_user.empty()) {
+      oblog_config.user.set(oblog_config.sys_user.val());
+    } else {
+      oblog_config.user.set(Config::instance().ob_sys_username.val());
+    }
+
+    if (check_clog(oblog_config, handshake->errmsg) != OMS_OK) {
+      handshake->ret = OMS_FAILED;
+      handshake->code = ErrorCode::NO_AUTH;
+    }
+  }
+
+  _accepter.post([this, handshake] { on_handshake_verified(handshake); });
+}
+
+void Arranger::on_handshake_verified(const PendingHandshakePtr& handshake)
+{
+  const Peer& peer = handshake->client.peer;
+  if (!_handshakes.complete(handshake)) {
+    // closed by client or expired
+    OMS_STREAM_WARN << "Drop result of handshake no longer pending, peer: " << peer.to_string();
+    return;
+  }
+
+  MessageVersion version = handshake->client.packet_version;
+  if (handshake->ret != OMS_OK) {
+    response_error(peer, version, handshake->code, handshake->errmsg);
+    _accepter.del(peer);
+    return;
+  }
 
   ClientHandshakeResponseMessage resp(0, _localip, __OMS_VERSION__);
-  resp.set_version(msg.version());
+  resp.set_version(version);
   int ret = _accepter.send_message(peer, resp, true);
   if (ret != OMS_OK) {
     OMS_STREAM_WARN << "Failed to send handshake response message. peer: " << peer.to_string();
-    return EventResult::ER_CLOSE_CHANNEL;
+    _accepter.del(peer);
+    return;
   }
 
-  client.peer = peer;
-  ret = create(client, oblog_config);
+  ret = create(handshake->client, handshake->oblog_config);
   if (ret != OMS_OK) {
-    response_error(peer, msg.version(), E_INNER, "Failed to create oblogreader");
-    return EventResult::ER_CLOSE_CHANNEL;
+    response_error(peer, version, E_INNER, "Failed to create oblogreader");
+    _accepter.del(peer);
   }
-  return EventResult::ER_SUCCESS;
+}
+
+void Arranger::expire_handshakes()
+{
+  _handshakes.expire(Timer::now(), [this](const PendingHandshakePtr& handshake) {
+    if (!handshake->admitted) {
+      OMS_STREAM_WARN << "Handshake not admitted after " << _s_conf.admission_wait_s.val()
+                      << "s, peer: " << handshake->client.peer.to_string();
+      response_error(handshake->client.peer, handshake->client.packet_version, E_INNER, "Exceed node capacity");
+    } else {
+      // the worker may still wait for observer, its result will be dropped
+      OMS_STREAM_WARN << "Handshake timeout after " << _s_conf.handshake_timeout_s.val()
+                      << "s, peer: " << handshake->client.peer.to_string();
+      response_error(handshake->client.peer, handshake->client.packet_version, E_INNER, "Handshake timeout");
+    }
+    _accepter.del(handshake->client.peer);
+  });
+}
+
+int Arranger::admit(size_t admitted, std::string& reason)
+{
+  // each one started or being checked reserves its budget
+  return Admission::admit(_client_peers.size() + admitted, reason);
 }
 
 int Arranger::resolve(OblogConfig& hs_config, std::string& errmsg)
@@ -188,8 +291,10 @@ int Arranger::check_quota()
     return OMS_OK;
   }
 
-  if (_client_peers.size() >= _s_conf.oblogreader_max_count.val()) {
-    OMS_STREAM_ERROR << "Exceed max oblogreader count, current: " << _client_peers.size();
+  // handshakes in progress will create oblogreaders too
+  size_t count = _client_peers.size() + _handshakes.size();
+  if (count >= _s_conf.oblogreader_max_count.val()) {
+    OMS_STREAM_ERROR << "Exceed max oblogreader count, current: " << count;
     return OMS_FAILED;
   }
 
@@ -223,8 +328,10 @@ int Arranger::create(ClientMeta& client, OblogConfig& oblog_config)
     //    close_client_force(fd_entry->second, "Duplication exist client_id");
   }
 
-  int ret = SourceInvoke::invoke(_accepter, client, oblog_config);
+  ClogMetaHub::instance().attach(client_id, oblog_config);
+  int ret = SourceInvoke::invoke(client, oblog_config);
   if (ret <= 0) {
+    ClogMetaHub::instance().detach(client_id);
     OMS_STREAM_ERROR << "Failed to start source of client:" << client.to_string();
     return OMS_FAILED;
   }
@@ -234,6 +341,9 @@ int Arranger::create(ClientMeta& client, OblogConfig& oblog_config)
                   << " after source invoked, current channel count:" << _accepter.channel_count();
 
   client.pid = ret;
+  if (Cgroup::enabled()) {
+    Cgroup::place("oblogreader." + std::to_string(ret), ret, ResourceBudget::client());
+  }
   _client_peers.emplace(client_id, client);
   OMS_STREAM_INFO << "Client connected: " << client_id << " with peer: " << client.peer.to_string();
   return OMS_OK;
@@ -252,6 +362,7 @@ void Arranger::response_error(const Peer& peer, MessageVersion version, ErrorCod
 
 void Arranger::on_close(const Peer& peer)
 {
+  _handshakes.remove(peer.id());
   for (auto iter = _client_peers.begin(); iter != _client_peers.end(); ++iter) {
     if (iter->second.peer.id() == peer.id()) {
       OMS_STREAM_WARN << "On close peer fd: " << peer.fd << " with client: " << iter->second.id;
@@ -261,6 +372,7 @@ void Arranger::on_close(const Peer& peer)
       shutdown(fd, SHUT_RDWR);
       OMS_STREAM_WARN << "Shutdown fd: " << fd;
 
+      ClogMetaHub::instance().detach(iter->first);
       _client_peers.erase(iter);
       break;
     }
@@ -293,6 +405,7 @@ int Arranger::close_client_force(const ClientMeta& client, const std::string& ms
       ::kill(pid, SIGKILL);
       close_by_pid(pid, client);
     }
+    ClogMetaHub::instance().detach(entry->first);
     _client_peers.erase(entry);
   }
   return OMS_OK;
@@ -305,11 +418,27 @@ void Arranger::gc_pid_routine()
     // detect if oblogreader still alive
     if (kill(pid, 0) != 0) {
       close_by_pid(pid, iter->second);
+      ClogMetaHub::instance().detach(iter->first);
       iter = _client_peers.erase(iter);
     } else {
       ++iter;
     }
   }
+  if (Cgroup::enabled()) {
+    Cgroup::gc("oblogreader.");
+  }
+}
+
+void Arranger::on_metrics(HttpResponse& response)
+{
+  std::vector<std::string> child_files;
+  child_files.reserve(_client_peers.size());
+  for (const auto& entry : _client_peers) {
+    child_files.emplace_back(
+        _s_conf.oblogreader_path.val() + "/" + entry.first + "/" + _s_conf.metric_export_file.val());
+  }
+  response.headers.emplace("Content-Type", "text/plain; version=0.0.4");
+  MetricRegistry::instance().render(child_files, response.payload);
 }
 
 void Arranger::close_by_pid(int pid, const ClientMeta& client)
@@ -343,23 +472,7 @@ void Arranger::close_by_pid(int pid, const ClientMeta& client)
 
 int Arranger::check_clog(const OblogConfig& oblog_config, std::string& errmsg)
 {
-
-  if (!_s_conf.check_clog_enable.val()) {
-    return OMS_OK;
-  }
-
-  ClogMetaRoutine clog_meta;
-  if (clog_meta.init(oblog_config) != OMS_OK) {
-    OMS_STREAM_ERROR << "Failed to initialize the Clog site checker";
-    return OMS_FAILED;
-  }
-
-  if (!clog_meta.check(oblog_config, errmsg)) {
-    OMS_STREAM_ERROR << errmsg;
-    return OMS_FAILED;
-  }
-
-  return OMS_OK;
+  return ClogMetaHub::instance().check(oblog_config, errmsg);
 }
 
 }  // namespace logproxy
@@ -18,6 +18,8 @@
 #include "source_meta.h"
 #include "client_meta.h"
 #include "oblog_config.h"
+#include "communication/http.h"
+#include "handshake_worker.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -35,6 +37,23 @@ private:
 
   EventResult on_handshake(const Peer&, const Message&);
 
+  /*!
+   * @brief Checks of handshake talking to observers, run by HandshakeWorker
+   */
+  void verify_handshake(const PendingHandshakePtr& handshake);
+
+  /*!
+   * @brief Reply and create oblogreader in event loop once checks of handshake are done
+   */
+  void on_handshake_verified(const PendingHandshakePtr& handshake);
+
+  void expire_handshakes();
+
+  /*!
+   * @brief Whether budgets of running clients and handshakes admitted leave room for one more
+   */
+  int admit(size_t admitted, std::string& reason);
+
   int resolve(OblogConfig&, std::string& errmsg);
 
   int auth(const OblogConfig&, std::string& errmsg);
@@ -59,16 +78,29 @@ private:
 
   void gc_pid_routine();
 
+  /*!
+   * @brief Serve /metrics, merging metrics exported by all alive oblogreaders
+   */
+  void on_metrics(HttpResponse& response);
+
 private:
   /**
    * <ClientId, sink_peer>
    */
   std::unordered_map<std::string, ClientMeta> _client_peers;
 
+  static constexpr size_t HANDSHAKE_QUEUE_SIZE = 1024;
+
+  HandshakeScheduler _handshakes{[this](const PendingHandshakePtr& handshake) { verify_handshake(handshake); },
+      [this](size_t admitted, std::string& reason) { return admit(admitted, reason); },
+      HANDSHAKE_QUEUE_SIZE};
+
   std::string _localhost;
   std::string _localip;
 
   Comm _accepter;
+
+  HttpServer _metric_server;
 };
 
 // class SysMetric;
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <unistd.h>
+#include <thread>
+#include "log.h"
+#include "config.h"
+#include "clog_meta_hub.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+ClogMetaHub::Poller::Poller(const std::string& shm_name, const OblogConfig& config)
+    : Thread("ClogMetaPoller"), _shm_name(shm_name)
+{
+  _config = config;
+}
+
+void ClogMetaHub::Poller::stop()
+{
+  if (is_run()) {
+    Thread::stop();
+    _timer.interrupt();
+  }
+}
+
+void ClogMetaHub::Poller::run()
+{
+  uint64_t interval_us = _s_config.ob_clog_fetch_interval_s.val() * 1000000;
+  while (is_run() && routine.init(_config) != OMS_OK) {
+    _timer.sleep(interval_us);
+  }
+  while (is_run()) {
+    routine.poll_once();
+    _timer.sleep(interval_us);
+  }
+}
+
+void ClogMetaHub::attach(const std::string& client_id, const OblogConfig& config)
+{
+  if (!_s_config.check_clog_enable.val()) {
+    return;
+  }
+
+  std::string shm_name = ClogMetaShm::name(getpid(), config);
+  std::lock_guard<std::mutex> guard(_lock);
+  std::shared_ptr<Poller>& poller = _pollers[shm_name];
+  if (poller == nullptr) {
+    OMS_STREAM_INFO << "Start polling clog timestamps of cluster for oblogreaders: " << shm_name;
+    poller = std::make_shared<Poller>(shm_name, config);
+    // created before the oblogreader is spawned, so that it finds the segment when subscribing
+    if (poller->routine.publish(shm_name) == OMS_OK) {
+      poller->start();
+    } else {
+      OMS_STREAM_WARN << "Failed to publish clog timestamps to " << shm_name << ", oblogreaders poll by themselves";
+    }
+  }
+  poller->clients.insert(client_id);
+  _client_pollers[client_id] = shm_name;
+}
+
+void ClogMetaHub::detach(const std::string& client_id)
+{
+  std::shared_ptr<Poller> stopped;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    auto entry = _client_pollers.find(client_id);
+    if (entry == _client_pollers.end()) {
+      return;
+    }
+    auto poller = _pollers.find(entry->second);
+    _client_pollers.erase(entry);
+    if (poller == _pollers.end()) {
+      return;
+    }
+    poller->second->clients.erase(client_id);
+    if (!poller->second->clients.empty()) {
+      return;
+    }
+    OMS_STREAM_INFO << "Stop polling clog timestamps of cluster without oblogreaders: " << poller->first;
+    stopped = poller->second;
+    _pollers.erase(poller);
+  }
+
+  // an inflight query may take up to its timeout, never wait for it in event loop
+  stopped->stop();
+  std::thread([stopped]() { stopped->join(); }).detach();
+}
+
+int ClogMetaHub::check(const OblogConfig& config, std::string& errmsg)
+{
+  if (!_s_config.check_clog_enable.val()) {
+    return OMS_OK;
+  }
+
+  uint64_t min_clog_timestamp_us = 0;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    auto poller = _pollers.find(ClogMetaShm::name(getpid(), config));
+    if (poller != _pollers.end()) {
+      min_clog_timestamp_us = poller->second->routine.min_clog_timestamp_us();
+    }
+  }
+
+  if (min_clog_timestamp_us == 0) {
+    ClogMetaRoutine clog_meta;
+    if (clog_meta.init(config) != OMS_OK) {
+      OMS_STREAM_ERROR << "Failed to initialize the Clog site checker";
+      return OMS_FAILED;
+    }
+    if (!clog_meta.check(config, errmsg)) {
+      OMS_STREAM_ERROR << errmsg;
+      return OMS_FAILED;
+    }
+    return OMS_OK;
+  }
+
+  uint64_t start_timestamp_us = (config.start_timestamp_us.val() != 0) ? config.start_timestamp_us.val()
+                                                                       : config.start_timestamp.val() * 1000000;
+  if (start_timestamp_us != 0 && start_timestamp_us < min_clog_timestamp_us) {
+    errmsg =
+        "Invalid start timestamp while current min clog timestamp in us: " + std::to_string(min_clog_timestamp_us);
+    OMS_STREAM_ERROR << errmsg;
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
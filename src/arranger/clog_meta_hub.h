@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "common.h"
+#include "thread.h"
+#include "timer.h"
+#include "oblog_config.h"
+#include "obaccess/clog_meta_routine.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Pollers of min clog timestamps in logproxy process, one for each cluster having alive oblogreaders.
+ * Each poller publishes to a ClogMetaShm segment subscribed by the oblogreaders of its cluster, which therefore
+ * share one sys connection and one query instead of polling observers by themselves.
+ */
+class ClogMetaHub {
+  OMS_SINGLETON(ClogMetaHub);
+  OMS_AVOID_COPY(ClogMetaHub);
+
+public:
+  /*!
+   * @brief Poll the cluster of an oblogreader to create, until all oblogreaders of the cluster are detached.
+   * Called before the oblogreader is spawned, as the segment it subscribes is created here.
+   */
+  void attach(const std::string& client_id, const OblogConfig& config);
+
+  void detach(const std::string& client_id);
+
+  /*!
+   * @brief Check start timestamp of a handshake against the latest polled timestamp of its cluster,
+   * only query observers when no oblogreader of the cluster is alive
+   */
+  int check(const OblogConfig& config, std::string& errmsg);
+
+private:
+  /*!
+   * @brief Polls in its own thread, so that connecting to a slow cluster never blocks the event loop
+   */
+  class Poller : public Thread {
+  public:
+    Poller(const std::string& shm_name, const OblogConfig& config);
+
+    void stop() override;
+
+    std::set<std::string> clients;
+    ClogMetaRoutine routine;
+
+  protected:
+    void run() override;
+
+  private:
+    std::string _shm_name;
+    OblogConfig _config{""};
+    Timer _timer;
+  };
+
+  std::mutex _lock;
+  /**
+   * <shm name, poller>
+   */
+  std::map<std::string, std::shared_ptr<Poller>> _pollers;
+  /**
+   * <client id, shm name>
+   */
+  std::unordered_map<std::string, std::string> _client_pollers;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
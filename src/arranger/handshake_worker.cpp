@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "config.h"
+#include "log.h"
+#include "timer.h"
+#include "handshake_worker.h"
+
+namespace oceanbase {
+namespace logproxy {
+static Config& _s_conf = Config::instance();
+
+HandshakeWorker::HandshakeWorker(
+    BlockingQueue<PendingHandshakePtr>& queue, std::function<void(const PendingHandshakePtr&)> handler)
+    : Thread("HandshakeWorker"), _queue(queue), _handler(std::move(handler))
+{}
+
+bool HandshakeWorker::stuck(uint64_t now_us) const
+{
+  uint64_t deadline_us = _deadline_us.load();
+  return deadline_us != 0 && now_us > deadline_us;
+}
+
+void HandshakeWorker::run()
+{
+  while (is_run()) {
+    PendingHandshakePtr handshake;
+    if (!_queue.poll(handshake, _s_conf.read_timeout_us.val())) {
+      continue;
+    }
+    _deadline_us.store(handshake->deadline_us);
+    _handler(handshake);
+    _deadline_us.store(0);
+  }
+}
+
+HandshakeScheduler::HandshakeScheduler(Handler verify, AdmitFunc admit, size_t queue_size)
+    : _verify(std::move(verify)), _admit(std::move(admit)), _queue(queue_size)
+{}
+
+HandshakeScheduler::~HandshakeScheduler()
+{
+  for (HandshakeWorker* worker : _workers) {
+    worker->stop();
+  }
+  for (HandshakeWorker* worker : _workers) {
+    worker->join();
+    delete worker;
+  }
+}
+
+void HandshakeScheduler::start(uint32_t worker_count)
+{
+  for (uint32_t i = 0; i < std::max(1U, worker_count); ++i) {
+    _workers.push_back(new_worker());
+  }
+}
+
+HandshakeWorker* HandshakeScheduler::new_worker()
+{
+  auto* worker = new HandshakeWorker(_queue, _verify);
+  worker->start();
+  return worker;
+}
+
+bool HandshakeScheduler::contains(uint64_t peer_id) const
+{
+  return _pending.find(peer_id) != _pending.end();
+}
+
+int HandshakeScheduler::submit(const PendingHandshakePtr& handshake, std::string& reason)
+{
+  // later ones never overtake handshakes waiting for admission
+  if (!_waiting.empty()) {
+    reason = std::to_string(_waiting.size()) + " handshakes waiting for admission ahead";
+  }
+  if (!reason.empty() || _admit(admitted(), reason) != OMS_OK) {
+    if (_s_conf.admission_wait_s.val() == 0) {
+      return OMS_FAILED;
+    }
+    handshake->admitted = false;
+    handshake->deadline_us = Timer::now() + (uint64_t)_s_conf.admission_wait_s.val() * 1000000;
+    _waiting.push_back(handshake);
+    _pending.emplace(handshake->client.peer.id(), handshake);
+    return OMS_OK;
+  }
+
+  if (!_queue.offer(handshake, 0)) {
+    reason = "Too many handshakes in progress";
+    return OMS_FAILED;
+  }
+  _pending.emplace(handshake->client.peer.id(), handshake);
+  return OMS_OK;
+}
+
+bool HandshakeScheduler::complete(const PendingHandshakePtr& handshake)
+{
+  auto entry = _pending.find(handshake->client.peer.id());
+  if (entry == _pending.end() || entry->second != handshake) {
+    return false;
+  }
+  _pending.erase(entry);
+  return true;
+}
+
+void HandshakeScheduler::remove(uint64_t peer_id)
+{
+  auto entry = _pending.find(peer_id);
+  if (entry == _pending.end()) {
+    return;
+  }
+  auto iter = std::find(_waiting.begin(), _waiting.end(), entry->second);
+  if (iter != _waiting.end()) {
+    _waiting.erase(iter);
+  }
+  _pending.erase(entry);
+}
+
+void HandshakeScheduler::expire(uint64_t now_us, const Handler& on_expired)
+{
+  std::vector<PendingHandshakePtr> expired;
+  for (const auto& entry : _pending) {
+    if (now_us > entry.second->deadline_us) {
+      expired.push_back(entry.second);
+    }
+  }
+  for (const PendingHandshakePtr& handshake : expired) {
+    on_expired(handshake);
+    remove(handshake->client.peer.id());
+  }
+
+  for (HandshakeWorker*& worker : _workers) {
+    if (!worker->stuck(now_us)) {
+      continue;
+    }
+    OMS_WARN(
+        "Replace handshake worker({}) stuck in checks after {}s", worker->tid(), _s_conf.handshake_timeout_s.val());
+    // released by itself once the checks return
+    worker->set_release_state(true);
+    worker->detach();
+    worker->stop();
+    worker = new_worker();
+  }
+}
+
+void HandshakeScheduler::admit_waiting()
+{
+  while (!_waiting.empty()) {
+    std::string reason;
+    if (_admit(admitted(), reason) != OMS_OK) {
+      return;
+    }
+    const PendingHandshakePtr& handshake = _waiting.front();
+    handshake->admitted = true;
+    handshake->deadline_us = Timer::now() + (uint64_t)_s_conf.handshake_timeout_s.val() * 1000000;
+    if (!_queue.offer(handshake, 0)) {
+      handshake->admitted = false;
+      return;
+    }
+    OMS_INFO("Handshake admitted, peer: {}", handshake->client.peer.to_string());
+    _waiting.pop_front();
+  }
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "thread.h"
+#include "blocking_queue.hpp"
+#include "client_meta.h"
+#include "oblog_config.h"
+#include "codec/message.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief A handshake waiting for the checks talking to observers, e.g. auth and clog
+ */
+struct PendingHandshake {
+  PendingHandshake(const ClientMeta& client_meta, uint64_t deadline)
+      : client(client_meta), oblog_config(client_meta.configuration), deadline_us(deadline)
+  {}
+
+  ClientMeta client;
+  // never copy OblogConfig, whose items are registered by address
+  OblogConfig oblog_config;
+  uint64_t deadline_us = 0;
+  // false while waiting for budgets of running clients released, until deadline_us
+  bool admitted = true;
+
+  // result of checks
+  int ret = OMS_OK;
+  ErrorCode code = ErrorCode::NONE;
+  std::string errmsg;
+};
+
+using PendingHandshakePtr = std::shared_ptr<PendingHandshake>;
+
+/*!
+ * @brief Runs checks of handshakes polled from the queue, out of the event loop, so that one slow observer never
+ * stalls handshakes of other clients
+ */
+class HandshakeWorker : public Thread {
+public:
+  HandshakeWorker(BlockingQueue<PendingHandshakePtr>& queue, std::function<void(const PendingHandshakePtr&)> handler);
+
+  /*!
+   * @brief Whether still checking a handshake past its deadline, e.g. blocked by an observer not responding
+   */
+  bool stuck(uint64_t now_us) const;
+
+protected:
+  void run() override;
+
+private:
+  BlockingQueue<PendingHandshakePtr>& _queue;
+  std::function<void(const PendingHandshakePtr&)> _handler;
+  // deadline of the handshake being checked, 0 if idle
+  std::atomic<uint64_t> _deadline_us{0};
+};
+
+/*!
+ * @brief States of handshakes from arrival until checked: waiting for admission in arrival order until
+ * admission_wait_s, then queued for and checked by workers until handshake_timeout_s. Called in event loop only, except
+ * the checks
+ */
+class HandshakeScheduler {
+public:
+  using Handler = std::function<void(const PendingHandshakePtr&)>;
+  /*!
+   * @brief Whether budgets leave room for one more client, given handshakes admitted and not done yet
+   */
+  using AdmitFunc = std::function<int(size_t admitted, std::string& reason)>;
+
+  HandshakeScheduler(Handler verify, AdmitFunc admit, size_t queue_size);
+
+  ~HandshakeScheduler();
+
+  void start(uint32_t worker_count);
+
+  inline size_t size() const
+  {
+    return _pending.size();
+  }
+
+  /*!
+   * @brief Handshakes queued for or in checks, which reserve budgets of clients
+   */
+  inline size_t admitted() const
+  {
+    return _pending.size() - _waiting.size();
+  }
+
+  inline size_t waiting() const
+  {
+    return _waiting.size();
+  }
+
+  bool contains(uint64_t peer_id) const;
+
+  /*!
+   * @brief Queue the handshake for checks, or for admission if budgets are used up and admission_wait_s allows
+   * @return OMS_FAILED with reason if rejected
+   */
+  int submit(const PendingHandshakePtr& handshake, std::string& reason);
+
+  /*!
+   * @brief Take the handshake whose checks are done
+   * @return false if no longer pending, e.g. closed by client or expired
+   */
+  bool complete(const PendingHandshakePtr& handshake);
+
+  void remove(uint64_t peer_id);
+
+  /*!
+   * @brief Drop handshakes past deadline, and replace workers stuck in checks of them, which exit once the checks
+   * return with results dropped
+   * @param on_expired called for each handshake before dropped
+   */
+  void expire(uint64_t now_us, const Handler& on_expired);
+
+  /*!
+   * @brief Queue handshakes waiting for admission for checks in arrival order, as far as budgets allow
+   */
+  void admit_waiting();
+
+private:
+  HandshakeWorker* new_worker();
+
+  Handler _verify;
+  AdmitFunc _admit;
+  // <peer id, handshake> not done yet
+  std::unordered_map<uint64_t, PendingHandshakePtr> _pending;
+  // handshakes not admitted yet, also in _pending
+  std::deque<PendingHandshakePtr> _waiting;
+  BlockingQueue<PendingHandshakePtr> _queue;
+  std::vector<HandshakeWorker*> _workers;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
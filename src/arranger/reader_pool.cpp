@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <csignal>
+#include "log.h"
+#include "config.h"
+#include "fs_util.h"
+#include "communication/io.h"
+#include "metric/sys_metric.h"
+#include "reader_pool.h"
+#include "spawner.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+void ReaderPool::replenish()
+{
+  for (auto iter = _standbys.begin(); iter != _standbys.end();) {
+    if (kill(iter->pid, 0) != 0) {
+      OMS_STREAM_WARN << "Standby oblogreader exited before serving any client, pid: " << iter->pid;
+      release(*iter, false);
+      iter = _standbys.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  size_t count = _s_config.oblogreader_prefork_count.val();
+  while (_standbys.size() > count) {
+    release(_standbys.back(), true);
+    _standbys.pop_back();
+  }
+  if (_standbys.size() == count) {
+    return;
+  }
+
+  std::string config_file = _s_config.oblogreader_path.val() + "/" + STANDBY_PATH + "/" + STANDBY_CONFIG;
+  if (serialize_configs(config_file) != OMS_OK) {
+    OMS_STREAM_ERROR << "Failed to serialize configs of standby oblogreaders to file: " << config_file;
+    return;
+  }
+  while (_standbys.size() < count) {
+    Standby standby;
+    if (spawn(standby) != OMS_OK) {
+      return;
+    }
+    _standbys.push_back(standby);
+  }
+}
+
+int ReaderPool::take(const ClientMeta& client, const std::string& config_name, const std::string& work_path)
+{
+  // <config name>\0<work path>
+  std::string payload = config_name;
+  payload.push_back('\0');
+  payload.append(work_path);
+
+  while (!_standbys.empty()) {
+    Standby standby = _standbys.front();
+    _standbys.pop_front();
+
+    if (send_fd(standby.sock, payload.data(), payload.size(), client.peer.fd) != OMS_OK) {
+      OMS_STREAM_WARN << "Failed to hand over client: " << client.id << " to standby oblogreader: " << standby.pid;
+      release(standby, true);
+      continue;
+    }
+    // standby exits once its socket closed without a client, so close only after client sent
+    release(standby, false);
+    OMS_STREAM_INFO << "+++ Handed over client: " << client.id << " to standby oblogreader with pid: " << standby.pid
+                    << ", remaining standbys: " << _standbys.size();
+    return standby.pid;
+  }
+  return OMS_FAILED;
+}
+
+int ReaderPool::spawn(Standby& standby)
+{
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+    OMS_STREAM_ERROR << "Failed to create socket pair for standby oblogreader: " << strerror(errno);
+    return OMS_FAILED;
+  }
+
+  std::string work_path = _s_config.oblogreader_path.val() + "/" + STANDBY_PATH;
+  std::string sock = std::to_string(fds[1]);
+  // standby never serves clients connected before it, the socket is the only fd inherited on purpose
+  std::string oblogreader_bin_file = _s_config.bin_path.val() + std::string("/") + "oblogreader";
+  int pid = spawn_process(
+      oblogreader_bin_file, {"./oblogreader", STANDBY_CONFIG, work_path, STANDBY_ARG, sock}, {fds[1]});
+  close(fds[1]);
+  if (pid < 0) {
+    close(fds[0]);
+    return OMS_FAILED;
+  }
+
+  standby.pid = pid;
+  standby.sock = fds[0];
+  OMS_STREAM_INFO << "+++ Created standby oblogreader with pid: " << pid;
+  track_process(pid);
+  return OMS_OK;
+}
+
+int ReaderPool::serialize_configs(const std::string& config_file)
+{
+  FsUtil::mkdir(config_file.substr(0, config_file.find_last_of('/')));
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  Config::instance().to_json(writer);
+  writer.EndObject();
+  return FsUtil::write_file(config_file, buffer.GetString());
+}
+
+void ReaderPool::release(Standby& standby, bool kill_process)
+{
+  if (kill_process) {
+    ::kill(standby.pid, SIGKILL);
+  }
+  if (standby.sock >= 0) {
+    close(standby.sock);
+    standby.sock = -1;
+  }
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
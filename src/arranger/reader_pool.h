@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include "common.h"
+#include "client_meta.h"
+#include "communication/comm.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Standby oblogreader processes started ahead of handshakes, which have loaded the obcdc libraries of
+ * oblogreader_prefork_ob_versions and wait on a unix domain socket for a client. Taking a standby for a client
+ * sends it the client socket(SCM_RIGHTS) and the path of serialized configs, saving fork, exec and loading obcdc
+ * from the latency between handshake and the first record sent to client.
+ * Only used in the event loop of logproxy, as forking oblogreaders does.
+ */
+class ReaderPool {
+  OMS_SINGLETON(ReaderPool);
+  OMS_AVOID_COPY(ReaderPool);
+
+public:
+  static constexpr const char* STANDBY_ARG = "--standby";
+  static constexpr const char* STANDBY_PATH = "standby";
+  static constexpr const char* STANDBY_CONFIG = "standby.conf";
+
+  /*!
+   * @brief Forget exited standbys, then start or kill standbys to keep oblogreader_prefork_count of them
+   */
+  void replenish();
+
+  /*!
+   * @brief Hand over a client to a standby oblogreader, whose configs have been serialized to work_path/config_name
+   * @return pid of the standby serving the client, or OMS_FAILED if no standby available
+   */
+  int take(const ClientMeta& client, const std::string& config_name, const std::string& work_path);
+
+  inline size_t idle_count() const
+  {
+    return _standbys.size();
+  }
+
+private:
+  struct Standby {
+    int pid = -1;
+    int sock = -1;
+  };
+
+  int spawn(Standby& standby);
+
+  int serialize_configs(const std::string& config_file);
+
+  static void release(Standby& standby, bool kill_process);
+
+private:
+  std::deque<Standby> _standbys;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
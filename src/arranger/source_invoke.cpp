@@ -19,12 +19,15 @@
 #include "config.h"
 #include "fs_util.h"
 #include "obaccess/ob_access.h"
+#include "metric/sys_metric.h"
+#include "reader_pool.h"
 #include "source_invoke.h"
+#include "spawner.h"
 
 namespace oceanbase {
 namespace logproxy {
 
-int SourceInvoke::start_oblogreader(Comm& comm, const ClientMeta& client, OblogConfig& config)
+int SourceInvoke::start_oblogreader(const ClientMeta& client, OblogConfig& config)
 {
   std::string oblogreader_work_path = Config::instance().oblogreader_path.val() + std::string("/") + client.id;
   FsUtil::mkdir(oblogreader_work_path);
@@ -35,27 +38,21 @@ int SourceInvoke::start_oblogreader(Comm& comm, const ClientMeta& client, OblogC
     return OMS_FAILED;
   }
 
-  int pid = fork();
-  if (pid == -1) {
-    OMS_ERROR("Failed to fork: {}({})", errno, strerror(errno));
-    return OMS_FAILED;
+  int pid = ReaderPool::instance().take(client, config_name, oblogreader_work_path);
+  if (pid > 0) {
+    return pid;
   }
 
-  if (pid == 0) {  // children
-    // close fds
-    comm.stop(client.peer.fd);
-
-    // exec oblogreader
-    std::string oblogreader_bin_file = Config::instance().bin_path.val() + std::string("/") + "oblogreader";
-    char* argv[] = {const_cast<char*>("./oblogreader"),
-        const_cast<char*>(config_name.c_str()),
-        const_cast<char*>(oblogreader_work_path.c_str()),
-        nullptr};
-    execv(oblogreader_bin_file.c_str(), argv);
-    ::exit(-1);
+  // oblogreader serves the client on its fd, which is in the configs, and inherits no other fd but stdio
+  std::string oblogreader_bin_file = Config::instance().bin_path.val() + std::string("/") + "oblogreader";
+  pid = spawn_process(
+      oblogreader_bin_file, {"./oblogreader", config_name, oblogreader_work_path}, {client.peer.fd});
+  if (pid < 0) {
+    return OMS_FAILED;
   }
 
   OMS_INFO("+++ Created oblogreader with pid: {}", pid);
+  track_process(pid);
   return pid;
 }
 
@@ -78,11 +75,11 @@ int SourceInvoke::serialize_configs(const ClientMeta& client, const OblogConfig&
 /**
  * @return pid of childern process or -1 failurs, childern process never return
  */
-int SourceInvoke::invoke(Comm& comm, const ClientMeta& client, OblogConfig& config)
+int SourceInvoke::invoke(const ClientMeta& client, OblogConfig& config)
 {
   switch (client.type) {
     case OCEANBASE:
-      return start_oblogreader(comm, client, config);
+      return start_oblogreader(client, config);
 
     default:
       OMS_ERROR("Unsupported invoke log type: {}", client.type);
@@ -22,12 +22,12 @@ namespace logproxy {
 
 class SourceInvoke {
 public:
-  static int invoke(Comm&, const ClientMeta&, OblogConfig&);
+  static int invoke(const ClientMeta&, OblogConfig&);
 
 private:
   static int serialize_configs(const ClientMeta& client, const OblogConfig& config, const std::string& config_file);
 
-  static int start_oblogreader(Comm& comm, const ClientMeta& client, OblogConfig& config);
+  static int start_oblogreader(const ClientMeta& client, OblogConfig& config);
 };
 
 }  // namespace logproxy
@@ -11,6 +11,7 @@
  */
 
 #include <bitset>
+#include <string_view>
 #include "config.h"
 #include "oblog_config.h"
 #include "counter.h"
@@ -24,6 +25,7 @@
 #include "binlog_convert.h"
 #include "counter.h"
 #include "ddl-converter/ddl_converter.h"
+#include "metric/latency_tracer.h"
 namespace oceanbase {
 namespace logproxy {
 static Config& _s_config = Config::instance();
@@ -39,7 +41,12 @@ static __thread LogMsgBuf* _t_s_lmb = nullptr;
 
 BinlogConvert::BinlogConvert(
     BinlogConverter& converter, BlockingQueue<ILogRecord*>& rqueue, BlockingQueue<ObLogEvent*>& event_queue)
-    : Thread("BinlogConvert"), _oblog(nullptr), _converter(converter), _rqueue(rqueue), _event_queue(event_queue)
+    : Thread("BinlogConvert"),
+      _oblog(nullptr),
+      _converter(converter),
+      _rqueue(rqueue),
+      _event_queue(event_queue),
+      _writeset_tracker(_s_config.binlog_writeset_history_size.val())
 {}
 
 int BinlogConvert::init(ConvertMeta& meta, OblogConfig& config, IObCdcAccess* oblog)
@@ -56,6 +63,9 @@ int BinlogConvert::init(ConvertMeta& meta, OblogConfig& config, IObCdcAccess* ob
     this->_cur_pos -= 16;
   }
   OMS_INFO("cur_pos: {}", this->_cur_pos);
+  if (_s_config.binlog_ddl_convert.val()) {
+    DdlConverter::warm_up();
+  }
 
   return recover(meta, config);
 }
@@ -84,10 +94,12 @@ int BinlogConvert::consume_exactly_once(const ConvertMeta& meta, OblogConfig& co
 
   OMS_INFO("Seek gtid events from: {}, result count: {}", index_record._file_name, gtid_events.size());
   size_t txn_ts = 0;
+  uint64_t sequence_number = 0;
   if (!gtid_events.empty()) {
     GtidLogEvent* event = gtid_events.back();
     _txn_id = event->get_gtid_txn_id();
-    txn_ts = event->get_last_committed() * 1000000 + event->get_sequence_number();
+    txn_ts = event->get_commit_timestamp_us();
+    sequence_number = event->get_sequence_number();
     config.start_timestamp_us.set(index_record.get_checkpoint());
     _start_timestamp = index_record.get_checkpoint();
     if (_txn_id == index_record._current_mapping.second) {
@@ -185,6 +197,8 @@ int BinlogConvert::consume_exactly_once(const ConvertMeta& meta, OblogConfig& co
 
   } else {
     _binlog_file_index = index_record.get_index();
+    // logical clocks go on within the current binlog file
+    _writeset_tracker.reset(sequence_number);
   }
 
   return OMS_OK;
@@ -205,14 +219,22 @@ void BinlogConvert::run()
     _stage_timer.reset();
     records.clear();
     while (!_rqueue.poll(records, _s_config.read_timeout_us.val()) || records.empty()) {
-      OMS_STREAM_INFO << "send transfer queue empty, retry...";
+      OMS_INFO_EVERY(10, "send transfer queue empty, retry...");
+    }
+    for (ILogRecord* r : records) {
+      LatencyTracer::instance().stamp(r, TRACE_QUEUE);
     }
     do_convert(records);
     for (ILogRecord* r : records) {
+      // traces of filtered transactions
+      LatencyTracer::instance().discard(r);
       _oblog->release(r);
     }
     logproxy::Counter::instance().count_key(Counter::SENDER_ENCODE_US, _stage_timer.elapsed());
   }
+  // events of the incomplete transaction are never appended
+  release_vector(_txn_events);
+  _txn_gtid = nullptr;
   LogMsgLocalDestroy;
 }
 
@@ -250,19 +272,20 @@ void BinlogConvert::convert_gtid_log_event(ILogRecord* record)
   gtid_log_event->set_gtid_uuid(this->get_meta().server_uuid);
 
   // set common _header
-  uint32_t event_len = COMMON_HEADER_LENGTH + GTID_HEADER_LEN + gtid_log_event->get_checksum_len();
+  uint32_t event_len = COMMON_HEADER_LENGTH + GTID_HEADER_LEN + GtidLogEvent::COMMIT_TIMESTAMP_LEN +
+                       gtid_log_event->get_checksum_len();
   auto* common_header =
       new OblogEventHeader(GTID_LOG_EVENT, get_timestamp_sec(record), event_len, this->_cur_pos + event_len);
   gtid_log_event->set_header(common_header);
   gtid_log_event->set_ob_txn(get_transaction_id(record));
   gtid_log_event->set_checkpoint(get_checkpoint_usec(record));
-  gtid_log_event->set_last_committed(record->getTimestamp());
-  gtid_log_event->set_sequence_number(record->getRecordUsec());
+  gtid_log_event->set_commit_timestamp_us(get_timestamp_usec(record));
 
   if (!this->_filter) {
     this->_cur_pos = gtid_log_event->get_header()->get_next_position();
     this->_txn_id = gtid_log_event->get_gtid_txn_id();
-    append_event(this->_event_queue, gtid_log_event);
+    // neither DDL nor transactions around it run in parallel with each other
+    begin_txn_events(gtid_log_event, record->recordType() == EDDL);
     convert_query_event(record);
   } else {
 
@@ -271,7 +294,7 @@ void BinlogConvert::convert_gtid_log_event(ILogRecord* record)
         _filter = false;
         this->_cur_pos = gtid_log_event->get_header()->get_next_position();
         this->_txn_id = gtid_log_event->get_gtid_txn_id();
-        append_event(this->_event_queue, gtid_log_event);
+        begin_txn_events(gtid_log_event, record->recordType() == EDDL);
         convert_query_event(record);
         OMS_INFO("If the gtid is specified, the transmission will resume from the current mapping [{}={}].",
             this->_txn_mapping.second,
@@ -657,7 +680,12 @@ void BinlogConvert::convert_xid_event(ILogRecord* record)
   this->_cur_pos = event->get_header()->get_next_position();
   this->_xid = event->get_xid();
   timestamp = event->get_header()->get_timestamp();
+  LatencyTracer::instance().stamp(record, TRACE_CONVERT);
+  LatencyTracer::instance().move(record, event);
   append_event(this->_event_queue, event);
+  if (_txn_gtid != nullptr) {
+    release_txn_events(false);
+  }
 
   if (this->_cur_pos > _meta.max_binlog_size_bytes) {
     this->_binlog_file_index++;
@@ -1059,10 +1087,188 @@ void BinlogConvert::convert_update_rows_event(ILogRecord* record)
   append_event(this->_event_queue, event);
 }
 
+void BinlogConvert::begin_txn_events(GtidLogEvent* gtid_log_event, bool isolated)
+{
+  _txn_gtid = gtid_log_event;
+  append_event(this->_event_queue, gtid_log_event);
+  if (isolated ||
+      (_s_config.binlog_writeset_history_size.val() == 0 && !_s_config.binlog_transaction_compression.val())) {
+    release_txn_events(true);
+  }
+}
+
 void BinlogConvert::append_event(BlockingQueue<ObLogEvent*>& queue, ObLogEvent* event)
 {
+  if (_txn_gtid != nullptr && &queue == &_event_queue) {
+    _txn_events.push_back(event);
+    _txn_bytes += event->get_header()->get_event_length();
+    if (_txn_bytes > _s_config.binlog_writeset_max_txn_bytes.val()) {
+      OMS_INFO("Release events of large transaction: {} before commit, bytes: {}", _txn_id, _txn_bytes);
+      release_txn_events(true);
+    }
+    return;
+  }
+  if (event->get_header()->get_type_code() == ROTATE_EVENT) {
+    // logical clocks start over in each binlog file
+    _writeset_tracker.reset();
+  }
   while (!queue.offer(event, _s_config.send_fail_interval_us.val())) {
-    OMS_INFO("storage queue full({}), retry...", queue.size(false));
+    OMS_INFO_EVERY(10, "storage queue full({}), retry...", queue.size(false));
+  }
+}
+
+void BinlogConvert::release_txn_events(bool isolated)
+{
+  int64_t last_committed = 0;
+  int64_t sequence_number = 0;
+  _writeset_tracker.commit(isolated, last_committed, sequence_number);
+  _txn_gtid->set_last_committed(last_committed);
+  _txn_gtid->set_sequence_number(sequence_number);
+  _txn_gtid = nullptr;
+
+  if (!isolated && _s_config.binlog_transaction_compression.val()) {
+    compress_txn_events();
+  }
+  for (ObLogEvent* event : _txn_events) {
+    append_event(_event_queue, event);
+  }
+  _txn_events.clear();
+  _txn_bytes = 0;
+}
+
+void BinlogConvert::compress_txn_events()
+{
+  if (_txn_events.size() < 2) {
+    return;
+  }
+  ObLogEvent* gtid_event = _txn_events.front();
+  ObLogEvent* xid_event = _txn_events.back();
+  uint32_t start_pos = gtid_event->get_header()->get_next_position();
+
+  // events in the payload are positioned at 0 and carry no checksum as in MySQL
+  std::string events(_txn_bytes, '\0');
+  size_t len = 0;
+  for (size_t i = 1; i < _txn_events.size(); ++i) {
+    ObLogEvent* event = _txn_events[i];
+    event->get_header()->set_next_position(0);
+    len += event->flush_without_checksum(reinterpret_cast<unsigned char*>(&events[len]));
+  }
+
+  auto* payload_event = new TransactionPayloadEvent();
+  uint32_t event_len = payload_event->compress(
+      reinterpret_cast<const unsigned char*>(events.data()), len, _s_config.binlog_transaction_compression_level_zstd.val());
+  if (event_len == 0 || event_len >= len) {
+    delete payload_event;
+    uint32_t next_pos = start_pos;
+    for (size_t i = 1; i < _txn_events.size(); ++i) {
+      next_pos += _txn_events[i]->get_header()->get_event_length();
+      _txn_events[i]->get_header()->set_next_position(next_pos);
+    }
+    return;
+  }
+
+  auto* common_header = new OblogEventHeader(
+      TRANSACTION_PAYLOAD_EVENT, xid_event->get_header()->get_timestamp(), event_len, start_pos + event_len);
+  payload_event->set_header(common_header);
+  this->_cur_pos = common_header->get_next_position();
+  LatencyTracer::instance().move(xid_event, payload_event);
+  for (size_t i = 1; i < _txn_events.size(); ++i) {
+    delete _txn_events[i];
+  }
+  _txn_events.resize(1);
+  _txn_events.push_back(payload_event);
+}
+
+static inline void hash_combine(uint64_t& seed, const char* data, size_t len)
+{
+  seed ^= std::hash<std::string_view>{}(std::string_view(data, len)) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+/*!
+ * @brief Add hashes of primary key and of each unique key column of the row image, unique key columns are hashed
+ * one by one for columns of each unique key are not told apart, which only adds false dependencies
+ */
+static void add_row_writeset(WritesetTracker& tracker, ILogRecord* record, ITableMeta* table_meta, bool before)
+{
+  unsigned int col_count = 0;
+  StrArray* str_buf = before ? record->parsedOldCols() : record->parsedNewCols();
+  BinLogBuf* bin_log_buf = before ? record->oldCols(col_count) : record->newCols(col_count);
+  auto value_of = [&](const std::string& col_name, const char*& data, size_t& data_len) {
+    int index = table_meta->getColIndex(col_name.c_str());
+    data = nullptr;
+    data_len = 0;
+    if (index < 0) {
+      return false;
+    }
+    if (record->isParsedRecord()) {
+      if (str_buf == nullptr || (size_t)index >= str_buf->size()) {
+        return false;
+      }
+      str_buf->elementAt(index, data, data_len);
+    } else {
+      if (bin_log_buf == nullptr || (unsigned int)index >= col_count) {
+        return false;
+      }
+      data = bin_log_buf[index].buf;
+      data_len = bin_log_buf[index].buf_used_size;
+    }
+    return data != nullptr;
+  };
+
+  uint64_t table_hash = 0;
+  hash_combine(table_hash, record->dbname(), strlen(record->dbname()));
+  hash_combine(table_hash, record->tbname(), strlen(record->tbname()));
+
+  bool keyed = false;
+  const char* data = nullptr;
+  size_t data_len = 0;
+  std::vector<std::string>& pk_names = table_meta->getPKColNames();
+  if (!pk_names.empty()) {
+    uint64_t hash = table_hash;
+    bool complete = true;
+    for (const std::string& col_name : pk_names) {
+      if (!value_of(col_name, data, data_len)) {
+        complete = false;
+        break;
+      }
+      hash_combine(hash, data, data_len);
+    }
+    if (complete) {
+      tracker.add_row(hash);
+      keyed = true;
+    }
+  }
+  // rows with NULL in unique keys never conflict on them
+  for (const std::string& col_name : table_meta->getUKColNames()) {
+    if (value_of(col_name, data, data_len)) {
+      uint64_t hash = table_hash;
+      hash_combine(hash, col_name.data(), col_name.size());
+      hash_combine(hash, data, data_len);
+      tracker.add_row(hash);
+      keyed = true;
+    }
+  }
+  if (!keyed) {
+    tracker.add_keyless_row();
+  }
+}
+
+void BinlogConvert::track_writeset(ILogRecord* record)
+{
+  if (_txn_gtid == nullptr || _s_config.binlog_writeset_history_size.val() == 0) {
+    return;
+  }
+  ITableMeta* table_meta = record->getTableMeta();
+  if (table_meta == nullptr) {
+    _writeset_tracker.add_keyless_row();
+    return;
+  }
+  int type = record->recordType();
+  if (type != EINSERT) {
+    add_row_writeset(_writeset_tracker, record, table_meta, true);
+  }
+  if (type != EDELETE) {
+    add_row_writeset(_writeset_tracker, record, table_meta, false);
   }
 }
 
@@ -1110,6 +1316,7 @@ void BinlogConvert::do_convert(const std::vector<ILogRecord*>& records)
         if (_filter) {
           break;
         }
+        track_writeset(record);
         convert_table_map_event(record);
         convert_write_rows_event(record);
         break;
@@ -1119,6 +1326,7 @@ void BinlogConvert::do_convert(const std::vector<ILogRecord*>& records)
         if (_filter) {
           break;
         }
+        track_writeset(record);
         convert_table_map_event(record);
         convert_delete_rows_event(record);
 
@@ -1128,6 +1336,7 @@ void BinlogConvert::do_convert(const std::vector<ILogRecord*>& records)
         if (_filter) {
           break;
         }
+        track_writeset(record);
         convert_table_map_event(record);
         convert_update_rows_event(record);
         break;
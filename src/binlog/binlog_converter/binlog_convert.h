@@ -27,6 +27,7 @@
 #include "convert_meta.h"
 #include "binlog_index.h"
 #include "table_cache.h"
+#include "writeset_tracker.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -48,8 +49,35 @@ public:
 
   void set_meta(const ConvertMeta& meta);
 
+  /*!
+   * @brief Start a transaction by its GTID event, holding events of it until commit only if writesets or compression
+   * need the whole transaction, otherwise it depends on the previous one and its events are appended straight through
+   * @param isolated whether to make it depend on all transactions before it and the other way round, e.g. DDL
+   */
+  void begin_txn_events(GtidLogEvent* gtid_log_event, bool isolated);
+
+  /*!
+   * @brief Events of the transaction being converted are held until its logical clock known at commit
+   */
   void append_event(BlockingQueue<ObLogEvent*>& queue, ObLogEvent* event);
 
+  /*!
+   * @brief Set logical clock of the transaction being converted and append events held of it
+   * @param isolated whether to make it depend on all transactions before it and the other way round
+   */
+  void release_txn_events(bool isolated);
+
+  /*!
+   * @brief Replace events held after the GTID event with a TRANSACTION_PAYLOAD_EVENT compressing them, which are kept
+   * as they are if not shrunk
+   */
+  void compress_txn_events();
+
+  /*!
+   * @brief Add rows changed by the DML record to writeset of the transaction being converted
+   */
+  void track_writeset(ILogRecord* record);
+
   void convert_gtid_log_event(ILogRecord* record);
 
   void convert_query_event(ILogRecord* record);
@@ -119,6 +147,11 @@ private:
   int64_t _skip_record_num = 0;
   uint64_t _start_timestamp = 0;
   TableCache _table_cache;
+  WritesetTracker _writeset_tracker;
+  // GTID event of the transaction of which events are held
+  GtidLogEvent* _txn_gtid = nullptr;
+  std::vector<ObLogEvent*> _txn_events;
+  uint64_t _txn_bytes = 0;
 };
 
 void fill_bitmap(int col_count, int col_bytes, unsigned char* bitmap);
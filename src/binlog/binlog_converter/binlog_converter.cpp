@@ -12,6 +12,7 @@
 
 #include <utility>
 #include "counter.h"
+#include "metric/metric_registry.h"
 
 #include "binlog_converter.h"
 
@@ -23,7 +24,10 @@ BinlogConverter::~BinlogConverter()
 }
 int BinlogConverter::init(MessageVersion packet_version, OblogConfig& config)
 {
+  MetricRegistry::instance().set_const_labels({{"cluster", config.cluster.val()}, {"tenant", config.tenant.val()}});
   Counter::instance().register_gauge("RecordQueueSize", [this]() { return _queue.size(); });
+  Counter::instance().register_gauge("RecordQueueBytes", [this]() { return _queue.bytes(); });
+  ObMetaCache::instance().register_metrics();
   OMS_STREAM_INFO << "config:" << config.generate_config();
   int ret;
 
@@ -74,8 +78,12 @@ int BinlogConverter::query_server_uuid(OblogConfig& config)
   if (ret != OMS_OK) {
     return ret;
   }
-  MysqlProtocol sys_auther;
-  _ob_access.fetch_connection(sys_auther);
+  MysqlConnectionPool::Connection sys_auther;
+  ret = _ob_access.fetch_connection(sys_auther);
+  if (ret != OMS_OK) {
+    OMS_STREAM_ERROR << "Failed to connect to observer to query server uuid, ret:" << ret;
+    return ret;
+  }
 
   MySQLResultSet rs;
   ret = sys_auther.query("SELECT value FROM oceanbase.__all_virtual_sys_variable WHERE tenant_id = (SELECT tenant_id "
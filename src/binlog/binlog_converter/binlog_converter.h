@@ -14,6 +14,7 @@
 
 #include "common.h"
 #include "oblog_config.h"
+#include "admission.h"
 #include "obcdcaccess/obcdc_factory.h"
 #include "obaccess/ob_access.h"
 #include "binlog_storage.h"
@@ -50,7 +51,7 @@ public:
 
 private:
   IObCdcAccess* _oblog = nullptr;
-  BlockingQueue<ILogRecord*> _queue{Config::instance().record_queue_size.val()};
+  BlockingQueue<ILogRecord*> _queue{Config::instance().record_queue_size.val(), ResourceBudget::record_queue_bytes()};
   BlockingQueue<ObLogEvent*> _event_queue{Config::instance().record_queue_size.val()};
   ClogReaderRoutine _reader{*this, _queue};
   BinlogConvert _convert{*this, _queue, _event_queue};
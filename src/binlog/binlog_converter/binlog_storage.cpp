@@ -14,6 +14,8 @@
 #include "config.h"
 #include "common_util.h"
 #include "counter.h"
+#include "guard.hpp"
+#include "metric/latency_tracer.h"
 
 #include "binlog_storage.h"
 
@@ -94,7 +96,7 @@ void BinlogStorage::run()
   while (is_run()) {
     _stage_timer.reset();
     while (!_event_queue.poll(records, _s_config.read_timeout_us.val()) || records.empty()) {
-      OMS_STREAM_INFO << "storage binlog queue empty, retry...";
+      OMS_INFO_EVERY(10, "storage binlog queue empty, retry...");
     }
     size_t record_count = records.size();
 
@@ -123,6 +125,10 @@ int BinlogStorage::storage_binlog_event(vector<ObLogEvent*>& records, const stri
 {
   Timer cache_time;
   cache_time.reset();
+  // traced transactions in buffer, finished once flushed
+  std::vector<TxnTrace> traces;
+  // records not stored when returning on failure would hold their traces forever, the ones stored are released
+  defer(for (auto* record : records) { LatencyTracer::instance().discard(record); });
   for (auto record : records) {
     if (record == nullptr) {
       OMS_STREAM_ERROR << "event is an unexpected NULL value";
@@ -153,8 +159,7 @@ int BinlogStorage::storage_binlog_event(vector<ObLogEvent*>& records, const stri
 
       index_record.set_checkpoint(record->get_checkpoint());
       Counter::instance().mark_checkpoint(record->get_checkpoint());
-      Counter::instance().mark_timestamp(
-          ((GtidLogEvent*)record)->get_last_committed() * 1000000 + ((GtidLogEvent*)record)->get_sequence_number());
+      Counter::instance().mark_timestamp(((GtidLogEvent*)record)->get_commit_timestamp_us());
       OMS_STREAM_DEBUG << "current ob txn:" << record->get_ob_txn()
                        << ",gtid txn id:" << index_record._current_mapping.second
                        << ", checkpoint:" << index_record.get_checkpoint();
@@ -165,9 +170,15 @@ int BinlogStorage::storage_binlog_event(vector<ObLogEvent*>& records, const stri
 
     if ((buffer_pos + record->get_header()->get_event_length()) >= _s_config.binlog_max_event_buffer_bytes.val() ||
         (cache_time.elapsed() > _s_config.binlog_convert_timeout_us.val() && buffer_pos != 0)) {
-      if (FsUtil::append_file(_file_name, buffer) != OMS_OK) {
+      Timer flush_timer;
+      if (_appender.append(_file_name, buffer) != OMS_OK) {
         return OMS_FAILED;
       }
+      Counter::instance().count_key(Counter::STORAGE_FLUSH_US, flush_timer.elapsed());
+      for (auto& trace : traces) {
+        LatencyTracer::instance().finish(trace);
+      }
+      traces.clear();
       // update index record
       // update offset
       struct stat file_stat;
@@ -184,14 +195,24 @@ int BinlogStorage::storage_binlog_event(vector<ObLogEvent*>& records, const stri
     }
     buffer.push_back(reinterpret_cast<char*>(data), ret);
     buffer_pos += ret;
+
+    TxnTrace trace;
+    if (LatencyTracer::instance().detach(record, trace)) {
+      traces.emplace_back(trace);
+    }
   }
 
   release_vector(records);
 
   if (buffer_pos > 0) {
-    if (FsUtil::append_file(_file_name, buffer) != OMS_OK) {
+    Timer flush_timer;
+    if (_appender.append(_file_name, buffer) != OMS_OK) {
       return OMS_FAILED;
     }
+    Counter::instance().count_key(Counter::STORAGE_FLUSH_US, flush_timer.elapsed());
+    for (auto& trace : traces) {
+      LatencyTracer::instance().finish(trace);
+    }
     // update offset
     struct stat file_stat;
     int file_size = stat(_file_name.c_str(), &file_stat);
@@ -212,7 +233,10 @@ void BinlogStorage::stop()
 }
 
 BinlogStorage::BinlogStorage(BinlogConverter& reader, BlockingQueue<ObLogEvent*>& event_queue)
-    : _event_queue(event_queue), _converter(reader), _oblog(nullptr)
+    : _event_queue(event_queue),
+      _converter(reader),
+      _oblog(nullptr),
+      _appender(Config::instance().binlog_io_uring.val())
 {
   std::uint32_t checksum = 0;
   if (Config::instance().binlog_checksum.val()) {
@@ -268,18 +292,12 @@ void fetch_pre_gtid_event(const BinlogIndexRecord& index_record, GtidMessage* gt
     // There will only be one server uuid for the same tenant by default
     for (auto const& gtid_it : gtids) {
       GtidMessage* previous_gtids = gtid_it.second;
-      if (!previous_gtids->get_txn_range().empty()) {
-        if (pair.first > previous_gtids->get_txn_range().back().second + 1) {
-          gtid_message->get_txn_range().assign(
-              previous_gtids->get_txn_range().begin(), previous_gtids->get_txn_range().end());
-          gtid_message->get_txn_range().emplace_back(pair);
-        } else {
-          gtid_message->get_txn_range().assign(
-              previous_gtids->get_txn_range().begin(), previous_gtids->get_txn_range().end());
-          gtid_message->get_txn_range().back().second = pair.second;
-        }
+      TxnRangeSet& txn_range = gtid_message->get_txn_range();
+      txn_range = previous_gtids->get_txn_range();
+      if (!txn_range.empty() && pair.first <= txn_range.back().second + 1) {
+        txn_range.add(txn_range.back().first, pair.second);
       } else {
-        gtid_message->get_txn_range().emplace_back(pair);
+        txn_range.add(pair.first, pair.second);
       }
     }
   }
@@ -328,7 +346,7 @@ size_t BinlogStorage::rotate(ObLogEvent* event, MsgBuf& content, std::size_t siz
     }
   } else {
     if (pair.first != 0) {
-      gtid_message->get_txn_range().emplace_back(pair);
+      gtid_message->get_txn_range().add(pair.first, pair.second);
     }
   }
 
@@ -366,7 +384,7 @@ int BinlogStorage::previous_rotation(MsgBuf& content, size_t size, RotateEvent*
     size_t ret = rotate_event->flush_to_buff(data);
     content.push_back(reinterpret_cast<char*>(data), ret);
     size += ret;
-    if (FsUtil::append_file(_file_name, content) != OMS_OK) {
+    if (_appender.append(_file_name, content) != OMS_OK) {
       free(data);
       data = nullptr;
       return OMS_FAILED;
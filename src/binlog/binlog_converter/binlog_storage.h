@@ -25,6 +25,7 @@
 #include "binlog_index.h"
 #include "data_type.h"
 #include "oblog_config.h"
+#include "io_uring.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -73,6 +74,8 @@ private:
   ConvertMeta _meta;
   uint64_t _offset;
   txn_range _range;
+  // keeps the binlog file written open across flushes
+  AppendFile _appender;
 };
 }  // namespace logproxy
 }  // namespace oceanbase
@@ -12,6 +12,7 @@
 
 #include "counter.h"
 #include "trace_log.h"
+#include "metric/latency_tracer.h"
 #include "binlog_converter/binlog_converter.h"
 #include "clog_reader_routine.h"
 
@@ -71,15 +72,19 @@ void ClogReaderRoutine::run()
       break;
     }
 
+    if (record->recordType() == ECOMMIT) {
+      LatencyTracer::instance().begin(record, record->getTimestamp() * 1000000 + record->getRecordUsec());
+    }
     if (_s_config.verbose_record_read.val()) {
       TraceLog::info(record);
     }
 
     stage_tm.reset();
-    counter.count_read_io(record->getRealSize());
+    size_t record_size = record->getRealSize();
+    counter.count_read_io(record_size);
     counter.count_read(1);
-    while (is_run() && !_queue.offer(record, _s_config.read_timeout_us.val())) {
-      OMS_STREAM_WARN << "reader transfer queue full(" << _queue.size(false) << "), retry...";
+    while (is_run() && !_queue.offer(record, record_size, _s_config.read_timeout_us.val())) {
+      OMS_WARN_EVERY(10, "reader transfer queue full({}), retry...", _queue.size(false));
     }
     int64_t offer_us = stage_tm.elapsed();
 
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "writeset_tracker.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+WritesetTracker::WritesetTracker(size_t history_size) : _max_history_size(history_size)
+{}
+
+void WritesetTracker::reset(int64_t sequence_number)
+{
+  _sequence_number = sequence_number;
+  _history_start = sequence_number;
+  _history.clear();
+  _writeset.clear();
+  _keyless = false;
+}
+
+void WritesetTracker::add_row(uint64_t hash)
+{
+  _writeset.push_back(hash);
+}
+
+void WritesetTracker::add_keyless_row()
+{
+  _keyless = true;
+}
+
+void WritesetTracker::commit(bool isolated, int64_t& last_committed, int64_t& sequence_number)
+{
+  sequence_number = ++_sequence_number;
+  // without writesets, a transaction depends on the previous one as by commit order
+  last_committed = sequence_number - 1;
+
+  bool usable = _max_history_size > 0 && !isolated && (!_writeset.empty() || _keyless);
+  bool exceeded = false;
+  if (usable) {
+    exceeded = _history.size() + _writeset.size() > _max_history_size;
+    int64_t parent = _history_start;
+    for (uint64_t hash : _writeset) {
+      auto iter = _history.find(hash);
+      if (iter != _history.end()) {
+        parent = std::max(parent, iter->second);
+        iter->second = sequence_number;
+      } else if (!exceeded) {
+        _history.emplace(hash, sequence_number);
+      }
+    }
+    // rows without keys may conflict with any others
+    if (!_keyless) {
+      last_committed = std::min(parent, last_committed);
+    }
+  }
+  if (!usable || exceeded) {
+    // rows of transactions from here on are not all known, so later ones depend on this one at least
+    _history_start = sequence_number;
+    _history.clear();
+  }
+
+  _writeset.clear();
+  _keyless = false;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
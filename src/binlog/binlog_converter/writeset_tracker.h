@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Logical clock of transactions by their writesets, as WRITESET of binlog_transaction_dependency_tracking of
+ * MySQL. A transaction depends on the last one that wrote any of the same rows, so that replicas applying binlogs
+ * with LOGICAL_CLOCK run it in parallel with any transactions since then.
+ * Rows are identified by hashes of their primary and unique key values.
+ */
+class WritesetTracker {
+public:
+  /*!
+   * @param history_size hashes of rows remembered, 0 to make every transaction depend on the previous one
+   */
+  explicit WritesetTracker(size_t history_size);
+
+  /*!
+   * @brief Restart the clock from sequence_number, as in a new binlog file
+   */
+  void reset(int64_t sequence_number = 0);
+
+  /*!
+   * @brief Add a row written by the transaction being converted
+   */
+  void add_row(uint64_t hash);
+
+  /*!
+   * @brief The transaction being converted wrote rows of a table without any key, which no writeset identifies
+   */
+  void add_keyless_row();
+
+  /*!
+   * @brief Complete the transaction being converted
+   * @param isolated whether it may depend on or be depended on by any other transaction regardless of rows, e.g. DDL
+   * @param last_committed[out] sequence number of the last transaction it depends on
+   * @param sequence_number[out] of the transaction
+   */
+  void commit(bool isolated, int64_t& last_committed, int64_t& sequence_number);
+
+  inline int64_t sequence_number() const
+  {
+    return _sequence_number;
+  }
+
+  inline size_t history_size() const
+  {
+    return _history.size();
+  }
+
+private:
+  size_t _max_history_size;
+  int64_t _sequence_number = 0;
+  // transactions before it all depend on each other by commit order
+  int64_t _history_start = 0;
+  // last transaction that wrote each row
+  std::unordered_map<uint64_t, int64_t> _history;
+
+  std::vector<uint64_t> _writeset;
+  bool _keyless = false;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -19,7 +19,9 @@
 #include "config.h"
 #include "guard.hpp"
 #include "common_util.h"
+#include "crc32.h"
 #include "counter.h"
+#include "metric/metric_registry.h"
 namespace oceanbase {
 namespace logproxy {
 void BinlogDumper::stop()
@@ -31,6 +33,8 @@ void BinlogDumper::stop()
 
 void BinlogDumper::run()
 {
+  _send_histogram = &MetricRegistry::instance().histogram(
+      "logproxy_dumper_send_us", {{"cluster", _connection->get_ob_cluster()}, {"tenant", _connection->get_ob_tenant()}});
   /*!
    * @brief 注册
    */
@@ -50,6 +54,7 @@ void BinlogDumper::run()
    * which is only valid for the fist one fake rotate event
    */
   init_binlog_checksum();
+  _payload_aware = is_payload_aware();
 
   if (!_relative_file.empty()) {
     if (!verify_subscription_offset(_start_pos)) {
@@ -95,22 +100,14 @@ void BinlogDumper::run()
     // 2. check binlog file
     unsigned char magic[BINLOG_MAGIC_SIZE];
     OMS_INFO("{}: Start open binlog file: {}", _connection->trace_id(), _file.c_str());
-    if (this->_fp != nullptr) {
-      fclose(this->_fp);
-      this->_fp = nullptr;
-    }
-    this->_fp = fopen(_file.c_str(), "rb+");
-    if (this->_fp == nullptr) {
-      OMS_ERROR(
-          "{}: Failed to open binlog file: {},reason:{}", _connection->trace_id(), _file, logproxy::system_err(errno));
+    if (_reader.open(_file) != OMS_OK) {
+      OMS_ERROR("{}: Failed to open binlog file: {}", _connection->trace_id(), _file);
       binlog::ErrPacket error_packet{BINLOG_FATAL_ERROR, "failed to open binlog file", "HY000"};
       _connection->send(error_packet);
       break;
     }
     // read magic number
-    FsUtil::read_file(this->_fp, magic, 0, sizeof(magic));
-
-    if (memcmp(magic, binlog_magic, sizeof(magic)) != 0) {
+    if (_reader.read(0, magic, sizeof(magic)) != OMS_OK || memcmp(magic, binlog_magic, sizeof(magic)) != 0) {
       OMS_ERROR("{}: The file format is invalid.", _connection->trace_id());
       binlog::ErrPacket error_packet{BINLOG_FATAL_ERROR,
           "Binlog has bad magic number;  It's not a binary log file that can be used by this version of MySQL.",
@@ -227,29 +224,14 @@ void BinlogDumper::is_subset_executed_gtid(
       is_subset = true;
       break;
     }
-    //  txn range
-    for (const auto& txn_range : gtid_message->get_txn_range()) {
-      OMS_STREAM_DEBUG << "executed gtid:[" << txn_range.first << "," << txn_range.second << ")";
-      bool include = false;
-      for (const auto& exclude_txn : message->get_txn_range()) {
-        OMS_STREAM_DEBUG << ""
-                         << "request gtid:[" << exclude_txn.first << "," << exclude_txn.second << ")";
-        if (txn_range.first >= exclude_txn.first && txn_range.second <= exclude_txn.second) {
-          include = true;
-          break;
-        }
-      }
-      if (!include) {
-        OMS_INFO("{}: The currently executed gtid does not contain the gtid up to the current binlog file, so it "
-                 "needs to look forward,binlog file:{}",
-            _connection->trace_id(),
-            binlog::CommonUtils::fill_binlog_file_name(p_index_record->_index));
-        is_subset = false;
-        break;
-      } else {
-        is_subset = true;
-        break;
-      }
+    if (!gtid_message->get_txn_range().is_subset_of(message->get_txn_range())) {
+      OMS_INFO("{}: The currently executed gtid does not contain the gtid up to the current binlog file, so it "
+               "needs to look forward,binlog file:{}",
+          _connection->trace_id(),
+          binlog::CommonUtils::fill_binlog_file_name(p_index_record->_index));
+      is_subset = false;
+    } else {
+      is_subset = true;
     }
     if (!is_subset) {
       break;
@@ -333,13 +315,17 @@ IoResult BinlogDumper::send_packet()
     return IoResult::SUCCESS;
   }
   IoResult ret;
+  // events of the batch share compressed frames
   for (const auto& iter : _packet) {
-    ret = _connection->send_binlog_event(reinterpret_cast<const uint8_t*>(iter.buffer()), iter.size());
+    ret = _connection->send_binlog_event(reinterpret_cast<const uint8_t*>(iter.buffer()), iter.size(), false);
     if (ret != IoResult::SUCCESS) {
       OMS_ERROR("{}: Failed to send packet, errno:{}, error:", _connection->trace_id(), errno, strerror(errno));
       break;
     }
   }
+  if (ret == IoResult::SUCCESS) {
+    ret = _connection->flush();
+  }
   _packet.reset();
   return ret;
 }
@@ -361,7 +347,7 @@ IoResult BinlogDumper::send_heartbeat_event(uint64_t pos)
       reinterpret_cast<const uint8_t*>(buff), heartbeat_event.get_header()->get_event_length() + 1);
 }
 
-IoResult BinlogDumper::send_format_description_event(FILE* stream, const std::string& file)
+IoResult BinlogDumper::send_format_description_event(ReadAheadFile& reader, const std::string& file)
 {
   if (get_binlog_checksum() == UNDEF && Config::instance().binlog_checksum.val()) {
     this->_connection->send_err_packet(BINLOG_FATAL_ERROR,
@@ -371,18 +357,18 @@ IoResult BinlogDumper::send_format_description_event(FILE* stream, const std::st
   }
   _checkpoint.second = BINLOG_MAGIC_SIZE;
   bool skip_record = false;
-  int ret = seek_event(stream, _packet, skip_record);
+  int ret = seek_event(reader, _packet, skip_record);
   if (ret != FORMAT_DESCRIPTION_EVENT) {
     return IoResult::FAIL;
   }
   return send_packet();
 }
 
-int BinlogDumper::seek_event(FILE* stream, MsgBuf& msg_buf, bool& skip_record)
+int BinlogDumper::seek_event(ReadAheadFile& reader, MsgBuf& msg_buf, bool& skip_record)
 {
   unsigned char buff[COMMON_HEADER_LENGTH];
   // read common header
-  size_t ret = FsUtil::read_file(stream, buff, _checkpoint.second, COMMON_HEADER_LENGTH);
+  size_t ret = reader.read(_checkpoint.second, buff, COMMON_HEADER_LENGTH);
   if (ret != OMS_OK) {
     OMS_ERROR("{}: Failed to seek event header from offset:{}", _connection->trace_id(), _checkpoint.second);
     return OMS_FAILED;
@@ -394,7 +380,7 @@ int BinlogDumper::seek_event(FILE* stream, MsgBuf& msg_buf, bool& skip_record)
   auto* event_buf = static_cast<unsigned char*>(malloc(header.get_event_length() + 1));
   FreeGuard<unsigned char*> free_guard(event_buf);
   int1store(event_buf, 0);
-  ret = FsUtil::read_file(stream, event_buf + 1, _checkpoint.second, event_len);
+  ret = reader.read(_checkpoint.second, event_buf + 1, event_len);
   if (ret != OMS_OK) {
     OMS_ERROR("{}: Failed to seek event from offset:{}", _connection->trace_id(), _checkpoint.second);
     return OMS_FAILED;
@@ -413,7 +399,13 @@ int BinlogDumper::seek_event(FILE* stream, MsgBuf& msg_buf, bool& skip_record)
   if (skip_record) {
     return UNKNOWN_EVENT;
   }
-  msg_buf.push_back_copy(reinterpret_cast<char*>(event_buf), event_len + 1);
+  if (header.get_type_code() == TRANSACTION_PAYLOAD_EVENT && !_payload_aware) {
+    if (expand_payload_event(header, event_buf, msg_buf) != OMS_OK) {
+      return OMS_FAILED;
+    }
+  } else {
+    msg_buf.push_back_copy(reinterpret_cast<char*>(event_buf), event_len + 1);
+  }
   /*!
    * @brief Record the latest location of the currently sent event
    */
@@ -546,9 +538,10 @@ IoResult BinlogDumper::send_events(uint64_t start_pos, uint64_t end_pos)
   bool skip_record = false;
   _checkpoint.second = start_pos;
   OMS_STREAM_DEBUG << "send events from offset:" << _checkpoint.second << " end pos:" << end_pos;
-  while (_checkpoint.second < end_pos && is_legal_event(this->_fp, _checkpoint.second, end_pos)) {
+  _reader.set_limit(end_pos);
+  while (_checkpoint.second < end_pos && is_legal_event(_reader, _checkpoint.second, end_pos)) {
     _stage_timer.reset();
-    int result = seek_event(this->_fp, _packet, skip_record);
+    int result = seek_event(_reader, _packet, skip_record);
 
     if (result == OMS_FAILED) {
       return IoResult::FAIL;
@@ -563,6 +556,7 @@ IoResult BinlogDumper::send_events(uint64_t start_pos, uint64_t end_pos)
         OMS_ERROR("{}: Failed to send packet", _connection->trace_id());
         return ret;
       }
+      _send_histogram->record(_stage_timer.elapsed());
       Counter::instance().count_write(1);
     }
     if (result == ROTATE_EVENT) {
@@ -580,7 +574,7 @@ IoResult BinlogDumper::send_events(uint64_t start_pos, uint64_t end_pos)
 IoResult BinlogDumper::send_binlog(const string& file, uint64_t start_pos)
 {
   // 1.send format description event
-  if (send_format_description_event(this->_fp, file) != IoResult::SUCCESS) {
+  if (send_format_description_event(_reader, file) != IoResult::SUCCESS) {
     return IoResult::FAIL;
   }
 
@@ -648,6 +642,62 @@ bool BinlogDumper::skip_event(OblogEventHeader& header, unsigned char* buff, boo
   return false;
 }
 
+bool BinlogDumper::is_payload_aware() const
+{
+  std::string program_name = _connection->get_connect_attr("program_name");
+  if (program_name != "mysqld" && program_name != "mysqlbinlog") {
+    return false;
+  }
+  int major = 0;
+  int minor = 0;
+  int patch = 0;
+  sscanf(_connection->get_connect_attr("_client_version").c_str(), "%d.%d.%d", &major, &minor, &patch);
+  return major * 10000 + minor * 100 + patch >= 80020;
+}
+
+int BinlogDumper::expand_payload_event(OblogEventHeader& header, unsigned char* buff, MsgBuf& msg_buf)
+{
+  TransactionPayloadEvent payload_event;
+  payload_event.set_checksum_flag(get_binlog_checksum());
+  payload_event.deserialize(buff + 1);
+  std::string events;
+  if (payload_event.decompress(events) != OMS_OK) {
+    OMS_ERROR("{}: Failed to decompress transaction payload at offset: {}",
+        _connection->trace_id(),
+        header.get_next_position() - header.get_event_length());
+    return OMS_FAILED;
+  }
+
+  size_t pos = 0;
+  while (pos + COMMON_HEADER_LENGTH <= events.size()) {
+    OblogEventHeader event_header;
+    event_header.deserialize(reinterpret_cast<unsigned char*>(&events[pos]));
+    uint32_t event_len = event_header.get_event_length();
+    if (event_len < COMMON_HEADER_LENGTH || pos + event_len > events.size()) {
+      OMS_ERROR("{}: Illegal event of length {} in transaction payload", _connection->trace_id(), event_len);
+      return OMS_FAILED;
+    }
+
+    // events in the payload carry no checksum, append one for clients expecting it
+    uint32_t checksum_len = get_binlog_checksum() == CRC32 ? COMMON_CHECKSUM_LENGTH : 0;
+    auto* event_buf = static_cast<unsigned char*>(malloc(event_len + checksum_len + 1));
+    FreeGuard<unsigned char*> free_guard(event_buf);
+    int1store(event_buf, 0);
+    memcpy(event_buf + 1, &events[pos], event_len);
+    pos += event_len;
+    if (pos == events.size()) {
+      // end of the transaction is where replicas resume from
+      int4store(event_buf + 1 + LOG_POS_OFFSET, header.get_next_position());
+    }
+    if (checksum_len > 0) {
+      int4store(event_buf + 1 + EVENT_LEN_OFFSET, event_len + checksum_len);
+      int4store(event_buf + 1 + event_len, Crc32::compute(event_buf + 1, event_len));
+    }
+    msg_buf.push_back_copy(reinterpret_cast<char*>(event_buf), event_len + checksum_len + 1);
+  }
+  return OMS_OK;
+}
+
 bool BinlogDumper::handle_gtid_event(unsigned char* buff)
 {
   GtidLogEvent gtid_log_event = GtidLogEvent();
@@ -659,19 +709,12 @@ bool BinlogDumper::handle_gtid_event(unsigned char* buff)
 
     string uuid_current;
     dumphex(reinterpret_cast<const char*>(gtid_log_event.get_gtid_uuid()), SERVER_UUID_LEN, uuid_current);
-    if (exclude_uuid == uuid_current) {
-      vector<txn_range> txn = gtid.second->get_txn_range();
-      for (const txn_range& range : txn) {
-        OMS_STREAM_DEBUG << "exclude_uuid range[" << range.first << "," << range.second << "]"
-                         << ", gno" << g_no;
-        if (g_no < range.second && g_no >= range.first) {
-          OMS_DEBUG("{}: Skip current gtid {} transaction exclude_uuid:{}",
-              _connection->trace_id(),
-              g_no,
-              gtid.second->format_string());
-          return true;
-        }
-      }
+    if (exclude_uuid == uuid_current && gtid.second->get_txn_range().contains(g_no)) {
+      OMS_DEBUG("{}: Skip current gtid {} transaction exclude_uuid:{}",
+          _connection->trace_id(),
+          g_no,
+          gtid.second->format_string());
+      return true;
     }
   }
   return false;
@@ -748,7 +791,10 @@ void BinlogDumper::set_meta(ConvertMeta meta)
   _meta = std::move(meta);
 }
 
-BinlogDumper::BinlogDumper() : Thread("BinlogDumper")
+BinlogDumper::BinlogDumper()
+    : Thread("BinlogDumper"),
+      _reader(Config::instance().binlog_read_ahead_chunk_bytes.val(), Config::instance().binlog_read_ahead_chunks.val(),
+          Config::instance().binlog_io_uring.val())
 {}
 
 void BinlogDumper::register_latency()
@@ -794,14 +840,16 @@ int BinlogDumper::send_events(
   bool skip_record = false;
   _checkpoint.second = start_pos;
 
-  FILE* fp = FsUtil::fopen_binary(file);
-  if (fp == nullptr) {
+  ReadAheadFile reader(
+      Config::instance().binlog_read_ahead_chunk_bytes.val(), Config::instance().binlog_read_ahead_chunks.val(), false);
+  if (reader.open(file) != OMS_OK) {
     return OMS_FAILED;
   }
+  reader.set_limit(end_pos);
   MsgBuf msg_buf;
   OMS_STREAM_INFO << "send events from offset:" << _checkpoint.second << "end pos:" << end_pos;
   while (_checkpoint.second < end_pos) {
-    seek_event(fp, msg_buf, skip_record);
+    seek_event(reader, msg_buf, skip_record);
     process_func(msg_buf, _connection);
   }
   return ret;
@@ -824,10 +872,6 @@ BinlogDumper::~BinlogDumper()
 
   delete _connection;
   _connection = nullptr;
-  if (_fp != nullptr) {
-    fclose(_fp);
-    _fp = nullptr;
-  }
 }
 
 const string& BinlogDumper::get_relative_file() const
@@ -848,7 +892,7 @@ void BinlogDumper::mark_metrics(uint64_t ts, uint64_t bytes)
   _metric.count_send_io(bytes);
 }
 
-bool BinlogDumper::is_legal_event(FILE* stream, uint64_t offset, uint64_t end_pos) const
+bool BinlogDumper::is_legal_event(ReadAheadFile& reader, uint64_t offset, uint64_t end_pos)
 {
   if (offset + COMMON_HEADER_LENGTH > end_pos) {
     OMS_WARN("{}: The content of the current binlog event header is incomplete, and the expected file length is {},the "
@@ -860,7 +904,7 @@ bool BinlogDumper::is_legal_event(FILE* stream, uint64_t offset, uint64_t end_po
   }
   unsigned char buff[COMMON_HEADER_LENGTH];
   // read common header
-  size_t ret = FsUtil::read_file(stream, buff, _checkpoint.second, COMMON_HEADER_LENGTH);
+  size_t ret = reader.read(_checkpoint.second, buff, COMMON_HEADER_LENGTH);
   if (ret != OMS_OK) {
     OMS_STREAM_ERROR << "failed to seek event header from offset:" << _checkpoint.second;
     return false;
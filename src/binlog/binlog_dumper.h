@@ -26,6 +26,7 @@
 #include "timer.h"
 #include "binlog_index.h"
 #include "counter.h"
+#include "io_uring.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -97,7 +98,7 @@ public:
    * @description get the format_description_event in the file and send it to the client
    * @date 2022/9/21 21:01
    */
-  IoResult send_format_description_event(FILE* stream, const std::string& file);
+  IoResult send_format_description_event(ReadAheadFile& reader, const std::string& file);
 
   /*
    * @params
@@ -105,7 +106,7 @@ public:
    * @description read an event from the Binlog file and fill it into msg_buf
    * @date 2022/9/21 21:47
    */
-  int seek_event(FILE* stream, MsgBuf& msg_buf, bool& skip_record);
+  int seek_event(ReadAheadFile& reader, MsgBuf& msg_buf, bool& skip_record);
 
   /*
    * @params
@@ -182,6 +183,18 @@ public:
    */
   bool skip_event(OblogEventHeader& header, unsigned char* buff, bool skip_record);
 
+  /*!
+   * @brief Whether the client reads TRANSACTION_PAYLOAD_EVENT, i.e. replicas and mysqlbinlog of MySQL 8.0.20 or later
+   */
+  bool is_payload_aware() const;
+
+  /*!
+   * @brief Fill events compressed in the TRANSACTION_PAYLOAD_EVENT into msg_buf one by one for clients not aware of
+   * it, the last of which takes the position of the payload event
+   * @param buff the payload event prefixed with the OK byte
+   */
+  int expand_payload_event(OblogEventHeader& header, unsigned char* buff, MsgBuf& msg_buf);
+
   /*!
    * @brief Subscribe to the s-level timestamp of the record and record size
    * @param ts
@@ -240,11 +253,11 @@ public:
 
   /*!
    * @brief Determine whether the current binlog event that has been placed on the disk is complete
-   * @param stream
+   * @param reader
    * @param offset
    * @return
    */
-  bool is_legal_event(FILE* stream, uint64_t offset, uint64_t end_pos) const;
+  bool is_legal_event(ReadAheadFile& reader, uint64_t offset, uint64_t end_pos);
 
   /*!
    * \brief Verify whether the subscribed offset is legal
@@ -312,13 +325,16 @@ private:
   std::ifstream _stream;
   ConvertMeta _meta;
   std::string _error_message;
-  FILE* _fp = nullptr;
+  ReadAheadFile _reader;
   binlog::Connection* _connection;
   Timer _stage_timer;
+  // latency of reading and sending an event, shared by dumpers of the same tenant
+  Histogram* _send_histogram = nullptr;
   CounterStatistics _counter;
   DumperMetric _metric;
   int64_t _checkpoint_ts;
   enum_checksum_flag _checksum_flag = UNDEF;
+  bool _payload_aware = false;
   std::string _rotate_file = "";
 };
 }  // namespace logproxy
@@ -53,7 +53,7 @@ int BinlogFunction::gtid_subset(const std::string& set_sub, const std::string& s
       return 0;
     }
     auto* target = target_msg.find(sub.first)->second;
-    if (!is_subset(sub.second->get_txn_range(), target->get_txn_range())) {
+    if (!sub.second->get_txn_range().is_subset_of(target->get_txn_range())) {
       return 0;
     }
   }
@@ -80,49 +80,10 @@ int BinlogFunction::deserialization(const std::string& gtid_str, std::map<std::s
 
 int BinlogFunction::merge_txn_range(GtidMessage* message, GtidMessage* target)
 {
-  uint64_t start = 0, end = 0;
-  std::vector<txn_range> merge;
-  std::vector<txn_range> full_range;
-  full_range.insert(full_range.end(), message->get_txn_range().begin(), message->get_txn_range().end());
-  full_range.insert(full_range.end(), target->get_txn_range().begin(), target->get_txn_range().end());
-  for (auto const& range : full_range) {
-    if (start == 0) {
-      start = range.first;
-      end = range.second;
-    } else {
-      if (range.first <= end + 1) {
-        end = std::max(end, range.second);
-      } else {
-        merge.emplace_back(start, end);
-        start = range.first;
-        end = range.second;
-      }
-    }
-  }
-  if (start != 0) {
-    merge.emplace_back(start, end);
-  }
-  target->set_txn_range(merge);
+  target->get_txn_range().add(message->get_txn_range());
   return OMS_OK;
 }
 
-bool BinlogFunction::is_subset(const std::vector<txn_range>& subset, const std::vector<txn_range>& target)
-{
-  for (auto sub : subset) {
-    bool found = false;
-    for (auto tar : target) {
-      if (sub.first >= tar.first && sub.second <= tar.second) {
-        found = true;
-        break;
-      }
-    }
-    if (!found) {
-      return false;
-    }
-  }
-  return true;
-}
-
 int BinlogFunction::gtid_subtract(const string& set_origin, const string& set_target, string& result)
 {
   // Parse the corresponding gtid collection
@@ -149,10 +110,9 @@ int BinlogFunction::gtid_subtract(const string& set_origin, const string& set_ta
       continue;
     }
     auto* target = target_msg.find(origin.first)->second;
-    std::vector<txn_range> diff;
-    difference(origin.second->get_txn_range(), target->get_txn_range(), diff);
+    TxnRangeSet diff = origin.second->get_txn_range();
+    diff.subtract(target->get_txn_range());
     if (!diff.empty()) {
-      std::sort(diff.begin(), diff.end());
       GtidMessage* tmp_msg = new GtidMessage();
       auto* uuid = static_cast<unsigned char*>(malloc(SERVER_UUID_LEN));
       memset(uuid, 0, SERVER_UUID_LEN);
@@ -176,68 +136,6 @@ int BinlogFunction::gtid_subtract(const string& set_origin, const string& set_ta
   return OMS_OK;
 }
 
-int BinlogFunction::difference(
-    std::vector<txn_range> origin, std::vector<txn_range> target, std::vector<txn_range>& result)
-{
-  // Sort origin and target according to the starting number from small to large
-  std::sort(origin.begin(), origin.end());
-  std::sort(target.begin(), target.end());
-
-  for (const auto& range_target : target) {
-    for (size_t i = 0; i < origin.size(); ++i) {
-      OMS_INFO("target range [{},{}],origin range [{},{}]",
-          range_target.first,
-          range_target.second,
-          origin[i].first,
-          origin[i].second);
-      if (range_target.second < origin[i].first) {
-        break;
-      } else if (range_target.first > origin[i].second) {
-        continue;
-      } else {
-        // 1. When range_target is completely within the range of origin, all range_targets need to be dug out at this
-        // time
-        if (range_target.second < origin[i].second && range_target.first > origin[i].first) {
-          uint64_t first = origin[i].first;
-          origin[i].first = range_target.second + 1;
-          origin.emplace_back(first, range_target.first - 1);
-          break;
-        }
-
-        if (range_target.second >= origin[i].second) {
-          if (range_target.first <= origin[i].first) {
-            // delete all
-            origin[i].first = 0;
-            origin[i].second = 0;
-            continue;
-          }
-
-          origin[i].second = range_target.first + 1;
-          continue;
-        }
-
-        if (origin[i].first >= range_target.first) {
-          origin[i].first = range_target.second + 1;
-          break;
-        }
-        uint64_t end = origin[i].second;
-        origin[i].second = range_target.first - 1;
-        origin.emplace_back(range_target.second + 1, end);
-        break;
-      }
-    }
-  }
-
-  std::copy_if(origin.begin(), origin.end(), std::back_inserter(result), [](txn_range range) {
-    return range.first != 0 && range.second != 0;
-  });
-
-  for (const auto& range : result) {
-    OMS_INFO("[{},{}]", range.first, range.second);
-  }
-  return OMS_OK;
-}
-
 IoResult GtidSubsetFuncProcessor::process(binlog::Connection* conn, hsql::SQLStatement* statement)
 {
   OMS_INFO("Execute the gtid_subset function");
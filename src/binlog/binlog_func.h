@@ -80,15 +80,6 @@ public:
 
   static int merge_txn_range(GtidMessage* message, GtidMessage* target);
 
-  /*!
-   * @brief  Determine whether the transaction set subset corresponding
-   * to the same uuid is a subset of target
-   * @param subset
-   * @param target
-   * @return
-   */
-  static bool is_subset(const std::vector<txn_range>& subset, const std::vector<txn_range>& target);
-
   /*!
    * @brief Get the difference between set_target and set_origin
    * @param set_origin
@@ -97,16 +88,6 @@ public:
    * @return Whether the calculation was successful
    */
   static int gtid_subtract(const std::string& set_origin, const std::string& set_target, std::string& result);
-
-  /*!
-   * @brief Obtain the gtid difference corresponding to the unified instance ID
-   * @param origin
-   * @param target
-   * @param result
-   * @return
-   */
-  static int difference(
-      std::vector<txn_range> origin, std::vector<txn_range> target, std::vector<txn_range>& result);
 };
 }  // namespace logproxy
 }  // namespace oceanbase
\ No newline at end of file
@@ -21,6 +21,8 @@
 #include "binlog_state_machine.h"
 #include "metric/sys_metric.h"
 #include "metric/status_thread.h"
+#include "metric/metric_registry.h"
+#include "binlog_index.h"
 
 namespace oceanbase {
 namespace binlog {
@@ -45,6 +47,17 @@ int BinlogServer::run_foreground()
   }
   fcntl(evconnlistener_get_fd(listener), F_SETFD, FD_CLOEXEC);
   OMS_STREAM_INFO << "Start OceanBase binlog server on port " << sys_var_listen_port;
+  logproxy::HttpServer metric_server;
+  if (s_config.metric_http_port.val() != 0) {
+    if (metric_server.init(ev_base, s_config.metric_http_port.val()) != OMS_OK) {
+      evconnlistener_free(listener);
+      event_base_free(ev_base);
+      return OMS_FAILED;
+    }
+    metric_server.register_handler(
+        "/metrics", [](const std::string&, logproxy::HttpResponse& response) { on_metrics(response); });
+  }
+  logproxy::set_disk_usage_func(disk_usage);
   logproxy::StatusThread status_thread(logproxy::g_metric, logproxy::g_proc_metric);
   if (s_config.metric_enable.val()) {
     status_thread.start();
@@ -54,6 +67,7 @@ int BinlogServer::run_foreground()
   event_base_dispatch(ev_base);
   OMS_STREAM_INFO << "Stop OceanBase binlog server";
 
+  metric_server.stop();
   evconnlistener_free(listener);
   event_base_free(ev_base);
   env_deInit();
@@ -81,7 +95,7 @@ void BinlogServer::start_owned_binlog_converters()
       }
 
       if (pulled_up.find(state_machine->get_unique_id()) == pulled_up.end()) {
-        g_bc_executor->submit(logproxy::start_binlog_converter, state_machine->get_config());
+        g_bc_executor->execute(logproxy::start_binlog_converter, state_machine->get_config());
         pulled_up[state_machine->get_unique_id()] = true;
       }
     }
@@ -90,5 +104,41 @@ void BinlogServer::start_owned_binlog_converters()
   logproxy::release_vector(state_machines);
 }
 
+bool BinlogServer::disk_usage(const std::string& path, uint64_t& bytes)
+{
+  // positions in index are updated by converter on each flush, and purged files are removed from it
+  std::string index_file = path + BINLOG_INDEX_NAME;
+  if (!logproxy::FsUtil::exist(index_file)) {
+    return false;
+  }
+  std::vector<logproxy::BinlogIndexRecord*> index_records;
+  if (logproxy::fetch_index_vector(index_file, index_records) != OMS_OK) {
+    logproxy::release_vector(index_records);
+    return false;
+  }
+  bytes = 0;
+  for (auto* index_record : index_records) {
+    bytes += index_record->get_position();
+  }
+  logproxy::release_vector(index_records);
+  return true;
+}
+
+void BinlogServer::on_metrics(logproxy::HttpResponse& response)
+{
+  std::vector<StateMachine*> state_machines;
+  g_state_machine->fetch_state_vector(get_default_state_file_path(), state_machines);
+  std::vector<std::string> child_files;
+  for (auto state_machine : state_machines) {
+    if (state_machine->get_converter_state() == RUNNING) {
+      child_files.emplace_back(state_machine->get_work_path() + "/" + s_config.metric_export_file.val());
+    }
+  }
+  logproxy::release_vector(state_machines);
+
+  response.headers.emplace("Content-Type", "text/plain; version=0.0.4");
+  logproxy::MetricRegistry::instance().render(child_files, response.payload);
+}
+
 }  // namespace binlog
 }  // namespace oceanbase
@@ -11,6 +11,7 @@
  */
 
 #include "common.h"
+#include "communication/http.h"
 
 namespace oceanbase {
 namespace binlog {
@@ -20,6 +21,16 @@ public:
 
 private:
   static void start_owned_binlog_converters();
+
+  /*!
+   * @brief Serve /metrics, merging metrics exported by all running binlog converters
+   */
+  static void on_metrics(logproxy::HttpResponse& response);
+
+  /*!
+   * @brief Disk usage of converter data directory, summed up from binlog index instead of walking the directory
+   */
+  static bool disk_usage(const std::string& path, uint64_t& bytes);
 };
 
 }  // namespace binlog
@@ -50,26 +50,37 @@ IoResult QueryCmdProcessor::process(Connection* conn, PacketBuf& payload)
   payload.read_fixed_length_string(query, payload.readable_bytes());
   OMS_INFO("Received query [{}] on connection {}", query, conn->endpoint());
 
-  hsql::SQLParserResult parser_result;
-  int ret = ObSqlParser::parse(query, parser_result);
-  if (ret != OMS_OK) {
+  // bootstrap queries of replication clients are answered without parsing
+  std::string normalized_query = SqlParseCache::normalize(query);
+  std::shared_ptr<const ImmutableResultSet> result_set = ImmutableResultCache::instance().get(normalized_query);
+  if (result_set != nullptr) {
+    return ImmutableResultCache::send(conn, *result_set);
+  }
+
+  std::shared_ptr<const hsql::SQLParserResult> parser_result = SqlParseCache::instance().parse(normalized_query);
+  if (!parser_result->isValid()) {
     OMS_WARN("unsupported sql query [{}], sqlError [{} (L{}:{})] on connection {}",
         query,
-        parser_result.errorMsg(),
-        parser_result.errorLine(),
-        parser_result.errorColumn(),
+        parser_result->errorMsg(),
+        parser_result->errorLine(),
+        parser_result->errorColumn(),
         conn->endpoint());
     conn->send_ok_packet();
     return IoResult::SUCCESS;
   }
 
-  if (parser_result.getStatements().empty()) {
+  if (parser_result->getStatements().empty()) {
     OMS_WARN("sql statement is empty on connection {}", conn->endpoint());
     conn->send_ok_packet();
     return IoResult::SUCCESS;
   }
-  auto* statement = parser_result.getStatement(0);
+  auto* statement = parser_result->getStatement(0);
   OMS_INFO("Successfully parsed SQL [type:{}],[{}]", statement->type(), query);
+  result_set = ImmutableResultCache::build(statement);
+  if (result_set != nullptr) {
+    ImmutableResultCache::instance().put(normalized_query, result_set);
+    return ImmutableResultCache::send(conn, *result_set);
+  }
   SqlCmdProcessor* p_sql_cmd_processor = sql_cmd_processor(statement->type());
   if (p_sql_cmd_processor != nullptr) {
     return p_sql_cmd_processor->process(conn, statement);
@@ -160,16 +171,13 @@ IoResult BinlogDumpGtidCmdProcessor::process(Connection* conn, PacketBuf& payloa
     uint64_t start = 0;
     uint64_t end = 0;
     std::vector<logproxy::txn_range> txn_range;
+    txn_range.reserve(n_intervals);
     for (uint64_t j = 0; j < n_intervals; ++j) {
       payload.read_uint8(start);
       payload.read_uint8(end);
-      logproxy::txn_range range;
-      range.first = start;
-      range.second = end;
-      OMS_STREAM_INFO << "start:" << start << " end:" << end;
-      txn_range.emplace_back(range);
+      txn_range.emplace_back(start, end);
     }
-    gtid_message->set_txn_range(txn_range);
+    gtid_message->set_txn_range(logproxy::TxnRangeSet(std::move(txn_range)));
 
     OMS_STREAM_INFO << "gtid message " << gtid_message->format_string();
 
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "compressed_stream.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <sys/uio.h>
+#include <zlib.h>
+
+#include "common.h"
+#include "log.h"
+#include "communication/io.h"
+#include "mysql-protocol/byte_order.h"
+
+namespace oceanbase {
+namespace binlog {
+
+CompressedStream::~CompressedStream()
+{
+  if (_zstd_cctx != nullptr) {
+    ZSTD_freeCCtx(_zstd_cctx);
+    _zstd_cctx = nullptr;
+  }
+}
+
+void CompressedStream::enable(CompressionAlgorithm algorithm, int level, uint32_t frame_size)
+{
+  _algorithm = algorithm;
+  _level = level;
+  _frame_size = std::min(std::max(frame_size, min_compress_length), max_frame_length);
+  if (_algorithm == CompressionAlgorithm::ZSTD && _zstd_cctx == nullptr) {
+    _zstd_cctx = ZSTD_createCCtx();
+  }
+}
+
+const char* CompressedStream::name(CompressionAlgorithm algorithm)
+{
+  switch (algorithm) {
+    case CompressionAlgorithm::ZLIB:
+      return "zlib";
+    case CompressionAlgorithm::ZSTD:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+int CompressedStream::write(int fd, const uint8_t* data, size_t len)
+{
+  while (len > 0) {
+    size_t n = std::min<size_t>(len, _frame_size - _pending.size());
+    _pending.append(reinterpret_cast<const char*>(data), n);
+    data += n;
+    len -= n;
+    if (_pending.size() >= _frame_size) {
+      if (flush(fd) != OMS_OK) {
+        return OMS_FAILED;
+      }
+    }
+  }
+  return OMS_OK;
+}
+
+int CompressedStream::flush(int fd)
+{
+  if (_pending.empty()) {
+    return OMS_OK;
+  }
+  int ret = send_frame(fd, reinterpret_cast<const uint8_t*>(_pending.data()), _pending.size());
+  _pending.clear();
+  return ret;
+}
+
+int CompressedStream::send_frame(int fd, const uint8_t* data, uint32_t len)
+{
+  assert(len <= max_frame_length);
+  size_t compressed_len = 0;
+  bool compressed = len >= min_compress_length && compress(data, len, compressed_len) == OMS_OK && compressed_len < len;
+
+  uint8_t header[header_length];
+  uint32_t write_index = 0;
+  write_htole24(header, write_index, compressed ? compressed_len : len);
+  write_htole8(header, write_index, _seq_no++);
+  // 0 means the payload is sent uncompressed
+  write_htole24(header, write_index, compressed ? len : 0);
+
+  struct iovec iov[2];
+  iov[0].iov_base = header;
+  iov[0].iov_len = header_length;
+  iov[1].iov_base = compressed ? static_cast<void*>(&_compressed[0]) : const_cast<uint8_t*>(data);
+  iov[1].iov_len = compressed ? compressed_len : len;
+  return logproxy::writevn(fd, iov, 2) < 0 ? OMS_FAILED : OMS_OK;
+}
+
+int CompressedStream::compress(const uint8_t* data, uint32_t len, size_t& compressed_len)
+{
+  if (_algorithm == CompressionAlgorithm::ZSTD) {
+    _compressed.resize(ZSTD_compressBound(len));
+    size_t ret = ZSTD_compressCCtx(_zstd_cctx, &_compressed[0], _compressed.size(), data, len, _level);
+    if (ZSTD_isError(ret)) {
+      OMS_ERROR("Failed to compress {} bytes by zstd: {}", len, ZSTD_getErrorName(ret));
+      return OMS_FAILED;
+    }
+    compressed_len = ret;
+    return OMS_OK;
+  }
+
+  uLongf dest_len = compressBound(len);
+  _compressed.resize(dest_len);
+  int ret = compress2(reinterpret_cast<Bytef*>(&_compressed[0]), &dest_len, data, len, Z_DEFAULT_COMPRESSION);
+  if (ret != Z_OK) {
+    OMS_ERROR("Failed to compress {} bytes by zlib: {}", len, ret);
+    return OMS_FAILED;
+  }
+  compressed_len = dest_len;
+  return OMS_OK;
+}
+
+int CompressedStream::read(int fd, uint8_t* buf, size_t len)
+{
+  while (_input.size() - _input_offset < len) {
+    if (read_frame(fd) != OMS_OK) {
+      return OMS_FAILED;
+    }
+  }
+  memcpy(buf, _input.data() + _input_offset, len);
+  _input_offset += len;
+  return OMS_OK;
+}
+
+int CompressedStream::read_frame(int fd)
+{
+  _input.erase(0, _input_offset);
+  _input_offset = 0;
+
+  uint8_t header[header_length];
+  if (logproxy::readn(fd, header, header_length) < 0) {
+    return OMS_FAILED;
+  }
+  uint32_t read_index = 0;
+  uint32_t payload_length = 0;
+  uint8_t sequence = 0;
+  uint32_t uncompressed_length = 0;
+  read_le24toh(header, read_index, payload_length);
+  read_le8toh(header, read_index, sequence);
+  read_le24toh(header, read_index, uncompressed_length);
+  if (sequence != _seq_no) {
+    OMS_ERROR("Unexpected compressed seq num, expected value is {}, actual value is {}", _seq_no, sequence);
+    return OMS_FAILED;
+  }
+  ++_seq_no;
+
+  size_t offset = _input.size();
+  if (uncompressed_length == 0) {
+    _input.resize(offset + payload_length);
+    return logproxy::readn(fd, &_input[offset], static_cast<int>(payload_length));
+  }
+
+  _compressed.resize(payload_length);
+  if (logproxy::readn(fd, &_compressed[0], static_cast<int>(payload_length)) < 0) {
+    return OMS_FAILED;
+  }
+  _input.resize(offset + uncompressed_length);
+  auto* dest = reinterpret_cast<uint8_t*>(&_input[offset]);
+  if (_algorithm == CompressionAlgorithm::ZSTD) {
+    size_t ret = ZSTD_decompress(dest, uncompressed_length, _compressed.data(), payload_length);
+    if (ZSTD_isError(ret) || ret != uncompressed_length) {
+      OMS_ERROR("Failed to decompress frame of {} bytes by zstd: {}",
+          payload_length,
+          ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatched");
+      return OMS_FAILED;
+    }
+    return OMS_OK;
+  }
+
+  uLongf dest_len = uncompressed_length;
+  int ret = uncompress(dest, &dest_len, reinterpret_cast<const Bytef*>(_compressed.data()), payload_length);
+  if (ret != Z_OK || dest_len != uncompressed_length) {
+    OMS_ERROR("Failed to decompress frame of {} bytes by zlib: {}", payload_length, ret);
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+}  // namespace binlog
+}  // namespace oceanbase
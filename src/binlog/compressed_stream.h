@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <zstd.h>
+
+namespace oceanbase {
+namespace binlog {
+
+enum class CompressionAlgorithm {
+  NONE,
+  ZLIB,
+  ZSTD,
+};
+
+/*!
+ * @brief Compressed packets of the MySQL protocol, see
+ * https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_basic_compression.html. Bytes of mysql packets
+ * written are buffered and sent in frames of up to frame_size bytes before compression, so that small packets share
+ * one frame and one compression context, and bytes read are decompressed from the frames sent by the client
+ */
+class CompressedStream {
+public:
+  CompressedStream() = default;
+
+  ~CompressedStream();
+
+  CompressedStream(const CompressedStream&) = delete;
+  CompressedStream& operator=(const CompressedStream&) = delete;
+
+  /*!
+   * @param level zstd compression level requested by the client, ignored by zlib
+   */
+  void enable(CompressionAlgorithm algorithm, int level, uint32_t frame_size);
+
+  bool is_enabled() const
+  {
+    return _algorithm != CompressionAlgorithm::NONE;
+  }
+
+  CompressionAlgorithm algorithm() const
+  {
+    return _algorithm;
+  }
+
+  /*!
+   * @brief The compressed sequence restarts from 0 on each command, independently of the one of mysql packets
+   */
+  void reset_sequence()
+  {
+    _seq_no = 0;
+  }
+
+  /*!
+   * @brief Buffer bytes of mysql packets, sending the frames filled up
+   */
+  int write(int fd, const uint8_t* data, size_t len);
+
+  /*!
+   * @brief Send bytes buffered in frames, called before waiting for the client or for more events
+   */
+  int flush(int fd);
+
+  /*!
+   * @brief Read len bytes of mysql packets, reading and decompressing frames as needed
+   */
+  int read(int fd, uint8_t* buf, size_t len);
+
+  static const char* name(CompressionAlgorithm algorithm);
+
+public:
+  static constexpr uint8_t header_length = 7;
+  static constexpr uint32_t max_frame_length = (1U << 24) - 1;
+  // shorter payloads are sent uncompressed, as MIN_COMPRESS_LENGTH of MySQL
+  static constexpr uint32_t min_compress_length = 50;
+
+private:
+  int send_frame(int fd, const uint8_t* data, uint32_t len);
+
+  int compress(const uint8_t* data, uint32_t len, size_t& compressed_len);
+
+  int read_frame(int fd);
+
+private:
+  CompressionAlgorithm _algorithm = CompressionAlgorithm::NONE;
+  int _level = 3;
+  uint32_t _frame_size = 0;
+  uint8_t _seq_no = 0;
+
+  std::string _pending;
+  std::string _compressed;
+  ZSTD_CCtx* _zstd_cctx = nullptr;
+
+  std::string _input;
+  size_t _input_offset = 0;
+};
+
+}  // namespace binlog
+}  // namespace oceanbase
@@ -28,6 +28,14 @@ using IoResult = Connection::IoResult;
 
 const std::regex Connection::ob_full_user_name_pattern{R"((.*)@(.*)#(.*))"};  // user@tenant#cluster
 
+static Capability server_capabilities()
+{
+  if (logproxy::Config::instance().binlog_protocol_compression.val()) {
+    return ob_binlog_server_capabilities | ob_binlog_server_compression_capabilities;
+  }
+  return ob_binlog_server_capabilities;
+}
+
 Connection::Connection(int sock_fd, std::string local_ip, std::string peer_ip, uint16_t local_port, uint16_t peer_port,
     ConnectionManager& conn_mgr, const SysVar& sys_var)
     : sock_fd_(sock_fd),
@@ -36,7 +44,8 @@ Connection::Connection(int sock_fd, std::string local_ip, std::string peer_ip, u
       local_port_(local_port),
       peer_port_(peer_port),
       conn_mgr_(conn_mgr),
-      client_capabilities_(ob_binlog_server_capabilities) /* for handshake */,
+      client_capabilities_(server_capabilities()) /* for handshake */,
+      zstd_compression_level_(3),
       thread_id_(0),
       ev_(nullptr),
       pkt_buf_(sys_var.net_buffer_length, sys_var.max_allowed_packet),
@@ -88,7 +97,10 @@ IoResult Connection::send(const DataPacket& data_packet)
 {
   pkt_buf_.clear();
   data_packet.serialize(pkt_buf_, client_capabilities_);
-  return send_data_packet();
+  if (send_data_packet() != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+  return flush();
 }
 
 IoResult Connection::read_data_packet()
@@ -106,7 +118,7 @@ IoResult Connection::read_data_packet()
 IoResult Connection::read_mysql_packet(uint32_t& payload_length)
 {
   uint8_t header[mysql_pkt_header_length];
-  if (logproxy::readn(sock_fd_, header, mysql_pkt_header_length) < 0) {
+  if (read_bytes(header, mysql_pkt_header_length) != IoResult::SUCCESS) {
     OMS_ERROR("Can not read response from client. Expected to read 4 bytes, read 0 bytes before connection was "
               "unexpectedly lost.");
     return IoResult::FAIL;
@@ -126,8 +138,7 @@ IoResult Connection::read_mysql_packet(uint32_t& payload_length)
     return IoResult::FAIL;
   }
 
-  if (logproxy::readn(sock_fd_, pkt_buf_.get_buf() + pkt_buf_.get_write_index(), static_cast<int>(payload_length)) <
-      0) {
+  if (read_bytes(pkt_buf_.get_buf() + pkt_buf_.get_write_index(), payload_length) != IoResult::SUCCESS) {
     return IoResult::FAIL;
   }
   pkt_buf_.set_write_index(pkt_buf_.get_write_index() + payload_length);
@@ -157,8 +168,30 @@ IoResult Connection::send_mysql_packet(const uint8_t* payload, uint32_t payload_
   write_htole24(header, write_index, payload_length);
   write_htole8(header, write_index, seq_no_++);
   assert(write_index == mysql_pkt_header_length);
-  if (logproxy::writen(sock_fd_, header, mysql_pkt_header_length) < 0 ||
-      logproxy::writen(sock_fd_, payload, static_cast<int>(payload_length)) < 0) {
+  if (write_bytes(header, mysql_pkt_header_length) != IoResult::SUCCESS ||
+      write_bytes(payload, payload_length) != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+  return IoResult::SUCCESS;
+}
+
+IoResult Connection::read_bytes(uint8_t* buf, uint32_t len)
+{
+  int ret = compressed_stream_.is_enabled() ? compressed_stream_.read(sock_fd_, buf, len)
+                                            : logproxy::readn(sock_fd_, buf, static_cast<int>(len));
+  return ret < 0 ? IoResult::FAIL : IoResult::SUCCESS;
+}
+
+IoResult Connection::write_bytes(const uint8_t* buf, uint32_t len)
+{
+  int ret = compressed_stream_.is_enabled() ? compressed_stream_.write(sock_fd_, buf, len)
+                                            : logproxy::writen(sock_fd_, buf, static_cast<int>(len));
+  return ret < 0 ? IoResult::FAIL : IoResult::SUCCESS;
+}
+
+IoResult Connection::flush()
+{
+  if (compressed_stream_.is_enabled() && compressed_stream_.flush(sock_fd_) != OMS_OK) {
     return IoResult::FAIL;
   }
   return IoResult::SUCCESS;
@@ -229,12 +262,56 @@ IoResult Connection::process_handshake_response()
     pkt_buf_.read_null_terminated_string(client_plugin_name);
   }
 
-  return send_ok_packet();
+  if (has_capability(client_capabilities, Capability::client_connect_attrs)) {
+    uint64_t attrs_length = 0;
+    pkt_buf_.read_uint(attrs_length);
+    uint64_t attrs_end = pkt_buf_.get_read_index() + attrs_length;
+    while (pkt_buf_.get_read_index() < attrs_end) {
+      std::string key;
+      std::string value;
+      if (pkt_buf_.read_length_encoded_string(key) < 0 || pkt_buf_.read_length_encoded_string(value) < 0) {
+        break;
+      }
+      connect_attrs_[key] = value;
+    }
+    OMS_STREAM_INFO << "Connection attributes on connection " << endpoint() << ", program_name: "
+                    << get_connect_attr("program_name") << ", _client_version: " << get_connect_attr("_client_version");
+  }
+
+  if (has_capability(client_capabilities, Capability::client_zstd_compression_algorithm)) {
+    pkt_buf_.read_uint1(zstd_compression_level_);
+  }
+
+  if (send_ok_packet() != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+
+  // both sides compress packets following the ok packet of the handshake, zlib preferred as MySQL does
+  CompressionAlgorithm algorithm = CompressionAlgorithm::NONE;
+  if (has_capability(client_capabilities_, Capability::client_compress)) {
+    algorithm = CompressionAlgorithm::ZLIB;
+  } else if (has_capability(client_capabilities_, Capability::client_zstd_compression_algorithm)) {
+    algorithm = CompressionAlgorithm::ZSTD;
+  }
+  if (algorithm != CompressionAlgorithm::NONE) {
+    compressed_stream_.enable(
+        algorithm, zstd_compression_level_, logproxy::Config::instance().binlog_protocol_compress_frame_bytes.val());
+    OMS_STREAM_INFO << "Enabled " << CompressedStream::name(algorithm) << " compression on connection " << endpoint()
+                    << ", zstd level: " << static_cast<int>(zstd_compression_level_);
+  }
+  return IoResult::SUCCESS;
+}
+
+std::string Connection::get_connect_attr(const std::string& key) const
+{
+  auto iter = connect_attrs_.find(key);
+  return iter == connect_attrs_.end() ? "" : iter->second;
 }
 
 IoResult Connection::do_cmd()
 {
   seq_no_ = 0;  // reset seq_no_ on each command
+  compressed_stream_.reset_sequence();
   if (read_data_packet() != IoResult::SUCCESS) {
     return IoResult::FAIL;
   }
@@ -279,7 +356,7 @@ IoResult Connection::send_err_packet(uint16_t err_code, std::string err_msg, con
   return send(err_packet);
 }
 
-IoResult Connection::send_binlog_event(const uint8_t* event_buf, uint32_t len)
+IoResult Connection::send_binlog_event(const uint8_t* event_buf, uint32_t len, bool flush)
 {
   while (len >= mysql_pkt_max_length) {
     if (send_mysql_packet(event_buf, mysql_pkt_max_length) != IoResult::SUCCESS) {
@@ -288,7 +365,10 @@ IoResult Connection::send_binlog_event(const uint8_t* event_buf, uint32_t len)
     event_buf += mysql_pkt_max_length;
     len -= mysql_pkt_max_length;
   }
-  return send_mysql_packet(event_buf, len);
+  if (send_mysql_packet(event_buf, len) != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+  return flush ? this->flush() : IoResult::SUCCESS;
 }
 
 std::string Connection::get_full_binlog_path() const
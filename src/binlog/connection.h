@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include "compressed_stream.h"
 #include "event_wrapper.h"
 #include "mysql-protocol/mysql_protocol_new.h"
 #include "sys_var.h"
@@ -111,6 +112,11 @@ public:
     return ob_user_;
   }
 
+  /*!
+   * @brief Attribute sent by the client in its handshake response, e.g. program_name, empty if not sent
+   */
+  std::string get_connect_attr(const std::string& key) const;
+
   void set_ob_cluster(const string& ob_cluster);
 
   void set_ob_tenant(const string& ob_tenant);
@@ -160,7 +166,20 @@ public:
 
   IoResult send_err_packet(uint16_t err_code, std::string err_msg, const std::string& sql_state);
 
-  IoResult send_binlog_event(const uint8_t* event_buf, uint32_t len);
+  /*!
+   * @param flush false to leave the event buffered in the compressed frame for the following ones of the batch
+   */
+  IoResult send_binlog_event(const uint8_t* event_buf, uint32_t len, bool flush = true);
+
+  /*!
+   * @brief Send packets buffered in the compressed frame, nothing to do if compression is not negotiated
+   */
+  IoResult flush();
+
+  CompressionAlgorithm get_compression_algorithm() const
+  {
+    return compressed_stream_.algorithm();
+  }
 
   std::string get_full_binlog_path() const;
 
@@ -198,6 +217,10 @@ private:
 
   IoResult send_mysql_packet(const uint8_t* payload, uint32_t payload_length);
 
+  IoResult read_bytes(uint8_t* buf, uint32_t len);
+
+  IoResult write_bytes(const uint8_t* buf, uint32_t len);
+
 private:
   static constexpr uint8_t mysql_pkt_header_length = 4;
   static constexpr uint32_t mysql_pkt_max_length = (1U << 24) - 1;
@@ -218,11 +241,15 @@ private:
   std::string ob_cluster_;
   std::string ob_tenant_;
   std::string ob_user_;
+  std::map<std::string, std::string> connect_attrs_;
+  uint8_t zstd_compression_level_;
 
   struct event* ev_;
 
   PacketBuf pkt_buf_;
   uint8_t seq_no_;
+  // enabled after the handshake if the client asks for compression
+  CompressedStream compressed_stream_;
 
   std::string _trace_id;
 
@@ -11,10 +11,44 @@
  */
 
 #include "ddl_converter.h"
+#include "config.h"
+#include "lru_cache.hpp"
+#include "str.h"
+#include "timer.h"
+
 namespace oceanbase {
 namespace logproxy {
 
+struct ConvertResult {
+  int ret = OMS_FAILED;
+  std::string dest;
+};
+
+static LruCache<std::string, ConvertResult> _s_results;
+
 int DdlConverter::convert(const std::string& source, std::string& dest)
+{
+  size_t capacity = Config::instance().binlog_ddl_convert_cache_size.val();
+  if (capacity == 0) {
+    return convert_uncached(source, dest);
+  }
+
+  std::string key = normalize_sql(source);
+  ConvertResult result;
+  if (_s_results.get(key, result)) {
+    OMS_STREAM_INFO << "convert ddl hit cache, source sql:[ " << source << " ], dest sql:[ " << result.dest << " ]";
+    dest = result.dest;
+    return result.ret;
+  }
+
+  result.ret = convert_uncached(source, result.dest);
+  dest = result.dest;
+  int ret = result.ret;
+  _s_results.put(key, std::move(result), capacity);
+  return ret;
+}
+
+int DdlConverter::convert_uncached(const std::string& source, std::string& dest)
 {
   OMS_STREAM_INFO << "convert ddl source sql:[ " << source << " ]";
 
@@ -31,5 +65,37 @@ int DdlConverter::convert(const std::string& source, std::string& dest)
   }
 }
 
+void DdlConverter::warm_up()
+{
+  static const char* ddls[] = {
+      "CREATE TABLE `t_warm_up` (`id` bigint(20) NOT NULL AUTO_INCREMENT, `name` varchar(64) DEFAULT NULL COMMENT "
+      "'name', `ts` timestamp(6) NULL DEFAULT CURRENT_TIMESTAMP(6), PRIMARY KEY (`id`), KEY `idx_name` (`name`)) "
+      "DEFAULT CHARSET = utf8mb4 PARTITION BY RANGE(`id`) (PARTITION p0 VALUES LESS THAN (100))",
+      "ALTER TABLE `t_warm_up` ADD COLUMN `c1` int(11) NOT NULL DEFAULT '0', MODIFY COLUMN `name` varchar(128)",
+      "ALTER TABLE `t_warm_up` ADD PARTITION (PARTITION p1 VALUES LESS THAN (200))",
+      "ALTER TABLE `t_warm_up` DROP PARTITION p0",
+      "CREATE INDEX `idx_ts` ON `t_warm_up` (`ts`)",
+      "DROP TABLE `t_warm_up`",
+  };
+  Timer timer;
+  std::string dest;
+  std::string err_msg;
+  for (const char* ddl : ddls) {
+    dest.clear();
+    etransfer::tool::ConvertTool::Parse(ddl, "", true, dest, err_msg);
+  }
+  OMS_INFO("Warmed up ddl converter in {} us", timer.elapsed());
+}
+
+size_t DdlConverter::cache_size()
+{
+  return _s_results.size();
+}
+
+void DdlConverter::clear_cache()
+{
+  _s_results.clear();
+}
+
 }  // namespace logproxy
-}  // namespace oceanbase
\ No newline at end of file
+}  // namespace oceanbase
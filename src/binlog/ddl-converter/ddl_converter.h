@@ -19,7 +19,24 @@ namespace oceanbase {
 namespace logproxy {
 class DdlConverter {
 public:
+  /*!
+   * @brief Convert the DDL of OceanBase MySQL mode to the one of MySQL, results are cached by normalize_sql() of the
+   * DDL, including failures, as the conversion depends on the text only
+   */
   static int convert(const std::string& source, std::string& dest);
+
+  /*!
+   * @brief Convert a few typical DDLs, by which ATN and DFA caches of the ANTLR parser shared by later conversions
+   * are filled ahead of the first DDL replicated
+   */
+  static void warm_up();
+
+  static size_t cache_size();
+
+  static void clear_cache();
+
+private:
+  static int convert_uncached(const std::string& source, std::string& dest);
 };
 }  // namespace logproxy
-}  // namespace oceanbase
\ No newline at end of file
+}  // namespace oceanbase
@@ -47,21 +47,21 @@ void on_handshake_cb(int sock, short events, void* p_connection)
 {
   auto conn = reinterpret_cast<Connection*>(p_connection);
   assert(sock == conn->get_sock_fd());
-  g_executor->submit(send_handshake_packet, conn);
+  g_executor->execute(send_handshake_packet, conn);
 }
 
 void on_handshake_response_cb(int sock, short events, void* p_connection)
 {
   auto conn = reinterpret_cast<Connection*>(p_connection);
   assert(sock == conn->get_sock_fd());
-  g_executor->submit(process_handshake_response, conn);
+  g_executor->execute(process_handshake_response, conn);
 }
 
 void on_cmd_cb(int sock, short events, void* p_connection)
 {
   auto conn = reinterpret_cast<Connection*>(p_connection);
   assert(sock == conn->get_sock_fd());
-  g_executor->submit(do_cmd, conn);
+  g_executor->execute(do_cmd, conn);
 }
 
 //================= functions that will be executed by g_executor =================================>
@@ -95,7 +95,7 @@ static void do_cmd(Connection* conn)
   Connection::IoResult io_result = conn->do_cmd();
   switch (io_result) {
     case Connection::IoResult::SUCCESS:
-      OMS_INFO("Succeeded do_cmd on connection {}", endpoint);
+      OMS_DEBUG("Succeeded do_cmd on connection {}", endpoint);
       conn->register_event(EV_READ, on_cmd_cb);
       break;
     case Connection::IoResult::FAIL:
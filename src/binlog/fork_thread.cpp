@@ -13,6 +13,9 @@
 #include "fork_thread.h"
 #include "binlog_converter/binlog_converter.h"
 #include "binlog_state_machine.h"
+#include "metric/sys_metric.h"
+#include "cgroup.h"
+#include "spawner.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -35,34 +38,24 @@ int ForkBinlogThread::invoke(const ConvertMeta& meta, OblogConfig config)
     return OMS_FAILED;
   }
 
-  int pid = fork();
-  if (pid == -1) {
-    OMS_ERROR("Failed to fork: {}({})", errno, strerror(errno));
-    return OMS_FAILED;
+  if (Cgroup::enabled()) {
+    Cgroup::gc("binlog_converter.");
   }
 
-  if (pid == 0) {  // children
-    // close fds
-    for (int i = 0; i < sysconf(_SC_OPEN_MAX); i++) {
-      if (i != STDOUT_FILENO && i != STDERR_FILENO)
-        close(i);
-    }
-
-    // exec binlog converter
-    std::string converter_bin_file = Config::instance().bin_path.val() + std::string("/") + "binlog_converter";
-    char* argv[] = {const_cast<char*>("./binlog_converter"),
-        const_cast<char*>(config_name.c_str()),
-        const_cast<char*>(converter_work_path.c_str()),
-        nullptr};
-    execv(converter_bin_file.c_str(), argv);
-
-    ::exit(-1);
+  // binlog converter inherits no fd but stdio
+  std::string converter_bin_file = Config::instance().bin_path.val() + std::string("/") + "binlog_converter";
+  int pid = spawn_process(converter_bin_file, {"./binlog_converter", config_name, converter_work_path}, {});
+  if (pid < 0) {
+    return OMS_FAILED;
   }
 
-  // parent
   std::string cluster = config.cluster.val();
   std::string tenant = config.tenant.val();
   OMS_INFO("+++ create binlog converter with pid: {}", pid);
+  track_process(pid);
+  if (Cgroup::enabled()) {
+    Cgroup::place("binlog_converter." + std::to_string(pid), pid, ResourceBudget::client());
+  }
   binlog::StateMachine state_machine{
       cluster, tenant, pid, converter_work_path, binlog::RUNNING, config.generate_config()};
   binlog::g_state_machine->update_state(binlog::get_default_state_file_path(), state_machine);
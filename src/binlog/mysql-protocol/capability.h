@@ -87,7 +87,10 @@ inline constexpr bool has_capability(Capability capabilities, Capability expecte
 constexpr Capability ob_binlog_server_capabilities =
     Capability::client_long_password | Capability::client_no_schema | Capability::client_ignore_space |
     Capability::client_protocol_41 | Capability::client_interactive | Capability::client_reserved |
-    Capability::client_secure_connection | Capability::client_plugin_auth;
+    Capability::client_secure_connection | Capability::client_plugin_auth | Capability::client_connect_attrs;
+
+constexpr Capability ob_binlog_server_compression_capabilities =
+    Capability::client_compress | Capability::client_zstd_compression_algorithm;
 
 }  // namespace binlog
 }  // namespace oceanbase
@@ -15,8 +15,9 @@
 #include <utility>
 #include <cstring>
 #include <cassert>
-#include <zlib.h>
+#include <zstd.h>
 #include "str.h"
+#include "crc32.h"
 #include "common_util.h"
 #include "guard.hpp"
 #include "binlog_func.h"
@@ -182,14 +183,19 @@ void ObLogEvent::set_checksum_flag(uint8_t checksum_flag)
 size_t ObLogEvent::write_checksum(unsigned char* buff, size_t& pos) const
 {
   if (_checksum_flag == CRC32) {
-    uint64_t crc = crc32(0L, Z_NULL, 0);
-    crc = crc32(crc, buff, pos);
-    int4store(buff + pos, crc);
+    int4store(buff + pos, Crc32::compute(buff, pos));
     pos += 4;
   }
   return pos;
 }
 
+size_t ObLogEvent::flush_without_checksum(unsigned char* buff)
+{
+  size_t event_len = flush_to_buff(buff) - get_checksum_len();
+  int4store(buff + EVENT_LEN_OFFSET, event_len);
+  return event_len;
+}
+
 uint8_t ObLogEvent::get_checksum_len() const
 {
   if (_checksum_flag != OFF) {
@@ -278,7 +284,9 @@ FormatDescriptionEvent::FormatDescriptionEvent(uint64_t timestamp, uint32_t serv
       IGNORABLE_HEADER_LEN,
       TRANSACTION_CONTEXT_HEADER_LEN,
       VIEW_CHANGE_HEADER_LEN,
-      XA_PREPARE_HEADER_LEN};
+      XA_PREPARE_HEADER_LEN,
+      ROWS_HEADER_LEN_V2, /* PARTIAL_UPDATE_ROWS_EVENT*/
+      TRANSACTION_PAYLOAD_HEADER_LEN};
   this->_event_type_header_len.insert(
       _event_type_header_len.begin(), server_event_header_length, server_event_header_length + ENUM_END_EVENT - 1);
 
@@ -412,10 +420,16 @@ void FormatDescriptionEvent::deserialize(unsigned char* buff)
   this->set_header_len(int1load(buff + pos));
   pos += 1;
 
+  // files written before TRANSACTION_PAYLOAD_EVENT was known describe fewer event types, which are followed by the
+  // checksum flag and checksum of 4 bytes if the flag is CRC32
+  int event_types = header->get_event_length() - pos - 1 - COMMON_CHECKSUM_LENGTH;
+  if (event_types < 0 || int1load(buff + pos + event_types) != CRC32) {
+    event_types = header->get_event_length() - pos - 1;
+  }
   std::vector<uint8_t> event_type_header_len;
-  assert(pos + LOG_EVENT_TYPES <= header->get_event_length());
+  assert(event_types > 0 && pos + event_types <= header->get_event_length());
 
-  for (int i = 0; i < LOG_EVENT_TYPES; ++i) {
+  for (int i = 0; i < event_types; ++i) {
     event_type_header_len.emplace_back(int1load(buff + pos));
     pos += 1;
   }
@@ -450,11 +464,7 @@ PreviousGtidsLogEvent::PreviousGtidsLogEvent(
     GtidMessage* msg = gtid_it.second;
     header_len += SERVER_UUID_LEN;
     header_len += 8;
-
-    for (auto const& txn_range : msg->get_txn_range()) {
-      OMS_STREAM_INFO << "gtid:[" << txn_range.first << "," << txn_range.second << ")";
-      header_len += 16;
-    }
+    header_len += 16 * msg->get_txn_range().size();
   }
 
   header_len += get_checksum_len();
@@ -478,10 +488,13 @@ size_t PreviousGtidsLogEvent::flush_to_buff(unsigned char* buff)
     memcpy(buff + pos, msg->get_gtid_uuid(), SERVER_UUID_LEN);
     pos += SERVER_UUID_LEN;
 
-    int8store(buff + pos, msg->get_gtid_txn_id_intervals());
+    // counted from the ranges written rather than get_gtid_txn_id_intervals(), which goes stale once ranges merge,
+    // so that the body always matches the event length computed by the constructor
+    const TxnRangeSet& txn_ranges = msg->get_txn_range();
+    int8store(buff + pos, txn_ranges.size());
     pos += 8;
 
-    for (auto const& txn_range : msg->get_txn_range()) {
+    for (auto const& txn_range : txn_ranges) {
       int8store(buff + pos, txn_range.first);
       pos += 8;
 
@@ -540,21 +553,17 @@ void PreviousGtidsLogEvent::deserialize(unsigned char* buff)
   pos += 8;
 
   std::vector<txn_range> txn_vector;
-
+  txn_vector.reserve(gtid_message->get_gtid_txn_id_intervals());
   for (uint64_t i = 0; i < gtid_message->get_gtid_txn_id_intervals(); ++i) {
     uint64_t txn_start = int8load(buff + pos);
     pos += 8;
     uint64_t txn_end = int8load(buff + pos);
     pos += 8;
-    OMS_STREAM_INFO << "txn_start:" << txn_start << " txn_end:" << txn_end;
-    txn_range range;
-    range.first = txn_start;
-    range.second = txn_end;
-    txn_vector.emplace_back(range);
+    txn_vector.emplace_back(txn_start, txn_end);
   }
 
-  gtid_message->set_txn_range(txn_vector);
-  OMS_STREAM_INFO << "gtid uuid" << gtid_message->format_string();
+  gtid_message->set_txn_range(TxnRangeSet(std::move(txn_vector)));
+  OMS_STREAM_DEBUG << "gtid uuid" << gtid_message->format_string();
 
   gtid_messages.emplace_back(gtid_message);
 
@@ -579,17 +588,7 @@ std::string PreviousGtidsLogEvent::print_event_info()
       info << std::endl;
     }
 
-    /*
-     * For Previous Gtids Log Event, it is an interval that is closed on the left and open on the right, so it needs to
-     * be revised first when serializing the display.
-     */
-    auto temp = *gtid_message.second;
-    for (auto& i : temp.get_txn_range()) {
-      if (i.second != i.first) {
-        i.second -= 1;
-      }
-    }
-    info << temp.format_string();
+    info << gtid_message.second->format_string();
     count++;
   }
   return info.str();
@@ -900,12 +899,12 @@ void GtidMessage::set_gtid_txn_id_intervals(uint64_t gtid_txn_id_intervals)
   _gtid_txn_id_intervals = gtid_txn_id_intervals;
 }
 
-std::vector<txn_range>& GtidMessage::get_txn_range()
+TxnRangeSet& GtidMessage::get_txn_range()
 {
   return _txn_range;
 }
 
-void GtidMessage::set_txn_range(std::vector<txn_range> txn_range)
+void GtidMessage::set_txn_range(TxnRangeSet txn_range)
 {
   _txn_range = std::move(txn_range);
 }
@@ -950,14 +949,14 @@ std::string GtidMessage::format_string()
   transform(item_fifth.begin(), item_fifth.end(), item_fifth.begin(), ::tolower);
   stream << item_fifth;
 
-  for (uint64_t i = 0; i < this->_txn_range.size(); ++i) {
-    if (this->_txn_range.at(i).second != this->_txn_range.at(i).first) {
-      stream << ":" << this->_txn_range.at(i).first << "-" << this->_txn_range.at(i).second;
+  // ranges are closed in text, e.g. [1, 6) as 1-5
+  for (const txn_range& range : this->_txn_range) {
+    if (range.second - 1 != range.first) {
+      stream << ":" << range.first << "-" << range.second - 1;
     } else {
-      stream << ":" << this->_txn_range.at(i).first;
+      stream << ":" << range.first;
     }
   }
-  OMS_INFO("uuid string {}", stream.str());
   return stream.str();
 }
 
@@ -996,22 +995,19 @@ int GtidMessage::deserialize_gtid_set(const std::string& gtid_set)
     return OMS_FAILED;
   }
 
+  std::vector<txn_range> ranges;
+  ranges.reserve(parts.size() - 1);
   for (size_t i = 1; i < parts.size(); ++i) {
     std::vector<std::string> txn_ranges;
     logproxy::split(parts[i], '-', txn_ranges);
     switch (txn_ranges.size()) {
       case 1: {
-        txn_range range;
-        range.first = atoll(txn_ranges.at(0).c_str());
-        range.second = atoll(txn_ranges.at(0).c_str());
-        _txn_range.emplace_back(range);
+        uint64_t txn_id = atoll(txn_ranges.at(0).c_str());
+        ranges.emplace_back(txn_id, txn_id + 1);
         break;
       }
       case 2: {
-        txn_range range;
-        range.first = atoll(txn_ranges.at(0).c_str());
-        range.second = atoll(txn_ranges.at(1).c_str());
-        _txn_range.emplace_back(range);
+        ranges.emplace_back(atoll(txn_ranges.at(0).c_str()), atoll(txn_ranges.at(1).c_str()) + 1);
         break;
       }
       default:
@@ -1019,8 +1015,7 @@ int GtidMessage::deserialize_gtid_set(const std::string& gtid_set)
     }
   }
 
-  merge_txn_range(this, this);
-
+  _txn_range.add(TxnRangeSet(std::move(ranges)));
   return OMS_OK;
 }
 
@@ -1034,29 +1029,7 @@ GtidMessage::~GtidMessage()
 
 int GtidMessage::merge_txn_range(GtidMessage* message, GtidMessage* target)
 {
-  uint64_t start = 0, end = 0;
-  std::vector<txn_range> merge;
-  std::vector<txn_range> full_range;
-  full_range.insert(full_range.end(), message->get_txn_range().begin(), message->get_txn_range().end());
-  full_range.insert(full_range.end(), target->get_txn_range().begin(), target->get_txn_range().end());
-  for (auto const& range : full_range) {
-    if (start == 0) {
-      start = range.first;
-      end = range.second;
-    } else {
-      if (range.first <= end + 1) {
-        end = std::max(end, range.second);
-      } else {
-        merge.emplace_back(start, end);
-        start = range.first;
-        end = range.second;
-      }
-    }
-  }
-  if (start != 0) {
-    merge.emplace_back(start, end);
-  }
-  target->set_txn_range(merge);
+  target->get_txn_range().add(message->get_txn_range());
   return OMS_OK;
 }
 
@@ -1109,6 +1082,145 @@ std::string XidEvent::print_event_info()
   return info.str();
 }
 
+// types of fields of TransactionPayloadEvent
+static const uint64_t PAYLOAD_HEADER_END_MARK = 0;
+static const uint64_t PAYLOAD_SIZE_FIELD = 1;
+static const uint64_t PAYLOAD_COMPRESSION_TYPE_FIELD = 2;
+static const uint64_t PAYLOAD_UNCOMPRESSED_SIZE_FIELD = 3;
+
+static size_t packed_len(uint64_t value)
+{
+  unsigned char buff[MAX_PACKET_INTEGER_LEN];
+  return packet_store_length(buff, value) - buff;
+}
+
+static unsigned char* store_payload_field(unsigned char* buff, uint64_t type, uint64_t value)
+{
+  buff = packet_store_length(buff, type);
+  buff = packet_store_length(buff, packed_len(value));
+  return packet_store_length(buff, value);
+}
+
+size_t TransactionPayloadEvent::fields_len() const
+{
+  // 1 byte each for type and length of 3 fields, and the end mark
+  return 3 * 2 + packed_len(_compression_type) + packed_len(_uncompressed_size) + packed_len(_payload.size()) + 1;
+}
+
+size_t TransactionPayloadEvent::flush_to_buff(unsigned char* buff)
+{
+  this->get_header()->flush_to_buff(buff);
+  unsigned char* ptr = buff + COMMON_HEADER_LENGTH;
+
+  ptr = store_payload_field(ptr, PAYLOAD_COMPRESSION_TYPE_FIELD, _compression_type);
+  ptr = store_payload_field(ptr, PAYLOAD_UNCOMPRESSED_SIZE_FIELD, _uncompressed_size);
+  ptr = store_payload_field(ptr, PAYLOAD_SIZE_FIELD, _payload.size());
+  ptr = packet_store_length(ptr, PAYLOAD_HEADER_END_MARK);
+
+  memcpy(ptr, _payload.data(), _payload.size());
+  size_t pos = ptr - buff + _payload.size();
+  return write_checksum(buff, pos);
+}
+
+void TransactionPayloadEvent::deserialize(unsigned char* buff)
+{
+  auto* header = new OblogEventHeader();
+  header->deserialize(buff);
+  this->set_header(header);
+  uint64_t pos = COMMON_HEADER_LENGTH;
+  uint64_t end_pos = header->get_event_length() - get_checksum_len();
+
+  uint64_t payload_size = 0;
+  bool has_payload_size = false;
+  while (pos < end_pos) {
+    uint64_t type = get_lenenc_uint(buff, pos);
+    if (type == PAYLOAD_HEADER_END_MARK) {
+      break;
+    }
+    uint64_t len = get_lenenc_uint(buff, pos);
+    uint64_t next_pos = pos + len;
+    switch (type) {
+      case PAYLOAD_COMPRESSION_TYPE_FIELD:
+        _compression_type = get_lenenc_uint(buff, pos);
+        break;
+      case PAYLOAD_UNCOMPRESSED_SIZE_FIELD:
+        _uncompressed_size = get_lenenc_uint(buff, pos);
+        break;
+      case PAYLOAD_SIZE_FIELD:
+        payload_size = get_lenenc_uint(buff, pos);
+        has_payload_size = true;
+        break;
+      default:
+        // fields of later versions
+        break;
+    }
+    pos = next_pos;
+  }
+  if (!has_payload_size || pos + payload_size > end_pos) {
+    payload_size = end_pos > pos ? end_pos - pos : 0;
+  }
+  _payload.assign(reinterpret_cast<char*>(buff + pos), payload_size);
+}
+
+std::string TransactionPayloadEvent::print_event_info()
+{
+  std::stringstream info;
+  info << "compression='" << (_compression_type == ZSTD ? "ZSTD" : "NONE")
+       << "', decompressed_size=" << _uncompressed_size << " bytes";
+  return info.str();
+}
+
+uint32_t TransactionPayloadEvent::compress(const unsigned char* events, size_t len, int level)
+{
+  _payload.resize(ZSTD_compressBound(len));
+  size_t ret = ZSTD_compress(&_payload[0], _payload.size(), events, len, level);
+  if (ZSTD_isError(ret)) {
+    OMS_ERROR("Failed to compress transaction payload of {} bytes: {}", len, ZSTD_getErrorName(ret));
+    _payload.clear();
+    return 0;
+  }
+  _payload.resize(ret);
+  _compression_type = ZSTD;
+  _uncompressed_size = len;
+  return COMMON_HEADER_LENGTH + fields_len() + _payload.size() + get_checksum_len();
+}
+
+int TransactionPayloadEvent::decompress(std::string& events) const
+{
+  if (_compression_type == NONE) {
+    events = _payload;
+    return OMS_OK;
+  }
+  if (_compression_type != ZSTD) {
+    OMS_ERROR("Unsupported compression type of transaction payload: {}", _compression_type);
+    return OMS_FAILED;
+  }
+  events.resize(_uncompressed_size);
+  size_t ret = ZSTD_decompress(&events[0], events.size(), _payload.data(), _payload.size());
+  if (ZSTD_isError(ret) || ret != _uncompressed_size) {
+    OMS_ERROR("Failed to decompress transaction payload of {} bytes: {}",
+        _uncompressed_size,
+        ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatched");
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+uint8_t TransactionPayloadEvent::get_compression_type() const
+{
+  return _compression_type;
+}
+
+uint64_t TransactionPayloadEvent::get_uncompressed_size() const
+{
+  return _uncompressed_size;
+}
+
+const std::string& TransactionPayloadEvent::get_payload() const
+{
+  return _payload;
+}
+
 uint64_t RowsEvent::get_table_id() const
 {
   return _table_id;
@@ -1449,6 +1561,10 @@ size_t GtidLogEvent::flush_to_buff(unsigned char* buff)
   int8store(buff + pos, this->get_sequence_number());
   pos += 8;
 
+  // the highest bit unset for no original_commit_timestamp following, which is the same as immediate one
+  int7store(buff + pos, this->get_commit_timestamp_us() & ~(1ULL << 55));
+  pos += COMMIT_TIMESTAMP_LEN;
+
   return write_checksum(buff, pos);
 }
 unsigned char GtidLogEvent::get_commit_flag() const
@@ -1496,6 +1612,14 @@ void GtidLogEvent::deserialize(unsigned char* buff)
 
   this->set_sequence_number(int8load(buff + pos));
   pos += 8;
+
+  if (header->get_event_length() >= COMMON_HEADER_LENGTH + GTID_HEADER_LEN + COMMIT_TIMESTAMP_LEN) {
+    this->set_commit_timestamp_us(int7load(buff + pos) & ~(1ULL << 55));
+    pos += COMMIT_TIMESTAMP_LEN;
+  } else {
+    // events written before logical clocks were tracked kept the commit timestamp in place of them
+    this->set_commit_timestamp_us(this->get_last_committed() * 1000000 + this->get_sequence_number());
+  }
 }
 void GtidLogEvent::set_commit_flag(const unsigned char commit_flag)
 {
@@ -1517,6 +1641,14 @@ void GtidLogEvent::set_sequence_number(uint64_t sequence_number)
 {
   _sequence_number = sequence_number;
 }
+uint64_t GtidLogEvent::get_commit_timestamp_us() const
+{
+  return _commit_timestamp_us;
+}
+void GtidLogEvent::set_commit_timestamp_us(uint64_t commit_timestamp_us)
+{
+  _commit_timestamp_us = commit_timestamp_us;
+}
 int GtidLogEvent::get_ts_type() const
 {
   return _ts_type;
@@ -1807,6 +1939,11 @@ int64_t seek_gtid_event(const std::string& binlog, int64_t& record_num, std::vec
         last_txn_record_num = record_num;
         record_num = 0;
         break;
+      case TRANSACTION_PAYLOAD_EVENT:
+        // the whole transaction after its GTID event
+        last_txn_record_num = record_num + 1;
+        record_num = 0;
+        break;
       case QUERY_EVENT:
       case TABLE_MAP_EVENT:
       case WRITE_ROWS_EVENT:
@@ -1926,6 +2063,14 @@ int get_the_last_complete_txn(const std::string& binlog, uint64_t& complete_tran
       }
     }
 
+    if (header.get_type_code() == TRANSACTION_PAYLOAD_EVENT) {
+      // BEGIN and XID are both compressed in the payload
+      last_complete_txn_id = current_gtid;
+      if (start_complete_txn_id == 0) {
+        start_complete_txn_id = last_complete_txn_id;
+      }
+    }
+
     if (header.get_type_code() == QUERY_EVENT) {
       auto query_event = QueryEvent();
       query_event.deserialize(event);
@@ -1991,15 +2136,14 @@ int verify_event_crc32(unsigned char* event, uint64_t len, uint8_t checksum_flag
   }
   uint32_t check_sum_pos = len - 4;
   uint32_t check_sum_read = int4load(event + check_sum_pos);
-  uint64_t crc = crc32(0L, Z_NULL, 0);
-  uint32_t check_sum_compute = crc32(crc, event, check_sum_pos);
+  uint32_t check_sum_compute = Crc32::compute(event, check_sum_pos);
   if (check_sum_read != check_sum_compute) {
     OMS_ERROR("The checksum [{}] carried by the last binlog event is different from the calculated checksum: {}",
         check_sum_read,
         check_sum_compute);
     return OMS_FAILED;
   }
-  OMS_INFO("The checksum carried by the last binlog event is equal to the calculated checksum: {} = {}",
+  OMS_DEBUG("The checksum carried by the last binlog event is equal to the calculated checksum: {} = {}",
       check_sum_read,
       check_sum_compute);
   return OMS_OK;
@@ -2100,6 +2244,12 @@ int seek_events(const std::string& binlog, std::vector<ObLogEvent*>& log_events,
           log_events.emplace_back(previous_gtids_log_event);
           break;
         }
+        case TRANSACTION_PAYLOAD_EVENT: {
+          auto* transaction_payload_event = new TransactionPayloadEvent();
+          transaction_payload_event->deserialize(event);
+          log_events.emplace_back(transaction_payload_event);
+          break;
+        }
         default:
           OMS_STREAM_ERROR << "Unknown event type:" << header.get_type_code();
           break;
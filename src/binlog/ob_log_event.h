@@ -20,6 +20,7 @@
 #include "fs_util.h"
 #include "log.h"
 #include "msg_buf.h"
+#include "txn_range_set.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -53,7 +54,7 @@ namespace logproxy {
 #define BEGIN_VAR "BEGIN"
 #define BEGIN_VAR_LEN 5
 #define LOG_EVENT_BINLOG_IN_USE_F 0x1
-#define BINLOG_START_POS 190
+#define BINLOG_START_POS 192
 
 constexpr uint8_t binlog_magic[4] = {254, 98, 105, 110};
 
@@ -89,7 +90,8 @@ enum enum_post_header_length {
   TRANSACTION_CONTEXT_HEADER_LEN = 18,
   VIEW_CHANGE_HEADER_LEN = 52,
   XA_PREPARE_HEADER_LEN = 0,
-  GTID_HEADER_LEN = 42
+  GTID_HEADER_LEN = 42,
+  TRANSACTION_PAYLOAD_HEADER_LEN = 0
 };  // end enum_post_header_length
 
 enum enum_checksum_flag { OFF = 0, CRC32 = 1, UNDEF = 255 };
@@ -271,6 +273,12 @@ public:
 
   virtual void deserialize(unsigned char* buff) = 0;
 
+  /*!
+   * @brief Serialize the event without the checksum trailer, as events inside a transaction payload
+   * @return length of the event written
+   */
+  size_t flush_without_checksum(unsigned char* buff);
+
   // Format binlog event, print out binlog event offset information
   std::string str_format();
 
@@ -327,21 +335,20 @@ private:
   std::vector<uint8_t> _event_type_header_len;
 };
 
-typedef std::pair<std::uint64_t, std::uint64_t> txn_range;
 class GtidMessage {
 private:
   unsigned char* _gtid_uuid = nullptr;
   uint64_t _gtid_txn_id_intervals = 0;
   /*  uint32_t _txn_start;
     uint32_t _txn_end;*/
-  std::vector<txn_range> _txn_range;
+  TxnRangeSet _txn_range;
 
 public:
   virtual ~GtidMessage();
 
-  std::vector<txn_range>& get_txn_range();
+  TxnRangeSet& get_txn_range();
 
-  void set_txn_range(std::vector<txn_range> txn_range);
+  void set_txn_range(TxnRangeSet txn_range);
 
   GtidMessage() = default;
 
@@ -380,7 +387,7 @@ public:
       _gtid_uuid = static_cast<unsigned char*>(malloc(SERVER_UUID_LEN));
       memcpy(_gtid_uuid, gtid_message._gtid_uuid, SERVER_UUID_LEN);
       _gtid_txn_id_intervals = gtid_message._gtid_txn_id_intervals;
-      _txn_range.assign(gtid_message._txn_range.begin(), gtid_message._txn_range.end());
+      _txn_range = gtid_message._txn_range;
     }
   }
 
@@ -393,7 +400,7 @@ public:
       _gtid_uuid = static_cast<unsigned char*>(malloc(SERVER_UUID_LEN));
       memcpy(_gtid_uuid, gtid_message._gtid_uuid, SERVER_UUID_LEN);
       _gtid_txn_id_intervals = gtid_message._gtid_txn_id_intervals;
-      _txn_range.assign(gtid_message._txn_range.begin(), gtid_message._txn_range.end());
+      _txn_range = gtid_message._txn_range;
     }
     return *this;
   }
@@ -471,6 +478,8 @@ public:
   void set_last_committed(uint64_t last_committed);
   uint64_t get_sequence_number() const;
   void set_sequence_number(uint64_t sequence_number);
+  uint64_t get_commit_timestamp_us() const;
+  void set_commit_timestamp_us(uint64_t commit_timestamp_us);
   int get_ts_type() const;
   void set_ts_type(int ts_type);
   size_t flush_to_buff(unsigned char* data) override;
@@ -483,6 +492,8 @@ public:
 
   static const int LOGICAL_TIMESTAMP_TYPECODE_LEN = 1;
   static const int LOGICAL_TIMESTAMP_TYPECODE = 2;
+  // immediate_commit_timestamp of MySQL 8.0, following sequence_number
+  static const int COMMIT_TIMESTAMP_LEN = 7;
 
 private:
   unsigned char _commit_flag = 1;
@@ -490,6 +501,7 @@ private:
   uint64_t _gtid_txn_id;
   uint64_t _last_committed;
   uint64_t _sequence_number;
+  uint64_t _commit_timestamp_us = 0;
   int _ts_type = LOGICAL_TIMESTAMP_TYPECODE;
 };
 
@@ -643,6 +655,48 @@ private:
   size_t _column_count;
 };
 
+/*
++=========================================================+
+| variable| fields                                        | type, length and value of each field in packed
+| part    |                                               | integers, ended by type 0
+|         +-----------------------------------------------+
+|         | payload                                       | events of the transaction except GTID
++=========================================================+
+ */
+
+class TransactionPayloadEvent : public ObLogEvent {
+public:
+  enum CompressionType { ZSTD = 0, NONE = 255 };
+
+  TransactionPayloadEvent() = default;
+  ~TransactionPayloadEvent() override = default;
+  size_t flush_to_buff(unsigned char* data) override;
+  void deserialize(unsigned char* buff) override;
+  std::string print_event_info() override;
+
+  /*!
+   * @brief Compress events serialized one after another as the payload
+   * @return length of the event, 0 if failed
+   */
+  uint32_t compress(const unsigned char* events, size_t len, int level);
+
+  /*!
+   * @brief Decompress the payload into events serialized one after another
+   */
+  int decompress(std::string& events) const;
+
+  uint8_t get_compression_type() const;
+  uint64_t get_uncompressed_size() const;
+  const std::string& get_payload() const;
+
+private:
+  size_t fields_len() const;
+
+  uint8_t _compression_type = ZSTD;
+  uint64_t _uncompressed_size = 0;
+  std::string _payload;
+};
+
 /*
 
  +======================================+
@@ -20,6 +20,8 @@
 #include "env.h"            // g_bc_executor
 #include "binlog_dumper.h"  // BINLOG_FATAL_ERROR
 #include "common_util.h"
+#include "metric/latency_tracer.h"
+#include "admission.h"
 #include "SQLParserResult.h"
 #include "sql/show_binlog_events.h"
 #include "sql/purge_binlog.h"
@@ -56,6 +58,103 @@ SqlCmdProcessor* sql_cmd_processor(hsql::StatementType type)
   return nullptr;
 }
 
+std::shared_ptr<const ImmutableResultSet> ImmutableResultCache::get(const std::string& normalized_query)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto iter = _result_sets.find(normalized_query);
+  if (iter == _result_sets.end()) {
+    return nullptr;
+  }
+  if (iter->second->global_var_version != g_sys_var->global_var_version.load()) {
+    _result_sets.erase(iter);
+    return nullptr;
+  }
+  return iter->second;
+}
+
+void ImmutableResultCache::put(
+    const std::string& normalized_query, std::shared_ptr<const ImmutableResultSet> result_set)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  // distinct immutable queries are few, the others beyond are just not cached
+  if (_result_sets.size() < logproxy::Config::instance().binlog_sql_parse_cache_size.val()) {
+    _result_sets[normalized_query] = std::move(result_set);
+  }
+}
+
+void ImmutableResultCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _result_sets.clear();
+}
+
+static std::string to_lower(std::string str)
+{
+  std::transform(
+      str.begin(), str.end(), str.begin(), [](unsigned char c) -> unsigned char { return std::tolower(c); });
+  return str;
+}
+
+std::shared_ptr<const ImmutableResultSet> ImmutableResultCache::build(const hsql::SQLStatement* statement)
+{
+  uint16_t utf8_cs = 33;
+  auto result_set = std::make_shared<ImmutableResultSet>();
+  result_set->global_var_version = g_sys_var->global_var_version.load();
+  std::string value;
+  if (statement->type() == hsql::COM_SELECT) {
+    // same as SelectProcessor::handle_query_var
+    auto* p_statement = (const hsql::SelectStatement*)statement;
+    if (p_statement->selectList == nullptr || p_statement->selectList->size() != 1 ||
+        p_statement->selectList->at(0)->type != hsql::kExprVar ||
+        p_statement->selectList->at(0)->var_level != hsql::Global) {
+      return nullptr;
+    }
+    std::string var_name = p_statement->selectList->at(0)->getName();
+    if (g_sys_var->get_global_var(to_lower(var_name), value) != OMS_OK) {
+      return nullptr;
+    }
+    result_set->columns.emplace_back(
+        "@@" + var_name, "", utf8_cs, 56, ColumnType::ct_var_string, ColumnDefinitionFlags::pri_key_flag, 31);
+    result_set->row = {value};
+    return result_set;
+  }
+
+  if (statement->type() == hsql::COM_SHOW) {
+    // same as ShowVarProcessor::show_specified_var
+    auto* p_statement = (const hsql::ShowStatement*)statement;
+    if (p_statement->type != hsql::kShowVar || p_statement->_var_name == nullptr ||
+        p_statement->var_type != hsql::Global) {
+      return nullptr;
+    }
+    std::string var_name = to_lower(p_statement->_var_name);
+    if (g_sys_var->get_global_var(var_name, value) != OMS_OK) {
+      return nullptr;
+    }
+    result_set->columns.emplace_back(
+        "Variable_name", "", utf8_cs, 56, ColumnType::ct_var_string, ColumnDefinitionFlags::pri_key_flag, 31);
+    result_set->columns.emplace_back(
+        "Value", "", utf8_cs, 36, ColumnType::ct_var_string, ColumnDefinitionFlags::pri_key_flag, 31);
+    result_set->row = {var_name, value};
+    return result_set;
+  }
+  return nullptr;
+}
+
+IoResult ImmutableResultCache::send(Connection* conn, const ImmutableResultSet& result_set)
+{
+  if (conn->send_result_metadata(result_set.columns) != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+  conn->start_row();
+  for (const std::string& value : result_set.row) {
+    conn->store_string(value);
+  }
+  if (conn->send_row() != IoResult::SUCCESS) {
+    return IoResult::FAIL;
+  }
+  return conn->send_eof_packet();
+}
+
 IoResult ShowBinaryLogsProcessor::process(Connection* conn, const hsql::SQLStatement* statement)
 {
   uint16_t utf8_cs = 33;
@@ -288,6 +387,13 @@ IoResult ShowBinlogEventsProcessor::process(Connection* conn, const hsql::SQLSta
           info = xid_event.print_event_info();
           break;
         }
+        case logproxy::TRANSACTION_PAYLOAD_EVENT: {
+          auto transaction_payload_event = logproxy::TransactionPayloadEvent();
+          transaction_payload_event.set_checksum_flag(checksum_flag);
+          transaction_payload_event.deserialize(event.get());
+          info = transaction_payload_event.print_event_info();
+          break;
+        }
         case logproxy::TABLE_MAP_EVENT: {
           auto table_map_event = logproxy::TableMapEvent();
           table_map_event.set_checksum_flag(checksum_flag);
@@ -377,14 +483,12 @@ static std::string get_executed_gtid_set(const logproxy::BinlogIndexRecord& inde
       if (count != 0) {
         executed_gtid_set_stream << ",";
       }
-      if (!gtid.second->get_txn_range().empty()) {
-        if (pair.first > gtid.second->get_txn_range().back().second) {
-          gtid.second->get_txn_range().emplace_back(pair);
-        } else {
-          gtid.second->get_txn_range().back().second = pair.second;
-        }
+      // transactions of the file up to the current one, ranges of previous gtids are half-open
+      logproxy::TxnRangeSet& txn_range = gtid.second->get_txn_range();
+      if (!txn_range.empty() && pair.first <= txn_range.back().second) {
+        txn_range.add(txn_range.back().first, pair.second + 1);
       } else {
-        gtid.second->get_txn_range().emplace_back(pair);
+        txn_range.add(pair.first, pair.second + 1);
       }
       executed_gtid_set_stream << gtid.second->format_string();
       count++;
@@ -506,7 +610,7 @@ IoResult PurgeBinaryLogsProcessor::process(Connection* conn, const hsql::SQLStat
   if (ret != OMS_OK) {
     return conn->send_err_packet(BINLOG_FATAL_ERROR, error_msg, "HY000");
   }
-  g_bc_executor->submit(purge_binlog_file, purge_binlog_files);
+  g_bc_executor->execute(purge_binlog_file, purge_binlog_files);
   return conn->send_ok_packet();
 }
 
@@ -626,7 +730,11 @@ IoResult CreateBinlogProcessor::process(Connection* conn, const hsql::SQLStateme
   binlog::g_state_machine->fetch_state_vector(get_default_state_file_path(), state_machines);
 
   bool is_existed = false;
+  size_t running_converters = 0;
   for (const StateMachine* state_machine : state_machines) {
+    if (state_machine->get_pid() > 0 && 0 == kill(state_machine->get_pid(), 0)) {
+      running_converters++;
+    }
     if (strcmp(config.cluster.val().c_str(), state_machine->get_cluster().c_str()) == 0 &&
         strcmp(config.tenant.val().c_str(), state_machine->get_tenant().c_str()) == 0) {
 
@@ -650,6 +758,14 @@ IoResult CreateBinlogProcessor::process(Connection* conn, const hsql::SQLStateme
     }
   }
   logproxy::release_vector(state_machines);
+
+  std::string reason;
+  if (logproxy::Admission::admit(running_converters, reason) != OMS_OK) {
+    OMS_STREAM_WARN << "Refuse to start binlog converter of " << config.cluster.val() << "." << config.tenant.val()
+                    << ": " << reason;
+    return conn->send_err_packet(BINLOG_FATAL_ERROR, reason, "HY000");
+  }
+
   StateMachine state_machine;
   state_machine.set_cluster(config.cluster.val());
   state_machine.set_tenant(config.tenant.val());
@@ -660,7 +776,7 @@ IoResult CreateBinlogProcessor::process(Connection* conn, const hsql::SQLStateme
     binlog::g_state_machine->add_state(get_default_state_file_path(), state_machine);
   }
   OMS_STREAM_INFO << "Start Binlog Converter with config:" << config.debug_str();
-  g_bc_executor->submit(logproxy::start_binlog_converter, config.serialize_configs());
+  g_bc_executor->execute(logproxy::start_binlog_converter, config.serialize_configs());
 
   return conn->send_ok_packet();
 }
@@ -725,7 +841,7 @@ IoResult DropBinlogProcessor::process(Connection* conn, const hsql::SQLStatement
                       << " BC server status:" << state_machine->get_converter_state();
 
       // Release the BC process, clean up the Binlog file and release related resources
-      g_bc_executor->submit(logproxy::stop_binlog_converter, state_machine->to_string());
+      g_bc_executor->execute(logproxy::stop_binlog_converter, state_machine->to_string());
       logproxy::release_vector(state_machines);
 
       return conn->send_ok_packet();
@@ -841,6 +957,15 @@ void ShowBinlogStatusProcessor::serialize_binlog_metrics(string& status, const S
   }
   logproxy::release_vector(index_records);
   binlog_json["binlog_files"] = binlog_metrics;
+
+  // latency breakdown of sampled transactions, exported by the binlog converter
+  Json::Value latency;
+  string metric_file = state_machine->get_work_path() + "/" + logproxy::Config::instance().metric_export_file.val();
+  string metric_text;
+  if (logproxy::FsUtil::exist(metric_file) && logproxy::FsUtil::read_file(metric_file, metric_text, false)) {
+    logproxy::LatencyTracer::serialize_breakdown(metric_text, latency);
+  }
+  binlog_json["latency"] = latency;
   Json::StreamWriterBuilder builder;
   status = Json::writeString(builder, binlog_json);
 }
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <mutex>
 #include <regex>
+#include <unordered_map>
 
 #include "sql_cmd.h"
 #include "common.h"
@@ -149,5 +151,46 @@ public:
 
 SqlCmdProcessor* sql_cmd_processor(hsql::StatementType type);
 
+/*!
+ * @brief Result set of a query on global variables only, e.g. SELECT @@version_comment, which stays the same until
+ * global variables changed
+ */
+struct ImmutableResultSet {
+  std::vector<ColumnPacket> columns;
+  std::vector<std::string> row;
+  uint64_t global_var_version = 0;
+};
+
+/*!
+ * @brief Result sets of immutable queries by normalized text, served without parsing
+ */
+class ImmutableResultCache {
+  OMS_SINGLETON(ImmutableResultCache);
+  OMS_AVOID_COPY(ImmutableResultCache);
+
+public:
+  /*!
+   * @return nullptr if not cached or outdated
+   */
+  std::shared_ptr<const ImmutableResultSet> get(const std::string& normalized_query);
+
+  void put(const std::string& normalized_query, std::shared_ptr<const ImmutableResultSet> result_set);
+
+  void clear();
+
+  /*!
+   * @brief Build the result set if the statement queries a global variable only, i.e. SELECT @@var or
+   * SHOW GLOBAL VARIABLES LIKE 'var'
+   * @return nullptr if not such a statement or the variable is unknown
+   */
+  static std::shared_ptr<const ImmutableResultSet> build(const hsql::SQLStatement* statement);
+
+  static IoResult send(Connection* conn, const ImmutableResultSet& result_set);
+
+private:
+  std::mutex _mutex;
+  std::unordered_map<std::string, std::shared_ptr<const ImmutableResultSet>> _result_sets;
+};
+
 }  // namespace binlog
 }  // namespace oceanbase
\ No newline at end of file
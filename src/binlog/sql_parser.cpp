@@ -11,6 +11,8 @@
  */
 
 #include "sql_parser.h"
+#include "config.h"
+#include "str.h"
 #include "SQLParserResult.h"
 #include "SQLParser.h"
 #include "util/sqlhelper.h"
@@ -28,5 +30,35 @@ int ObSqlParser::parse(const std::string& sql, hsql::SQLParserResult& result)
     return OMS_FAILED;
   }
 }
+
+std::string SqlParseCache::normalize(const std::string& query)
+{
+  return logproxy::normalize_sql(query);
+}
+
+std::shared_ptr<const hsql::SQLParserResult> SqlParseCache::parse(const std::string& normalized_query)
+{
+  size_t capacity = logproxy::Config::instance().binlog_sql_parse_cache_size.val();
+  std::shared_ptr<const hsql::SQLParserResult> cached;
+  if (capacity > 0 && _results.get(normalized_query, cached)) {
+    return cached;
+  }
+
+  auto result = std::make_shared<hsql::SQLParserResult>();
+  if (ObSqlParser::parse(normalized_query, *result) == OMS_OK) {
+    _results.put(normalized_query, result, capacity);
+  }
+  return result;
+}
+
+size_t SqlParseCache::size()
+{
+  return _results.size();
+}
+
+void SqlParseCache::clear()
+{
+  _results.clear();
+}
 }  // namespace binlog
 }  // namespace oceanbase
\ No newline at end of file
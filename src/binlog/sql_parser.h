@@ -15,7 +15,9 @@
 #include "sql_cmd.h"
 #include "log.h"
 #include "SQLParserResult.h"
+#include "lru_cache.hpp"
 
+#include <memory>
 #include <regex>
 #include <string>
 
@@ -33,5 +35,33 @@ public:
   static int parse(const std::string& sql, hsql::SQLParserResult& result);
 };
 
+/*!
+ * @brief Parse results shared by connections, keyed by normalized text of queries, as replication clients send the
+ * same bootstrap queries on every connect. The least recently used result is evicted beyond
+ * binlog_sql_parse_cache_size, parse results are read only while processing, so they are shared without copy
+ */
+class SqlParseCache {
+  OMS_SINGLETON(SqlParseCache);
+  OMS_AVOID_COPY(SqlParseCache);
+
+public:
+  /*!
+   * @brief Key of the query in the cache, see normalize_sql()
+   */
+  static std::string normalize(const std::string& query);
+
+  /*!
+   * @brief Parse the normalized query if not cached, only valid results are cached
+   */
+  std::shared_ptr<const hsql::SQLParserResult> parse(const std::string& normalized_query);
+
+  size_t size();
+
+  void clear();
+
+private:
+  logproxy::LruCache<std::string, std::shared_ptr<const hsql::SQLParserResult>> _results;
+};
+
 }  // namespace binlog
 }  // namespace oceanbase
@@ -14,6 +14,8 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <atomic>
+#include <mutex>
 #include <shared_mutex>
 
 #include "common.h"
@@ -28,11 +30,14 @@ struct SysVar {
   uint64_t net_retry_count = 10;
 
   std::shared_timed_mutex global_var_mutex;
+  // bumped on each change of global variables, by which results cached of them are outdated
+  std::atomic<uint64_t> global_var_version{0};
 
   void add_global_var(const std::string& key, const std::string& value)
   {
     std::unique_lock<std::shared_timed_mutex> lock(global_var_mutex);
     support_global_var[key] = value;
+    global_var_version++;
   }
 
   int get_global_var(const std::string& key, std::string& value)
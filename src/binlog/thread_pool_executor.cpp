@@ -10,15 +10,23 @@
  * See the Mulan PubL v2 for more details.
  */
 
+#include <algorithm>
 #include "thread_pool_executor.h"
 
 namespace oceanbase {
 namespace binlog {
-ThreadPoolExecutor::ThreadPoolExecutor(unsigned int nof_threads)
-    : work_threads_(nof_threads), nof_running_tasks_(0), shutdown_(false)
+// executor and index of the deque owned by current thread, if it is a work thread
+static thread_local const ThreadPoolExecutor* _t_executor = nullptr;
+static thread_local unsigned int _t_worker_index = 0;
+
+ThreadPoolExecutor::ThreadPoolExecutor(unsigned int nof_threads) : shutdown_(false)
 {
-  for (auto& work_thread : work_threads_) {
-    work_thread = std::thread([=]() { process_task_loop(); });
+  nof_threads = std::max(nof_threads, 1U);
+  for (unsigned int i = 0; i < nof_threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (unsigned int i = 0; i < nof_threads; ++i) {
+    work_threads_.emplace_back([=]() { process_task_loop(i); });
   }
 }
 
@@ -34,30 +42,97 @@ ThreadPoolExecutor::~ThreadPoolExecutor()
   }
 }
 
-void ThreadPoolExecutor::process_task_loop()
+void ThreadPoolExecutor::push(Task&& task)
+{
+  bool local = _t_executor == this;
+  unsigned int index =
+      local ? _t_worker_index : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+  Worker& worker = *workers_[index];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    (local ? worker.tasks : worker.injected).push_back(std::move(task));
+  }
+  nof_pending_tasks_.fetch_add(1);
+
+  // pairs with the check of nof_pending_tasks_ after nof_idle_threads_ is increased in process_task_loop(),
+  // either the idle thread sees the task or we see the idle thread
+  if (nof_idle_threads_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_one();
+  }
+}
+
+static inline bool take_front(std::deque<std::function<void()>>& tasks, std::function<void()>& task)
+{
+  if (tasks.empty()) {
+    return false;
+  }
+  task = std::move(tasks.front());
+  tasks.pop_front();
+  return true;
+}
+
+bool ThreadPoolExecutor::pop(unsigned int index, Task& task, bool blocking)
 {
+  {
+    Worker& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      nof_pending_tasks_.fetch_sub(1);
+      return true;
+    }
+    if (take_front(own.injected, task)) {
+      nof_pending_tasks_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker& victim = *workers_[(index + i) % workers_.size()];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::defer_lock);
+    if (blocking) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      continue;
+    }
+    if (take_front(victim.injected, task) || take_front(victim.tasks, task)) {
+      nof_pending_tasks_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPoolExecutor::process_task_loop(unsigned int index)
+{
+  _t_executor = this;
+  _t_worker_index = index;
+
   while (true) {
     Task task;
 
-    // fetch the next task to run
-    {
+    // fetch the next task to run, waiting for locks of the others only if skipping them missed any task,
+    // sleep only when no task is pending in any deque
+    if (!pop(index, task, false) && !(nof_pending_tasks_.load() > 0 && pop(index, task, true))) {
+      if (nof_pending_tasks_.load() > 0) {
+        // pushed to a deque behind the scan
+        continue;
+      }
+
       std::unique_lock<std::mutex> lock(mutex_);
-      cv_.wait(lock, [=]() { return !pending_tasks_.empty() || (shutdown_ && (nof_running_tasks_ == 0)); });
-      if (pending_tasks_.empty()) {  // i.e. (shutdown_ == true) && (nof_running_tasks_ == 0)
+      nof_idle_threads_.fetch_add(1);
+      cv_.wait(lock, [=]() { return nof_pending_tasks_.load() > 0 || shutdown_; });
+      nof_idle_threads_.fetch_sub(1);
+      if (nof_pending_tasks_.load() == 0) {  // i.e. shutdown_ == true, and all tasks are done
         break;
       }
-      task = std::move(pending_tasks_.front());
-      pending_tasks_.pop();
-      ++nof_running_tasks_;
+      continue;
     }
 
     // run the fetched task
     task();
-
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      --nof_running_tasks_;
-    }
   }
 
   // notify all other threads to exit the loop
@@ -12,19 +12,39 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <queue>
+#include <vector>
 #include <functional>
 
 namespace oceanbase {
 namespace binlog {
+/*!
+ * @brief Each work thread owns a deque of tasks submitted by itself, and a queue of tasks injected from outside, which
+ * are spread over all work threads. A work thread takes the newest task of its own deque, then the oldest injected one,
+ * and steals the oldest ones of the others when both are empty, so submitters rarely contend on the same lock and
+ * injected tasks run in the order they were submitted.
+ */
 class ThreadPoolExecutor {
 public:
   explicit ThreadPoolExecutor(unsigned int nof_threads = std::thread::hardware_concurrency());
 
   ~ThreadPoolExecutor();
 
+  /*!
+   * @brief Run fn(args...) in a work thread without a way to wait for it, cheaper than submit()
+   */
+  template <class Fn, class... Args>
+  void execute(Fn&& fn, Args&&... args)
+  {
+    push(Task{std::bind(std::forward<Fn>(fn), std::forward<Args>(args)...)});
+  }
+
   template <class Fn, class... Args>
   auto submit(Fn&& fn, Args&&... args) -> std::future<std::invoke_result_t<Fn, Args...>>
   {
@@ -32,27 +52,41 @@ public:
     using PackagedTask = std::packaged_task<FnResT()>;
     auto p_packaged_task = std::make_shared<PackagedTask>(std::bind(std::forward<Fn>(fn), std::forward<Args>(args)...));
     std::future<FnResT> fut = p_packaged_task->get_future();
-    Task task{[p_packaged_task]() { (*p_packaged_task)(); }};
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    pending_tasks_.push(task);
-    cv_.notify_one();
-
+    push(Task{[p_packaged_task]() { (*p_packaged_task)(); }});
     return fut;
   }
 
 private:
   using Task = std::function<void()>;
 
+  struct Worker {
+    std::mutex mutex;
+    // submitted by the work thread itself, taken newest first by it
+    std::deque<Task> tasks;
+    // submitted from outside, always taken oldest first
+    std::deque<Task> injected;
+  };
+
 private:
-  void process_task_loop();
+  void push(Task&& task);
+
+  /*!
+   * @param blocking whether to wait for locks of the others instead of skipping them
+   */
+  bool pop(unsigned int index, Task& task, bool blocking);
+
+  void process_task_loop(unsigned int index);
 
 private:
+  std::vector<std::unique_ptr<Worker>> workers_;
   std::vector<std::thread> work_threads_;
+  std::atomic<unsigned int> next_worker_{0};
+  // tasks in all deques
+  std::atomic<int> nof_pending_tasks_{0};
+  // work threads waiting for tasks, submitters only touch mutex_ to wake them up
+  std::atomic<int> nof_idle_threads_{0};
   std::mutex mutex_;
   std::condition_variable cv_;
-  std::queue<Task> pending_tasks_;
-  unsigned int nof_running_tasks_;
   bool shutdown_;  // when ~ThreadPoolExecutor() is called, set it to true to make work threads exit.
 };
 
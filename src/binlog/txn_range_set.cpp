@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "txn_range_set.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+TxnRangeSet::TxnRangeSet(std::vector<txn_range> ranges)
+{
+  std::sort(ranges.begin(), ranges.end());
+  for (const txn_range& range : ranges) {
+    if (range.first >= range.second) {
+      continue;
+    }
+    if (!_ranges.empty() && range.first <= _ranges.back().second) {
+      _ranges.back().second = std::max(_ranges.back().second, range.second);
+    } else {
+      _ranges.push_back(range);
+    }
+  }
+}
+
+void TxnRangeSet::add(uint64_t first, uint64_t second)
+{
+  if (first >= second) {
+    return;
+  }
+  // the first range that may merge with [first, second), ending at or after first
+  auto begin = std::lower_bound(_ranges.begin(), _ranges.end(), first, [](const txn_range& range, uint64_t id) {
+    return range.second < id;
+  });
+  auto end = begin;
+  while (end != _ranges.end() && end->first <= second) {
+    first = std::min(first, end->first);
+    second = std::max(second, end->second);
+    ++end;
+  }
+  if (begin == end) {
+    _ranges.insert(begin, txn_range(first, second));
+    return;
+  }
+  *begin = txn_range(first, second);
+  _ranges.erase(begin + 1, end);
+}
+
+void TxnRangeSet::add(const TxnRangeSet& other)
+{
+  if (other.empty()) {
+    return;
+  }
+  if (_ranges.empty() || other._ranges.front().first > _ranges.back().second) {
+    _ranges.insert(_ranges.end(), other._ranges.begin(), other._ranges.end());
+    return;
+  }
+
+  std::vector<txn_range> merged;
+  merged.reserve(_ranges.size() + other._ranges.size());
+  auto left = _ranges.begin();
+  auto right = other._ranges.begin();
+  while (left != _ranges.end() || right != other._ranges.end()) {
+    const txn_range& next =
+        (right == other._ranges.end() || (left != _ranges.end() && left->first <= right->first)) ? *left++ : *right++;
+    if (!merged.empty() && next.first <= merged.back().second) {
+      merged.back().second = std::max(merged.back().second, next.second);
+    } else {
+      merged.push_back(next);
+    }
+  }
+  _ranges.swap(merged);
+}
+
+void TxnRangeSet::subtract(const TxnRangeSet& other)
+{
+  if (_ranges.empty() || other.empty()) {
+    return;
+  }
+
+  std::vector<txn_range> result;
+  result.reserve(_ranges.size() + other._ranges.size());
+  auto removed = other._ranges.begin();
+  for (txn_range range : _ranges) {
+    // ranges removed ending before this one never overlap the following ones either
+    while (removed != other._ranges.end() && removed->second <= range.first) {
+      ++removed;
+    }
+    auto iter = removed;
+    while (iter != other._ranges.end() && iter->first < range.second) {
+      if (iter->first > range.first) {
+        result.emplace_back(range.first, iter->first);
+      }
+      range.first = std::max(range.first, iter->second);
+      if (range.first >= range.second) {
+        break;
+      }
+      ++iter;
+    }
+    if (range.first < range.second) {
+      result.push_back(range);
+    }
+  }
+  _ranges.swap(result);
+}
+
+bool TxnRangeSet::contains(uint64_t txn_id) const
+{
+  auto iter = std::upper_bound(_ranges.begin(), _ranges.end(), txn_id, [](uint64_t id, const txn_range& range) {
+    return id < range.second;
+  });
+  return iter != _ranges.end() && iter->first <= txn_id;
+}
+
+bool TxnRangeSet::is_subset_of(const TxnRangeSet& other) const
+{
+  auto iter = other._ranges.begin();
+  for (const txn_range& range : _ranges) {
+    // each range must be within a single one of other, as ranges of other are never adjacent
+    while (iter != other._ranges.end() && iter->second < range.second) {
+      ++iter;
+    }
+    if (iter == other._ranges.end() || iter->first > range.first) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t TxnRangeSet::count() const
+{
+  uint64_t count = 0;
+  for (const txn_range& range : _ranges) {
+    count += range.second - range.first;
+  }
+  return count;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
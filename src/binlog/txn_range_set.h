@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace oceanbase {
+namespace logproxy {
+
+// transaction ids [first, second) of a server uuid, as intervals of GTID sets in binlog events
+typedef std::pair<std::uint64_t, std::uint64_t> txn_range;
+
+/*!
+ * @brief Set of transaction ids as sorted, disjoint and non-adjacent half-open intervals, so that union,
+ * subtraction and subset of two sets all take one merge pass over their intervals
+ */
+class TxnRangeSet {
+public:
+  TxnRangeSet() = default;
+
+  /*!
+   * @param ranges in any order, overlapped or adjacent ones are merged
+   */
+  explicit TxnRangeSet(std::vector<txn_range> ranges);
+
+  /*!
+   * @brief Add [first, second), which costs O(log n) at the end of the set, as transaction ids grow
+   */
+  void add(uint64_t first, uint64_t second);
+
+  void add(const TxnRangeSet& other);
+
+  /*!
+   * @brief Remove all ids of other
+   */
+  void subtract(const TxnRangeSet& other);
+
+  bool contains(uint64_t txn_id) const;
+
+  bool is_subset_of(const TxnRangeSet& other) const;
+
+  /*!
+   * @return count of transaction ids
+   */
+  uint64_t count() const;
+
+  inline bool empty() const
+  {
+    return _ranges.empty();
+  }
+
+  inline size_t size() const
+  {
+    return _ranges.size();
+  }
+
+  inline const txn_range& back() const
+  {
+    return _ranges.back();
+  }
+
+  inline void clear()
+  {
+    _ranges.clear();
+  }
+
+  inline const std::vector<txn_range>& ranges() const
+  {
+    return _ranges;
+  }
+
+  inline std::vector<txn_range>::const_iterator begin() const
+  {
+    return _ranges.begin();
+  }
+
+  inline std::vector<txn_range>::const_iterator end() const
+  {
+    return _ranges.end();
+  }
+
+  inline bool operator==(const TxnRangeSet& other) const
+  {
+    return _ranges == other._ranges;
+  }
+
+private:
+  std::vector<txn_range> _ranges;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
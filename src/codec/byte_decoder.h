@@ -101,6 +101,12 @@ static inline void int6store(unsigned char* T, uint64_t A)
   *(T + 4) = (unsigned char)(A >> 32);
   *(T + 5) = (unsigned char)(A >> 40);
 }
+static inline void int7store(unsigned char* T, uint64_t A);
+static inline void int7store(unsigned char* T, uint64_t A)
+{
+  int6store(T, A);
+  *(T + 6) = (unsigned char)(A >> 48);
+}
 static inline void int_variable_store(unsigned char* T, size_t A, int variable);
 static inline void int_variable_store(unsigned char* T, size_t A, int variable)
 {
@@ -195,6 +201,12 @@ static inline uint64_t int6load(unsigned char* T)
           (((uint64_t)(T[4])) << 32) + (((uint64_t)(T[5])) << 40));
 }
 
+static inline uint64_t int7load(unsigned char* T);
+static inline uint64_t int7load(unsigned char* T)
+{
+  return int6load(T) + (((uint64_t)(T[6])) << 48);
+}
+
 static inline void hf_int1store(unsigned char* T, uint8_t A);
 static inline void hf_int1store(unsigned char* T, uint8_t A)
 {
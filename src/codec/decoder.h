@@ -55,6 +55,8 @@ private:
   static int decode_runtime_status(MsgBufReader& buffer_reader, Message*& msg);
 
   static int decode_data_client(MsgBufReader& buffer_reader, Message*& msg);
+
+  static int decode_credit_client(MsgBufReader& buffer_reader, Message*& msg);
 };
 
 }  // namespace logproxy
@@ -69,6 +69,8 @@ private:
   static int encode_runtime_status(const Message& msg, MsgBuf& buffer, size_t& raw_len);
 
   static int encode_data_client(const Message& msg, MsgBuf& buffer, size_t& raw_len);
+
+  static int encode_credit_client(const Message& msg, MsgBuf& buffer);
 };
 
 }  // namespace logproxy
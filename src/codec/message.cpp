@@ -28,7 +28,7 @@ bool is_version_available(uint16_t version_val)
 
 bool is_type_available(int8_t type_val)
 {
-  return type_val >= -1 && type_val <= 8;
+  return type_val >= -1 && type_val <= 9;
 }
 
 Message::Message(MessageType type) : _type(type)
@@ -47,6 +47,8 @@ const std::string& Message::debug_string() const
       static std::string msg = "DATA_CLIENT";
       return msg;
     }
+    case MessageType::CREDIT_CLIENT:
+      return ((CreditMessage*)this)->to_string();
     case MessageType::STATUS: {
       // TODO
       static std::string msg = "RUNTIME STATUS";
@@ -93,6 +95,13 @@ RuntimeStatusMessage::RuntimeStatusMessage(const char* ip, int port, int stream_
     : Message(MessageType::STATUS), ip(ip), port(port), stream_count(stream_count), worker_count(worker_count)
 {}
 
+CreditMessage::CreditMessage() : Message(MessageType::CREDIT_CLIENT)
+{}
+
+CreditMessage::CreditMessage(int64_t bytes, int64_t records)
+    : Message(MessageType::CREDIT_CLIENT), bytes(bytes), records(records)
+{}
+
 RecordDataMessage::RecordDataMessage(std::vector<ILogRecord*>& in_records)
     : Message(MessageType::DATA_CLIENT), records(in_records), _offset(0), _count(in_records.size())
 {}
@@ -42,6 +42,7 @@ enum class MessageType : int8_t {
   DATA_CLIENT = 6,
   STATUS = 7,
   //  STATUS_LOGREADER = 8,
+  CREDIT_CLIENT = 9,
 
   SET_GLOBAL_CONFIG = 100,
   SET_READER_CONFIG = 101,
@@ -186,6 +187,9 @@ public:
   OMS_MF(std::string, version);
   OMS_MF(std::string, configuration);
   OMS_MF_DFT(bool, enable_monitor, false);
+  // initial credit of flow control, which is enabled if any of them is not 0, V2 only
+  OMS_MF_DFT(int64_t, credit_bytes, 0);
+  OMS_MF_DFT(int64_t, credit_records, 0);
 };
 
 class ClientHandshakeResponseMessage : public Message, public Model {
@@ -215,6 +219,21 @@ private:
   OMS_MF_DFT(int, worker_count, -1);
 };
 
+/*!
+ * @brief More credit granted by client with flow control enabled by handshake, as it consumed records
+ */
+class CreditMessage : public Message, public Model {
+public:
+  CreditMessage();
+
+  CreditMessage(int64_t bytes, int64_t records);
+
+  ~CreditMessage() override = default;
+
+  OMS_MF_DFT(int64_t, bytes, 0);
+  OMS_MF_DFT(int64_t, records, 0);
+};
+
 class MsgBuf;
 
 class RecordDataMessage : public Message {
@@ -256,6 +275,9 @@ public:
 
   // index to count message seq for a client session
   uint32_t idx = 0;
+
+  // uncompressed bytes of records decoded, by which client grants credit back
+  size_t raw_len = 0;
 };
 
 }  // namespace logproxy
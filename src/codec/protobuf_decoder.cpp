@@ -104,6 +104,9 @@ int ProtobufDecoder::decode_payload(MessageType type, const MsgBuf& buffer, Mess
     case MessageType::DATA_CLIENT: {
       return decode_data_client(reader, msg);
     }
+    case MessageType::CREDIT_CLIENT: {
+      return decode_credit_client(reader, msg);
+    }
     default: {
       OMS_STREAM_ERROR << "Unknown message type: " << (int)type;
     } break;
@@ -164,6 +167,8 @@ int ProtobufDecoder::decode_handshake_request(MsgBufReader& buffer_reader, Messa
     OMS_STREAM_ERROR << "Failed to create client_hand_shake_request_message.";
     return OMS_FAILED;
   }
+  msg->credit_bytes = pb_msg.credit_bytes();
+  msg->credit_records = pb_msg.credit_records();
 
   out_msg = msg;
   return OMS_OK;
@@ -241,6 +246,7 @@ int ProtobufDecoder::decode_data_client(MsgBufReader& buffer_reader, Message*& _
     delete msg;
     return ret;
   }
+  msg->raw_len = pb_msg.raw_len();
 
   ILogRecord* record = msg->records[msg->offset()];
   if (_s_config.verbose_packet.val()) {
@@ -261,5 +267,25 @@ int ProtobufDecoder::decode_data_client(MsgBufReader& buffer_reader, Message*& _
   return OMS_OK;
 }
 
+int ProtobufDecoder::decode_credit_client(MsgBufReader& buffer_reader, Message*& msg)
+{
+  ZeroCopyStreamAdapter zero_copy_stream(buffer_reader);
+  Credit pb_msg;
+  bool result = pb_msg.ParseFromZeroCopyStream(&zero_copy_stream);
+  if (!result) {
+    OMS_STREAM_ERROR << "Failed to parse protobuf message from buffer";
+    return OMS_FAILED;
+  }
+
+  CreditMessage* credit_msg = new (std::nothrow) CreditMessage(pb_msg.bytes(), pb_msg.records());
+  if (nullptr == credit_msg) {
+    OMS_STREAM_ERROR << "Failed to create CreditMessage.";
+    return OMS_FAILED;
+  }
+
+  msg = credit_msg;
+  return OMS_OK;
+}
+
 }  // namespace logproxy
 }  // namespace oceanbase
\ No newline at end of file
@@ -42,6 +42,9 @@ int ProtobufEncoder::encode(const Message& msg, MsgBuf& buffer, size_t& raw_len)
     case MessageType::DATA_CLIENT: {
       return encode_data_client(msg, buffer, raw_len);
     }
+    case MessageType::CREDIT_CLIENT: {
+      return encode_credit_client(msg, buffer);
+    }
     default: {
       OMS_STREAM_ERROR << "Unknown message type: " << (int)msg.type();
       return OMS_FAILED;
@@ -128,6 +131,8 @@ int ProtobufEncoder::encode_client_handshake_request(const Message& msg, MsgBuf&
   pb_msg.set_version(request_message.version);
   pb_msg.set_enable_monitor(request_message.enable_monitor);
   pb_msg.set_configuration(request_message.configuration);
+  pb_msg.set_credit_bytes(request_message.credit_bytes);
+  pb_msg.set_credit_records(request_message.credit_records);
   return encode_message(pb_msg, request_message.type(), buffer, true);
 }
 
@@ -184,5 +189,15 @@ int ProtobufEncoder::encode_data_client(const Message& msg, MsgBuf& buffer, size
   return encode_message(pb_msg, record_data_message.type(), buffer, false);
 }
 
+int ProtobufEncoder::encode_credit_client(const Message& msg, MsgBuf& buffer)
+{
+  const CreditMessage& credit_message = (const CreditMessage&)msg;
+  Credit pb_msg;
+  pb_msg.set_bytes(credit_message.bytes);
+  pb_msg.set_records(credit_message.records);
+  // sent by client as handshake request, which server expects magic ahead of
+  return encode_message(pb_msg, credit_message.type(), buffer, true);
+}
+
 }  // namespace logproxy
 }  // namespace oceanbase
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "adaptive_batcher.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+AdaptiveBatcher::AdaptiveBatcher(uint64_t latency_target_us, size_t max_bytes)
+    : _latency_target_us(latency_target_us),
+      _min_bytes(std::min(MIN_TARGET_BYTES, max_bytes)),
+      _max_bytes(max_bytes),
+      // start small, the first packets measure the link
+      _target_bytes(latency_target_us == 0 ? max_bytes : _min_bytes)
+{}
+
+uint64_t AdaptiveBatcher::wait_us(uint64_t pending_since_us, uint64_t now_us) const
+{
+  uint64_t due_us = pending_since_us + _latency_target_us;
+  return now_us >= due_us ? 0 : due_us - now_us;
+}
+
+void AdaptiveBatcher::on_sent(size_t bytes, size_t written)
+{
+  if (_latency_target_us == 0 || bytes == 0 || written == 0) {
+    return;
+  }
+  _written += written;
+  _bytes_per_written = ALPHA * bytes / written + (1 - ALPHA) * _bytes_per_written;
+  update_target();
+}
+
+void AdaptiveBatcher::on_queue_sampled(uint64_t now_us, size_t queued)
+{
+  if (_latency_target_us == 0) {
+    return;
+  }
+  size_t written = _written;
+  _written = 0;
+  if (_sampled_us == 0 || now_us < _sampled_us) {
+    _sampled_us = now_us;
+    _queued = queued;
+    return;
+  }
+  _drained += _queued + written > queued ? _queued + written - queued : 0;
+  _drain_us += now_us - _sampled_us;
+  // the queue only drains between writes, so it never emptied in the interval if not empty at the end
+  _backlogged = _backlogged && queued > 0;
+  _sampled_us = now_us;
+  _queued = queued;
+  if (_drain_us < MIN_SAMPLE_US) {
+    return;
+  }
+
+  double written_per_us = (double)_drained / _drain_us;
+  // the queue emptied waits for records rather than the link, which is at least as fast as measured then
+  if (_backlogged || written_per_us > _written_per_us) {
+    _written_per_us = _written_per_us == 0 ? written_per_us : ALPHA * written_per_us + (1 - ALPHA) * _written_per_us;
+    update_target();
+  }
+  _drained = 0;
+  _drain_us = 0;
+  _backlogged = true;
+}
+
+void AdaptiveBatcher::update_target()
+{
+  if (_written_per_us == 0) {
+    return;
+  }
+  double target = _written_per_us * _bytes_per_written * _latency_target_us;
+  size_t target_bytes = target >= _max_bytes ? _max_bytes : std::max(_min_bytes, (size_t)target);
+  _target_bytes.store(target_bytes, std::memory_order_relaxed);
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Decides when records pending for a packet are sent: once they reach the target bytes, or the oldest one has
+ * waited for the latency target, whichever comes first.
+ * The target bytes follow the throughput of the link, so that delivering a packet takes about the latency target:
+ * small packets keep the first record early on a slow link, large ones save per packet cost on a fast link.
+ * Throughput is measured by the send queue of the socket drained, i.e. bytes acknowledged by the client, rather than
+ * by time spent writing, which only tells how fast the socket buffer takes bytes until it is full.
+ */
+class AdaptiveBatcher {
+public:
+  static constexpr size_t MIN_TARGET_BYTES = 64 * 1024;
+
+  /*!
+   * @param latency_target_us 0 to send records as soon as they arrive
+   * @param max_bytes upper bound of target bytes
+   */
+  AdaptiveBatcher(uint64_t latency_target_us, size_t max_bytes);
+
+  /*!
+   * @brief Safe to read from threads other than the sender, e.g. by gauges
+   */
+  inline size_t target_bytes() const
+  {
+    return _target_bytes.load(std::memory_order_relaxed);
+  }
+
+  /*!
+   * @return how long to wait for more records before sending the ones pending since pending_since_us, 0 if due
+   */
+  uint64_t wait_us(uint64_t pending_since_us, uint64_t now_us) const;
+
+  /*!
+   * @brief Account a packet sent, of which bytes of records per byte written measured, e.g. more than 1 if compressed
+   * @param written bytes of the packet written to the socket
+   */
+  void on_sent(size_t bytes, size_t written);
+
+  /*!
+   * @brief Measure throughput by bytes drained from the send queue of the socket since last sampled, sampled before
+   * and after packets written
+   * @param queued bytes in the send queue of the socket not acknowledged by the client, e.g. by TIOCOUTQ
+   */
+  void on_queue_sampled(uint64_t now_us, size_t queued);
+
+  /*!
+   * @return smoothed throughput in bytes of records per second, 0 before measured
+   */
+  inline uint64_t throughput() const
+  {
+    return (uint64_t)(_written_per_us * _bytes_per_written * 1000000);
+  }
+
+private:
+  void update_target();
+
+private:
+  // weight of the latest measure in smoothed ones
+  static constexpr double ALPHA = 0.2;
+  // bytes drained are accumulated over at least this long before taken as throughput
+  static constexpr uint64_t MIN_SAMPLE_US = 1000;
+
+  uint64_t _latency_target_us;
+  size_t _min_bytes;
+  size_t _max_bytes;
+  std::atomic<size_t> _target_bytes;
+  double _bytes_per_written = 1;
+  double _written_per_us = 0;
+
+  // last sample of the send queue, 0 if never sampled
+  uint64_t _sampled_us = 0;
+  size_t _queued = 0;
+  // written since last sampled
+  size_t _written = 0;
+  // drained since throughput last measured, and whether the queue never emptied meanwhile
+  uint64_t _drained = 0;
+  uint64_t _drain_us = 0;
+  bool _backlogged = true;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <unistd.h>
+#include "common.h"
+#include "config.h"
+#include "admission.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+ResourceBudget ResourceBudget::client()
+{
+  ResourceBudget budget;
+  budget.memory_mb = _s_config.client_memory_budget_mb.val();
+  budget.cpu_percent = _s_config.client_cpu_budget_percent.val();
+  return budget;
+}
+
+ResourceBudget ResourceBudget::node()
+{
+  ResourceBudget budget;
+  budget.memory_mb = _s_config.node_memory_capacity_mb.val();
+  if (budget.memory_mb == 0) {
+    budget.memory_mb = (uint64_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) / 1024 / 1024;
+  }
+  budget.cpu_percent = _s_config.node_cpu_capacity_percent.val();
+  if (budget.cpu_percent == 0) {
+    budget.cpu_percent = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN) * 100;
+  }
+  return budget;
+}
+
+uint64_t ResourceBudget::record_queue_bytes()
+{
+  uint64_t max_bytes = _s_config.record_queue_max_bytes.val();
+  uint64_t memory_mb = _s_config.client_memory_budget_mb.val();
+  if (memory_mb != 0 && (max_bytes == 0 || memory_mb * 1024 * 1024 / 2 < max_bytes)) {
+    max_bytes = memory_mb * 1024 * 1024 / 2;
+  }
+  return max_bytes;
+}
+
+int Admission::admit(size_t clients, std::string& reason)
+{
+  return admit(clients, ResourceBudget::client(), ResourceBudget::node(), reason);
+}
+
+int Admission::admit(size_t clients, const ResourceBudget& client, const ResourceBudget& node, std::string& reason)
+{
+  if (client.memory_mb != 0 && node.memory_mb != 0 && (clients + 1) * client.memory_mb > node.memory_mb) {
+    reason = "Exceed node memory capacity in MB: " + std::to_string(node.memory_mb) + ", reserved by " +
+             std::to_string(clients) + " clients: " + std::to_string(clients * client.memory_mb);
+    return OMS_FAILED;
+  }
+  if (client.cpu_percent != 0 && node.cpu_percent != 0 && (clients + 1) * client.cpu_percent > node.cpu_percent) {
+    reason = "Exceed node cpu capacity in percent: " + std::to_string(node.cpu_percent) + ", reserved by " +
+             std::to_string(clients) + " clients: " + std::to_string(clients * client.cpu_percent);
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
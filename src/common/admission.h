@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Memory and cpu of a client process or of the node, 0 means unlimited
+ */
+struct ResourceBudget {
+  uint64_t memory_mb = 0;
+  // percent of one core, e.g. 200 for 2 cores
+  uint32_t cpu_percent = 0;
+
+  /*!
+   * @brief Budget of each oblogreader or binlog_converter
+   */
+  static ResourceBudget client();
+
+  /*!
+   * @brief Capacity shared by all clients, detected from the node if not configured
+   */
+  static ResourceBudget node();
+
+  /*!
+   * @brief Bytes bound of the record queue of a client, leaving the other half of its memory budget to obcdc
+   */
+  static uint64_t record_queue_bytes();
+};
+
+/*!
+ * @brief Admission control of new clients by budgets, each running client reserves its whole budget,
+ * so that a node never takes more clients than it can afford at their peak
+ */
+class Admission {
+public:
+  /*!
+   * @param clients count of clients running or being started
+   * @param reason[out] the exceeded resource if not admitted
+   * @return OMS_OK if budgets of clients plus a new one fit node capacity
+   */
+  static int admit(size_t clients, std::string& reason);
+
+  static int admit(size_t clients, const ResourceBudget& client, const ResourceBudget& node, std::string& reason);
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
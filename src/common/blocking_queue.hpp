@@ -17,32 +17,50 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <utility>
 #include <vector>
 
 namespace oceanbase {
 namespace logproxy {
+/*!
+ * @brief Queue bounded by count of elements, and optionally by total bytes of elements given on offer
+ */
 template <typename T>
 class BlockingQueue {
 public:
-  explicit BlockingQueue(const size_t max_queue_size = S_DEFAULT_MAX_QUEUE_SIZE) : _max_queue_size(max_queue_size)
+  /*!
+   * @param max_bytes 0 means bounded by count only, otherwise an element larger than max_bytes is still accepted
+   * by an empty queue, so that it never blocks forever
+   */
+  explicit BlockingQueue(const size_t max_queue_size = S_DEFAULT_MAX_QUEUE_SIZE, const size_t max_bytes = 0)
+      : _max_queue_size(max_queue_size), _max_bytes(max_bytes)
   {
     // nothing to do
   }
 
   bool offer(const T& element, uint64_t timeout_us)
+  {
+    return offer(element, 0, timeout_us);
+  }
+
+  /*!
+   * @param bytes size of element, taken before offer as the element may be released by consumers at once
+   */
+  bool offer(const T& element, size_t bytes, uint64_t timeout_us)
   {
     std::unique_lock<std::mutex> op_lock(_op_mutex);
-    while (_queue.size() >= _max_queue_size) {
+    while (full(bytes)) {
       std::cv_status st = _not_full.wait_for(op_lock, std::chrono::microseconds(timeout_us));
       if (st == std::cv_status::timeout) {
         return false;
       }
     }
 
-    if (_queue.size() >= _max_queue_size) {
+    if (full(bytes)) {
       return false;
     }
-    _queue.emplace_back(element);
+    _queue.emplace_back(element, bytes);
+    _bytes += bytes;
     _not_empty.notify_one();
     return true;
   }
@@ -60,7 +78,8 @@ public:
     if (_queue.empty()) {
       return false;
     }
-    element = _queue.front();
+    element = _queue.front().first;
+    _bytes -= _queue.front().second;
     _queue.pop_front();
     _not_full.notify_one();
     return true;
@@ -80,11 +99,12 @@ public:
     }
 
     while (!_queue.empty() && elements.size() < elements.capacity()) {
-      elements.push_back(_queue.front());
+      elements.push_back(_queue.front().first);
+      _bytes -= _queue.front().second;
       _queue.pop_front();
     }
 
-    _not_full.notify_one();
+    _not_full.notify_all();
     return true;
   }
 
@@ -98,6 +118,15 @@ public:
     }
   }
 
+  /*!
+   * @brief Total bytes of elements in queue, as given on offer
+   */
+  size_t bytes()
+  {
+    std::lock_guard<std::mutex> lock(_op_mutex);
+    return _bytes;
+  }
+
   void clear()
   {
     clear([] {});
@@ -108,18 +137,31 @@ public:
     std::lock_guard<std::mutex> lock(_op_mutex);
     while (!_queue.empty()) {
       if (foreach) {
-        foreach (_queue.front())
+        foreach (_queue.front().first)
           ;
       }
       _queue.pop_front();
     }
+    _bytes = 0;
+    _not_full.notify_all();
+  }
+
+private:
+  inline bool full(size_t bytes) const
+  {
+    if (_queue.size() >= _max_queue_size) {
+      return true;
+    }
+    return _max_bytes != 0 && !_queue.empty() && _bytes + bytes > _max_bytes;
   }
 
 private:
   static const size_t S_DEFAULT_MAX_QUEUE_SIZE = 60000;
 
   size_t _max_queue_size;
-  std::deque<T> _queue;
+  size_t _max_bytes;
+  size_t _bytes = 0;
+  std::deque<std::pair<T, size_t>> _queue;
   std::mutex _op_mutex;
   std::condition_variable _not_empty;
   std::condition_variable _not_full;
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "log.h"
+#include "config.h"
+#include "cgroup.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+static constexpr uint32_t CPU_PERIOD_US = 100000;
+
+bool Cgroup::enabled()
+{
+  return !_s_config.cgroup_root.val().empty();
+}
+
+std::string Cgroup::cpu_max(uint32_t cpu_percent)
+{
+  if (cpu_percent == 0) {
+    return "max " + std::to_string(CPU_PERIOD_US);
+  }
+  return std::to_string((uint64_t)cpu_percent * CPU_PERIOD_US / 100) + " " + std::to_string(CPU_PERIOD_US);
+}
+
+std::string Cgroup::memory_max(uint64_t memory_mb)
+{
+  if (memory_mb == 0) {
+    return "max";
+  }
+  return std::to_string(memory_mb * 1024 * 1024);
+}
+
+int Cgroup::place(const std::string& name, int pid, const ResourceBudget& budget)
+{
+  const std::string& root = _s_config.cgroup_root.val();
+  // controllers must be enabled for children of root, which is a no-op once done
+  if (budget.memory_mb != 0 || budget.cpu_percent != 0) {
+    write(root + "/cgroup.subtree_control", "+cpu +memory");
+  }
+
+  std::string path = root + "/" + name;
+  if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    OMS_STREAM_WARN << "Failed to create cgroup: " << path << ", error: " << strerror(errno);
+    return OMS_FAILED;
+  }
+  if (write(path + "/memory.max", memory_max(budget.memory_mb)) != OMS_OK ||
+      write(path + "/cpu.max", cpu_max(budget.cpu_percent)) != OMS_OK ||
+      write(path + "/cgroup.procs", std::to_string(pid)) != OMS_OK) {
+    ::rmdir(path.c_str());
+    return OMS_FAILED;
+  }
+  OMS_STREAM_INFO << "Placed process: " << pid << " into cgroup: " << path << " with memory budget in MB: "
+                  << budget.memory_mb << ", cpu budget in percent: " << budget.cpu_percent;
+  return OMS_OK;
+}
+
+void Cgroup::gc(const std::string& prefix)
+{
+  const std::string& root = _s_config.cgroup_root.val();
+  DIR* dir = ::opendir(root.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  struct dirent* dent = nullptr;
+  while ((dent = readdir(dir)) != nullptr) {
+    if (dent->d_type == DT_DIR && strncmp(dent->d_name, prefix.c_str(), prefix.size()) == 0) {
+      // fails with EBUSY while any process alive in it
+      std::string path = root + "/" + dent->d_name;
+      if (::rmdir(path.c_str()) == 0) {
+        OMS_STREAM_INFO << "Removed cgroup of exited process: " << path;
+      }
+    }
+  }
+  ::closedir(dir);
+}
+
+int Cgroup::write(const std::string& file, const std::string& value)
+{
+  int fd = ::open(file.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    OMS_STREAM_WARN << "Failed to open cgroup file: " << file << ", error: " << strerror(errno);
+    return OMS_FAILED;
+  }
+  ssize_t ret = ::write(fd, value.data(), value.size());
+  int err = errno;
+  ::close(fd);
+  if (ret != (ssize_t)value.size()) {
+    OMS_STREAM_WARN << "Failed to write " << value << " to cgroup file: " << file << ", error: " << strerror(err);
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <string>
+#include "admission.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Groups of child processes under the delegated cgroup v2 directory cgroup_root, one group for each process,
+ * limited by memory.max and cpu.max of its budget
+ */
+class Cgroup {
+public:
+  static bool enabled();
+
+  /*!
+   * @brief Create group <cgroup_root>/<name> limited by budget and move the process into it
+   */
+  static int place(const std::string& name, int pid, const ResourceBudget& budget);
+
+  /*!
+   * @brief Remove groups with prefix of which processes have all exited, the kernel refuses removing others
+   */
+  static void gc(const std::string& prefix);
+
+  /*!
+   * @return value of cpu.max, e.g. "150000 100000" for 150 percent
+   */
+  static std::string cpu_max(uint32_t cpu_percent);
+
+  static std::string memory_max(uint64_t memory_mb);
+
+private:
+  static int write(const std::string& file, const std::string& value);
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -23,10 +23,13 @@ ClientMeta ClientMeta::from_handshake(const Peer& peer, ClientHandshakeRequestMe
   meta.ip = handshake.ip;
   meta.version = handshake.version;
   meta.configuration = handshake.configuration;
+  meta.credit_bytes = handshake.credit_bytes;
+  meta.credit_records = handshake.credit_records;
 
   meta.peer = peer;
 
   meta.register_time = time(nullptr);
+  meta.handshake_time_us = Timer::now();
   return meta;
 }
 
@@ -43,6 +46,13 @@ int ClientMeta::init_from_json(const rapidjson::Value& json)
   register_time = json["register_time"].GetInt64();
   enable_monitor = json["enable_monitor"].GetBool();
   packet_version = static_cast<MessageVersion>(json["packet_version"].GetInt());
+  if (json.HasMember("handshake_time_us")) {
+    handshake_time_us = json["handshake_time_us"].GetUint64();
+  }
+  if (json.HasMember("credit_bytes")) {
+    credit_bytes = json["credit_bytes"].GetInt64();
+    credit_records = json["credit_records"].GetInt64();
+  }
   return OMS_OK;
 }
 
@@ -59,6 +69,9 @@ void ClientMeta::to_json(rapidjson::PrettyWriter<rapidjson::StringBuffer>& write
   writer.Key("register_time");writer.Uint64(register_time);
   writer.Key("enable_monitor");writer.Bool(enable_monitor);
   writer.Key("packet_version");writer.Int((int)packet_version);
+  writer.Key("handshake_time_us");writer.Uint64(handshake_time_us);
+  writer.Key("credit_bytes");writer.Int64(credit_bytes);
+  writer.Key("credit_records");writer.Int64(credit_records);
   writer.EndObject();
 }
 
@@ -41,6 +41,13 @@ public:
   OMS_MF(time_t, register_time);
   OMS_MF_DFT(bool, enable_monitor, false);
   OMS_MF_DFT(MessageVersion, packet_version, MessageVersion::V2);
+  // when handshake request received by logproxy, to measure the latency of starting oblogreader
+  OMS_MF_DFT(uint64_t, handshake_time_us, 0);
+  // initial credit of flow control requested by handshake, 0 for unlimited
+  OMS_MF_DFT(int64_t, credit_bytes, 0);
+  OMS_MF_DFT(int64_t, credit_records, 0);
+  // served by a standby oblogreader started ahead of handshake, never serialized
+  OMS_MF_DFT(bool, prefork, false);
 
 public:
   static ClientMeta from_handshake(const Peer&, ClientHandshakeRequestMessage&);
@@ -54,16 +54,30 @@ public:
   OMS_CONFIG_UINT32(encode_queue_size, 20000);
   OMS_CONFIG_UINT32(max_packet_bytes, 1024 * 1024 * 64);  // 64MB
   OMS_CONFIG_UINT32(command_timeout_s, 10);
+  // interval of routine jobs of accepter, e.g. reaping exited oblogreader processes
   OMS_CONFIG_UINT64(accept_interval_us, 500000);
+  OMS_CONFIG_UINT32(listen_backlog, 1024);
+  // allow several logproxy processes to listen on the same port, kernel balances connections among them
+  OMS_CONFIG_BOOL(listen_reuse_port, false);
 
   OMS_CONFIG_UINT32(record_queue_size, 20000);
+  // total bytes of records in the queue between reader and sender or converter, at most half of client memory budget
+  OMS_CONFIG_UINT64(record_queue_max_bytes, 1024UL * 1024 * 1024);  // 1GB
   OMS_CONFIG_UINT64(read_timeout_us, 2000000);
   OMS_CONFIG_UINT64(read_fail_interval_us, 1000000);
   OMS_CONFIG_UINT32(read_wait_num, 20000);
 
   OMS_CONFIG_UINT64(send_timeout_us, 2000000);
+  // records are sent once they fill a packet of target bytes or the oldest waits for the latency target,
+  // target bytes adapt to send throughput up to sender_max_batch_bytes. 0: send records as soon as polled
+  OMS_CONFIG_UINT64(sender_latency_target_us, 2000);
+  OMS_CONFIG_UINT64(sender_max_batch_bytes, 8 * 1024 * 1024);  // 8MB
   OMS_CONFIG_UINT64(send_fail_interval_us, 1000000);
 
+  // threads running auth and clog checks of handshakes
+  OMS_CONFIG_UINT32(handshake_worker_count, 4);
+  OMS_CONFIG_UINT32(handshake_timeout_s, 30);
+
   OMS_CONFIG_BOOL(check_quota_enable, false);
   /*!
    * @brief Whether to enable clog site verification
@@ -80,16 +94,36 @@ public:
   OMS_CONFIG_UINT16(log_flush_period_s, 1);       // unit: second
   OMS_CONFIG_UINT16(log_max_file_size_mb, 1024);  // default: 1 GB
   OMS_CONFIG_UINT16(log_retention_h, 360);        // default: 15 Days
+  // records in the queue of async logger, 0 to log synchronously
+  OMS_CONFIG_UINT32(log_async_queue_size, 8192);
+  // when the queue is full, 0(default): block the caller, 1: overwrite the oldest record
+  OMS_CONFIG_UINT16(log_async_overflow_policy, 0);
 
   OMS_CONFIG_STR(oblogreader_path, "./run");
   OMS_CONFIG_STR(bin_path, "./bin");
   OMS_CONFIG_UINT32(oblogreader_path_retain_hour, 168);  // 7 Days
   OMS_CONFIG_UINT32(oblogreader_lease_s, 300);           // 5 mins
   OMS_CONFIG_UINT32(oblogreader_max_count, 100);
+  // standby oblogreaders started ahead of handshakes, which get client socket and configs over unix domain socket.
+  // 0(default): fork and exec an oblogreader for each client
+  OMS_CONFIG_UINT32(oblogreader_prefork_count, 0);
+  // comma separated ob versions of which obcdc libraries are loaded by standby oblogreaders, e.g. 4.2.1,4.3.0
+  OMS_CONFIG_STR(oblogreader_prefork_ob_versions, "");
 
   OMS_CONFIG_UINT32(max_cpu_ratio, 0);
   OMS_CONFIG_UINT64(max_mem_quota_mb, 0);
 
+  // budgets of each oblogreader or binlog_converter, enforced by cgroup and reserved by admission control, 0: unlimited
+  OMS_CONFIG_UINT64(client_memory_budget_mb, 0);
+  OMS_CONFIG_UINT32(client_cpu_budget_percent, 0);  // percent of one core
+  // capacity shared by budgets of all clients, 0: detected from the node
+  OMS_CONFIG_UINT64(node_memory_capacity_mb, 0);
+  OMS_CONFIG_UINT32(node_cpu_capacity_percent, 0);
+  // how long a handshake beyond node capacity waits for budgets released, 0: reject at once
+  OMS_CONFIG_UINT32(admission_wait_s, 0);
+  // delegated cgroup v2 directory, under which each client process gets a group limited by its budgets, empty: disabled
+  OMS_CONFIG_STR(cgroup_root, "");
+
   OMS_CONFIG_BOOL(allow_all_tenant, false);
   OMS_CONFIG_BOOL(auth_user, true);
   OMS_CONFIG_BOOL(auth_use_rs, false);
@@ -100,10 +134,27 @@ public:
 
   OMS_CONFIG_UINT64(ob_clog_fetch_interval_s, 600);  // 10 mins
   OMS_CONFIG_UINT64(ob_clog_expr_s, 43200);          // 12 h
+  // idle sys connections to observers kept for reuse per server, 0 to disable pooling
+  OMS_CONFIG_UINT32(ob_connection_pool_max_idle, 4);
+  OMS_CONFIG_UINT32(ob_connection_idle_timeout_s, 300);
+  // ttl of cached server lists, auth verdicts and observer versions, 0 to disable
+  OMS_CONFIG_UINT32(ob_meta_cache_ttl_s, 60);
+  // ttl of cached failures of them, 0 to disable
+  OMS_CONFIG_UINT32(ob_meta_cache_negative_ttl_s, 5);
 
   OMS_CONFIG_UINT32(counter_interval_s, 2);  // 2s
   OMS_CONFIG_BOOL(metric_enable, true);
   OMS_CONFIG_UINT32(metric_interval_s, 120);  // 2mins
+  // interval to walk working directories of processes for disk usage, unless it is tracked incrementally
+  OMS_CONFIG_UINT32(metric_disk_refresh_interval_s, 600);  // 10mins
+  // port of prometheus style /metrics endpoint, 0 to disable
+  OMS_CONFIG_UINT16(metric_http_port, 0);
+  // window over which quantiles of latency histograms are computed, shorter than metric_interval_s to catch spikes
+  OMS_CONFIG_UINT32(metric_quantile_window_s, 10);
+  // file in working directory to which child processes export metrics for the endpoint and SHOW BINLOG STATUS
+  OMS_CONFIG_STR(metric_export_file, "metrics.prom");
+  // trace commit-to-delivery latency of one in every N transactions, 0 to disable
+  OMS_CONFIG_UINT32(latency_trace_sample_interval, 1000);
 
   // when builtin_cluster_url_prefix not empty, we read cluster_id in handshake to make an complete cluster_url
   OMS_CONFIG_STR(builtin_cluster_url_prefix, "");
@@ -116,6 +167,10 @@ public:
   OMS_CONFIG_STR(tls_cert_file, "");
   OMS_CONFIG_STR(tls_key_file, "");
   OMS_CONFIG_BOOL(tls_verify_peer, true);
+  // encrypt records sent in the kernel after handshakes (kTLS), needs OpenSSL 3 built with ktls and the tls module
+  OMS_CONFIG_BOOL(tls_ktls, false);
+  // resume sessions of reconnecting clients by tickets instead of full handshakes
+  OMS_CONFIG_BOOL(tls_session_tickets, true);
 
   // tls between observer and liboblog
   OMS_CONFIG_BOOL(liboblog_tls, true);
@@ -151,10 +206,32 @@ public:
   OMS_CONFIG_UINT16(binlog_file_name_fill_zeroes_width, 6);          // fill zeroes width for mysql binlog file name
   OMS_CONFIG_UINT64(binlog_heartbeat_interval_us, 1000000);          // The interval at which heartbeat events are sent
   OMS_CONFIG_BOOL(binlog_ddl_convert, true);
+  // converted results of distinct DDLs, bulk partition maintenance and migrations repeat DDLs alike, 0 to disable
+  OMS_CONFIG_UINT32(binlog_ddl_convert_cache_size, 1024);
+  // append and read binlog files by io_uring, falling back to synchronous io if it is unavailable
+  OMS_CONFIG_BOOL(binlog_io_uring, false);
+  // dumpers read binlog files by chunks, of which the ones following are read ahead in flight with io_uring
+  OMS_CONFIG_UINT32(binlog_read_ahead_chunk_bytes, 256 * 1024);
+  OMS_CONFIG_UINT32(binlog_read_ahead_chunks, 4);
+  // compress packets for clients connecting with --compress or --compression-algorithms, e.g. replicas across zones
+  OMS_CONFIG_BOOL(binlog_protocol_compression, true);
+  // bytes of packets grouped into one compressed frame before compression, so small events share a frame
+  OMS_CONFIG_UINT32(binlog_protocol_compress_frame_bytes, 64 * 1024);
   OMS_CONFIG_STR(binlog_memory_limit, "3G");
   OMS_CONFIG_STR(binlog_working_mode, "storage");
 
   OMS_CONFIG_BOOL(binlog_gtid_display, true);  // Whether to display gtid information in show master status
+  // parse results and immutable result sets of distinct queries shared by connections, 0 to disable
+  OMS_CONFIG_UINT32(binlog_sql_parse_cache_size, 1024);
+  // transactions of which writesets are remembered to tell which transactions each one depends on, as
+  // binlog_transaction_dependency_history_size of MySQL, 0: every transaction depends on the previous one.
+  // Off by default: foreign keys are not told by table metas of obcdc, enable only if no table has any
+  OMS_CONFIG_UINT64(binlog_writeset_history_size, 0);
+  // events of a transaction are held until committed to emit its dependency, larger ones depend on the previous one
+  OMS_CONFIG_UINT64(binlog_writeset_max_txn_bytes, 64 * 1024 * 1024);
+  // compress each committed transaction into a TRANSACTION_PAYLOAD_EVENT as binlog_transaction_compression of MySQL
+  OMS_CONFIG_BOOL(binlog_transaction_compression, false);
+  OMS_CONFIG_UINT32(binlog_transaction_compression_level_zstd, 3);
 
   /*!
    * When restoring binlog breakpoint, whether to enable backup?
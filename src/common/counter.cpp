@@ -13,9 +13,14 @@
 #include <sstream>
 #include "log.h"
 #include "counter.h"
+#include "metric/metric_registry.h"
 
 namespace oceanbase {
 namespace logproxy {
+Counter::CountItem::CountItem(const char* n, const char* metric_name)
+    : name(n), histogram(MetricRegistry::instance().histogram(metric_name))
+{}
+
 void Counter::stop()
 {
   if (is_run()) {
@@ -29,6 +34,7 @@ void Counter::run()
   OMS_STREAM_INFO << "#### Counter thread running, tid: " << tid();
 
   std::stringstream ss;
+  HistogramSnapshot current;
   while (is_run()) {
     _timer.reset();
     this->sleep();
@@ -58,7 +64,9 @@ void Counter::run()
        << ",AVG:" << avg_size << "][XWIOS:" << xwios << ",AVG:" << xavg_size << "]";
     for (auto& count : _counts) {
       uint64_t c = count.count.load();
-      ss << "[" << count.name << ":" << c << "]";
+      count.histogram.snapshot(current);
+      ss << "[" << count.name << ":" << c << ",P99:" << current.delta(count.last).value_at(99) << "]";
+      count.last = current;
       count.count.fetch_sub(c);
     }
     for (auto& entry : _gauges) {
@@ -66,6 +74,11 @@ void Counter::run()
     }
     OMS_STREAM_INFO << ss.str();
 
+    MetricRegistry::instance().roll_if_due(Timer::now());
+    if (Config::instance().metric_enable.val()) {
+      MetricRegistry::instance().export_file(Config::instance().metric_export_file.val());
+    }
+
     // sub count that logged
     _read_count.fetch_sub(rcount);
     _write_count.fetch_sub(wcount);
@@ -80,6 +93,7 @@ void Counter::run()
 void Counter::register_gauge(const std::string& key, const std::function<int64_t()>& func)
 {
   _gauges.emplace(key, func);
+  MetricRegistry::instance().register_gauge("logproxy_gauge", func, {{"name", key}});
 }
 
 void Counter::count_read(uint64_t count)
@@ -110,6 +124,7 @@ void Counter::count_xwrite_io(uint64_t bytes)
 void Counter::count_key(Counter::CountKey key, uint64_t count)
 {
   _counts[key].count.fetch_add(count);
+  _counts[key].histogram.record(count);
 }
 
 void Counter::mark_timestamp(uint64_t timestamp_us)
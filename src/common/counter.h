@@ -23,6 +23,7 @@
 #include "thread.h"
 #include "timer.h"
 #include "config.h"
+#include "metric/histogram.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -57,6 +58,7 @@ public:
     SENDER_ENCODE_US = 3,
     SENDER_SEND_US = 4,
     BINLOG_DELAY_US = 5,
+    STORAGE_FLUSH_US = 6,
   };
 
   void count_key(CountKey key, uint64_t count);
@@ -72,9 +74,11 @@ private:
   struct CountItem {
     const char* name;
     std::atomic<uint64_t> count{0};
+    // per call latency distribution, exported as metric
+    Histogram& histogram;
+    HistogramSnapshot last;
 
-    CountItem(const char* n) : name(n)
-    {}
+    CountItem(const char* n, const char* metric_name);
   };
 
   Timer _timer;
@@ -88,7 +92,13 @@ private:
   volatile uint64_t _checkpoint_us = _timestamp_us;
   volatile uint64_t _count_timestamp_us = _timestamp_us;
 
-  CountItem _counts[6]{{"RFETCH"}, {"ROFFER"}, {"SPOLL"}, {"SENCODE"}, {"SSEND"}, {"BINLOG_DELAY_US"}};
+  CountItem _counts[7]{{"RFETCH", "logproxy_reader_fetch_us"},
+      {"ROFFER", "logproxy_reader_offer_us"},
+      {"SPOLL", "logproxy_sender_poll_us"},
+      {"SENCODE", "logproxy_sender_encode_us"},
+      {"SSEND", "logproxy_sender_send_us"},
+      {"BINLOG_DELAY_US", "logproxy_binlog_delay_us"},
+      {"SFLUSH", "logproxy_storage_flush_us"}};
 
   std::map<std::string, std::function<int64_t()>> _gauges;
 
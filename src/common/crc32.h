@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief CRC-32 of binlog checksums, same as crc32() of zlib, folded with PCLMULQDQ on x86-64 cpus supporting it,
+ * otherwise computed by slicing-by-8 tables
+ */
+class Crc32 {
+public:
+  /*!
+   * @param crc checksum of the preceding data, 0 at start
+   */
+  static uint32_t update(uint32_t crc, const void* data, size_t len);
+
+  static uint32_t compute(const void* data, size_t len)
+  {
+    return update(0, data, len);
+  }
+
+  static uint32_t update_slicing_by_8(uint32_t crc, const void* data, size_t len);
+
+  /*!
+   * @return name of the implementation picked for the running cpu
+   */
+  static const char* implementation();
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "credit_window.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+void CreditWindow::reset(int64_t bytes, int64_t records)
+{
+  _bytes_limited = bytes > 0;
+  _records_limited = records > 0;
+  _bytes = bytes;
+  _records = records;
+}
+
+void CreditWindow::grant(int64_t bytes, int64_t records)
+{
+  if (bytes > 0) {
+    _bytes += bytes;
+  }
+  if (records > 0) {
+    _records += records;
+  }
+}
+
+void CreditWindow::consume(size_t bytes, size_t records)
+{
+  _bytes -= (int64_t)bytes;
+  _records -= (int64_t)records;
+}
+
+size_t CreditWindow::limit_bytes(size_t bytes) const
+{
+  if (!_bytes_limited) {
+    return bytes;
+  }
+  return _bytes <= 0 ? 0 : std::min(bytes, (size_t)_bytes);
+}
+
+size_t CreditWindow::limit_records(size_t records) const
+{
+  if (!_records_limited) {
+    return records;
+  }
+  return _records <= 0 ? 0 : std::min(records, (size_t)_records);
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Credit of records granted by a client with flow control, in uncompressed bytes and count of records.
+ * Records are sent only within credit, except that a packet may overdraw bytes by its first record,
+ * so that a record larger than the whole window is still delivered.
+ * Dimension with initial credit 0 is unlimited, and so are both if flow control disabled.
+ */
+class CreditWindow {
+public:
+  /*!
+   * @brief Enable flow control if any of the initial credit is not 0
+   */
+  void reset(int64_t bytes, int64_t records);
+
+  inline bool enabled() const
+  {
+    return _bytes_limited || _records_limited;
+  }
+
+  void grant(int64_t bytes, int64_t records);
+
+  void consume(size_t bytes, size_t records);
+
+  /*!
+   * @return max bytes of the next packet, no more than bytes
+   */
+  size_t limit_bytes(size_t bytes) const;
+
+  /*!
+   * @return max records of the next packet, no more than records
+   */
+  size_t limit_records(size_t records) const;
+
+  /*!
+   * @return true if no more record could be sent until more credit granted
+   */
+  inline bool exhausted() const
+  {
+    return (_bytes_limited && _bytes <= 0) || (_records_limited && _records <= 0);
+  }
+
+  inline int64_t bytes() const
+  {
+    return _bytes;
+  }
+
+  inline int64_t records() const
+  {
+    return _records;
+  }
+
+private:
+  bool _bytes_limited = false;
+  bool _records_limited = false;
+  // negative if overdrawn
+  int64_t _bytes = 0;
+  int64_t _records = 0;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
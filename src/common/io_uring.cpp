@@ -0,0 +1,595 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "io_uring.h"
+#include "log.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static int sys_io_uring_setup(uint32_t entries, struct io_uring_params* params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int sys_io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int sys_io_uring_register(int fd, uint32_t opcode, const void* arg, uint32_t nr_args)
+{
+  return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+IoUring::~IoUring()
+{
+  if (_sqes != nullptr) {
+    munmap(_sqes, _sqes_size);
+  }
+  if (_cq_ptr != nullptr && _cq_ptr != _sq_ptr) {
+    munmap(_cq_ptr, _cq_ring_size);
+  }
+  if (_sq_ptr != nullptr) {
+    munmap(_sq_ptr, _sq_ring_size);
+  }
+  if (_ring_fd >= 0) {
+    ::close(_ring_fd);
+  }
+}
+
+int IoUring::init(uint32_t entries)
+{
+  memset(&_params, 0, sizeof(_params));
+  int fd = sys_io_uring_setup(entries, &_params);
+  if (fd < 0) {
+    OMS_WARN("Failed to setup io_uring, reason: {}", system_err(errno));
+    return OMS_FAILED;
+  }
+
+  _sq_ring_size = _params.sq_off.array + _params.sq_entries * sizeof(uint32_t);
+  _cq_ring_size = _params.cq_off.cqes + _params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = (_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+  }
+  void* sq_ptr = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ptr == MAP_FAILED) {
+    OMS_WARN("Failed to map submission ring of io_uring, reason: {}", system_err(errno));
+    ::close(fd);
+    return OMS_FAILED;
+  }
+  void* cq_ptr = sq_ptr;
+  if (!single_mmap) {
+    cq_ptr = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ptr == MAP_FAILED) {
+      OMS_WARN("Failed to map completion ring of io_uring, reason: {}", system_err(errno));
+      munmap(sq_ptr, _sq_ring_size);
+      ::close(fd);
+      return OMS_FAILED;
+    }
+  }
+  _sqes_size = _params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    OMS_WARN("Failed to map submission entries of io_uring, reason: {}", system_err(errno));
+    if (cq_ptr != sq_ptr) {
+      munmap(cq_ptr, _cq_ring_size);
+    }
+    munmap(sq_ptr, _sq_ring_size);
+    ::close(fd);
+    return OMS_FAILED;
+  }
+
+  _ring_fd = fd;
+  _sq_ptr = sq_ptr;
+  _cq_ptr = cq_ptr;
+  _sqes = static_cast<struct io_uring_sqe*>(sqes);
+  auto* sq = static_cast<char*>(sq_ptr);
+  _sq_head = reinterpret_cast<uint32_t*>(sq + _params.sq_off.head);
+  _sq_tail = reinterpret_cast<uint32_t*>(sq + _params.sq_off.tail);
+  _sq_mask = *reinterpret_cast<uint32_t*>(sq + _params.sq_off.ring_mask);
+  _sq_array = reinterpret_cast<uint32_t*>(sq + _params.sq_off.array);
+  auto* cq = static_cast<char*>(cq_ptr);
+  _cq_head = reinterpret_cast<uint32_t*>(cq + _params.cq_off.head);
+  _cq_tail = reinterpret_cast<uint32_t*>(cq + _params.cq_off.tail);
+  _cq_mask = *reinterpret_cast<uint32_t*>(cq + _params.cq_off.ring_mask);
+  _cqes = reinterpret_cast<struct io_uring_cqe*>(cq + _params.cq_off.cqes);
+  return OMS_OK;
+}
+
+int IoUring::register_files(const std::vector<int>& fds)
+{
+  if (sys_io_uring_register(_ring_fd, IORING_REGISTER_FILES, fds.data(), fds.size()) < 0) {
+    OMS_WARN("Failed to register files to io_uring, reason: {}", system_err(errno));
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+int IoUring::unregister_files()
+{
+  if (sys_io_uring_register(_ring_fd, IORING_UNREGISTER_FILES, nullptr, 0) < 0) {
+    OMS_WARN("Failed to unregister files of io_uring, reason: {}", system_err(errno));
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+int IoUring::register_buffers(const std::vector<struct iovec>& buffers)
+{
+  if (sys_io_uring_register(_ring_fd, IORING_REGISTER_BUFFERS, buffers.data(), buffers.size()) < 0) {
+    OMS_WARN("Failed to register buffers to io_uring, reason: {}", system_err(errno));
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+struct io_uring_sqe* IoUring::get_sqe()
+{
+  uint32_t head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+  uint32_t tail = *_sq_tail + _sq_pending;
+  if (tail - head >= _params.sq_entries) {
+    return nullptr;
+  }
+  uint32_t index = tail & _sq_mask;
+  _sq_array[index] = index;
+  ++_sq_pending;
+  struct io_uring_sqe* sqe = &_sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+int IoUring::submit(uint32_t wait_nr)
+{
+  if (_sq_pending > 0) {
+    __atomic_store_n(_sq_tail, *_sq_tail + _sq_pending, __ATOMIC_RELEASE);
+    _sq_pending = 0;
+  }
+  uint32_t to_submit = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+  if (to_submit == 0 && wait_nr == 0) {
+    return 0;
+  }
+  int ret;
+  do {
+    ret = sys_io_uring_enter(_ring_fd, to_submit, wait_nr, wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+  } while (ret < 0 && errno == EINTR);
+  int err = ret < 0 ? errno : 0;
+
+  // the kernel reads sqes only within io_uring_enter of this thread, so ones it did not take can be taken back
+  uint32_t left = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+  if (left > 0) {
+    __atomic_store_n(_sq_tail, *_sq_tail - left, __ATOMIC_RELEASE);
+  }
+  return err != 0 ? -err : ret;
+}
+
+bool IoUring::peek_cqe(struct io_uring_cqe& cqe)
+{
+  uint32_t head = *_cq_head;
+  if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  cqe = _cqes[head & _cq_mask];
+  __atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+int IoUring::wait_cqe(struct io_uring_cqe& cqe)
+{
+  while (!peek_cqe(cqe)) {
+    int ret = submit(1);
+    if (ret < 0) {
+      OMS_ERROR("Failed to wait for completions of io_uring, reason: {}", system_err(-ret));
+      return OMS_FAILED;
+    }
+  }
+  return OMS_OK;
+}
+
+ReadAheadFile::ReadAheadFile(size_t chunk_size, uint32_t depth, bool use_io_uring)
+    : _chunk_size(chunk_size), _depth(std::max(depth, 2U)), _slots(_depth)
+{
+  std::vector<struct iovec> buffers;
+  for (Slot& slot : _slots) {
+    slot.buf = static_cast<unsigned char*>(malloc(_chunk_size));
+    buffers.push_back({slot.buf, _chunk_size});
+  }
+  if (use_io_uring && _ring.init(_depth) == OMS_OK) {
+    _buffers_registered = _ring.register_buffers(buffers) == OMS_OK;
+  }
+}
+
+ReadAheadFile::~ReadAheadFile()
+{
+  close();
+  for (Slot& slot : _slots) {
+    free(slot.buf);
+  }
+}
+
+int ReadAheadFile::open(const std::string& file)
+{
+  close();
+  _fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (_fd < 0) {
+    OMS_ERROR("Failed to open file: {}, reason: {}", file, system_err(errno));
+    return OMS_FAILED;
+  }
+  // read by pread if the file can not be registered, e.g. out of RLIMIT_NOFILE
+  _file_registered = _ring.is_inited() && _ring.register_files({_fd}) == OMS_OK;
+  return OMS_OK;
+}
+
+void ReadAheadFile::close()
+{
+  if (_fd < 0) {
+    return;
+  }
+  drain();
+  for (Slot& slot : _slots) {
+    slot.state = EMPTY;
+  }
+  if (_file_registered) {
+    _ring.unregister_files();
+    _file_registered = false;
+  }
+  ::close(_fd);
+  _fd = -1;
+  _limit = 0;
+}
+
+int ReadAheadFile::read(uint64_t offset, unsigned char* buf, size_t len)
+{
+  if (len == 0) {
+    return OMS_OK;
+  }
+  uint64_t first = offset / _chunk_size;
+  uint64_t last = (offset + len - 1) / _chunk_size;
+  if (last - first + 1 >= _depth) {
+    // too large to be buffered
+    size_t read_len = 0;
+    if (pread_fully(offset, buf, len, read_len) != OMS_OK || read_len != len) {
+      OMS_ERROR("Failed to read file at offset: {}, expected: {}, actual: {}", offset, len, read_len);
+      return OMS_FAILED;
+    }
+    return OMS_OK;
+  }
+
+  for (uint64_t chunk = first; chunk <= last; ++chunk) {
+    uint64_t chunk_begin = chunk * _chunk_size;
+    size_t begin = chunk == first ? offset - chunk_begin : 0;
+    size_t end = chunk == last ? offset + len - chunk_begin : _chunk_size;
+    if (fill(chunk, end) != OMS_OK) {
+      OMS_ERROR("Failed to read file at offset: {}, length: {}", offset, len);
+      return OMS_FAILED;
+    }
+    memcpy(buf, _slots[chunk % _depth].buf + begin, end - begin);
+    buf += end - begin;
+  }
+
+  if (is_io_uring()) {
+    // chunks following are read ahead in slots not holding the chunks just read
+    for (uint64_t chunk = last + 1; chunk < first + _depth && chunk * _chunk_size < _limit; ++chunk) {
+      Slot& slot = _slots[chunk % _depth];
+      if (slot.state == IN_FLIGHT || (slot.state == READY && slot.chunk == chunk)) {
+        continue;
+      }
+      submit_read(chunk);
+    }
+    int ret = submit();
+    if (ret < 0) {
+      OMS_WARN("Failed to submit reads ahead, reason: {}", system_err(-ret));
+    }
+  }
+  return OMS_OK;
+}
+
+int ReadAheadFile::fill(uint64_t chunk, size_t needed)
+{
+  Slot& slot = _slots[chunk % _depth];
+  if (slot.state == IN_FLIGHT && wait_slot(slot) != OMS_OK) {
+    return OMS_FAILED;
+  }
+  if (slot.state == READY && slot.chunk == chunk && slot.valid >= needed) {
+    return OMS_OK;
+  }
+
+  // not read yet, or read short before the file grows, of which only the missing tail is read
+  size_t from = (slot.state == READY && slot.chunk == chunk) ? slot.valid : 0;
+  if (is_io_uring()) {
+    submit_read(chunk, from);
+    int ret = submit();
+    if (ret < 0) {
+      OMS_ERROR("Failed to submit read, reason: {}", system_err(-ret));
+      return OMS_FAILED;
+    }
+    if (wait_slot(slot) != OMS_OK) {
+      return OMS_FAILED;
+    }
+  } else {
+    slot.chunk = chunk;
+    slot.state = EMPTY;
+    size_t read_len = 0;
+    if (pread_fully(chunk * _chunk_size + from, slot.buf + from, _chunk_size - from, read_len) != OMS_OK) {
+      return OMS_FAILED;
+    }
+    slot.valid = from + read_len;
+    slot.state = READY;
+  }
+  return slot.state == READY && slot.valid >= needed ? OMS_OK : OMS_FAILED;
+}
+
+void ReadAheadFile::submit_read(uint64_t chunk, size_t from)
+{
+  uint32_t index = chunk % _depth;
+  Slot& slot = _slots[index];
+  struct io_uring_sqe* sqe = _ring.get_sqe();
+  if (sqe == nullptr) {
+    // never happens with entries no fewer than slots
+    return;
+  }
+  sqe->opcode = _buffers_registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  sqe->flags = IOSQE_FIXED_FILE;
+  sqe->fd = 0;
+  sqe->off = chunk * _chunk_size + from;
+  sqe->addr = reinterpret_cast<uint64_t>(slot.buf + from);
+  sqe->len = _chunk_size - from;
+  sqe->buf_index = _buffers_registered ? index : 0;
+  sqe->user_data = chunk;
+  slot.chunk = chunk;
+  slot.state = IN_FLIGHT;
+  slot.valid = from;
+  ++_in_flight;
+  _queued.push_back(chunk);
+}
+
+int ReadAheadFile::submit()
+{
+  int ret = _ring.submit();
+  for (size_t i = ret < 0 ? 0 : ret; i < _queued.size(); ++i) {
+    Slot& slot = _slots[_queued[i] % _depth];
+    slot.state = slot.valid > 0 ? READY : EMPTY;
+    --_in_flight;
+  }
+  _queued.clear();
+  return ret;
+}
+
+int ReadAheadFile::wait_slot(Slot& slot)
+{
+  struct io_uring_cqe cqe {};
+  while (slot.state == IN_FLIGHT) {
+    if (_ring.wait_cqe(cqe) != OMS_OK) {
+      return OMS_FAILED;
+    }
+    reap(cqe);
+  }
+  return OMS_OK;
+}
+
+void ReadAheadFile::reap(const struct io_uring_cqe& cqe)
+{
+  --_in_flight;
+  if (cqe.res > 0) {
+    _bytes_read += cqe.res;
+  }
+  Slot& slot = _slots[cqe.user_data % _depth];
+  if (slot.state != IN_FLIGHT || slot.chunk != cqe.user_data) {
+    return;
+  }
+  if (cqe.res < 0) {
+    OMS_ERROR("Failed to read chunk: {}, reason: {}", cqe.user_data, system_err(-cqe.res));
+    slot.state = EMPTY;
+    return;
+  }
+  slot.valid += cqe.res;
+  slot.state = READY;
+}
+
+void ReadAheadFile::drain()
+{
+  struct io_uring_cqe cqe {};
+  while (_in_flight > 0 && _ring.wait_cqe(cqe) == OMS_OK) {
+    reap(cqe);
+  }
+}
+
+int ReadAheadFile::pread_fully(uint64_t offset, unsigned char* buf, size_t len, size_t& read_len)
+{
+  read_len = 0;
+  while (read_len < len) {
+    ssize_t n = pread(_fd, buf + read_len, len - read_len, offset + read_len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OMS_ERROR("Failed to read file at offset: {}, reason: {}", offset + read_len, system_err(errno));
+      return OMS_FAILED;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_len += n;
+    _bytes_read += n;
+  }
+  return OMS_OK;
+}
+
+AppendFile::AppendFile(bool use_io_uring)
+{
+  if (use_io_uring) {
+    _ring.init(64);
+  }
+}
+
+AppendFile::~AppendFile()
+{
+  close();
+}
+
+int AppendFile::open(const std::string& file)
+{
+  close();
+  _fd = ::open(file.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+  if (_fd < 0) {
+    OMS_ERROR("Failed to open file: {}, reason: {}", file, system_err(errno));
+    return OMS_FAILED;
+  }
+  // written by writev if the file can not be registered, e.g. out of RLIMIT_NOFILE
+  _file_registered = _ring.is_inited() && _ring.register_files({_fd}) == OMS_OK;
+  _file = file;
+  return OMS_OK;
+}
+
+void AppendFile::close()
+{
+  if (_fd < 0) {
+    return;
+  }
+  if (_file_registered) {
+    _ring.unregister_files();
+    _file_registered = false;
+  }
+  ::close(_fd);
+  _fd = -1;
+  _file.clear();
+}
+
+int AppendFile::append(const std::string& file, MsgBuf& content)
+{
+  if (file != _file && open(file) != OMS_OK) {
+    return OMS_FAILED;
+  }
+  std::vector<struct iovec> iovs;
+  iovs.reserve(content.count());
+  for (const auto& chunk : content) {
+    if (chunk.size() > 0) {
+      iovs.push_back({chunk.buffer(), chunk.size()});
+    }
+  }
+  if (iovs.empty()) {
+    return OMS_OK;
+  }
+  int ret = is_io_uring() ? write_io_uring(iovs) : write_sync(iovs.data(), iovs.size());
+  if (ret != OMS_OK) {
+    // reopen on the next append in case of the file removed or truncated
+    close();
+  }
+  return ret;
+}
+
+int AppendFile::write_io_uring(std::vector<struct iovec>& iovs)
+{
+  // writes of a buffer are linked to be done in order, the file is opened with O_APPEND so offsets are ignored
+  size_t done = 0;
+  while (done < iovs.size()) {
+    std::vector<std::pair<size_t, size_t>> batch;
+    struct io_uring_sqe* last = nullptr;
+    struct io_uring_sqe* sqe = nullptr;
+    while (done < iovs.size() && (sqe = _ring.get_sqe()) != nullptr) {
+      size_t count = std::min(iovs.size() - done, static_cast<size_t>(IOV_MAX));
+      sqe->opcode = IORING_OP_WRITEV;
+      sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+      sqe->fd = 0;
+      sqe->addr = reinterpret_cast<uint64_t>(&iovs[done]);
+      sqe->len = count;
+      sqe->user_data = batch.size();
+      batch.emplace_back(done, count);
+      done += count;
+      last = sqe;
+    }
+    last->flags &= ~IOSQE_IO_LINK;
+
+    int ret = _ring.submit(batch.size());
+    if (ret < static_cast<int>(batch.size())) {
+      // writes not submitted are dropped by the ring, the ones submitted still point to iovs until done
+      OMS_ERROR("Failed to submit writes to file: {}, submitted: {} of {}, reason: {}",
+          _file,
+          std::max(ret, 0),
+          batch.size(),
+          system_err(ret < 0 ? -ret : EAGAIN));
+      for (int i = 0; i < ret; ++i) {
+        struct io_uring_cqe cqe {};
+        if (_ring.wait_cqe(cqe) != OMS_OK) {
+          break;
+        }
+      }
+      return OMS_FAILED;
+    }
+    std::vector<int> results(batch.size(), 0);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      struct io_uring_cqe cqe {};
+      if (_ring.wait_cqe(cqe) != OMS_OK) {
+        return OMS_FAILED;
+      }
+      results[cqe.user_data] = cqe.res;
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+      size_t expected = 0;
+      for (size_t j = batch[i].first; j < batch[i].first + batch[i].second; ++j) {
+        expected += iovs[j].iov_len;
+      }
+      if (results[i] < 0) {
+        OMS_ERROR("Failed to write file: {}, reason: {}", _file, system_err(-results[i]));
+        return OMS_FAILED;
+      }
+      if (static_cast<size_t>(results[i]) < expected) {
+        // a short write breaks the link, the rest is written synchronously in order
+        size_t skip = results[i];
+        size_t j = batch[i].first;
+        for (; skip >= iovs[j].iov_len; ++j) {
+          skip -= iovs[j].iov_len;
+        }
+        iovs[j].iov_base = static_cast<char*>(iovs[j].iov_base) + skip;
+        iovs[j].iov_len -= skip;
+        return write_sync(&iovs[j], iovs.size() - j);
+      }
+    }
+  }
+  return OMS_OK;
+}
+
+int AppendFile::write_sync(struct iovec* iovs, size_t count)
+{
+  while (count > 0) {
+    ssize_t n = writev(_fd, iovs, std::min(count, static_cast<size_t>(IOV_MAX)));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OMS_ERROR("Failed to write file: {}, reason: {}", _file, system_err(errno));
+      return OMS_FAILED;
+    }
+    auto written = static_cast<size_t>(n);
+    while (count > 0 && written >= iovs->iov_len) {
+      written -= iovs->iov_len;
+      ++iovs;
+      --count;
+    }
+    if (count > 0) {
+      iovs->iov_base = static_cast<char*>(iovs->iov_base) + written;
+      iovs->iov_len -= written;
+    }
+  }
+  return OMS_OK;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "common.h"
+#include "msg_buf.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Submission and completion rings of io_uring set up by raw syscalls, used by one thread only
+ */
+class IoUring {
+  OMS_AVOID_COPY(IoUring);
+
+public:
+  IoUring() = default;
+
+  ~IoUring();
+
+  /*!
+   * @return OMS_FAILED if io_uring is unsupported by the kernel or forbidden, e.g. by seccomp
+   */
+  int init(uint32_t entries);
+
+  bool is_inited() const
+  {
+    return _ring_fd >= 0;
+  }
+
+  int register_files(const std::vector<int>& fds);
+
+  int unregister_files();
+
+  int register_buffers(const std::vector<struct iovec>& buffers);
+
+  /*!
+   * @return nullptr if the submission queue is full
+   */
+  struct io_uring_sqe* get_sqe();
+
+  /*!
+   * @brief Submit all sqes prepared and wait for at least wait_nr completions. Sqes not taken by the kernel are
+   * dropped instead of being left for the next submission, as buffers they point to may not outlive the caller
+   * @return sqes submitted, or -errno if none
+   */
+  int submit(uint32_t wait_nr = 0);
+
+  /*!
+   * @return false if no completion is ready
+   */
+  bool peek_cqe(struct io_uring_cqe& cqe);
+
+  int wait_cqe(struct io_uring_cqe& cqe);
+
+private:
+  int _ring_fd = -1;
+  struct io_uring_params _params {};
+
+  void* _sq_ptr = nullptr;
+  size_t _sq_ring_size = 0;
+  void* _cq_ptr = nullptr;
+  size_t _cq_ring_size = 0;
+  struct io_uring_sqe* _sqes = nullptr;
+  size_t _sqes_size = 0;
+
+  uint32_t* _sq_head = nullptr;
+  uint32_t* _sq_tail = nullptr;
+  uint32_t _sq_mask = 0;
+  uint32_t* _sq_array = nullptr;
+  uint32_t* _cq_head = nullptr;
+  uint32_t* _cq_tail = nullptr;
+  uint32_t _cq_mask = 0;
+  struct io_uring_cqe* _cqes = nullptr;
+
+  // sqes got but not submitted yet
+  uint32_t _sq_pending = 0;
+};
+
+/*!
+ * @brief Reader of a growing file, reading ahead chunks of it into fixed buffers. With io_uring, several chunks
+ * following the one read are kept in flight by batched submissions, otherwise a chunk is read by pread when needed
+ */
+class ReadAheadFile {
+  OMS_AVOID_COPY(ReadAheadFile);
+
+public:
+  /*!
+   * @param depth chunks read ahead, at least 2
+   */
+  ReadAheadFile(size_t chunk_size, uint32_t depth, bool use_io_uring);
+
+  ~ReadAheadFile();
+
+  int open(const std::string& file);
+
+  void close();
+
+  bool is_open() const
+  {
+    return _fd >= 0;
+  }
+
+  /*!
+   * @brief Whether the file opened is read by io_uring, which falls back to pread if the file is not registered
+   */
+  bool is_io_uring() const
+  {
+    return _ring.is_inited() && _file_registered;
+  }
+
+  /*!
+   * @brief Bytes at and after the limit are not read ahead, as they may not be written yet
+   */
+  void set_limit(uint64_t limit)
+  {
+    _limit = limit;
+  }
+
+  int read(uint64_t offset, unsigned char* buf, size_t len);
+
+  /*!
+   * @brief Bytes read from the file so far, including the ones read ahead
+   */
+  uint64_t bytes_read() const
+  {
+    return _bytes_read;
+  }
+
+private:
+  enum SlotState { EMPTY, IN_FLIGHT, READY };
+
+  struct Slot {
+    unsigned char* buf = nullptr;
+    uint64_t chunk = 0;
+    SlotState state = EMPTY;
+    // bytes of the chunk read, which are kept in flight as the ones read by a previous short read
+    size_t valid = 0;
+  };
+
+  int fill(uint64_t chunk, size_t needed);
+
+  /*!
+   * @brief Read [from, chunk_size) of the chunk, keeping bytes before from in its slot as read before
+   */
+  void submit_read(uint64_t chunk, size_t from = 0);
+
+  /*!
+   * @brief Submit reads prepared, slots of the ones dropped by the ring go back to what they held
+   */
+  int submit();
+
+  int wait_slot(Slot& slot);
+
+  void reap(const struct io_uring_cqe& cqe);
+
+  void drain();
+
+  int pread_fully(uint64_t offset, unsigned char* buf, size_t len, size_t& read_len);
+
+private:
+  size_t _chunk_size;
+  uint32_t _depth;
+  std::vector<Slot> _slots;
+  int _fd = -1;
+  uint64_t _limit = 0;
+  IoUring _ring;
+  bool _buffers_registered = false;
+  bool _file_registered = false;
+  uint32_t _in_flight = 0;
+  // chunks of reads prepared but not submitted yet
+  std::vector<uint64_t> _queued;
+  uint64_t _bytes_read = 0;
+};
+
+/*!
+ * @brief Appender keeping the file open across appends, writing each buffer by linked writev requests on the
+ * registered file with io_uring, otherwise by writev
+ */
+class AppendFile {
+  OMS_AVOID_COPY(AppendFile);
+
+public:
+  explicit AppendFile(bool use_io_uring);
+
+  ~AppendFile();
+
+  /*!
+   * @brief Append the content to the file, which is reopened if it differs from the last one
+   */
+  int append(const std::string& file, MsgBuf& content);
+
+  void close();
+
+  /*!
+   * @brief Whether the file opened is written by io_uring, which falls back to writev if the file is not registered
+   */
+  bool is_io_uring() const
+  {
+    return _ring.is_inited() && _file_registered;
+  }
+
+private:
+  int open(const std::string& file);
+
+  int write_io_uring(std::vector<struct iovec>& iovs);
+
+  int write_sync(struct iovec* iovs, size_t count);
+
+private:
+  std::string _file;
+  int _fd = -1;
+  IoUring _ring;
+  bool _file_registered = false;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
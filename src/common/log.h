@@ -19,7 +19,12 @@
 #include <set>
 #include <unordered_set>
 #include <list>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "rotating_file_with_compress_sink.hpp"
 #include "config.h"
@@ -293,9 +298,24 @@ public:
       fs::create_directories(log_dir);
     }
 
-    // create logger
-    _default_logger =
-        rotating_with_compress_logger_mt(logger_name, log_path, log_max_file_size_mb * 1024 * 1024, log_retention_h);
+    // create logger, records of async logger are formatted and written by a background thread through a bounded queue
+    Config& conf = Config::instance();
+    if (conf.log_async_queue_size.val() == 0) {
+      _default_logger = rotating_with_compress_logger_mt(
+          logger_name, log_path, log_max_file_size_mb * 1024 * 1024, log_retention_h);
+    } else {
+      spdlog::init_thread_pool(conf.log_async_queue_size.val(), 1);
+      if (conf.log_async_overflow_policy.val() == 0) {
+        _default_logger = rotating_with_compress_logger_mt<spdlog::async_factory>(
+            logger_name, log_path, log_max_file_size_mb * 1024 * 1024, log_retention_h);
+      } else {
+        _default_logger = rotating_with_compress_logger_mt<spdlog::async_factory_nonblock>(
+            logger_name, log_path, log_max_file_size_mb * 1024 * 1024, log_retention_h);
+      }
+      // records still queued are written out by the thread pool, which is joined by shutdown
+      static std::once_flag shutdown_at_exit;
+      std::call_once(shutdown_at_exit, []() { std::atexit([]() { spdlog::shutdown(); }); });
+    }
     if (nullptr != _default_logger) {
       _default_logger->set_pattern("[%Y-%m-%d %H:%M:%S] [%^%l%$] %s(%#): %v");
       _default_logger->flush_on(spdlog::level::level_enum(Config::instance().log_level.val()));
@@ -316,10 +336,58 @@ public:
     return _default_logger;
   }
 
+  /*!
+   * @brief Same as default_logger() without touching the reference count, for the logging macros
+   */
+  spdlog::logger* logger()
+  {
+    spdlog::logger* logger = _default_logger.get();
+    return nullptr == logger ? spdlog::default_logger_raw() : logger;
+  }
+
+  bool should_log(spdlog::level::level_enum log_level)
+  {
+    return logger()->should_log(log_level);
+  }
+
 private:
   std::shared_ptr<spdlog::logger> _default_logger;
 };
 
+/*!
+ * @brief Turns the "stream << ..." expression into void, so that a disabled OMS_STREAM_* evaluates nothing at all
+ */
+class LogVoidify {
+public:
+  void operator&(const std::ostream&)
+  {}
+};
+
+/*!
+ * @brief Allows one log per interval at a call site, counting the ones suppressed in between
+ */
+class LogRateLimiter {
+public:
+  bool allow(uint64_t interval_s, uint64_t& suppressed)
+  {
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+    int64_t last = _last_us.load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < (int64_t)interval_s * 1000000) ||
+        !_last_us.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+      _suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  std::atomic<int64_t> _last_us{0};
+  std::atomic<uint64_t> _suppressed{0};
+};
+
 class StreamLogger : public std::ostringstream {
 public:
   explicit StreamLogger(spdlog::source_loc source_loc, spdlog::level::level_enum log_level)
@@ -333,7 +401,7 @@ public:
 
   void flush()
   {
-    Logger::instance().default_logger()->log(_source_loc, _log_level, str().c_str());
+    Logger::instance().logger()->log(_source_loc, _log_level, spdlog::string_view_t(str()));
   }
 
 private:
@@ -370,9 +438,26 @@ void replace_spdlog_default_logger();
 #define LOG_LEVEL_ERROR 4
 #define LOG_LEVEL_FATAL 5
 
-#define LOG_BASE(level, fmt, ...)                                \
-  oceanbase::logproxy::Logger::instance().default_logger()->log( \
-      {__FILE__, __LINE__, __FUNCTION__}, level, fmt, ##__VA_ARGS__)
+#define LOG_BASE(level, fmt, ...) \
+  oceanbase::logproxy::Logger::instance().logger()->log({__FILE__, __LINE__, __FUNCTION__}, level, fmt, ##__VA_ARGS__)
+
+// the stream is neither constructed nor written when the level is disabled at runtime
+#define LOG_STREAM(level)                                                      \
+  !oceanbase::logproxy::Logger::instance().should_log(level)                   \
+      ? (void)0                                                                \
+      : oceanbase::logproxy::LogVoidify() &                                    \
+            oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, level)
+
+// log at most once every interval_s seconds at the call site, for retry loops
+#define LOG_EVERY(level, interval_s, fmt, ...)                                                         \
+  do {                                                                                                 \
+    static oceanbase::logproxy::LogRateLimiter _oms_log_limiter;                                      \
+    uint64_t _oms_log_suppressed = 0;                                                                 \
+    if (oceanbase::logproxy::Logger::instance().should_log(level) &&                                   \
+        _oms_log_limiter.allow(interval_s, _oms_log_suppressed)) {                                   \
+      LOG_BASE(level, fmt " (suppressed {} times)", ##__VA_ARGS__, _oms_log_suppressed);              \
+    }                                                                                                  \
+  } while (0)
 
 /* !!! HINT: the macros starts with "OMS_STREAM_" are for compatibility with the previous usage of glog,
  * and will be unified into the macros like "OMS_INFO" eventually.
@@ -380,7 +465,7 @@ void replace_spdlog_default_logger();
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_TRACE)
 #define OMS_TRACE(fmt, ...) LOG_BASE(spdlog::level::trace, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_TRACE oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::trace)
+#define OMS_STREAM_TRACE LOG_STREAM(spdlog::level::trace)
 #else
 #define OMS_TRACE(fmt, ...)
 #define OMS_STREAM_TRACE oceanbase::logproxy::EmptyStreamLogger()
@@ -388,7 +473,7 @@ void replace_spdlog_default_logger();
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_DEBUG)
 #define OMS_DEBUG(fmt, ...) LOG_BASE(spdlog::level::debug, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_DEBUG oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::debug)
+#define OMS_STREAM_DEBUG LOG_STREAM(spdlog::level::debug)
 #else
 #define OMS_DEBUG(fmt, ...)
 #define OMS_STREAM_DEBUG oceanbase::logproxy::EmptyStreamLogger()
@@ -396,23 +481,27 @@ void replace_spdlog_default_logger();
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_INFO)
 #define OMS_INFO(fmt, ...) LOG_BASE(spdlog::level::info, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_INFO oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::info)
+#define OMS_INFO_EVERY(interval_s, fmt, ...) LOG_EVERY(spdlog::level::info, interval_s, fmt, ##__VA_ARGS__)
+#define OMS_STREAM_INFO LOG_STREAM(spdlog::level::info)
 #else
 #define OMS_INFO(fmt, ...)
+#define OMS_INFO_EVERY(interval_s, fmt, ...)
 #define OMS_STREAM_INFO oceanbase::logproxy::EmptyStreamLogger()
 #endif
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_WARN)
 #define OMS_WARN(fmt, ...) LOG_BASE(spdlog::level::warn, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_WARN oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::warn)
+#define OMS_WARN_EVERY(interval_s, fmt, ...) LOG_EVERY(spdlog::level::warn, interval_s, fmt, ##__VA_ARGS__)
+#define OMS_STREAM_WARN LOG_STREAM(spdlog::level::warn)
 #else
 #define OMS_WARN(fmt, ...)
+#define OMS_WARN_EVERY(interval_s, fmt, ...)
 #define OMS_STREAM_WARN oceanbase::logproxy::EmptyStreamLogger()
 #endif
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_ERROR)
 #define OMS_ERROR(fmt, ...) LOG_BASE(spdlog::level::err, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_ERROR oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::err)
+#define OMS_STREAM_ERROR LOG_STREAM(spdlog::level::err)
 #else
 #define OMS_ERROR(fmt, ...)
 #define OMS_STREAM_ERROR oceanbase::logproxy::EmptyStreamLogger()
@@ -420,7 +509,7 @@ void replace_spdlog_default_logger();
 
 #if (LOGGER_LEVEL <= LOG_LEVEL_FATAL)
 #define OMS_FATAL(fmt, ...) LOG_BASE(spdlog::level::critical, fmt, ##__VA_ARGS__)
-#define OMS_STREAM_FATAL oceanbase::logproxy::StreamLogger({__FILE__, __LINE__, __FUNCTION__}, spdlog::level::critical)
+#define OMS_STREAM_FATAL LOG_STREAM(spdlog::level::critical)
 #else
 #define OMS_FATAL(fmt, ...)
 #define OMS_STREAM_FATAL oceanbase::logproxy::EmptyStreamLogger()
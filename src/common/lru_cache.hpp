@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace oceanbase {
+namespace logproxy {
+/*!
+ * @brief Thread safe cache evicting the least recently used entry beyond capacity, which is given on each put so
+ * that it follows configurations changed at runtime
+ */
+template <typename K, typename V>
+class LruCache {
+public:
+  /*!
+   * @brief Copy out the value cached of key, which becomes the most recently used
+   * @return false if not cached
+   */
+  bool get(const K& key, V& value)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _index.find(key);
+    if (iter == _index.end()) {
+      return false;
+    }
+    _entries.splice(_entries.begin(), _entries, iter->second);
+    value = iter->second->second;
+    return true;
+  }
+
+  /*!
+   * @brief Cache the value unless key cached already, e.g. put by another thread meanwhile
+   * @param capacity 0 caches nothing
+   */
+  void put(const K& key, V value, size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (capacity == 0 || _index.find(key) != _index.end()) {
+      return;
+    }
+    _entries.emplace_front(key, std::move(value));
+    _index[key] = _entries.begin();
+    while (_entries.size() > capacity) {
+      _index.erase(_entries.back().first);
+      _entries.pop_back();
+    }
+  }
+
+  size_t size()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+  }
+
+private:
+  using Entry = std::pair<K, V>;
+
+  std::mutex _mutex;
+  // most recently used first
+  std::list<Entry> _entries;
+  std::unordered_map<K, typename std::list<Entry>::iterator> _index;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
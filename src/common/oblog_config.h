@@ -29,6 +29,10 @@ public:
   OMS_CONFIG_STR(id, "");
   OMS_CONFIG_STR_K(sys_user, "sys_user", "");
   OMS_CONFIG_STR_K(sys_password, "sys_password", "");
+  // columns sent of tables, others sent as NULL, syntax: tenant.db.table:col1,col2|tenant.db.*:col1
+  OMS_CONFIG_STR_K(table_columns, "tb_column_list", "");
+  // rows sent of tables, syntax: tenant.db.table:op=insert,update;col1=v1,v2;col2>=100|tenant.db.*:col1!=v1
+  OMS_CONFIG_STR_K(row_filters, "tb_row_filter", "");
 
   // from here to beflow, params use to send to liboblog
   OMS_CONFIG_UINT64_K(start_timestamp, "first_start_timestamp", 0);
@@ -0,0 +1,400 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <fnmatch.h>
+#include <strings.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "common.h"
+#include "str.h"
+#include "record_filter.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static bool to_number(const char* str, size_t size, double& number)
+{
+  if (str == nullptr || size == 0 || isspace(str[0])) {
+    return false;
+  }
+  // values are not null terminated
+  std::string value(str, size);
+  char* end = nullptr;
+  number = strtod(value.c_str(), &end);
+  return end == value.c_str() + size;
+}
+
+static int compare(const char* value, size_t size, const std::string& literal, bool numeric, double number)
+{
+  double value_number = 0;
+  if (numeric && to_number(value, size, value_number)) {
+    return value_number < number ? -1 : (value_number > number ? 1 : 0);
+  }
+  int ret = memcmp(value, literal.data(), std::min(size, literal.size()));
+  if (ret != 0) {
+    return ret;
+  }
+  return size < literal.size() ? -1 : (size > literal.size() ? 1 : 0);
+}
+
+static bool is_row(int record_type)
+{
+  return record_type == EINSERT || record_type == EUPDATE || record_type == EDELETE || record_type == EREPLACE;
+}
+
+static int to_record_type(const std::string& op)
+{
+  if (strcasecmp(op.c_str(), "insert") == 0) {
+    return EINSERT;
+  }
+  if (strcasecmp(op.c_str(), "update") == 0) {
+    return EUPDATE;
+  }
+  if (strcasecmp(op.c_str(), "delete") == 0) {
+    return EDELETE;
+  }
+  if (strcasecmp(op.c_str(), "replace") == 0) {
+    return EREPLACE;
+  }
+  return -1;
+}
+
+int ColumnCondition::parse(const std::string& str, ColumnCondition& condition, std::string& errmsg)
+{
+  size_t pos = str.find_first_of("!=<>");
+  if (pos == std::string::npos || pos == 0) {
+    errmsg = "Invalid condition: " + str;
+    return OMS_FAILED;
+  }
+  size_t value_pos = pos + 1;
+  bool or_equal = value_pos < str.size() && str[value_pos] == '=';
+  switch (str[pos]) {
+    case '=':
+      condition.op = Op::EQ;
+      break;
+    case '!':
+      if (!or_equal) {
+        errmsg = "Invalid condition: " + str;
+        return OMS_FAILED;
+      }
+      condition.op = Op::NE;
+      break;
+    case '<':
+      condition.op = or_equal ? Op::LE : Op::LT;
+      break;
+    default:
+      condition.op = or_equal ? Op::GE : Op::GT;
+      break;
+  }
+  if (or_equal && condition.op != Op::EQ) {
+    ++value_pos;
+  }
+
+  condition.column = str.substr(0, pos);
+  trim(condition.column);
+  condition.values.clear();
+  if (condition.op == Op::EQ || condition.op == Op::NE) {
+    split(str.substr(value_pos), ',', condition.values);
+  } else {
+    condition.values.push_back(str.substr(value_pos));
+  }
+  if (condition.column.empty() || condition.values.empty()) {
+    errmsg = "Invalid condition: " + str;
+    return OMS_FAILED;
+  }
+
+  condition.numbers.assign(condition.values.size(), 0);
+  condition.numeric.assign(condition.values.size(), false);
+  for (size_t i = 0; i < condition.values.size(); ++i) {
+    trim(condition.values[i]);
+    condition.numeric[i] = to_number(condition.values[i].data(), condition.values[i].size(), condition.numbers[i]);
+  }
+  return OMS_OK;
+}
+
+bool ColumnCondition::eval(const char* value, size_t size) const
+{
+  if (value == nullptr) {
+    return false;
+  }
+  switch (op) {
+    case Op::EQ:
+    case Op::NE:
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (compare(value, size, values[i], numeric[i], numbers[i]) == 0) {
+          return op == Op::EQ;
+        }
+      }
+      return op == Op::NE;
+    case Op::LT:
+      return compare(value, size, values[0], numeric[0], numbers[0]) < 0;
+    case Op::LE:
+      return compare(value, size, values[0], numeric[0], numbers[0]) <= 0;
+    case Op::GT:
+      return compare(value, size, values[0], numeric[0], numbers[0]) > 0;
+    case Op::GE:
+      return compare(value, size, values[0], numeric[0], numbers[0]) >= 0;
+  }
+  return false;
+}
+
+int RecordFilter::init(const std::string& column_list, const std::string& row_filter, std::string& errmsg)
+{
+  _column_rules.clear();
+  _row_rules.clear();
+  _tables.clear();
+  if (parse_rules(column_list, false, _column_rules, errmsg) != OMS_OK) {
+    errmsg = "Invalid tb_column_list, " + errmsg;
+    return OMS_FAILED;
+  }
+  if (parse_rules(row_filter, true, _row_rules, errmsg) != OMS_OK) {
+    errmsg = "Invalid tb_row_filter, " + errmsg;
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+int RecordFilter::parse_rules(
+    const std::string& str, bool with_conditions, std::vector<TableRule>& rules, std::string& errmsg)
+{
+  std::vector<std::string> tables;
+  split(str, '|', tables);
+  for (std::string& table : tables) {
+    trim(table);
+    if (table.empty()) {
+      continue;
+    }
+    // tenant.db.table:...
+    std::vector<std::string> parts;
+    split(table, ':', parts, true);
+    if (parts.size() != 2 || std::count(parts[0].begin(), parts[0].end(), '.') != 2) {
+      errmsg = "expected tenant.db.table:..., got: " + table;
+      return OMS_FAILED;
+    }
+
+    TableRule rule;
+    rule.pattern = parts[0];
+    trim(rule.pattern);
+    if (!with_conditions) {
+      split(parts[1], ',', rule.columns);
+      for (std::string& column : rule.columns) {
+        trim(column);
+      }
+      if (rule.columns.empty()) {
+        errmsg = "no column of table: " + rule.pattern;
+        return OMS_FAILED;
+      }
+      rules.push_back(std::move(rule));
+      continue;
+    }
+
+    std::vector<std::string> conditions;
+    split(parts[1], ';', conditions);
+    for (std::string& str_condition : conditions) {
+      trim(str_condition);
+      if (str_condition.empty()) {
+        continue;
+      }
+      ColumnCondition condition;
+      if (ColumnCondition::parse(str_condition, condition, errmsg) != OMS_OK) {
+        return OMS_FAILED;
+      }
+      // op=insert,update restricts types of rows rather than a column
+      if (condition.column == "op") {
+        if (condition.op != ColumnCondition::Op::EQ) {
+          errmsg = "only = is supported for op, got: " + str_condition;
+          return OMS_FAILED;
+        }
+        for (const std::string& op : condition.values) {
+          int record_type = to_record_type(op);
+          if (record_type < 0) {
+            errmsg = "unknown op: " + op + ", expected insert, update, delete or replace";
+            return OMS_FAILED;
+          }
+          rule.record_types.insert(record_type);
+        }
+        continue;
+      }
+      rule.conditions.push_back(std::move(condition));
+    }
+    rules.push_back(std::move(rule));
+  }
+  return OMS_OK;
+}
+
+// whether the column is still at index of meta, or still missing if index is -1
+static bool same_index(ITableMeta* meta, const std::string& column, int index)
+{
+  if (index < 0) {
+    return meta->getColIndex(column.c_str()) < 0;
+  }
+  IColMeta* col_meta = meta->getCol(index);
+  return col_meta != nullptr && col_meta->getName() != nullptr && column == col_meta->getName();
+}
+
+bool RecordFilter::TableState::resolved(ITableMeta* meta) const
+{
+  if (column_count != meta->getColCount()) {
+    return false;
+  }
+  if (column_rule != nullptr) {
+    for (size_t i = 0; i < column_rule->columns.size(); ++i) {
+      if (!same_index(meta, column_rule->columns[i], projected_columns[i])) {
+        return false;
+      }
+    }
+  }
+  if (row_rule != nullptr) {
+    for (size_t i = 0; i < row_rule->conditions.size(); ++i) {
+      if (!same_index(meta, row_rule->conditions[i].column, condition_columns[i])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+RecordFilter::TableState* RecordFilter::resolve(ILogRecord* record)
+{
+  ITableMeta* meta = record->getTableMeta();
+  if (meta == nullptr || record->dbname() == nullptr || record->tbname() == nullptr) {
+    return nullptr;
+  }
+
+  // dbname is tenant.db
+  std::string name = std::string(record->dbname()) + "." + record->tbname();
+  auto iter = _tables.find(name);
+  if (iter == _tables.end()) {
+    TableState table;
+    for (const TableRule& rule : _column_rules) {
+      if (fnmatch(rule.pattern.c_str(), name.c_str(), 0) == 0) {
+        table.column_rule = &rule;
+        break;
+      }
+    }
+    for (const TableRule& rule : _row_rules) {
+      if (fnmatch(rule.pattern.c_str(), name.c_str(), 0) == 0) {
+        table.row_rule = &rule;
+        break;
+      }
+    }
+    iter = _tables.emplace(name, std::move(table)).first;
+  }
+
+  // meta changes with DDL, so column indexes are resolved again
+  TableState& table = iter->second;
+  if (!table.resolved(meta)) {
+    table.column_count = meta->getColCount();
+    if (table.column_rule != nullptr) {
+      table.projected.assign(table.column_count, false);
+      table.projected_columns.clear();
+      for (const std::string& column : table.column_rule->columns) {
+        int index = meta->getColIndex(column.c_str());
+        if (index >= table.column_count) {
+          index = -1;
+        }
+        if (index >= 0) {
+          table.projected[index] = true;
+        }
+        table.projected_columns.push_back(index);
+      }
+    }
+    if (table.row_rule != nullptr) {
+      table.condition_columns.clear();
+      for (const ColumnCondition& condition : table.row_rule->conditions) {
+        int index = meta->getColIndex(condition.column.c_str());
+        table.condition_columns.push_back(index < table.column_count ? index : -1);
+      }
+    }
+  }
+  return &table;
+}
+
+bool RecordFilter::accept(ILogRecord* record)
+{
+  int record_type = record->recordType();
+  if (_row_rules.empty() || !is_row(record_type)) {
+    return true;
+  }
+  TableState* table = resolve(record);
+  if (table == nullptr || table->row_rule == nullptr) {
+    return true;
+  }
+
+  const TableRule& rule = *table->row_rule;
+  if (!rule.record_types.empty() && rule.record_types.count(record_type) == 0) {
+    return false;
+  }
+  if (rule.conditions.empty()) {
+    return true;
+  }
+  unsigned int count = 0;
+  BinLogBuf* cols = record_type == EDELETE ? record->oldCols(count) : record->newCols(count);
+  for (size_t i = 0; i < rule.conditions.size(); ++i) {
+    int index = table->condition_columns[i];
+    if (cols == nullptr || index < 0 || index >= (int)count ||
+        !rule.conditions[i].eval(cols[index].buf, cols[index].buf_used_size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RecordFilter::project(ILogRecord* record)
+{
+  if (_column_rules.empty() || !is_row(record->recordType())) {
+    return;
+  }
+  TableState* table = resolve(record);
+  if (table == nullptr || table->column_rule == nullptr) {
+    return;
+  }
+  unsigned int count = 0;
+  BinLogBuf* cols = record->oldCols(count);
+  project(cols, count, table->projected, _saved_old);
+  cols = record->newCols(count);
+  project(cols, count, table->projected, _saved_new);
+}
+
+void RecordFilter::project(
+    BinLogBuf* cols, unsigned int count, const std::vector<bool>& projected, std::vector<BinLogBuf>& saved)
+{
+  if (cols == nullptr || count == 0) {
+    return;
+  }
+  saved.assign(cols, cols + count);
+  for (unsigned int i = 0; i < count; ++i) {
+    if (i >= projected.size() || !projected[i]) {
+      cols[i].buf = nullptr;
+      cols[i].buf_used_size = 0;
+    }
+  }
+}
+
+void RecordFilter::restore(ILogRecord* record)
+{
+  unsigned int count = 0;
+  if (!_saved_old.empty()) {
+    BinLogBuf* cols = record->oldCols(count);
+    std::copy(_saved_old.begin(), _saved_old.begin() + std::min((size_t)count, _saved_old.size()), cols);
+    _saved_old.clear();
+  }
+  if (!_saved_new.empty()) {
+    BinLogBuf* cols = record->newCols(count);
+    std::copy(_saved_new.begin(), _saved_new.begin() + std::min((size_t)count, _saved_new.size()), cols);
+    _saved_new.clear();
+  }
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "log_record.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Condition on a column value of a row, compared as numbers if both sides are numeric, or else as bytes.
+ * NULL never meets any condition
+ */
+struct ColumnCondition {
+  enum class Op {
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+  };
+
+  std::string column;
+  Op op = Op::EQ;
+  // more than one for EQ and NE only, as IN and NOT IN
+  std::vector<std::string> values;
+  std::vector<double> numbers;
+  std::vector<bool> numeric;
+
+  /*!
+   * @param str e.g. status=1,2 or amount>=100
+   */
+  static int parse(const std::string& str, ColumnCondition& condition, std::string& errmsg);
+
+  bool eval(const char* value, size_t size) const;
+};
+
+/*!
+ * @brief Rule of tables matching pattern tenant.db.table, in which * matches any characters
+ */
+struct TableRule {
+  std::string pattern;
+  // columns projected
+  std::vector<std::string> columns;
+  // types of rows passed, any if empty
+  std::set<int> record_types;
+  // all met by rows passed
+  std::vector<ColumnCondition> conditions;
+};
+
+/*!
+ * @brief Column projection and row filtering pushed down by handshake configuration of a client, applied before
+ * records serialized so that columns and rows discarded by client cost neither encoding nor network.
+ * Only rows of insert, update, delete and replace are subject to them, and the first rule matching a table applies.
+ */
+class RecordFilter {
+public:
+  /*!
+   * @param column_list tb_column_list, e.g. t1.db1.orders:id,status|t1.db1.*:id
+   * @param row_filter tb_row_filter, e.g. t1.db1.orders:op=insert,update;status=1,2;amount>=100
+   * @param errmsg[out] the invalid part if any
+   */
+  int init(const std::string& column_list, const std::string& row_filter, std::string& errmsg);
+
+  inline bool enabled() const
+  {
+    return !_column_rules.empty() || !_row_rules.empty();
+  }
+
+  /*!
+   * @return false if record is a row of which type or values do not meet the filter of its table,
+   * conditions are evaluated on values after update, or before delete
+   */
+  bool accept(ILogRecord* record);
+
+  /*!
+   * @brief Clear values of columns not projected, sent as NULL, which must be restored once record serialized
+   */
+  void project(ILogRecord* record);
+
+  void restore(ILogRecord* record);
+
+  /*!
+   * @brief Clear values of an image not projected, of which original values are saved
+   */
+  static void project(BinLogBuf* cols, unsigned int count, const std::vector<bool>& projected,
+      std::vector<BinLogBuf>& saved);
+
+private:
+  // rules resolved for a table of its current meta
+  struct TableState {
+    const TableRule* column_rule = nullptr;
+    const TableRule* row_rule = nullptr;
+    // columns of the meta resolved, -1 if never resolved
+    int column_count = -1;
+    std::vector<bool> projected;
+    // index in meta of each column projected, -1 if not found
+    std::vector<int> projected_columns;
+    // index in meta of the column of each condition, -1 if not found, which no row meets
+    std::vector<int> condition_columns;
+
+    /*!
+     * @brief Whether resolved indexes still hold for the meta, checked by column names rather than the address of
+     * meta, which may be reused by a meta after DDL
+     */
+    bool resolved(ITableMeta* meta) const;
+  };
+
+  static int parse_rules(const std::string& str, bool with_conditions, std::vector<TableRule>& rules,
+      std::string& errmsg);
+
+  TableState* resolve(ILogRecord* record);
+
+private:
+  std::vector<TableRule> _column_rules;
+  std::vector<TableRule> _row_rules;
+  // by tenant.db.table
+  std::unordered_map<std::string, TableState> _tables;
+
+  // values of the record being projected
+  std::vector<BinLogBuf> _saved_old;
+  std::vector<BinLogBuf> _saved_new;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include "common.h"
+#include "log.h"
+#include "spawner.h"
+
+// same number on all architectures, missing in headers older than linux 5.9
+#ifndef __NR_close_range
+#define __NR_close_range 436
+#endif
+
+namespace oceanbase {
+namespace logproxy {
+
+struct linux_dirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+
+/*
+ * Functions below run in the vfork child, which shares the memory and the stack of the parent until execv: nothing
+ * is allocated, locked or logged there, and only async-signal-safe syscalls are made.
+ */
+
+static int parse_fd(const char* name)
+{
+  int fd = 0;
+  for (; *name != '\0'; ++name) {
+    if (*name < '0' || *name > '9') {
+      return -1;
+    }
+    fd = fd * 10 + (*name - '0');
+  }
+  return fd;
+}
+
+// close fds in [low, high] open in the child, listed by /proc, for kernels without close_range
+static bool close_listed_fds(int low, int high)
+{
+  int dir = ::open("/proc/self/fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir < 0) {
+    return false;
+  }
+  char buf[4096];
+  long len;
+  while ((len = ::syscall(SYS_getdents64, dir, buf, sizeof(buf))) > 0) {
+    for (long offset = 0; offset < len;) {
+      auto* entry = reinterpret_cast<struct linux_dirent64*>(buf + offset);
+      int fd = parse_fd(entry->d_name);
+      if (fd >= low && fd <= high && fd != dir) {
+        ::close(fd);
+      }
+      offset += entry->d_reclen;
+    }
+  }
+  ::close(dir);
+  return len == 0;
+}
+
+static void close_fds(int low, int high, int max_fd)
+{
+  if (::syscall(__NR_close_range, static_cast<unsigned int>(low), static_cast<unsigned int>(high), 0) == 0 ||
+      close_listed_fds(low, high)) {
+    return;
+  }
+  for (int fd = low; fd <= std::min(high, max_fd); ++fd) {
+    ::close(fd);
+  }
+}
+
+static void exec_child(const char* path, char* const* argv, const int* fds, size_t fd_count, int max_fd,
+    const sigset_t& old_mask, volatile int& exec_errno)
+{
+  // handlers of the parent make no sense in the child, while ignored signals are kept ignored as by fork
+  for (int sig = 1; sig < NSIG; ++sig) {
+    struct sigaction action {};
+    if (::sigaction(sig, nullptr, &action) == 0 && action.sa_handler != SIG_IGN && action.sa_handler != SIG_DFL) {
+      action.sa_handler = SIG_DFL;
+      action.sa_flags = 0;
+      ::sigaction(sig, &action, nullptr);
+    }
+  }
+
+  int low = STDERR_FILENO + 1;
+  for (size_t i = 0; i < fd_count; ++i) {
+    if (fds[i] > low) {
+      close_fds(low, fds[i] - 1, max_fd);
+    }
+    ::fcntl(fds[i], F_SETFD, 0);
+    low = fds[i] + 1;
+  }
+  close_fds(low, INT_MAX, max_fd);
+
+  ::pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+  ::execv(path, argv);
+  exec_errno = errno;
+  ::_exit(127);
+}
+
+int spawn_process(const std::string& path, const std::vector<std::string>& args, const std::vector<int>& inherited_fds)
+{
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  std::vector<int> fds;
+  for (int fd : inherited_fds) {
+    if (fd > STDERR_FILENO) {
+      fds.push_back(fd);
+    }
+  }
+  std::sort(fds.begin(), fds.end());
+  fds.erase(std::unique(fds.begin(), fds.end()), fds.end());
+
+  struct rlimit limit {};
+  int max_fd = (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+                   ? static_cast<int>(std::min<rlim_t>(limit.rlim_cur, INT_MAX))
+                   : 65536;
+
+  // no signal is handled by the child before its handlers are reset, as they would run on memory of the parent
+  sigset_t all_mask;
+  sigset_t old_mask;
+  sigfillset(&all_mask);
+  ::pthread_sigmask(SIG_SETMASK, &all_mask, &old_mask);
+
+  volatile int exec_errno = 0;
+  pid_t pid = ::vfork();
+  if (pid == 0) {
+    exec_child(path.c_str(), argv.data(), fds.data(), fds.size(), max_fd, old_mask, exec_errno);
+  }
+  int err = errno;
+  ::pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+  if (pid < 0) {
+    OMS_ERROR("Failed to vfork for {}: {}({})", path, err, strerror(err));
+    return OMS_FAILED;
+  }
+  // the parent resumes once the child has exec-ed or exited, after which exec_errno is set if execv failed
+  if (exec_errno != 0) {
+    OMS_ERROR("Failed to exec {}: {}({})", path, exec_errno, strerror(exec_errno));
+    ::waitpid(pid, nullptr, 0);
+    return OMS_FAILED;
+  }
+  return pid;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,32 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Launch a program in a child process cloned by vfork, which shares the memory of this process until execv
+ * instead of copying its page tables, so launching costs the same however large this process grows. The child
+ * inherits stdio and the fds listed only, at their numbers, the others are closed by close_range in one syscall
+ * @param args arguments of the program, the first one being its name
+ * @param inherited_fds fds the program is told of, e.g. by its arguments or configs, close-on-exec or not
+ * @return pid of the child, or OMS_FAILED if the child failed to be created or to exec the program
+ */
+int spawn_process(const std::string& path, const std::vector<std::string>& args, const std::vector<int>& inherited_fds);
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -151,5 +151,43 @@ std::string pad_right(const std::string* value, int size, char padding)
   }
 }
 
+std::string normalize_sql(const std::string& query)
+{
+  size_t begin = query.find_first_not_of(" \t\r\n");
+  size_t end = query.find_last_not_of(" \t\r\n;");
+  if (begin == std::string::npos || end == std::string::npos || end < begin) {
+    return "";
+  }
+
+  std::string normalized;
+  normalized.reserve(end - begin + 1);
+  char quote = 0;
+  for (size_t i = begin; i <= end; ++i) {
+    char c = query[i];
+    if (quote != 0) {
+      normalized.push_back(c);
+      if (c == '\\' && i < end) {
+        normalized.push_back(query[++i]);
+      } else if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+    if (c == '\'' || c == '"' || c == '`') {
+      quote = c;
+    } else if (c == '#' || (i < end && ((c == '-' && query[i + 1] == '-') || (c == '/' && query[i + 1] == '*')))) {
+      // collapsing would move text following a line comment into it
+      return query.substr(begin, end - begin + 1);
+    } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      if (normalized.back() != ' ') {
+        normalized.push_back(' ');
+      }
+      continue;
+    }
+    normalized.push_back(c);
+  }
+  return normalized;
+}
+
 }  // namespace logproxy
 }  // namespace oceanbase
\ No newline at end of file
@@ -61,6 +61,12 @@ void rtrim(std::string& s);
  */
 void trim(std::string& s);
 
+/*!
+ * @brief Trim the query, strip trailing semicolons and collapse whitespace outside quotes, queries with comments are
+ * only trimmed
+ */
+std::string normalize_sql(const std::string& query);
+
 }  // namespace logproxy
 }  // namespace oceanbase
 
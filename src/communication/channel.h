@@ -23,6 +23,7 @@
 #include "config.h"
 #include "event.h"
 #include "peer.h"
+#include "msg_buf.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -83,6 +84,21 @@ public:
    */
   virtual int writen(const char* buf, int size) = 0;
 
+  /**
+   * write all chunks of the buffer to the channel
+   * @return OMS_OK all bytes has been write into the channel
+   *         OMS_FAILED some errors occurs
+   */
+  virtual int writev(const MsgBuf& buffer)
+  {
+    for (const auto& chunk : buffer) {
+      if (OMS_OK != writen(chunk.buffer(), chunk.size())) {
+        return OMS_FAILED;
+      }
+    }
+    return OMS_OK;
+  }
+
   /**
    * Get the last error message.
    * It will use the errno internal.
@@ -143,6 +159,7 @@ public:
   int readn(char* buf, int size) override;
   int write(const char* buf, int size) override;
   int writen(const char* buf, int size) override;
+  int writev(const MsgBuf& buffer) override;
 
   const char* last_error() override;
 };
@@ -165,9 +182,18 @@ public:
   int readn(char* buf, int size) override;
   int write(const char* buf, int size) override;
   int writen(const char* buf, int size) override;
+  int writev(const MsgBuf& buffer) override;
 
   const char* last_error() override;
 
+  /**
+   * whether records sent are encrypted by the kernel, by which plain bytes are written to the socket directly
+   */
+  bool is_ktls_send() const
+  {
+    return _ktls_send;
+  }
+
 private:
   // int verify(int preverify_ok, X509_STORE_CTX* ctx);
 
@@ -175,10 +201,13 @@ private:
 
   int handle_error(int ret);
 
+  void check_ktls();
+
 private:
   static SSL_CTX* _s_ssl_ctx;
 
   SSL* _ssl = nullptr;
+  bool _ktls_send = false;
 
   int _last_error = 0;
   char _error_string[256];
@@ -15,6 +15,8 @@
 #include <arpa/inet.h>
 #include <deque>
 #include <fcntl.h>
+#include <sys/eventfd.h>
+#include <event2/listener.h>
 
 #include "communication/comm.h"
 #include "communication/io.h"
@@ -48,6 +50,10 @@ Comm::~Comm()
   // FIXME... memory leak, but coredump
   //  event_base_free(_event_base);
   _event_base = nullptr;
+  if (_post_fd >= 0) {
+    close(_post_fd);
+    _post_fd = -1;
+  }
 }
 
 int Comm::stop(int reserved_fd)
@@ -68,10 +74,16 @@ int Comm::stop(int reserved_fd)
 
 void Comm::close_listen()
 {
-  if (_listenfd > 0) {
-    OMS_STREAM_WARN << ">>> Communicator disabled listening, fd: " << _listenfd;
-    close(_listenfd);
-    _listenfd = 0;
+  if (_listener != nullptr) {
+    int listenfd = evconnlistener_get_fd(_listener);
+    OMS_STREAM_WARN << ">>> Communicator disabled listening, fd: " << listenfd;
+    if (getpid() != _owner_pid) {
+      // forked child shares the epoll instance with parent, deleting listener from it would stop parent accepting
+      close(listenfd);
+    } else {
+      evconnlistener_free(_listener);
+    }
+    _listener = nullptr;
   }
 }
 
@@ -87,51 +99,78 @@ int Comm::init()
     OMS_STREAM_ERROR << "Failed to create event base. system error " << strerror(errno);
     return OMS_FAILED;
   }
+  _owner_pid = getpid();
 
+  _post_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (_post_fd < 0) {
+    OMS_STREAM_ERROR << "Failed to create eventfd. system error " << strerror(errno);
+    return OMS_FAILED;
+  }
+  _post_event = event_new(_event_base, _post_fd, EV_READ | EV_PERSIST, _s_evcb_on_post, this);
+  if (_post_event == nullptr || event_add(_post_event, nullptr) < 0) {
+    OMS_STREAM_ERROR << "Failed to add event of posted tasks";
+    return OMS_FAILED;
+  }
   return OMS_OK;
 }
 
 int Comm::listen(uint16_t listen_port)
 {
-  if (_listenfd > 0) {
+  if (_listener != nullptr) {
     return OMS_OK;
   }
 
-  _listenfd = oceanbase::logproxy::listen(nullptr, listen_port, false, true);
-  if (_listenfd <= 0) {
+  struct sockaddr_in sin;
+  memset(&sin, 0, sizeof(sin));
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = INADDR_ANY;
+  sin.sin_port = htons(listen_port);
+  unsigned flags = LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE | LEV_OPT_CLOSE_ON_EXEC;
+  if (_s_conf.listen_reuse_port.val()) {
+    flags |= LEV_OPT_REUSEABLE_PORT;
+  }
+  _listener = evconnlistener_new_bind(_event_base,
+      _s_evcb_on_listen,
+      this,
+      flags,
+      (int)_s_conf.listen_backlog.val(),
+      reinterpret_cast<const struct sockaddr*>(&sin),
+      sizeof(sin));
+  if (_listener == nullptr) {
+    OMS_STREAM_ERROR << "Failed to listen on port: " << listen_port << ", error: " << strerror(errno);
     return OMS_FAILED;
   }
-  fcntl(_listenfd, F_SETFD, FD_CLOEXEC);
-  OMS_STREAM_INFO << "+++ Listen on port: " << listen_port << ", fd: " << _listenfd;
+  evconnlistener_set_error_cb(_listener, _s_evcb_on_accept_error);
+  OMS_STREAM_INFO << "+++ Listen on port: " << listen_port << ", fd: " << evconnlistener_get_fd(_listener)
+                  << ", backlog: " << _s_conf.listen_backlog.val();
   return OMS_OK;
 }
 
 int Comm::start()
 {
+  if (_listener == nullptr) {
+    OMS_STREAM_WARN << "Communicator not listening, quit";
+    return OMS_OK;
+  }
   OMS_STREAM_INFO << "+++ Communicator about to start";
 
-  while (_listenfd > 0) {
-    int ret = poll();
-    if (ret != OMS_OK && ret != OMS_AGAIN) {
-      OMS_STREAM_ERROR << "Failed to poll communication, ret: " << ret;
-      break;
-    }
-
-    struct sockaddr_in peer_addr;
-    socklen_t peer_addr_size = sizeof(struct sockaddr_in);
-    int connfd = accept(_listenfd, (struct sockaddr*)&peer_addr, &peer_addr_size);
-    if (connfd > 0) {
-      _s_evcb_on_accept(connfd, peer_addr);
-      continue;  // may be other connection, dealing directly
-    }
-
-    if (_routine_callback) {
-      _routine_callback();
-    }
+  // connections are accepted as soon as they arrive, and routine callback runs every accept_interval_us
+  _routine_event = event_new(_event_base, -1, EV_PERSIST, _s_evcb_on_routine, this);
+  if (_routine_event == nullptr) {
+    OMS_STREAM_ERROR << "Failed to create routine event";
+    return OMS_FAILED;
+  }
+  struct timeval interval = {(time_t)(_s_conf.accept_interval_us.val() / 1000000),
+      (suseconds_t)(_s_conf.accept_interval_us.val() % 1000000)};
+  event_add(_routine_event, &interval);
 
-    usleep(_s_conf.accept_interval_us.val());
+  int ret = event_base_dispatch(_event_base);
+  if (ret == -1) {
+    OMS_STREAM_ERROR << "Failed to run Comm, event base dispatch error, ret: " << ret;
   }
 
+  event_free(_routine_event);
+  _routine_event = nullptr;
   OMS_STREAM_WARN << "!!! Communicator about to quit";
   return OMS_OK;
 }
@@ -170,6 +209,70 @@ void Comm::_s_evcb_on_accept(int fd, const struct sockaddr_in& peer_addr)
   }
 }
 
+void Comm::_s_evcb_on_listen(struct evconnlistener*, int fd, struct sockaddr* addr, int len, void* arg)
+{
+  Comm& comm = *(Comm*)arg;
+  if (addr->sa_family != AF_INET || len < (int)sizeof(struct sockaddr_in)) {
+    OMS_STREAM_WARN << "Unsupported address family: " << addr->sa_family << ", fd: " << fd;
+    evutil_closesocket(fd);
+    return;
+  }
+  comm._s_evcb_on_accept(fd, *(struct sockaddr_in*)addr);
+}
+
+void Comm::_s_evcb_on_accept_error(struct evconnlistener* listener, void* arg)
+{
+  Comm& comm = *(Comm*)arg;
+  int err = EVUTIL_SOCKET_ERROR();
+  OMS_WARN_EVERY(10, "Failed to accept: {}({}), pause listening", err, evutil_socket_error_to_string(err));
+
+  // the listen socket keeps readable when fds run out, so stop polling it until the next routine round
+  evconnlistener_disable(listener);
+  comm._listener_paused = true;
+}
+
+void Comm::_s_evcb_on_routine(int, short, void* arg)
+{
+  Comm& comm = *(Comm*)arg;
+  if (comm._listener_paused && comm._listener != nullptr) {
+    evconnlistener_enable(comm._listener);
+    comm._listener_paused = false;
+  }
+  if (comm._routine_callback) {
+    comm._routine_callback();
+  }
+}
+
+void Comm::post(const std::function<void()>& task)
+{
+  {
+    std::lock_guard<std::mutex> lock(_post_mutex);
+    _posted_tasks.push_back(task);
+  }
+  uint64_t one = 1;
+  if (write(_post_fd, &one, sizeof(one)) != sizeof(one)) {
+    OMS_STREAM_ERROR << "Failed to wake up event loop for posted task, error: " << strerror(errno);
+  }
+}
+
+void Comm::_s_evcb_on_post(int fd, short, void* arg)
+{
+  Comm& comm = *(Comm*)arg;
+  uint64_t count = 0;
+  if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+    return;
+  }
+
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(comm._post_mutex);
+    tasks.swap(comm._posted_tasks);
+  }
+  for (auto& task : tasks) {
+    task();
+  }
+}
+
 int Comm::add(const Peer& peer)
 {
   uint64_t peer_id = peer.id();
@@ -390,16 +493,15 @@ int Comm::write_message(Channel& ch, const Message& msg)
     return ret;
   }
 
-  Counter::instance().count_key(Counter::SENDER_ENCODE_US, _stage_timer.stopwatch());
+  Counter::instance().count_key(Counter::SENDER_ENCODE_US, _stage_timer.elapsed());
+  _stage_timer.reset();
 
-  size_t wsize = 0;
-  for (const auto& chunk : buffer) {
-    if (OMS_OK != ch.writen(chunk.buffer(), chunk.size())) {
-      OMS_STREAM_ERROR << "Failed to send message through channel:" << ch.peer().id() << ", error:" << ch.last_error();
-      return OMS_FAILED;
-    }
-    wsize += chunk.size();
+  if (OMS_OK != ch.writev(buffer)) {
+    OMS_STREAM_ERROR << "Failed to send message through channel:" << ch.peer().id() << ", error:" << ch.last_error();
+    return OMS_FAILED;
   }
+  size_t wsize = buffer.byte_size();
+  _written_bytes += wsize;
 
   Counter::instance().count_key(Counter::SENDER_SEND_US, _stage_timer.elapsed());
   Counter::instance().count_write_io(raw_len);
@@ -14,6 +14,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <unordered_map>
 #include <mutex>
 #include <atomic>
@@ -61,8 +62,26 @@ public:
 
   int write_message(Channel& ch, const Message&);
 
+  /*!
+   * @brief Bytes written by write_message() so far, as encoded and compressed
+   */
+  inline uint64_t written_bytes() const
+  {
+    return _written_bytes;
+  }
+
   void debug_events();
 
+  /*!
+   * @brief Run task in the thread of event loop, e.g. to hand results of off-loop jobs back, callable from any thread
+   */
+  void post(const std::function<void()>& task);
+
+  inline struct event_base* get_event_base()
+  {
+    return _event_base;
+  }
+
   inline size_t channel_count()
   {
     return _channel_factory.size();
@@ -91,7 +110,13 @@ public:
 private:
   void _s_evcb_on_accept(int fd, const struct sockaddr_in&);
 
-  //  void _s_evcb_on_accept_error(struct evconnlistener* listener, void* ctx);
+  static void _s_evcb_on_listen(struct evconnlistener* listener, int fd, struct sockaddr* addr, int len, void* arg);
+
+  static void _s_evcb_on_accept_error(struct evconnlistener* listener, void* arg);
+
+  static void _s_evcb_on_routine(int fd, short event, void* arg);
+
+  static void _s_evcb_on_post(int fd, short event, void* arg);
 
   static void _s_evcb_on_event(int fd, short event, void* arg);
 
@@ -99,13 +124,23 @@ private:
 
 private:
   Timer _stage_timer;
+  uint64_t _written_bytes = 0;
 
   ChannelFactory& _channel_factory = ChannelFactory::instance();
   static MessageDecoder* _s_decoders[3];
   static MessageEncoder* _s_encoders[3];
 
-  int _listenfd = 0;
-  //  struct evconnlistener* _listener = nullptr;
+  struct evconnlistener* _listener = nullptr;
+  // paused when accept fails, e.g. too many open files, and resumed by routine event
+  bool _listener_paused = false;
+  struct event* _routine_event = nullptr;
+  // process that created the event base
+  pid_t _owner_pid = 0;
+  // eventfd waking up event loop for posted tasks
+  int _post_fd = -1;
+  struct event* _post_event = nullptr;
+  std::mutex _post_mutex;
+  std::vector<std::function<void()>> _posted_tasks;
   struct event_base* _event_base = nullptr;
 
   std::function<EventResult(const Peer&, const Message&)> _read_callback;
@@ -11,6 +11,7 @@
  */
 
 #include <sys/queue.h>
+#include <fcntl.h>
 #include <cstring>
 #include "event2/event.h"
 #include "event2/buffer.h"
@@ -152,6 +153,71 @@ int HttpClient::get(const std::string& url, HttpResponse& response)
   return OMS_OK;
 }
 
+HttpServer::~HttpServer()
+{
+  stop();
+}
+
+int HttpServer::init(struct event_base* base, uint16_t port)
+{
+  _http = evhttp_new(base);
+  if (_http == nullptr) {
+    OMS_ERROR("Failed to create http server, evhttp_new failed");
+    return OMS_FAILED;
+  }
+  struct evhttp_bound_socket* handle = evhttp_bind_socket_with_handle(_http, "0.0.0.0", port);
+  if (handle == nullptr) {
+    OMS_ERROR("Failed to bind http server on port: {}, error: {}", port, system_err(errno));
+    stop();
+    return OMS_FAILED;
+  }
+  // never leak listen fd to forked children
+  fcntl(evhttp_bound_socket_get_fd(handle), F_SETFD, FD_CLOEXEC);
+  evhttp_set_allowed_methods(_http, EVHTTP_REQ_GET);
+  evhttp_set_gencb(_http, _s_on_request, this);
+  OMS_INFO("+++ Http server listen on port: {}", port);
+  return OMS_OK;
+}
+
+void HttpServer::register_handler(const std::string& path, const Handler& handler)
+{
+  _handlers[path] = handler;
+}
+
+void HttpServer::stop()
+{
+  if (_http != nullptr) {
+    evhttp_free(_http);
+    _http = nullptr;
+  }
+}
+
+void HttpServer::_s_on_request(struct evhttp_request* request, void* arg)
+{
+  auto* server = (HttpServer*)arg;
+  const char* path = evhttp_uri_get_path(evhttp_request_get_evhttp_uri(request));
+  std::string request_path = (path == nullptr || strlen(path) == 0) ? "/" : path;
+
+  HttpResponse response;
+  response.code = HTTP_NOTFOUND;
+  response.message = "Not Found";
+  auto iter = server->_handlers.find(request_path);
+  if (iter != server->_handlers.end()) {
+    response.code = HTTP_OK;
+    response.message = "OK";
+    iter->second(request_path, response);
+  }
+
+  struct evkeyvalq* headers = evhttp_request_get_output_headers(request);
+  for (const auto& header : response.headers) {
+    evhttp_add_header(headers, header.first.c_str(), header.second.c_str());
+  }
+  struct evbuffer* body = evbuffer_new();
+  evbuffer_add(body, response.payload.data(), response.payload.size());
+  evhttp_send_reply(request, response.code, response.message.c_str(), body);
+  evbuffer_free(body);
+}
+
 }  // namespace logproxy
 
 }  // namespace oceanbase
\ No newline at end of file
@@ -12,6 +12,14 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <functional>
+
+struct event_base;
+struct evhttp;
+struct evhttp_request;
+
 namespace oceanbase {
 namespace logproxy {
 struct HttpResponse {
@@ -26,5 +34,29 @@ public:
   static int get(const std::string& url, HttpResponse& response);
 };
 
+/*!
+ * @brief Minimal http server attached to an existing event base, requests are handled in the thread which
+ * dispatches the event base, so handlers must not block
+ */
+class HttpServer {
+public:
+  typedef std::function<void(const std::string& path, HttpResponse& response)> Handler;
+
+  ~HttpServer();
+
+  int init(struct event_base* base, uint16_t port);
+
+  void register_handler(const std::string& path, const Handler& handler);
+
+  void stop();
+
+private:
+  static void _s_on_request(struct evhttp_request* request, void* arg);
+
+private:
+  struct evhttp* _http = nullptr;
+  std::map<std::string, Handler> _handlers;
+};
+
 }  // namespace logproxy
 }  // namespace oceanbase
\ No newline at end of file
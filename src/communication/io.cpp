@@ -10,8 +10,11 @@
  * See the Mulan PubL v2 for more details.
  */
 
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <climits>
+#include <algorithm>
 #include <cerrno>
 #include <fcntl.h>
 #include <cstring>
@@ -45,6 +48,32 @@ int writen(int fd, const void* buf, int size)
   return OMS_OK;
 }
 
+int writevn(int fd, struct iovec* iov, int count)
+{
+  while (count > 0) {
+    const ssize_t ret = ::writev(fd, iov, std::min(count, IOV_MAX));
+    if (ret < 0) {
+      const int err = errno;
+      if (EAGAIN != err && EINTR != err) {
+        return OMS_FAILED;
+      }
+      continue;
+    }
+
+    auto written = static_cast<size_t>(ret);
+    while (count > 0 && written >= iov->iov_len) {
+      written -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+  return OMS_OK;
+}
+
 int readn(int fd, void* buf, int size)
 {
   char* tmp = (char*)buf;
@@ -223,6 +252,16 @@ int set_reuse_addr(int sock)
   return OMS_OK;
 }
 
+int send_queue_bytes(int fd, size_t& bytes)
+{
+  int queued = 0;
+  if (ioctl(fd, TIOCOUTQ, &queued) < 0) {
+    return OMS_FAILED;
+  }
+  bytes = queued;
+  return OMS_OK;
+}
+
 int set_non_block(int fd)
 {
   int flags = fcntl(fd, F_GETFL);
@@ -241,13 +280,14 @@ int set_non_block(int fd)
 
 int set_close_on_exec(int fd)
 {
-  int flags = fcntl(fd, F_GETFL);
+  // close-on-exec is a fd flag, which F_SETFL ignores
+  int flags = fcntl(fd, F_GETFD);
   if (flags == -1) {
     OMS_STREAM_WARN << "Failed to get flags of fd(" << fd << "). error=" << strerror(errno);
     return OMS_FAILED;
   }
 
-  flags = fcntl(fd, F_SETFL, flags | O_CLOEXEC);
+  flags = fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
   if (flags == -1) {
     OMS_STREAM_WARN << "Failed to set close on exec flags of fd(" << fd << "). error=" << strerror(errno);
     return OMS_FAILED;
@@ -255,5 +295,69 @@ int set_close_on_exec(int fd)
   return OMS_OK;
 }
 
+int send_fd(int sock, const void* buf, int size, int fd)
+{
+  struct iovec iov;
+  iov.iov_base = const_cast<void*>(buf);
+  iov.iov_len = size;
+
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  ssize_t ret;
+  do {
+    ret = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
+  } while (ret < 0 && errno == EINTR);
+  if (ret != size) {
+    OMS_STREAM_WARN << "Failed to send fd(" << fd << ") over socket(" << sock << "). error=" << strerror(errno);
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+int recv_fd(int sock, void* buf, int size, int& fd)
+{
+  fd = -1;
+  struct iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = size;
+
+  char control[CMSG_SPACE(sizeof(int))];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t ret;
+  do {
+    ret = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+  } while (ret < 0 && errno == EINTR);
+  if (ret <= 0) {
+    return (int)ret;
+  }
+
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+      break;
+    }
+  }
+  return (int)ret;
+}
+
 }  // namespace logproxy
 }  // namespace oceanbase
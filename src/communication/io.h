@@ -12,10 +12,20 @@
 
 #pragma once
 
+#include <cstddef>
+#include <sys/uio.h>
+
 namespace oceanbase {
 namespace logproxy {
 int writen(int fd, const void* buf, int size);
 
+/**
+ * write all the buffers by writev
+ * @param iov buffers to write, modified as bytes written
+ * @return OMS_OK if all bytes have been written
+ */
+int writevn(int fd, struct iovec* iov, int count);
+
 int readn(int fd, void* buf, int size);
 
 /**
@@ -40,9 +50,32 @@ int connect(const char* host, int port, bool block_mode, int timeout, int& sockf
  */
 int listen(const char* host, int port, bool block_mode, bool reuse_address);
 
+/**
+ * get bytes in the send queue of a socket, written but not acknowledged by peer yet
+ * @param bytes[out] the bytes queued
+ * @return OMS_OK if got by TIOCOUTQ
+ */
+int send_queue_bytes(int fd, size_t& bytes);
+
 int set_reuse_addr(int fd);
 int set_non_block(int fd);
 int set_close_on_exec(int fd);
 
+/**
+ * send a message along with a file descriptor over a unix domain socket(SCM_RIGHTS)
+ * @param sock The unix domain socket
+ * @param fd The file descriptor to send, still owned by the caller
+ * @return OMS_OK if the whole message was sent
+ */
+int send_fd(int sock, const void* buf, int size, int fd);
+
+/**
+ * receive a message sent by send_fd
+ * @param sock The unix domain socket
+ * @param fd[out] The received file descriptor, -1 if none attached
+ * @return size of the message received, 0 if peer closed, -1 on error
+ */
+int recv_fd(int sock, void* buf, int size, int& fd);
+
 }  // namespace logproxy
 }  // namespace oceanbase
@@ -50,6 +50,13 @@ public:
     return _id;
   }
 
+  // the same connection received by another process over unix domain socket gets another fd number
+  inline void reset_fd(int new_fd)
+  {
+    fd = new_fd;
+    _id = (_id & ~(uint64_t)UINT16_MAX) | (new_fd & UINT16_MAX);
+  }
+
   inline bool operator==(const Peer& other) const
   {
     return this->_id == other._id;
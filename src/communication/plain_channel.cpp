@@ -49,6 +49,16 @@ int PlainChannel::writen(const char* buf, int size)
   return ::oceanbase::logproxy::writen(_peer.fd, buf, size);
 }
 
+int PlainChannel::writev(const MsgBuf& buffer)
+{
+  std::vector<struct iovec> iov;
+  iov.reserve(buffer.count());
+  for (const auto& chunk : buffer) {
+    iov.push_back({chunk.buffer(), chunk.size()});
+  }
+  return ::oceanbase::logproxy::writevn(_peer.fd, iov.data(), static_cast<int>(iov.size()));
+}
+
 const char* PlainChannel::last_error()
 {
   return strerror(errno);
@@ -17,6 +17,7 @@
 
 #include "channel.h"
 #include "peer.h"
+#include "io.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -137,6 +138,23 @@ int TlsChannel::init_global(const Config& config)
     return OMS_FAILED;
   }
 
+  if (config.tls_session_tickets.val()) {
+    // sessions resumed must be of the same context, or fail to be resumed when verifying peers
+    static const unsigned char session_id_context[] = "oblogproxy";
+    SSL_CTX_set_session_id_context(ssl_ctx, session_id_context, sizeof(session_id_context) - 1);
+    SSL_CTX_set_session_cache_mode(ssl_ctx, SSL_SESS_CACHE_SERVER);
+  } else {
+    SSL_CTX_set_options(ssl_ctx, SSL_OP_NO_TICKET);
+  }
+
+  if (config.tls_ktls.val()) {
+#ifdef SSL_OP_ENABLE_KTLS
+    SSL_CTX_set_options(ssl_ctx, SSL_OP_ENABLE_KTLS);
+#else
+    OMS_STREAM_WARN << "kTLS is not supported by OpenSSL " << OPENSSL_VERSION_TEXT << ", records are encrypted by it";
+#endif
+  }
+
   _s_ssl_ctx = ssl_ctx;
   return OMS_OK;
 }
@@ -194,6 +212,7 @@ int TlsChannel::after_accept()
       return OMS_FAILED;
     } else if (ret == 1) {
       OMS_STREAM_DEBUG << "accept new connection success";
+      check_ktls();
       return OMS_OK;
     }
   }
@@ -221,6 +240,7 @@ int TlsChannel::after_connect()  // TODO simplify with after_accept
       return OMS_FAILED;
     } else if (ret == 1) {
       OMS_STREAM_DEBUG << "connect to server success";
+      check_ktls();
       return OMS_OK;
     }
   }
@@ -289,6 +309,37 @@ int TlsChannel::writen(const char* buf, int size)
   return OMS_OK;
 }
 
+int TlsChannel::writev(const MsgBuf& buffer)
+{
+  if (!_ktls_send) {
+    return Channel::writev(buffer);
+  }
+
+  _last_error = SSL_ERROR_SYSCALL;
+  std::vector<struct iovec> iov;
+  iov.reserve(buffer.count());
+  for (const auto& chunk : buffer) {
+    iov.push_back({chunk.buffer(), chunk.size()});
+  }
+  if (::oceanbase::logproxy::writevn(_peer.fd, iov.data(), static_cast<int>(iov.size())) != OMS_OK) {
+    return OMS_FAILED;
+  }
+  _last_error = SSL_ERROR_NONE;
+  return OMS_OK;
+}
+
+void TlsChannel::check_ktls()
+{
+#ifdef SSL_OP_ENABLE_KTLS
+  _ktls_send = BIO_get_ktls_send(SSL_get_wbio(_ssl));
+#endif
+  if (Config::instance().tls_ktls.val()) {
+    OMS_STREAM_INFO << "Records sent to peer: " << _peer.id() << " are encrypted by "
+                    << (_ktls_send ? "kernel" : "OpenSSL") << ", cipher: " << SSL_get_cipher_name(_ssl)
+                    << ", session reused: " << SSL_session_reused(_ssl);
+  }
+}
+
 int TlsChannel::handle_error(int ret)
 {
   const int error = SSL_get_error(_ssl, ret);
@@ -16,11 +16,17 @@
 #include "codec/encoder.h"
 #include "communication/io.h"
 #include "communication/comm.h"
-#include "oblogreader/oblog_config.h"
+#include "oblog_config.h"
 #include "obaccess/mysql_protocol.h"
 
 using namespace oceanbase::logproxy;
 
+// initial credit of flow control, disabled if both 0
+static int64_t _s_credit_bytes = 0;
+static int64_t _s_credit_records = 0;
+// time to consume each packet, simulating a slow consumer
+static uint64_t _s_consume_us = 0;
+
 void debug_record(const RecordDataMessage& record)
 {
   OMS_STREAM_INFO << "fetch a record from liboblog: ";
@@ -31,7 +37,7 @@ void debug_record(const RecordDataMessage& record)
   //    << ", tbname: " << record->tbname();
 }
 
-EventResult on_msg(const Peer& peer, const Message& message)
+EventResult on_msg(Comm& comm, const Peer& peer, const Message& message)
 {
   switch (message.type()) {
     case MessageType::HANDSHAKE_RESPONSE_CLIENT:
@@ -43,6 +49,17 @@ EventResult on_msg(const Peer& peer, const Message& message)
       OMS_STREAM_INFO << "data packet, compress: " << (int)record.compress_type << ", count: " << record.count();
 
       debug_record(record);
+      if (_s_consume_us > 0) {
+        usleep(_s_consume_us);
+      }
+      if (_s_credit_bytes > 0 || _s_credit_records > 0) {
+        // grant back credit of records consumed
+        CreditMessage credit(record.raw_len, record.count());
+        if (comm.send_message(peer, credit, true) != OMS_OK) {
+          OMS_STREAM_ERROR << "Failed to grant credit: " << credit.to_string();
+          return EventResult::ER_CLOSE_CHANNEL;
+        }
+      }
       break;
     }
 
@@ -85,7 +102,7 @@ int run(const std::string& host, uint16_t port, const std::string& client_id, co
   set_non_block(sockfd);
   OMS_STREAM_INFO << "Connected to " << host << ":" << port << " with sockfd: " << sockfd;
   struct sockaddr_in peer_addr;
-  socklen_t len;
+  socklen_t len = sizeof(peer_addr);
   ret = getpeername(sockfd, (struct sockaddr*)&peer_addr, &len);
   if (ret == 0 && peer_addr.sin_addr.s_addr != 0) {
     Peer p(peer_addr.sin_addr.s_addr, ntohs(peer_addr.sin_port), sockfd);
@@ -94,12 +111,11 @@ int run(const std::string& host, uint16_t port, const std::string& client_id, co
     OMS_STREAM_WARN << "Failed to fetch peer info of fd:" << sockfd << ", errno:" << errno << ", error:" << strerror(errno);
   }
   Peer peer(peer_addr.sin_addr.s_addr, htons(peer_addr.sin_port), sockfd);
-  //  ret = comm.add(peer);
-  //  if (ret != OMS_OK) {
-  //    OMS_STREAM_ERROR << "Failed to add channel with sockfd: " << sockfd << ", ret: " << ret;
-  //    return -1;
-  //  }
-  //
+  ret = comm.add(peer);
+  if (ret != OMS_OK) {
+    OMS_STREAM_ERROR << "Failed to add channel with sockfd: " << sockfd << ", ret: " << ret;
+    return -1;
+  }
 
   ClientHandshakeRequestMessage handshake((int)LogType::OCEANBASE,
       host.c_str(),
@@ -107,15 +123,17 @@ int run(const std::string& host, uint16_t port, const std::string& client_id, co
       "1.0.0",
       false,
       config.c_str());
-  comm.listen(port + 1);
-  ret = comm.start();
-  ret = comm.send_message(peer, handshake);
+  handshake.credit_bytes = _s_credit_bytes;
+  handshake.credit_records = _s_credit_records;
+  comm.set_read_callback(
+      [&comm](const Peer& peer, const Message& message) { return on_msg(comm, peer, message); });
+  ret = comm.send_message(peer, handshake, true);
   if (ret != OMS_OK) {
     OMS_STREAM_ERROR << "Failed to send handshake: " << handshake.to_string();
     return -1;
   }
-  comm.set_read_callback(on_msg);
-  return ret;
+  comm.listen(port + 1);
+  return comm.start();
 }
 
 int main(int argc, char** argv)
@@ -143,6 +161,15 @@ int main(int argc, char** argv)
       OmsOption('E', "tls-cert-file", true, "cert file", [&](const std::string& optarg) { tls_cert_file = optarg; }));
   options.add(
       OmsOption('K', "tls-key-file", true, "key file", [&](const std::string& optarg) { tls_key_file = optarg; }));
+  options.add(OmsOption('B', "credit-bytes", true, "Credit bytes of flow control", [&](const std::string& optarg) {
+    _s_credit_bytes = strtoll(optarg.c_str(), nullptr, 10);
+  }));
+  options.add(OmsOption('R', "credit-records", true, "Credit records of flow control", [&](const std::string& optarg) {
+    _s_credit_records = strtoll(optarg.c_str(), nullptr, 10);
+  }));
+  options.add(OmsOption('S', "consume-us", true, "Time to consume each packet", [&](const std::string& optarg) {
+    _s_consume_us = strtoull(optarg.c_str(), nullptr, 10);
+  }));
 
   struct option* long_options = options.long_pattern();
   std::string&& pattern = options.pattern();
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "histogram.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static int thread_shard()
+{
+  static std::atomic<int> _s_next_shard{0};
+  static thread_local int shard = _s_next_shard.fetch_add(1, std::memory_order_relaxed) % Histogram::SHARD_COUNT;
+  return shard;
+}
+
+Histogram::Histogram() : _shards(new Shard[SHARD_COUNT])
+{
+  for (int i = 0; i < SHARD_COUNT; ++i) {
+    for (auto& count : _shards[i].counts) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+Histogram::~Histogram()
+{
+  delete[] _shards;
+}
+
+int Histogram::bucket_index(uint64_t value)
+{
+  if (value < (SUB_BUCKET_COUNT << 1)) {
+    return (int)value;
+  }
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - SUB_BUCKET_BITS;
+  return SUB_BUCKET_COUNT * (shift + 1) + (int)((value >> shift) - SUB_BUCKET_COUNT);
+}
+
+uint64_t Histogram::bucket_upper_bound(int index)
+{
+  if (index < (SUB_BUCKET_COUNT << 1)) {
+    return index;
+  }
+  int shift = index / SUB_BUCKET_COUNT - 1;
+  uint64_t sub = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+  // the last bucket wraps around to UINT64_MAX
+  return ((sub + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value)
+{
+  Shard& shard = _shards[thread_shard()];
+  shard.counts[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+  shard.count.fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = shard.max.load(std::memory_order_relaxed);
+  while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+void Histogram::snapshot(HistogramSnapshot& snapshot) const
+{
+  snapshot.counts.assign(BUCKET_COUNT, 0);
+  snapshot.count = 0;
+  snapshot.sum = 0;
+  snapshot.max = 0;
+  for (int i = 0; i < SHARD_COUNT; ++i) {
+    const Shard& shard = _shards[i];
+    for (int j = 0; j < BUCKET_COUNT; ++j) {
+      snapshot.counts[j] += shard.counts[j].load(std::memory_order_relaxed);
+    }
+    snapshot.count += shard.count.load(std::memory_order_relaxed);
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+  }
+}
+
+uint64_t HistogramSnapshot::value_at(double percentile) const
+{
+  uint64_t total = 0;
+  for (uint64_t c : counts) {
+    total += c;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  auto rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint64_t upper = Histogram::bucket_upper_bound((int)i);
+      return (max != 0 && upper > max) ? max : upper;
+    }
+  }
+  return max;
+}
+
+HistogramSnapshot HistogramSnapshot::delta(const HistogramSnapshot& prev) const
+{
+  HistogramSnapshot window;
+  window.counts = counts;
+  for (size_t i = 0; i < window.counts.size() && i < prev.counts.size(); ++i) {
+    window.counts[i] -= prev.counts[i];
+  }
+  window.count = count - prev.count;
+  window.sum = sum - prev.sum;
+  // max is not decomposable, keep the lifetime one as the upper bound of the window
+  window.max = max;
+  return window;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
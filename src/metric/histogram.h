@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "common.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Point-in-time copy of a Histogram, on which percentiles are computed
+ */
+struct HistogramSnapshot {
+  std::vector<uint64_t> counts;
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  /*!
+   * @brief Returns the upper bound of the bucket where the given percentile falls into
+   * @param percentile in range [0, 100]
+   */
+  uint64_t value_at(double percentile) const;
+
+  /*!
+   * @brief Counts recorded between prev and this snapshot, used to compute percentiles of a window
+   */
+  HistogramSnapshot delta(const HistogramSnapshot& prev) const;
+};
+
+/*!
+ * @brief HDR-style log-linear histogram of unsigned values (microseconds for latencies).
+ * Values are grouped into power-of-two magnitudes which are linearly divided into
+ * SUB_BUCKET_COUNT buckets, so the relative error is bounded by 1/SUB_BUCKET_COUNT in the whole range.
+ * Recording is wait-free: each thread is mapped to one of SHARD_COUNT cache line aligned shards and
+ * updates it with relaxed atomics, the shards are merged only when taking snapshot.
+ */
+class Histogram {
+  OMS_AVOID_COPY(Histogram);
+
+public:
+  static constexpr int SUB_BUCKET_BITS = 5;
+  static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static constexpr int BUCKET_COUNT = SUB_BUCKET_COUNT * (64 - SUB_BUCKET_BITS + 1);
+  static constexpr int SHARD_COUNT = 4;
+
+  Histogram();
+
+  ~Histogram();
+
+  void record(uint64_t value);
+
+  void snapshot(HistogramSnapshot& snapshot) const;
+
+  static int bucket_index(uint64_t value);
+
+  /*!
+   * @brief Largest value that falls into the bucket
+   */
+  static uint64_t bucket_upper_bound(int index);
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> counts[BUCKET_COUNT];
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+  };
+
+  Shard* _shards;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "config.h"
+#include "log.h"
+#include "timer.h"
+#include "metric_registry.h"
+#include "latency_tracer.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+static const char* _s_stage_names[TRACE_STAGE_COUNT + 1] = {"upstream", "queue", "convert", "deliver", "total"};
+
+static constexpr uint64_t STAMP_MASK = UINT32_MAX;
+
+// key of a slot while a trace starts in it, so that no other one starts there at the same time
+static const char _s_starting = 0;
+
+void LatencyTracer::begin(const void* key, uint64_t commit_us)
+{
+  uint32_t interval = _s_config.latency_trace_sample_interval.val();
+  if (interval == 0 || _commits.fetch_add(1, std::memory_order_relaxed) % interval != 0) {
+    return;
+  }
+
+  Slot* oldest = nullptr;
+  for (auto& slot : _slots) {
+    const void* expected = nullptr;
+    if (slot.key.compare_exchange_strong(expected, &_s_starting)) {
+      start(slot, commit_us);
+      slot.key.store(key);
+      _inflight.fetch_add(1);
+      return;
+    }
+    if (oldest == nullptr ||
+        slot.start_us.load(std::memory_order_relaxed) < oldest->start_us.load(std::memory_order_relaxed)) {
+      oldest = &slot;
+    }
+  }
+
+  // all slots are occupied, the oldest trace is most likely leaked by an object released without discarding it
+  const void* expected = oldest->key.load(std::memory_order_acquire);
+  uint64_t age_us = Timer::now() - oldest->start_us.load(std::memory_order_relaxed);
+  if (expected != nullptr && expected != &_s_starting && oldest->key.compare_exchange_strong(expected, &_s_starting)) {
+    start(*oldest, commit_us);
+    oldest->key.store(key);
+    OMS_WARN("All {} latency trace slots are occupied, evicted the oldest trace started {}us ago", SLOT_COUNT, age_us);
+  }
+}
+
+void LatencyTracer::start(Slot& slot, uint64_t commit_us)
+{
+  // stamps in flight for the evicted trace are still tagged by the last generation, and dropped
+  uint64_t generation = slot.generation.fetch_add(1) + 1;
+  slot.commit_us.store(commit_us, std::memory_order_relaxed);
+  slot.start_us.store(Timer::now(), std::memory_order_relaxed);
+  for (auto& stamp : slot.stamps) {
+    stamp.store(generation << 32);
+  }
+  slot.stamps[TRACE_UPSTREAM].store((generation << 32) | 1);
+}
+
+LatencyTracer::Slot* LatencyTracer::find(const void* key, uint32_t& generation)
+{
+  if (_inflight.load(std::memory_order_relaxed) == 0 || key == nullptr) {
+    return nullptr;
+  }
+  for (auto& slot : _slots) {
+    // generation loaded ahead of key, so that it is never newer than the trace of key
+    generation = slot.generation.load();
+    if (slot.key.load() == key) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+void LatencyTracer::stamp(const void* key, TraceStage stage)
+{
+  uint32_t generation = 0;
+  Slot* slot = find(key, generation);
+  if (slot == nullptr) {
+    return;
+  }
+  uint64_t elapsed_us = Timer::now() - slot->start_us.load(std::memory_order_relaxed);
+  uint64_t value = ((uint64_t)generation << 32) | std::min(elapsed_us + 1, STAMP_MASK);
+  uint64_t current = slot->stamps[stage].load();
+  // stamp only the trace of key, never the one taking the slot over since
+  while ((current >> 32) == generation && !slot->stamps[stage].compare_exchange_weak(current, value)) {
+  }
+}
+
+void LatencyTracer::move(const void* from, const void* to)
+{
+  uint32_t generation = 0;
+  Slot* slot = find(from, generation);
+  if (slot != nullptr) {
+    slot->key.compare_exchange_strong(from, to);
+  }
+}
+
+bool LatencyTracer::detach(const void* key, TxnTrace& trace)
+{
+  uint32_t generation = 0;
+  Slot* slot = find(key, generation);
+  if (slot == nullptr) {
+    return false;
+  }
+  trace = TxnTrace();
+  trace.commit_us = slot->commit_us.load(std::memory_order_relaxed);
+  uint64_t start_us = slot->start_us.load(std::memory_order_relaxed);
+  for (int i = 0; i < TRACE_STAGE_COUNT; ++i) {
+    uint64_t value = slot->stamps[i].load();
+    if ((value >> 32) == generation && (value & STAMP_MASK) != 0) {
+      trace.stamps[i] = start_us + (value & STAMP_MASK) - 1;
+    }
+  }
+  // evicted meanwhile, what was read may belong to the next trace
+  if (!slot->key.compare_exchange_strong(key, nullptr)) {
+    return false;
+  }
+  _inflight.fetch_sub(1);
+  return true;
+}
+
+void LatencyTracer::finish(const void* key)
+{
+  TxnTrace trace;
+  if (detach(key, trace)) {
+    finish(trace);
+  }
+}
+
+void LatencyTracer::finish(TxnTrace& trace)
+{
+  trace.stamps[TRACE_DELIVER] = Timer::now();
+  record(trace);
+}
+
+void LatencyTracer::discard(const void* key)
+{
+  TxnTrace trace;
+  detach(key, trace);
+}
+
+void LatencyTracer::record(const TxnTrace& trace)
+{
+  static Histogram* histograms[TRACE_STAGE_COUNT + 1] = {
+      &MetricRegistry::instance().histogram(METRIC_NAME, {{"stage", _s_stage_names[TRACE_UPSTREAM]}}),
+      &MetricRegistry::instance().histogram(METRIC_NAME, {{"stage", _s_stage_names[TRACE_QUEUE]}}),
+      &MetricRegistry::instance().histogram(METRIC_NAME, {{"stage", _s_stage_names[TRACE_CONVERT]}}),
+      &MetricRegistry::instance().histogram(METRIC_NAME, {{"stage", _s_stage_names[TRACE_DELIVER]}}),
+      &MetricRegistry::instance().histogram(METRIC_NAME, {{"stage", _s_stage_names[TRACE_STAGE_COUNT]}})};
+
+  // clocks of observer and local host may drift, never record a negative latency
+  uint64_t prev = trace.commit_us;
+  for (int i = 0; i < TRACE_STAGE_COUNT; ++i) {
+    // stage skipped, e.g. readonly mode does not serialize records
+    if (trace.stamps[i] == 0) {
+      continue;
+    }
+    histograms[i]->record(trace.stamps[i] > prev ? trace.stamps[i] - prev : 0);
+    prev = std::max(prev, trace.stamps[i]);
+  }
+  histograms[TRACE_STAGE_COUNT]->record(prev - trace.commit_us);
+}
+
+static std::string label_value(const std::string& sample, const std::string& label)
+{
+  std::string prefix = label + "=\"";
+  size_t begin = sample.find(prefix);
+  if (begin == std::string::npos) {
+    return "";
+  }
+  begin += prefix.size();
+  size_t end = sample.find('"', begin);
+  return end == std::string::npos ? "" : sample.substr(begin, end - begin);
+}
+
+void LatencyTracer::serialize_breakdown(const std::string& metric_text, Json::Value& breakdown)
+{
+  std::string prefix = std::string(METRIC_NAME) + "{";
+  std::istringstream input(metric_text);
+  std::string line;
+  while (std::getline(input, line)) {
+    // _sum and _count samples are not prefixed with the bare metric name
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    std::string stage = label_value(line, "stage");
+    std::string quantile = label_value(line, "quantile");
+    size_t value_pos = line.rfind(' ');
+    if (stage.empty() || quantile.empty() || value_pos == std::string::npos) {
+      continue;
+    }
+    breakdown[stage][quantile] = (Json::UInt64)strtoull(line.c_str() + value_pos + 1, nullptr, 10);
+  }
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
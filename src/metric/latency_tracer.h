@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "common.h"
+#include "jsonutil.hpp"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Stages a transaction goes through from OB commit to delivery, each one ends at the time it is stamped
+ */
+enum TraceStage {
+  // OB commit -> handed over by obcdc
+  TRACE_UPSTREAM = 0,
+  // enqueued by reader -> dequeued by sender/converter
+  TRACE_QUEUE = 1,
+  // dequeued -> serialized or converted to binlog event
+  TRACE_CONVERT = 2,
+  // converted -> written to client or flushed to binlog file
+  TRACE_DELIVER = 3,
+  TRACE_STAGE_COUNT = 4,
+};
+
+struct TxnTrace {
+  uint64_t commit_us = 0;
+  uint64_t stamps[TRACE_STAGE_COUNT]{};
+};
+
+/*!
+ * @brief Sampled commit-to-delivery latency tracing.
+ * One of every latency_trace_sample_interval commit records is traced, it is identified by the address of the object
+ * carrying it through the pipeline (ILogRecord, then ObLogEvent), and is stamped when leaving each stage.
+ * A finished trace is recorded into the logproxy_txn_latency_us{stage=...} histograms, so the breakdown is exported
+ * by the metrics endpoint as well as SHOW BINLOG STATUS.
+ * Only a few traces are in flight at the same time, lookups of untraced objects cost one relaxed atomic load.
+ * Stages stamp a slot from different threads while it may be evicted, so stamps are tagged by the generation of the
+ * trace and never land on the one taking the slot over.
+ */
+class LatencyTracer {
+  OMS_SINGLETON(LatencyTracer);
+  OMS_AVOID_COPY(LatencyTracer);
+
+public:
+  static constexpr int SLOT_COUNT = 16;
+
+  static constexpr const char* METRIC_NAME = "logproxy_txn_latency_us";
+
+  /*!
+   * @brief Called by reader for each fetched commit record, starts a trace if it is sampled. The oldest trace is
+   * evicted if all slots are occupied, so traces leaked by objects never finished nor discarded stop nothing
+   */
+  void begin(const void* key, uint64_t commit_us);
+
+  void stamp(const void* key, TraceStage stage);
+
+  /*!
+   * @brief Hand the trace over to another object, e.g. the XidEvent converted from a commit record
+   */
+  void move(const void* from, const void* to);
+
+  /*!
+   * @brief Take the trace out of the tracer, for objects released before they are delivered
+   */
+  bool detach(const void* key, TxnTrace& trace);
+
+  /*!
+   * @brief Stamp delivery and record the trace, if any
+   */
+  void finish(const void* key);
+
+  void finish(TxnTrace& trace);
+
+  void discard(const void* key);
+
+  /*!
+   * @brief Extract the latency breakdown of each stage from exported metrics text into json,
+   * in the form of {"stage": {"0.99": latency_us, ...}, ...}
+   */
+  static void serialize_breakdown(const std::string& metric_text, Json::Value& breakdown);
+
+private:
+  struct Slot {
+    std::atomic<const void*> key{nullptr};
+    // bumped each time a trace starts in the slot
+    std::atomic<uint32_t> generation{0};
+    std::atomic<uint64_t> commit_us{0};
+    std::atomic<uint64_t> start_us{0};
+    // generation in high 32 bits, 1 + microseconds since start_us in low 32 bits, untagged if not stamped
+    std::atomic<uint64_t> stamps[TRACE_STAGE_COUNT]{};
+  };
+
+  Slot* find(const void* key, uint32_t& generation);
+
+  void start(Slot& slot, uint64_t commit_us);
+
+  void record(const TxnTrace& trace);
+
+private:
+  std::atomic<int> _inflight{0};
+  std::atomic<uint64_t> _commits{0};
+  Slot _slots[SLOT_COUNT];
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <cstdio>
+#include <sstream>
+#include "log.h"
+#include "config.h"
+#include "fs_util.h"
+#include "timer.h"
+#include "metric_registry.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static const std::pair<const char*, double> _s_quantiles[] = {{"0.5", 50}, {"0.9", 90}, {"0.99", 99}, {"0.999", 99.9}};
+
+void MetricRegistry::set_const_labels(const MetricLabels& labels)
+{
+  std::lock_guard<std::mutex> lk(_lock);
+  _const_labels = labels;
+}
+
+Histogram& MetricRegistry::histogram(const std::string& name, const MetricLabels& labels)
+{
+  std::string key = name + format_labels(labels);
+  std::lock_guard<std::mutex> lk(_lock);
+  auto iter = _histograms.find(key);
+  if (iter != _histograms.end()) {
+    return iter->second->histogram;
+  }
+  auto* entry = new HistogramEntry();
+  entry->name = name;
+  entry->labels = labels;
+  _histograms.emplace(key, std::unique_ptr<HistogramEntry>(entry));
+  return entry->histogram;
+}
+
+void MetricRegistry::register_gauge(
+    const std::string& name, const std::function<int64_t()>& func, const MetricLabels& labels)
+{
+  std::lock_guard<std::mutex> lk(_lock);
+  _gauges[name + format_labels(labels)] = GaugeEntry{name, labels, func};
+}
+
+void MetricRegistry::unregister_gauge(const std::string& name, const MetricLabels& labels)
+{
+  std::lock_guard<std::mutex> lk(_lock);
+  _gauges.erase(name + format_labels(labels));
+}
+
+void MetricRegistry::roll()
+{
+  std::lock_guard<std::mutex> lk(_lock);
+  roll_histograms(Timer::now());
+}
+
+void MetricRegistry::roll_if_due(uint64_t now_us)
+{
+  uint64_t window_us = (uint64_t)Config::instance().metric_quantile_window_s.val() * 1000000;
+  std::lock_guard<std::mutex> lk(_lock);
+  if (now_us < _rolled_us + window_us) {
+    return;
+  }
+  roll_histograms(now_us);
+}
+
+void MetricRegistry::roll_histograms(uint64_t now_us)
+{
+  _rolled_us = now_us;
+  HistogramSnapshot current;
+  for (auto& entry : _histograms) {
+    HistogramEntry& h = *entry.second;
+    h.histogram.snapshot(current);
+    h.window = current.delta(h.last);
+    h.last = current;
+  }
+}
+
+MetricLabels MetricRegistry::merge_const_labels(const MetricLabels& labels)
+{
+  MetricLabels merged = _const_labels;
+  for (const auto& label : labels) {
+    merged[label.first] = label.second;
+  }
+  return merged;
+}
+
+void MetricRegistry::collect(MetricFamilies& families)
+{
+  std::lock_guard<std::mutex> lk(_lock);
+  for (auto& entry : _histograms) {
+    HistogramEntry& h = *entry.second;
+    MetricLabels labels = merge_const_labels(h.labels);
+
+    MetricFamily& summary = families[h.name];
+    summary.type = "summary";
+    for (const auto& quantile : _s_quantiles) {
+      summary.samples.emplace_back(h.name + format_labels(labels, std::string("quantile=\"") + quantile.first + "\"") +
+                                   " " + std::to_string(h.window.value_at(quantile.second)));
+    }
+    summary.samples.emplace_back(h.name + "_sum" + format_labels(labels) + " " + std::to_string(h.last.sum));
+    summary.samples.emplace_back(h.name + "_count" + format_labels(labels) + " " + std::to_string(h.last.count));
+
+    MetricFamily& max = families[h.name + "_max"];
+    max.type = "gauge";
+    max.samples.emplace_back(h.name + "_max" + format_labels(labels) + " " + std::to_string(h.last.max));
+  }
+
+  for (auto& entry : _gauges) {
+    GaugeEntry& g = entry.second;
+    MetricFamily& gauge = families[g.name];
+    gauge.type = "gauge";
+    gauge.samples.emplace_back(g.name + format_labels(merge_const_labels(g.labels)) + " " + std::to_string(g.func()));
+  }
+}
+
+int MetricRegistry::export_file(const std::string& file)
+{
+  MetricFamilies families;
+  collect(families);
+  std::string text;
+  format(families, text);
+
+  std::string tmp_file = file + ".tmp";
+  if (FsUtil::write_file(tmp_file, text) != OMS_OK) {
+    return OMS_FAILED;
+  }
+  if (::rename(tmp_file.c_str(), file.c_str()) != 0) {
+    OMS_ERROR("Failed to rename metric file {} to {}, error: {}", tmp_file, file, system_err(errno));
+    return OMS_FAILED;
+  }
+  return OMS_OK;
+}
+
+void MetricRegistry::render(const std::vector<std::string>& child_files, std::string& text)
+{
+  MetricFamilies families;
+  collect(families);
+
+  std::string content;
+  for (const std::string& file : child_files) {
+    // child process may not export metrics yet
+    if (!FsUtil::exist(file)) {
+      continue;
+    }
+    content.clear();
+    if (FsUtil::read_file(file, content, false) && !content.empty()) {
+      parse(content, families);
+    }
+  }
+  format(families, text);
+}
+
+void MetricRegistry::parse(const std::string& text, MetricFamilies& families)
+{
+  std::istringstream input(text);
+  std::string line;
+  MetricFamily* current = nullptr;
+  while (std::getline(input, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if (line.compare(0, 7, "# TYPE ") == 0) {
+      std::istringstream type_line(line.substr(7));
+      std::string name;
+      std::string type;
+      type_line >> name >> type;
+      current = &families[name];
+      current->type = type;
+      continue;
+    }
+    if (line[0] == '#') {
+      continue;
+    }
+    if (current == nullptr) {
+      current = &families[line.substr(0, line.find_first_of("{ "))];
+      current->type = "untyped";
+    }
+    current->samples.emplace_back(line);
+  }
+}
+
+void MetricRegistry::format(const MetricFamilies& families, std::string& text)
+{
+  for (const auto& family : families) {
+    text.append("# TYPE ").append(family.first).append(" ").append(family.second.type).append("\n");
+    for (const std::string& sample : family.second.samples) {
+      text.append(sample).append("\n");
+    }
+  }
+}
+
+std::string MetricRegistry::format_labels(const MetricLabels& labels, const std::string& extra)
+{
+  if (labels.empty() && extra.empty()) {
+    return "";
+  }
+  std::string text = "{";
+  for (const auto& label : labels) {
+    if (text.size() > 1) {
+      text.append(",");
+    }
+    text.append(label.first).append("=\"");
+    for (char c : label.second) {
+      switch (c) {
+        case '\\':
+          text.append("\\\\");
+          break;
+        case '"':
+          text.append("\\\"");
+          break;
+        case '\n':
+          text.append("\\n");
+          break;
+        default:
+          text.push_back(c);
+      }
+    }
+    text.append("\"");
+  }
+  if (!extra.empty()) {
+    if (text.size() > 1) {
+      text.append(",");
+    }
+    text.append(extra);
+  }
+  return text.append("}");
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
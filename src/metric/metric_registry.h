@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include "common.h"
+#include "histogram.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+typedef std::map<std::string, std::string> MetricLabels;
+
+struct MetricFamily {
+  std::string type;
+  std::vector<std::string> samples;
+};
+
+/*!
+ * @brief Metric families keyed by name, rendered in prometheus text exposition format
+ */
+typedef std::map<std::string, MetricFamily> MetricFamilies;
+
+/*!
+ * @brief Process wide registry of latency histograms and gauges.
+ * Histograms are exported as prometheus summaries, of which the quantiles are computed over the window between
+ * two successive roll(), while _sum and _count are cumulative.
+ * Child processes(oblogreader, binlog_converter) periodically export their metrics to a file in their working
+ * directory, and the /metrics endpoint of the parent process merges these files into its own output.
+ */
+class MetricRegistry {
+  OMS_SINGLETON(MetricRegistry);
+  OMS_AVOID_COPY(MetricRegistry);
+
+public:
+  /*!
+   * @brief Labels attached to all metrics of current process, e.g. client_id of oblogreader
+   */
+  void set_const_labels(const MetricLabels& labels);
+
+  /*!
+   * @brief Get or create the histogram, the returned reference keeps valid until the process exits,
+   * so callers on hot path should cache it rather than look it up for each record
+   */
+  Histogram& histogram(const std::string& name, const MetricLabels& labels = {});
+
+  void register_gauge(
+      const std::string& name, const std::function<int64_t()>& func, const MetricLabels& labels = {});
+
+  void unregister_gauge(const std::string& name, const MetricLabels& labels = {});
+
+  /*!
+   * @brief Start a new percentile window for all histograms, called by one timer of the process only, i.e. the
+   * Counter thread of child processes and the StatusThread of parent processes, so that scrapes and exports never
+   * cut the windows of each other
+   */
+  void roll();
+
+  /*!
+   * @brief roll() if metric_quantile_window_s passed since the last roll, for timers waking up more often
+   */
+  void roll_if_due(uint64_t now_us);
+
+  void collect(MetricFamilies& families);
+
+  /*!
+   * @brief Write all metrics to file, atomically replaced by rename
+   */
+  int export_file(const std::string& file);
+
+  /*!
+   * @brief Render metrics of current process merged with the ones exported by child processes
+   */
+  void render(const std::vector<std::string>& child_files, std::string& text);
+
+  static void parse(const std::string& text, MetricFamilies& families);
+
+  static void format(const MetricFamilies& families, std::string& text);
+
+  static std::string format_labels(const MetricLabels& labels, const std::string& extra = "");
+
+private:
+  struct HistogramEntry {
+    std::string name;
+    MetricLabels labels;
+    Histogram histogram;
+    HistogramSnapshot last;
+    HistogramSnapshot window;
+  };
+
+  struct GaugeEntry {
+    std::string name;
+    MetricLabels labels;
+    std::function<int64_t()> func;
+  };
+
+  MetricLabels merge_const_labels(const MetricLabels& labels);
+
+  void roll_histograms(uint64_t now_us);
+
+private:
+  std::mutex _lock;
+  uint64_t _rolled_us = 0;
+  MetricLabels _const_labels;
+  std::map<std::string, std::unique_ptr<HistogramEntry>> _histograms;
+  std::map<std::string, GaugeEntry> _gauges;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
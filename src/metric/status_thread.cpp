@@ -11,11 +11,13 @@
  */
 
 #include "status_thread.h"
+#include <algorithm>
 #include <iomanip>
 #include "log.h"
 #include "config.h"
 #include "timer.h"
 #include "sys_metric.h"
+#include "metric_registry.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -32,8 +34,16 @@ void StatusThread::register_gauge(const std::string& key, const std::function<in
 void StatusThread::run()
 {
   std::stringstream ss;
+  Timer metric_timer;
   while (is_run()) {
-    _timer.sleep(Config::instance().metric_interval_s.val() * 1000000);
+    // wakes up by the shorter of both, rolling quantile windows at their own pace
+    uint32_t interval_s = Config::instance().metric_interval_s.val();
+    _timer.sleep(std::max(1U, std::min(interval_s, Config::instance().metric_quantile_window_s.val())) * 1000000);
+    MetricRegistry::instance().roll_if_due(Timer::now());
+    if (metric_timer.elapsed() < (int64_t)interval_s * 1000000) {
+      continue;
+    }
+    metric_timer.reset();
 
     if (!_gauges.empty()) {
       ss.str("");
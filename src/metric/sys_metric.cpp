@@ -13,7 +13,9 @@
 #include <string>
 #include <cassert>
 #include <csignal>
-#include "shell_executor.h"
+#include <mutex>
+#include <set>
+#include <fcntl.h>
 #include "timer.h"
 #include "config.h"
 #include "fs_util.h"
@@ -40,6 +42,60 @@ static const int64_t UNIT_KB = 1024L;
 
 NetworkStatus _last_net_st;
 
+static std::mutex _s_tracked_lock;
+static std::set<int> _s_tracked_pids;
+static bool _s_discovered = false;
+static std::function<bool(const std::string&, uint64_t&)> _s_disk_usage_func;
+// folder size of paths without disk usage func, path -> <size in bytes, last refreshed time in us>
+static std::map<std::string, std::pair<uint64_t, uint64_t>> _s_folder_sizes;
+
+/*
+ * @description read a small file of procfs or cgroupfs into buffer which is reused among calls,
+ * so that no stream or per line string is allocated
+ */
+static bool read_proc_file(const char* filename, std::string& buf)
+{
+  int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  buf.clear();
+  size_t len = 0;
+  while (true) {
+    if (buf.size() < len + READ_BUF_SIZE) {
+      buf.resize(len + READ_BUF_SIZE);
+    }
+    ssize_t n = ::read(fd, &buf[len], buf.size() - len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ::close(fd);
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    len += n;
+  }
+  ::close(fd);
+  buf.resize(len);
+  return true;
+}
+
+/*
+ * @description parse the number following key in buffer, e.g. "VmRSS:    1024 kB"
+ */
+static bool parse_proc_field(const std::string& buf, const char* key, int64_t& value)
+{
+  size_t pos = buf.find(key);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  value = strtoll(buf.c_str() + pos + strlen(key), nullptr, 10);
+  return true;
+}
+
 static int get_cpu_core_count()
 {
   const std::string& filename = "/sys/fs/cgroup/cpuacct/cpuacct.usage_percpu";
@@ -112,52 +168,37 @@ static int64_t get_limit_cpu_core_count()
  */
 static int64_t get_sys_cpu_usage()
 {
-  const std::string& filename = "/proc/stat";
-  std::vector<std::string> lines;
-  if (!FsUtil::read_lines(filename, lines) || lines.empty()) {
-    OMS_STREAM_ERROR << "Failed to get_sys_cpu_usage for failed to read:" << filename;
+  static thread_local std::string buf;
+  if (!read_proc_file("/proc/stat", buf) || buf.empty()) {
+    OMS_STREAM_ERROR << "Failed to get_sys_cpu_usage for failed to read: /proc/stat";
     return -1;
   }
 
-  // find line of prefix equals "cpu "
-  std::string prefix = "cpu ";
-  for (const std::string& line : lines) {
-    if (line.empty()) {
-      continue;
-    }
-    size_t pos = line.find_first_of(prefix);
-    if (pos != 0) {
-      continue;
-    }
-
-    std::string cpu;
-    cpu = line.substr(pos + prefix.size());
-    trim(cpu);
-
-    std::vector<std::string> units;
-    split_by_str(cpu, " ", units);
-
-    int64_t total = 0;
-    for (const std::string& unit : units) {
-      if (unit.empty()) {
-        continue;
-      }
-      total += atof(unit.c_str());
+  // first line is the summary of all cpus, prefixed by "cpu "
+  if (buf.compare(0, 4, "cpu ") != 0) {
+    return 0;
+  }
+  const char* p = buf.c_str() + 4;
+  int64_t total = 0;
+  while (*p != '\n' && *p != '\0') {
+    char* end = nullptr;
+    total += strtoll(p, &end, 10);
+    if (end == p) {
+      break;
     }
-    return total;
+    p = end;
   }
-  return 0;
+  return total;
 }
 
 static int64_t get_cpu_tick()
 {
-  std::string result;
-  int ret = exec_cmd("getconf CLK_TCK", result);
-  if (ret != 0 || result.empty()) {
-    OMS_STREAM_ERROR << "Failed to get cpu tick for failed to exec cmd: getconf CLK_TCK";
+  int64_t tick = sysconf(_SC_CLK_TCK);
+  if (tick <= 0) {
+    OMS_STREAM_ERROR << "Failed to get cpu tick, error: " << system_err(errno);
     return 0;
   }
-  return atoll(result.c_str());
+  return tick;
 }
 
 static int64_t get_cpu_tick_nano(int64_t tick)
@@ -237,12 +278,18 @@ bool collect_load(LoadStatus& load_status)
 
 static int64_t get_mem_total()
 {
-  std::string result;
-  int ret = exec_cmd("cat /proc/meminfo | grep 'MemTotal' | awk '{print $(NF-1)}'", result);
-  if (ret != 0 || result.empty()) {
+  // physical memory never changes during the lifetime of process
+  static int64_t mem_total = 0;
+  if (mem_total != 0) {
+    return mem_total;
+  }
+  std::string buf;
+  int64_t value = 0;
+  if (!read_proc_file("/proc/meminfo", buf) || !parse_proc_field(buf, "MemTotal:", value) || value <= 0) {
     return MEM_DEFAULT;
   }
-  return atoll(result.c_str());
+  mem_total = value;
+  return mem_total;
 }
 
 bool collect_mem(MemoryStatus& memory_status)
@@ -280,9 +327,28 @@ bool collect_mem(MemoryStatus& memory_status)
   return true;
 }
 
+static uint64_t get_disk_usage(const std::string& path)
+{
+  uint64_t bytes = 0;
+  if (_s_disk_usage_func && _s_disk_usage_func(path, bytes)) {
+    return bytes;
+  }
+
+  // walking a directory is expensive, only refresh it at an interval much longer than the metric one
+  uint64_t now = Timer::now();
+  auto entry = _s_folder_sizes.find(path);
+  if (entry != _s_folder_sizes.end() &&
+      now - entry->second.second < Config::instance().metric_disk_refresh_interval_s.val() * 1000000) {
+    return entry->second.first;
+  }
+  bytes = FsUtil::folder_size(path);
+  _s_folder_sizes[path] = std::make_pair(bytes, now);
+  return bytes;
+}
+
 bool collect_disk(DiskStatus& disk_status, const std::string& path)
 {
-  uint64_t folder_size_bytes = FsUtil::folder_size(path);
+  uint64_t folder_size_bytes = get_disk_usage(path);
   disk_status.disk_usage_size_process_mb = folder_size_bytes / UNIT_MB;
   FsUtil::disk_info disk_info = FsUtil::space(path);
 
@@ -358,132 +424,176 @@ void collect_network(NetworkStatus& network_status)
 
 int64_t get_pro_cpu_time(unsigned int pid)
 {
-  char filename[1024];
-  std::memset(filename, 0, sizeof(filename));
-  sprintf(filename, "/proc/%d/stat", pid);
-  std::string content;
-  if (!FsUtil::read_file(filename, content)) {
+  static thread_local std::string buf;
+  char filename[READ_BUF_SIZE];
+  snprintf(filename, sizeof(filename), "/proc/%u/stat", pid);
+  if (!read_proc_file(filename, buf)) {
     OMS_STREAM_ERROR << "Failed to read stat:" << filename;
     return 0;
   }
-  std::vector<std::string> cpu_stat;
-  split(content, ' ', cpu_stat);
 
-  if (cpu_stat.size() < CPU_START_POS + 4) {
+  // comm in the 2nd field may contain spaces, so count fields from its closing parenthesis
+  size_t pos = buf.rfind(')');
+  if (pos == std::string::npos) {
     return 0;
   }
-  return atol(cpu_stat.at(CPU_START_POS).c_str()) + atol(cpu_stat.at(CPU_START_POS + 1).c_str()) +
-         atol(cpu_stat.at(CPU_START_POS + 2).c_str()) + atol(cpu_stat.at(CPU_START_POS + 3).c_str());
+  const char* p = buf.c_str() + pos + 1;
+  int64_t total = 0;
+  // utime, stime, cutime and cstime are the 14th to 17th fields
+  for (int field = 3; field < CPU_START_POS + 4 && *p != '\0'; ++field) {
+    while (*p == ' ') {
+      ++p;
+    }
+    char* end = nullptr;
+    int64_t value = strtoll(p, &end, 10);
+    if (field >= CPU_START_POS) {
+      total += value;
+    }
+    // skip the rest of non numeric field, i.e. state
+    for (p = end; *p != ' ' && *p != '\0'; ++p) {
+    }
+  }
+  return total;
 }
 
-void get_cpu_stat(unsigned int pid, CpuStatus& cpu_status)
+/*
+ * @description cpu ratio of process since last collection, instead of sampling for a while for each process
+ */
+void get_cpu_stat(unsigned int pid, int64_t sys_cpu, int64_t limit_cpu_core_count, ProcessMetric& process_metric)
 {
-  long s_cur_pro_cpu, s_pre_pro_cpu;
-  long s_cur_sys_cpu, s_pre_sys_cpu;
+  int64_t pro_cpu = get_pro_cpu_time(pid);
   float ratio = 0.0;
-  s_pre_pro_cpu = get_pro_cpu_time(pid);
-  s_pre_sys_cpu = get_sys_cpu_usage();
-
-  sleep(1);
-  s_cur_pro_cpu = get_pro_cpu_time(pid);
-  s_cur_sys_cpu = get_sys_cpu_usage();
-
-  if ((s_cur_pro_cpu == s_pre_pro_cpu) || (s_cur_sys_cpu == s_pre_sys_cpu) || (s_cur_pro_cpu == 0) ||
-      (s_cur_sys_cpu == 0)) {
-    ratio = 0;
-  } else {
-    ratio = (100.0f * float(s_cur_pro_cpu - s_pre_pro_cpu)) / float(s_cur_sys_cpu - s_pre_sys_cpu);
+  if (process_metric.last_pro_cpu != 0 && process_metric.last_sys_cpu != 0 && pro_cpu > process_metric.last_pro_cpu &&
+      sys_cpu > process_metric.last_sys_cpu) {
+    ratio = (100.0f * float(pro_cpu - process_metric.last_pro_cpu)) / float(sys_cpu - process_metric.last_sys_cpu);
   }
+  process_metric.last_pro_cpu = pro_cpu;
+  process_metric.last_sys_cpu = sys_cpu;
 
-  s_pre_pro_cpu = s_cur_pro_cpu;
-  s_pre_sys_cpu = s_cur_sys_cpu;
+  process_metric.cpu_status.cpu_used_ratio = ratio;
+  process_metric.cpu_status.cpu_count = limit_cpu_core_count;
+}
 
-  cpu_status.cpu_used_ratio = ratio;
-  cpu_status.cpu_count = get_limit_cpu_core_count();
+void track_process(int pid)
+{
+  std::lock_guard<std::mutex> lk(_s_tracked_lock);
+  _s_tracked_pids.insert(pid);
 }
 
-void collect_by_pid_name(const std::string& pid_name, ProcessGroupMetric& proc_group_metric)
+void set_disk_usage_func(const std::function<bool(const std::string& path, uint64_t& bytes)>& func)
 {
-  DIR* proc_dir;
-  struct dirent* ent;
-  char filename[READ_BUF_SIZE];
+  _s_disk_usage_func = func;
+}
 
-  proc_dir = opendir("/proc");
-  assert(proc_dir != nullptr);
+// comm of processes is cut to TASK_COMM_LEN - 1 characters by kernel, e.g. "binlog_converte"
+static constexpr size_t PROC_COMM_MAX_LENGTH = 15;
 
-  while ((ent = readdir(proc_dir)) != nullptr) {
-    if (strcmp(ent->d_name, "..") == 0) {
-      continue;
+static bool is_collected_process(const ProcessGroupMetric& proc_group_metric, const std::string& proc_name)
+{
+  for (const std::string& item_name : proc_group_metric.item_names) {
+    if (item_name.compare(0, PROC_COMM_MAX_LENGTH, proc_name) == 0) {
+      return true;
     }
+  }
+  return false;
+}
+
+/*
+ * @description discover processes started by previous incarnation of current process, which are still alive
+ */
+static void discover_processes(const ProcessGroupMetric& proc_group_metric)
+{
+  DIR* proc_dir = opendir("/proc");
+  if (proc_dir == nullptr) {
+    OMS_STREAM_ERROR << "Failed to open /proc, error: " << system_err(errno);
+    return;
+  }
 
+  std::string buf;
+  char filename[READ_BUF_SIZE];
+  struct dirent* ent;
+  while ((ent = readdir(proc_dir)) != nullptr) {
     if (!isdigit(*ent->d_name)) {
       continue;
     }
-
-    sprintf(filename, "/proc/%s/status", ent->d_name);
-
-    std::map<std::string, std::string> status;
-    if (!FsUtil::read_kvs(filename, "\t", status)) {
+    snprintf(filename, sizeof(filename), "/proc/%s/comm", ent->d_name);
+    if (!read_proc_file(filename, buf)) {
       continue;
     }
-
-    if (status.find("Name:") != status.end()) {
-      std::string proc_name = status.find("Name:")->second;
-      if (std::equal(proc_name.begin(), proc_name.end(), pid_name.c_str())) {
-        int pid = atoi(ent->d_name);
-        // Path to build symbolic links
-        char link_path[PATH_MAX];
-        std::memset(link_path, 0, sizeof(link_path));
-        std::snprintf(link_path, sizeof(link_path), "/proc/%d/cwd", pid);
-        // collect disk
-        // Read the target path pointed to by the symbolic link
-        char cwd[PATH_MAX];
-        std::memset(cwd, 0, sizeof(cwd));
-        if (readlink(link_path, cwd, sizeof(cwd)) == -1) {
-          continue;
-        }
-        ProcessMetric* process_metric = nullptr;
-        std::string path = std::string(cwd);
-        if (proc_group_metric.metric_group.find(path) != proc_group_metric.metric_group.end()) {
-          process_metric = proc_group_metric.metric_group.find(path)->second;
-        } else {
-          process_metric = new ProcessMetric();
-          process_metric->pid = pid;
-        }
-        // collect mem
-        if (status.find("VmRSS:") != status.end()) {
-          std::string vmrss_str = status.find("VmRSS:")->second;
-          logproxy::trim(vmrss_str);
-          std::vector<std::string> vmrss_parts;
-          logproxy::split(vmrss_str, ' ', vmrss_parts);
-          if (!vmrss_parts.empty()) {
-            uint64_t vmrss = std::stoul(vmrss_parts.at(0));
-            process_metric->memory_status.mem_used_size_mb = vmrss / 1024L;
-            process_metric->memory_status.mem_total_size_mb = get_mem_total() / 1024L;
-            process_metric->memory_status.mem_used_ratio =
-                process_metric->memory_status.mem_used_size_mb / process_metric->memory_status.mem_total_size_mb;
-          }
-        }
-        // collect cpu
-        get_cpu_stat(pid, process_metric->cpu_status);
-        // collect disk
-        /*!
-         * @brief Binlog mode collects resource indicators of non-main processes
-         */
-        if (Config::instance().binlog_mode.val() && !std::equal(proc_name.begin(), proc_name.end(), "logproxy")) {
-          collect_disk(process_metric->disk_status, path + DATA_DIR);
-        } else {
-          collect_disk(process_metric->disk_status, path);
-        }
-        process_metric->client_id = path;
-        proc_group_metric.metric_group.emplace(path, process_metric);
-      }
+    trim(buf);
+    if (is_collected_process(proc_group_metric, buf)) {
+      track_process(atoi(ent->d_name));
     }
   }
-
   closedir(proc_dir);
 }
 
+static bool collect_by_pid(int pid, int64_t sys_cpu, int64_t limit_cpu_core_count, ProcessGroupMetric& proc_group_metric)
+{
+  static thread_local std::string buf;
+  char filename[READ_BUF_SIZE];
+  snprintf(filename, sizeof(filename), "/proc/%d/status", pid);
+  if (!read_proc_file(filename, buf)) {
+    return false;
+  }
+
+  std::string proc_name;
+  size_t name_pos = buf.find("Name:");
+  if (name_pos != std::string::npos) {
+    size_t end = buf.find('\n', name_pos);
+    proc_name = buf.substr(name_pos + 5, end == std::string::npos ? std::string::npos : end - name_pos - 5);
+    trim(proc_name);
+  }
+  // pid reused by another program
+  if (!is_collected_process(proc_group_metric, proc_name)) {
+    return false;
+  }
+
+  // Path to build symbolic links
+  char link_path[READ_BUF_SIZE];
+  std::snprintf(link_path, sizeof(link_path), "/proc/%d/cwd", pid);
+  // Read the target path pointed to by the symbolic link
+  char cwd[PATH_MAX];
+  std::memset(cwd, 0, sizeof(cwd));
+  if (readlink(link_path, cwd, sizeof(cwd) - 1) == -1) {
+    return false;
+  }
+  std::string path = std::string(cwd);
+
+  ProcessMetric* process_metric = nullptr;
+  auto entry = proc_group_metric.metric_group.find(path);
+  if (entry != proc_group_metric.metric_group.end()) {
+    process_metric = entry->second;
+    process_metric->pid = pid;
+  } else {
+    process_metric = new ProcessMetric();
+    process_metric->pid = pid;
+    process_metric->client_id = path;
+    proc_group_metric.metric_group.emplace(path, process_metric);
+  }
+
+  // collect mem
+  int64_t vmrss = 0;
+  if (parse_proc_field(buf, "VmRSS:", vmrss)) {
+    process_metric->memory_status.mem_used_size_mb = vmrss / 1024L;
+    process_metric->memory_status.mem_total_size_mb = get_mem_total() / 1024L;
+    process_metric->memory_status.mem_used_ratio =
+        (float)process_metric->memory_status.mem_used_size_mb / process_metric->memory_status.mem_total_size_mb;
+  }
+  // collect cpu
+  get_cpu_stat(pid, sys_cpu, limit_cpu_core_count, *process_metric);
+  // collect disk
+  /*!
+   * @brief Binlog mode collects resource indicators of non-main processes
+   */
+  if (Config::instance().binlog_mode.val() && proc_name != "logproxy") {
+    collect_disk(process_metric->disk_status, path + DATA_DIR);
+  } else {
+    collect_disk(process_metric->disk_status, path);
+  }
+  return true;
+}
+
 bool collect_metric(SysMetric& metric, ProcessGroupMetric& pro_group_metric)
 {
   SysMetric temp;
@@ -521,20 +631,44 @@ bool collect_metric(SysMetric& metric, ProcessGroupMetric& pro_group_metric)
  */
 bool collect_process_metric(ProcessGroupMetric& proc_group_metric)
 {
+  if (!_s_discovered) {
+    discover_processes(proc_group_metric);
+    _s_discovered = true;
+  }
+
+  std::set<int> pids;
+  {
+    std::lock_guard<std::mutex> lk(_s_tracked_lock);
+    _s_tracked_pids.insert(getpid());
+    pids = _s_tracked_pids;
+  }
+
+  int64_t sys_cpu = get_sys_cpu_usage();
+  int64_t limit_cpu_core_count = get_limit_cpu_core_count();
+  std::set<int> alive_pids;
+  for (int pid : pids) {
+    if (collect_by_pid(pid, sys_cpu, limit_cpu_core_count, proc_group_metric)) {
+      alive_pids.insert(pid);
+      continue;
+    }
+    std::lock_guard<std::mutex> lk(_s_tracked_lock);
+    _s_tracked_pids.erase(pid);
+  }
+
   // Clean up dead process indicators
-  for (auto iter = proc_group_metric.metric_group.begin(); iter != proc_group_metric.metric_group.end(); ++iter) {
-    if (iter->second != nullptr && 0 != kill(iter->second->pid, 0)) {
+  for (auto iter = proc_group_metric.metric_group.begin(); iter != proc_group_metric.metric_group.end();) {
+    if (iter->second != nullptr && alive_pids.count(iter->second->pid) != 0) {
+      ++iter;
+      continue;
+    }
+    if (iter->second != nullptr) {
       OMS_INFO("The current process {} is no longer alive,pid:{},remove the process from indicator collection",
           iter->second->client_id,
           iter->second->pid);
+      _s_folder_sizes.erase(iter->second->client_id);
       delete iter->second;
-      iter->second = nullptr;
-      proc_group_metric.metric_group.erase(iter);
     }
-  }
-
-  for (const std::string& proc_name : proc_group_metric.item_names) {
-    collect_by_pid_name(proc_name, proc_group_metric);
+    iter = proc_group_metric.metric_group.erase(iter);
   }
   return true;
 }
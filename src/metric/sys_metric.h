@@ -16,6 +16,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 #include "jsonutil.hpp"
 #include "log.h"
 namespace oceanbase {
@@ -99,6 +100,9 @@ struct ProcessMetric {
   CpuStatus cpu_status;
   DiskStatus disk_status;
   NetworkStatus network_status;
+  // cpu time of process and system at last collection, in ticks
+  int64_t last_pro_cpu = 0;
+  int64_t last_sys_cpu = 0;
 
   bool operator==(const ProcessMetric& rhs) const
   {
@@ -161,6 +165,17 @@ bool collect_metric(SysMetric& metric, ProcessGroupMetric& pro_group_metric);
 
 bool collect_process_metric(ProcessGroupMetric& proc_group_metric);
 
+/*
+ * @description register a child process to collect, so that collection never scans all processes in /proc
+ */
+void track_process(int pid);
+
+/*
+ * @description compute disk usage of a working path without walking it, e.g. from binlog index,
+ * falls back to walking the path at metric_disk_refresh_interval_s when returns false
+ */
+void set_disk_usage_func(const std::function<bool(const std::string& path, uint64_t& bytes)>& func);
+
 void get_network_stat(NetworkStatus& network_status);
 
 extern logproxy::SysMetric g_metric;
@@ -24,9 +24,39 @@ void ClogMetaRoutine::stop()
 {
   if (is_run()) {
     Thread::stop();
+    _timer.interrupt();
   }
 }
 
+int ClogMetaRoutine::publish(const std::string& shm_name)
+{
+  return _shared.create(shm_name);
+}
+
+int ClogMetaRoutine::subscribe(const std::string& shm_name)
+{
+  _subscribed_name = shm_name;
+  return _shared.open(shm_name);
+}
+
+static uint64_t shared_max_age_us()
+{
+  // the poller of logproxy process publishes every interval, allow it to miss one
+  return Config::instance().ob_clog_fetch_interval_s.val() * 2 * 1000000;
+}
+
+bool ClogMetaRoutine::read_shared(uint64_t& min_clog_timestamp_us)
+{
+  if (_shared.owner() || _subscribed_name.empty()) {
+    return false;
+  }
+  if (_shared.read(min_clog_timestamp_us, shared_max_age_us())) {
+    return true;
+  }
+  // not yet published when subscribed, or the segment mapped has been unlinked by a stopped poller
+  return _shared.open(_subscribed_name) == OMS_OK && _shared.read(min_clog_timestamp_us, shared_max_age_us());
+}
+
 int ClogMetaRoutine::init(const OblogConfig& config)
 {
   if (!Config::instance().check_clog_enable.val()) {
@@ -40,7 +70,17 @@ int ClogMetaRoutine::init(const OblogConfig& config)
     return ret;
   }
 
-  ret = _ob_access.fetch_connection(_sys_auther);
+  uint64_t min_clog_timestamp_us = 0;
+  if (read_shared(min_clog_timestamp_us)) {
+    OMS_STREAM_INFO << "Use min clog timestamp published by logproxy: " << min_clog_timestamp_us;
+    return OMS_OK;
+  }
+  return connect();
+}
+
+int ClogMetaRoutine::connect()
+{
+  int ret = _ob_access.fetch_connection(_sys_auther);
   if (ret != OMS_OK) {
     return ret;
   }
@@ -58,32 +98,39 @@ int ClogMetaRoutine::init(const OblogConfig& config)
 
 void ClogMetaRoutine::run()
 {
-  Timer timer;
-  timer.reset();
   while (is_run() && _available) {
-    uint64_t min_clog_timestamp_us = 0;
-    int ret = fetch_once(min_clog_timestamp_us);
-    if (ret == OMS_CONNECT_FAILED) {
-      // When a connection error occurs, it means that there is already a problem with the connection and needs to be
-      // re-established, so the previous connection needs to be closed here
-      _sys_auther.close();
-      // Re-request the config server to obtain the corresponding available observer address
-      this->init(_oblog_config);
-      // try to fetch new connection
-      ret = _ob_access.fetch_connection(_sys_auther);
-      OMS_STREAM_WARN << "Try to fetch new connection:" << ret;
-      if (ret != OMS_OK) {
-        _sys_auther.close();
-      }
-      timer.sleep(Config::instance().ob_clog_fetch_interval_s.val() * 1000000);
-      continue;
+    poll_once();
+    _timer.sleep(Config::instance().ob_clog_fetch_interval_s.val() * 1000000);
+  }
+}
+
+int ClogMetaRoutine::poll_once()
+{
+  uint64_t min_clog_timestamp_us = 0;
+  int ret = fetch_once(min_clog_timestamp_us);
+  if (ret == OMS_CONNECT_FAILED) {
+    // When a connection error occurs, it means that there is already a problem with the connection and needs to be
+    // re-established, so the previous connection needs to be closed here
+    _sys_auther.discard();
+    // Re-request the config server to obtain the corresponding available observer address
+    if (!_oblog_config.cluster_url.empty()) {
+      ObMetaCache::instance().invalidate_servers(_oblog_config.cluster_url.val());
     }
-    if (min_clog_timestamp_us != 0) {
-      _min_clog_timestamp_us = min_clog_timestamp_us;
-      OMS_STREAM_INFO << "min clog timestamp in us: " << _min_clog_timestamp_us;
+    _ob_access.init(_oblog_config, _oblog_config.password_sha1, _oblog_config.sys_password_sha1);
+    // try to fetch new connection
+    ret = connect();
+    OMS_STREAM_WARN << "Try to fetch new connection:" << ret;
+    if (ret != OMS_OK) {
+      _sys_auther.discard();
     }
-    timer.sleep(Config::instance().ob_clog_fetch_interval_s.val() * 1000000);
+    return OMS_CONNECT_FAILED;
+  }
+  if (min_clog_timestamp_us != 0) {
+    _min_clog_timestamp_us.store(min_clog_timestamp_us);
+    _shared.publish(min_clog_timestamp_us);
+    OMS_STREAM_INFO << "min clog timestamp in us: " << min_clog_timestamp_us;
   }
+  return ret;
 }
 
 int ClogMetaRoutine::fetch_once(uint64_t& min_clog_timestamp_us)
@@ -91,6 +138,20 @@ int ClogMetaRoutine::fetch_once(uint64_t& min_clog_timestamp_us)
   if (!_available) {
     return OMS_OK;
   }
+  if (read_shared(min_clog_timestamp_us)) {
+    if (_sys_auther.valid()) {
+      // polled by logproxy again, e.g. the oblogreader started before the first poll, no longer need the connection
+      _sys_auther.discard();
+    }
+    return OMS_OK;
+  }
+  if (!_sys_auther.valid()) {
+    // published timestamps went stale, e.g. logproxy restarted, poll by ourselves
+    int ret = connect();
+    if (ret != OMS_OK) {
+      return OMS_CONNECT_FAILED;
+    }
+  }
 
   MySQLResultSet rs;
   int ret = _sys_auther.query(FETCH_CLOG_MIN_TS_SQL, rs);
@@ -115,8 +176,9 @@ int ClogMetaRoutine::fetch_once(uint64_t& min_clog_timestamp_us)
 bool ClogMetaRoutine::check(uint64_t clog_timestamp_us)
 {
   uint64_t now_time = Timer::now();
-  bool ret = !_available || clog_timestamp_us == 0 || _min_clog_timestamp_us == 0 ||
-             clog_timestamp_us >= _min_clog_timestamp_us;
+  uint64_t min_clog_timestamp_us = _min_clog_timestamp_us.load();
+  bool ret = !_available || clog_timestamp_us == 0 || min_clog_timestamp_us == 0 ||
+             clog_timestamp_us >= min_clog_timestamp_us;
   if (ret) {
     _last_check_timestamp_us = now_time;
   } else {
@@ -129,12 +191,15 @@ bool ClogMetaRoutine::check(uint64_t clog_timestamp_us)
 
 bool ClogMetaRoutine::check(const OblogConfig& config, std::string& errmsg)
 {
-  fetch_once(_min_clog_timestamp_us);
+  uint64_t min_clog_timestamp_us = 0;
+  if (fetch_once(min_clog_timestamp_us) == OMS_OK && min_clog_timestamp_us != 0) {
+    _min_clog_timestamp_us.store(min_clog_timestamp_us);
+  }
   bool ret = (config.start_timestamp_us.val() != 0) ? check(config.start_timestamp_us.val())
                                                     : check(config.start_timestamp.val() * 1000000);
   if (!ret) {
     errmsg =
-        "Invalid start timestamp while current min clog timestamp in us: " + std::to_string(_min_clog_timestamp_us);
+        "Invalid start timestamp while current min clog timestamp in us: " + std::to_string(_min_clog_timestamp_us.load());
   }
   return ret;
 }
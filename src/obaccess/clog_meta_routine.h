@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <atomic>
 #include "thread.h"
+#include "timer.h"
 #include "mysql_protocol.h"
 #include "oblog_config.h"
 #include "ob_access.h"
+#include "clog_meta_shm.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -27,8 +30,31 @@ public:
 
   int init(const OblogConfig& config);
 
+  /*!
+   * @brief Publish polled timestamps to the shared memory segment, by the poller of logproxy process.
+   * Must be called before init.
+   */
+  int publish(const std::string& shm_name);
+
+  /*!
+   * @brief Read timestamps published by logproxy process while they are fresh, and only query observers when they
+   * are not. Must be called before init. The segment is opened again on each fetch until it is found, or when it
+   * went stale, e.g. republished by a new poller of the cluster.
+   */
+  int subscribe(const std::string& shm_name);
+
   int fetch_once(uint64_t& min_clog_timestamp_us);
 
+  /*!
+   * @brief Fetch once and remember the result, re-resolve servers and reconnect on connection failure
+   */
+  int poll_once();
+
+  inline uint64_t min_clog_timestamp_us() const
+  {
+    return _min_clog_timestamp_us.load();
+  }
+
   bool check(uint64_t clog_timestamp_us);
 
   bool check(const OblogConfig& config, std::string& errmsg);
@@ -36,14 +62,22 @@ public:
 protected:
   void run() override;
 
+private:
+  int connect();
+
+  bool read_shared(uint64_t& min_clog_timestamp_us);
+
 private:
   bool _available = true;
   uint64_t _last_check_timestamp_us = 0;
 
-  uint64_t _min_clog_timestamp_us = 0;
-  MysqlProtocol _sys_auther;
+  std::atomic<uint64_t> _min_clog_timestamp_us{0};
+  MysqlConnectionPool::Connection _sys_auther;
   ObAccess _ob_access;
   OblogConfig _oblog_config{""};
+  ClogMetaShm _shared;
+  std::string _subscribed_name;
+  Timer _timer;
 };
 
 }  // namespace logproxy
@@ -0,0 +1,181 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "log.h"
+#include "timer.h"
+#include "obaccess/clog_meta_shm.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+ClogMetaShm::~ClogMetaShm()
+{
+  close();
+}
+
+std::string ClogMetaShm::name(pid_t owner, const OblogConfig& config)
+{
+  const std::string& cluster = !config.cluster_url.empty() ? config.cluster_url.val() : config.root_servers.val();
+  // FNV-1a, stable across the binaries of logproxy and oblogreader
+  uint64_t hash = 14695981039346656037UL;
+  for (char c : cluster) {
+    hash = (hash ^ (uint8_t)c) * 1099511628211UL;
+  }
+  char buf[64];
+  snprintf(buf, sizeof(buf), "oblogproxy.%d.clog.%016lx", owner, hash);
+  return buf;
+}
+
+void ClogMetaShm::remove_stale()
+{
+  DIR* dir = opendir("/dev/shm");
+  if (dir == nullptr) {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    int owner = 0;
+    int consumed = 0;
+    if (sscanf(entry->d_name, "oblogproxy.%d.clog.%*16[0-9a-f]%n", &owner, &consumed) != 1 ||
+        entry->d_name[consumed] != '\0' || consumed == 0) {
+      continue;
+    }
+    // segments of other logproxy processes alive on the host are left alone
+    if (owner == getpid() || (owner > 0 && (kill(owner, 0) == 0 || errno != ESRCH))) {
+      continue;
+    }
+    std::string path = std::string("/dev/shm/") + entry->d_name;
+    if (::unlink(path.c_str()) == 0) {
+      OMS_STREAM_INFO << "Removed stale shared memory of clog timestamps: " << path;
+    }
+  }
+  closedir(dir);
+}
+
+int ClogMetaShm::create(const std::string& name)
+{
+  close();
+  std::string path = "/dev/shm/" + name;
+  // a poller of the same cluster being stopped may still map the old segment, never reuse it
+  ::unlink(path.c_str());
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    OMS_STREAM_ERROR << "Failed to create shared memory: " << path << ", error: " << strerror(errno);
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return OMS_FAILED;
+  }
+  if (ftruncate(fd, sizeof(Slot)) != 0) {
+    OMS_STREAM_ERROR << "Failed to resize shared memory: " << path << ", error: " << strerror(errno);
+    ::close(fd);
+    ::unlink(path.c_str());
+    return OMS_FAILED;
+  }
+  void* addr = mmap(nullptr, sizeof(Slot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    OMS_STREAM_ERROR << "Failed to map shared memory: " << path << ", error: " << strerror(errno);
+    ::unlink(path.c_str());
+    return OMS_FAILED;
+  }
+
+  _slot = static_cast<Slot*>(addr);
+  _slot->min_clog_timestamp_us.store(0);
+  _slot->update_us.store(0);
+  _slot->magic = MAGIC;
+  _path = path;
+  _inode = st.st_ino;
+  _owner = true;
+  return OMS_OK;
+}
+
+int ClogMetaShm::open(const std::string& name)
+{
+  close();
+  std::string path = "/dev/shm/" + name;
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return OMS_FAILED;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Slot)) {
+    ::close(fd);
+    return OMS_FAILED;
+  }
+  void* addr = mmap(nullptr, sizeof(Slot), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    OMS_STREAM_WARN << "Failed to map shared memory: " << path << ", error: " << strerror(errno);
+    return OMS_FAILED;
+  }
+
+  _slot = static_cast<Slot*>(addr);
+  if (_slot->magic != MAGIC) {
+    close();
+    return OMS_FAILED;
+  }
+  _path = path;
+  _owner = false;
+  return OMS_OK;
+}
+
+void ClogMetaShm::close()
+{
+  if (_slot != nullptr) {
+    munmap(_slot, sizeof(Slot));
+    _slot = nullptr;
+  }
+  if (_owner) {
+    // the path may have been taken over by a new poller of the same cluster
+    struct stat st;
+    if (stat(_path.c_str(), &st) == 0 && st.st_ino == _inode) {
+      ::unlink(_path.c_str());
+    }
+    _owner = false;
+  }
+  _path.clear();
+}
+
+void ClogMetaShm::publish(uint64_t min_clog_timestamp_us)
+{
+  if (_slot == nullptr || !_owner) {
+    return;
+  }
+  _slot->min_clog_timestamp_us.store(min_clog_timestamp_us, std::memory_order_relaxed);
+  _slot->update_us.store(Timer::now(), std::memory_order_release);
+}
+
+bool ClogMetaShm::read(uint64_t& min_clog_timestamp_us, uint64_t max_age_us) const
+{
+  if (_slot == nullptr) {
+    return false;
+  }
+  uint64_t update_us = _slot->update_us.load(std::memory_order_acquire);
+  if (update_us == 0 || update_us + max_age_us < Timer::now()) {
+    return false;
+  }
+  min_clog_timestamp_us = _slot->min_clog_timestamp_us.load(std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <atomic>
+#include <string>
+#include "common.h"
+#include "oblog_config.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Min clog timestamp of a cluster published in shared memory by the poller of logproxy process, so that
+ * oblogreaders of the same cluster read it rather than each of them querying observers.
+ * The segment is named after pid of logproxy process, oblogreaders find it by their parent pid.
+ */
+class ClogMetaShm {
+  OMS_AVOID_COPY(ClogMetaShm);
+
+public:
+  ClogMetaShm() = default;
+
+  ~ClogMetaShm();
+
+  static std::string name(pid_t owner, const OblogConfig& config);
+
+  /*!
+   * @brief Unlink segments left by logproxy processes no longer alive, e.g. killed before their pollers stopped
+   */
+  static void remove_stale();
+
+  /*!
+   * @brief Create the segment to publish, by logproxy process
+   */
+  int create(const std::string& name);
+
+  /*!
+   * @brief Map an existing segment read only, by oblogreader
+   */
+  int open(const std::string& name);
+
+  void close();
+
+  inline bool opened() const
+  {
+    return _slot != nullptr;
+  }
+
+  inline bool owner() const
+  {
+    return _owner;
+  }
+
+  void publish(uint64_t min_clog_timestamp_us);
+
+  /*!
+   * @return false if nothing published within max_age_us, e.g. the poller has stopped or lost its connection
+   */
+  bool read(uint64_t& min_clog_timestamp_us, uint64_t max_age_us) const;
+
+private:
+  struct Slot {
+    uint64_t magic;
+    std::atomic<uint64_t> min_clog_timestamp_us;
+    std::atomic<uint64_t> update_us;
+  };
+
+  static constexpr uint64_t MAGIC = 0x4f4d53434c4f4731;  // OMSCLOG1
+
+  std::string _path;
+  ino_t _inode = 0;
+  Slot* _slot = nullptr;
+  bool _owner = false;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
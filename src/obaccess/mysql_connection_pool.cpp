@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "config.h"
+#include "log.h"
+#include "timer.h"
+#include "obaccess/mysql_connection_pool.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+MysqlConnectionPool::Connection::~Connection()
+{
+  release();
+}
+
+int MysqlConnectionPool::Connection::query(const std::string& sql, MySQLResultSet& rs)
+{
+  if (_conn == nullptr) {
+    OMS_STREAM_ERROR << "Failed to query with a released connection";
+    return OMS_FAILED;
+  }
+  int ret = _conn->query(sql, rs);
+  if (ret == OMS_CONNECT_FAILED && _reused) {
+    OMS_STREAM_WARN << "Pooled connection to " << _host << ":" << _port << " lost while idle, login again";
+    _reused = false;
+    _conn.reset(new MysqlProtocol());
+    ret = _conn->login(_host, _port, _user, _passwd_sha1);
+    if (ret == OMS_OK) {
+      ret = _conn->query(sql, rs);
+    }
+  }
+  if (ret == OMS_CONNECT_FAILED) {
+    _broken = true;
+  }
+  return ret;
+}
+
+void MysqlConnectionPool::Connection::release()
+{
+  if (_conn != nullptr) {
+    MysqlConnectionPool::instance().give_back(*this);
+  }
+}
+
+void MysqlConnectionPool::Connection::discard()
+{
+  _broken = true;
+  release();
+}
+
+int MysqlConnectionPool::acquire(
+    const std::string& host, int port, const std::string& user, const std::string& passwd_sha1, Connection& conn)
+{
+  conn.release();
+  conn._key = host + ":" + std::to_string(port) + "/" + user + "/" + dumphex(passwd_sha1);
+  conn._host = host;
+  conn._port = port;
+  conn._user = user;
+  conn._passwd_sha1 = passwd_sha1;
+  conn._broken = false;
+
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    purge(Timer::now());
+    auto entry = _idles.find(conn._key);
+    if (entry != _idles.end() && !entry->second.empty()) {
+      // the most recently used one is the least likely closed by observer
+      conn._conn = std::move(entry->second.back().conn);
+      entry->second.pop_back();
+      conn._reused = true;
+      return OMS_OK;
+    }
+  }
+
+  conn._reused = false;
+  conn._conn.reset(new MysqlProtocol());
+  int ret = conn._conn->login(host, port, user, passwd_sha1);
+  if (ret != OMS_OK) {
+    conn._conn.reset();
+  }
+  return ret;
+}
+
+void MysqlConnectionPool::give_back(Connection& conn)
+{
+  std::unique_ptr<MysqlProtocol> mysql = std::move(conn._conn);
+  uint32_t max_idle = _s_config.ob_connection_pool_max_idle.val();
+  if (conn._broken || max_idle == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(_lock);
+  std::deque<IdleConnection>& idles = _idles[conn._key];
+  if (idles.size() >= max_idle) {
+    return;
+  }
+  idles.push_back(IdleConnection{std::move(mysql), Timer::now()});
+}
+
+void MysqlConnectionPool::purge(uint64_t now_us)
+{
+  uint64_t timeout_us = _s_config.ob_connection_idle_timeout_s.val() * 1000000UL;
+  for (auto entry = _idles.begin(); entry != _idles.end();) {
+    std::deque<IdleConnection>& idles = entry->second;
+    while (!idles.empty() && idles.front().idle_since_us + timeout_us <= now_us) {
+      idles.pop_front();
+    }
+    if (idles.empty()) {
+      entry = _idles.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void MysqlConnectionPool::clear()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _idles.clear();
+}
+
+size_t MysqlConnectionPool::idle_count()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  size_t count = 0;
+  for (auto& entry : _idles) {
+    count += entry.second.size();
+  }
+  return count;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
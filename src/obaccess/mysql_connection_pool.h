@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "common.h"
+#include "mysql_protocol.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Logged in connections to observers kept alive and reused across operations, keyed by server and credentials,
+ * so that metadata queries do not pay a TCP connect and scramble handshake each time.
+ * Idle connections are kept up to ob_connection_pool_max_idle per key for ob_connection_idle_timeout_s.
+ */
+class MysqlConnectionPool {
+  OMS_SINGLETON(MysqlConnectionPool);
+  OMS_AVOID_COPY(MysqlConnectionPool);
+
+public:
+  /*!
+   * @brief Borrowed connection, given back to the pool on release() or destruction unless it is broken
+   */
+  class Connection {
+    OMS_AVOID_COPY(Connection);
+
+  public:
+    Connection() = default;
+
+    ~Connection();
+
+    /*!
+     * @brief Query and mark the connection broken on network errors. A connection reused from the pool may have been
+     * closed by observer while idle, in which case login again and retry once.
+     */
+    int query(const std::string& sql, MySQLResultSet& rs);
+
+    void release();
+
+    /*!
+     * @brief Close the connection rather than give it back
+     */
+    void discard();
+
+    inline bool valid() const
+    {
+      return _conn != nullptr;
+    }
+
+    inline bool reused() const
+    {
+      return _reused;
+    }
+
+  private:
+    friend class MysqlConnectionPool;
+
+    std::string _key;
+    std::string _host;
+    int _port = 0;
+    std::string _user;
+    std::string _passwd_sha1;
+    std::unique_ptr<MysqlProtocol> _conn;
+    bool _reused = false;
+    bool _broken = false;
+  };
+
+  int acquire(const std::string& host, int port, const std::string& user, const std::string& passwd_sha1,
+      Connection& conn);
+
+  /*!
+   * @brief Close all idle connections
+   */
+  void clear();
+
+  size_t idle_count();
+
+private:
+  void give_back(Connection& conn);
+
+  void purge(uint64_t now_us);
+
+private:
+  struct IdleConnection {
+    std::unique_ptr<MysqlProtocol> conn;
+    uint64_t idle_since_us;
+  };
+
+  std::mutex _lock;
+  std::unordered_map<std::string, std::deque<IdleConnection>> _idles;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -106,10 +106,14 @@ int ObAccess::init(const OblogConfig& hs_config, const std::string& password_sha
   _user_to_conn = _user;
   _password_sha1 = password_sha1;
   _sys_password_sha1 = sys_password_sha1;
+  _servers.clear();
 
   std::vector<std::string> sections;
   if (!hs_config.cluster_url.empty()) {
-    if (parse_cluster_url(hs_config.cluster_url.val(), _servers) != OMS_OK) {
+    const std::string& cluster_url = hs_config.cluster_url.val();
+    int ret = ObMetaCache::instance().servers(
+        cluster_url, _servers, [&](std::vector<ServerInfo>& servers) { return parse_cluster_url(cluster_url, servers); });
+    if (ret != OMS_OK) {
       return OMS_FAILED;
     }
     _user_to_conn = ObUsername(_user).name_without_cluster();
@@ -165,19 +169,30 @@ int ObAccess::init(const OblogConfig& hs_config, const std::string& password_sha
     return ret;
   }
 
+  const std::string& cluster = !hs_config.cluster_url.empty() ? hs_config.cluster_url.val() : hs_config.root_servers.val();
+  _auth_key = ObMetaCache::make_key({cluster,
+      _user,
+      _password_sha1,
+      _sys_user,
+      _sys_password_sha1,
+      hs_config.tenant.val(),
+      hs_config.table_whites.val()});
+  _version_key = ObMetaCache::make_key({cluster, _sys_user, _sys_password_sha1});
   return OMS_OK;
 }
 
 int ObAccess::auth()
 {
-  for (auto& server : _servers) {
-    bool auth_by_sys = _table_whites.all_tenant || _table_whites.with_sys;
-    int ret = auth_by_sys ? auth_sys(server) : auth_tenant(server);
-    if (ret != OMS_OK) {
-      return OMS_FAILED;
+  return ObMetaCache::instance().auth(_auth_key, [this]() {
+    for (auto& server : _servers) {
+      bool auth_by_sys = _table_whites.all_tenant || _table_whites.with_sys;
+      int ret = auth_by_sys ? auth_sys(server) : auth_tenant(server);
+      if (ret != OMS_OK) {
+        return OMS_FAILED;
+      }
     }
-  }
-  return OMS_OK;
+    return OMS_OK;
+  });
 }
 
 int ObAccess::auth_sys(const ServerInfo& server)
@@ -213,8 +228,8 @@ int ObAccess::auth_tenant(const ServerInfo& server)
   OMS_STREAM_INFO << "About to auth user: " << _user << " for observer: " << server.host << ":" << server.port;
 
   // 1. found tenant server using sys
-  MysqlProtocol sys_auther;
-  int ret = sys_auther.login(server.host, server.port, _sys_user, _sys_password_sha1);
+  MysqlConnectionPool::Connection sys_auther;
+  int ret = MysqlConnectionPool::instance().acquire(server.host, server.port, _sys_user, _sys_password_sha1, sys_auther);
   if (ret != OMS_OK) {
     return ret;
   }
@@ -346,34 +361,45 @@ int ObAccess::fetch_connection(MysqlProtocol& mysql_protocol)
   return mysql_protocol.login(server_info.host, server_info.port, _sys_user, _sys_password_sha1);
 }
 
-int ObAccess::query_ob_version(const OblogConfig& config, std::string& ob_version)
+int ObAccess::fetch_connection(MysqlConnectionPool::Connection& connection)
 {
-  int ret = init(config, config.password_sha1, config.sys_password_sha1);
-  if (OMS_OK != ret) {
-    return ret;
+  ServerInfo server_info;
+  if (!_servers.empty()) {
+    server_info = _servers.front();
   }
+  return MysqlConnectionPool::instance().acquire(
+      server_info.host, server_info.port, _sys_user, _sys_password_sha1, connection);
+}
 
-  MysqlProtocol sys_user;
-  ret = fetch_connection(sys_user);
+int ObAccess::query_ob_version(const OblogConfig& config, std::string& ob_version)
+{
+  int ret = init(config, config.password_sha1, config.sys_password_sha1);
   if (OMS_OK != ret) {
     return ret;
   }
 
-  MySQLResultSet rs;
-  ret = sys_user.query(QUERY_OB_VERSION, rs);
-  if (OMS_OK != ret) {
-    OMS_ERROR("Failed to fetch OB version, code: {}, error: {}", rs.code, rs.message);
-    return ret;
-  }
+  return ObMetaCache::instance().ob_version(_version_key, ob_version, [this](std::string& version) {
+    MysqlConnectionPool::Connection sys_user;
+    int ret = fetch_connection(sys_user);
+    if (OMS_OK != ret) {
+      return ret;
+    }
 
-  ob_version = rs.rows.front().fields()[6];
-  if (ob_version.empty()) {
-    OMS_ERROR("Failed to parse OB version from MySQLResultSet.");
-    return OMS_FAILED;
-  }
-  OMS_INFO("OB version: {}", ob_version);
+    MySQLResultSet rs;
+    ret = sys_user.query(QUERY_OB_VERSION, rs);
+    if (OMS_OK != ret) {
+      OMS_ERROR("Failed to fetch OB version, code: {}, error: {}", rs.code, rs.message);
+      return ret;
+    }
 
-  return OMS_OK;
+    version = rs.rows.front().fields()[6];
+    if (version.empty()) {
+      OMS_ERROR("Failed to parse OB version from MySQLResultSet.");
+      return OMS_FAILED;
+    }
+    OMS_INFO("OB version: {}", version);
+    return OMS_OK;
+  });
 }
 
 ObUsername::ObUsername(const std::string& full_name)
@@ -17,16 +17,15 @@
 #include <unordered_set>
 #include "oblog_config.h"
 #include "mysql_protocol.h"
+#include "mysql_connection_pool.h"
+#include "ob_meta_cache.h"
 
 namespace oceanbase {
 namespace logproxy {
 
 class ObAccess {
 public:
-  struct ServerInfo {
-    std::string host;
-    int port;
-  };
+  using ServerInfo = ObServerAddr;
 
 public:
   ObAccess() = default;
@@ -36,6 +35,11 @@ public:
 
   int fetch_connection(MysqlProtocol& mysql_protocol);
 
+  /*!
+   * @brief Borrow a sys connection to the first server from MysqlConnectionPool
+   */
+  int fetch_connection(MysqlConnectionPool::Connection& connection);
+
   int auth();
 
   int query_ob_version(const OblogConfig&, std::string&);
@@ -57,6 +61,10 @@ private:
 
   // TODO... database table auth
   TenantDbTable _table_whites;
+
+  // cache keys of auth verdict and observer version, built in init
+  std::string _auth_key;
+  std::string _version_key;
 };
 
 struct ObUsername {
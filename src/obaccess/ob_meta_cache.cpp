@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "config.h"
+#include "metric/metric_registry.h"
+#include "obaccess/ob_meta_cache.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+static Config& _s_config = Config::instance();
+
+static uint64_t ttl_us()
+{
+  return _s_config.ob_meta_cache_ttl_s.val() * 1000000UL;
+}
+
+static uint64_t negative_ttl_us()
+{
+  return _s_config.ob_meta_cache_negative_ttl_s.val() * 1000000UL;
+}
+
+int ObMetaCache::servers(const std::string& cluster_url, std::vector<ObServerAddr>& servers,
+    const std::function<int(std::vector<ObServerAddr>&)>& loader)
+{
+  return _servers.get(cluster_url, servers, ttl_us(), negative_ttl_us(), loader);
+}
+
+void ObMetaCache::invalidate_servers(const std::string& cluster_url)
+{
+  _servers.invalidate(cluster_url);
+}
+
+int ObMetaCache::auth(const std::string& key, const std::function<int()>& loader)
+{
+  bool verdict = false;
+  return _auths.get(key, verdict, ttl_us(), negative_ttl_us(), [&](bool& passed) {
+    int ret = loader();
+    passed = (ret == OMS_OK);
+    return ret;
+  });
+}
+
+int ObMetaCache::ob_version(
+    const std::string& key, std::string& ob_version, const std::function<int(std::string&)>& loader)
+{
+  return _ob_versions.get(key, ob_version, ttl_us(), negative_ttl_us(), loader);
+}
+
+void ObMetaCache::clear()
+{
+  _servers.clear();
+  _auths.clear();
+  _ob_versions.clear();
+}
+
+void ObMetaCache::register_metrics()
+{
+  MetricRegistry& registry = MetricRegistry::instance();
+  registry.register_gauge("logproxy_ob_meta_cache_hits", [this] { return _servers.hits(); }, {{"cache", "servers"}});
+  registry.register_gauge("logproxy_ob_meta_cache_misses", [this] { return _servers.misses(); }, {{"cache", "servers"}});
+  registry.register_gauge("logproxy_ob_meta_cache_hits", [this] { return _auths.hits(); }, {{"cache", "auth"}});
+  registry.register_gauge("logproxy_ob_meta_cache_misses", [this] { return _auths.misses(); }, {{"cache", "auth"}});
+  registry.register_gauge(
+      "logproxy_ob_meta_cache_hits", [this] { return _ob_versions.hits(); }, {{"cache", "ob_version"}});
+  registry.register_gauge(
+      "logproxy_ob_meta_cache_misses", [this] { return _ob_versions.misses(); }, {{"cache", "ob_version"}});
+}
+
+std::string ObMetaCache::make_key(const std::vector<std::string>& parts)
+{
+  std::string key;
+  for (const std::string& part : parts) {
+    // length prefixed, so that no separator inside of a part is ambiguous
+    key.append(std::to_string(part.size()));
+    key.push_back(':');
+    key.append(part);
+  }
+  return key;
+}
+
+}  // namespace logproxy
+}  // namespace oceanbase
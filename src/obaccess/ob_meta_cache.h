@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "timer.h"
+
+namespace oceanbase {
+namespace logproxy {
+
+/*!
+ * @brief Thread safe map of which entries expire after a ttl, results of failed loads are cached as well
+ * (negative caching) so that a bad client reconnecting in loop can not hammer observers
+ */
+template <typename V>
+class TtlCache {
+public:
+  static constexpr size_t MAX_ENTRIES = 4096;
+
+  /*!
+   * @brief Returns the cached value and result code of its load, or loads it by loader on miss or expiration
+   */
+  int get(const std::string& key, V& value, uint64_t ttl_us, uint64_t negative_ttl_us,
+      const std::function<int(V&)>& loader)
+  {
+    uint64_t now = Timer::now();
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      auto entry = _entries.find(key);
+      if (entry != _entries.end() && entry->second.expire_us > now) {
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        value = entry->second.value;
+        return entry->second.ret;
+      }
+    }
+    _misses.fetch_add(1, std::memory_order_relaxed);
+
+    // concurrent misses of the same key load it more than once, which is no worse than no cache
+    V loaded{};
+    int ret = loader(loaded);
+    uint64_t ttl = (ret == OMS_OK) ? ttl_us : negative_ttl_us;
+    if (ttl != 0) {
+      std::lock_guard<std::mutex> guard(_lock);
+      if (_entries.size() >= MAX_ENTRIES) {
+        purge(Timer::now());
+      }
+      if (_entries.size() < MAX_ENTRIES) {
+        _entries[key] = Entry{loaded, ret, Timer::now() + ttl};
+      }
+    }
+    value = std::move(loaded);
+    return ret;
+  }
+
+  void invalidate(const std::string& key)
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _entries.erase(key);
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _entries.clear();
+  }
+
+  size_t size()
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _entries.size();
+  }
+
+  uint64_t hits() const
+  {
+    return _hits.load(std::memory_order_relaxed);
+  }
+
+  uint64_t misses() const
+  {
+    return _misses.load(std::memory_order_relaxed);
+  }
+
+private:
+  void purge(uint64_t now)
+  {
+    for (auto iter = _entries.begin(); iter != _entries.end();) {
+      if (iter->second.expire_us <= now) {
+        iter = _entries.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+private:
+  struct Entry {
+    V value;
+    int ret;
+    uint64_t expire_us;
+  };
+
+  std::mutex _lock;
+  std::unordered_map<std::string, Entry> _entries;
+  std::atomic<uint64_t> _hits{0};
+  std::atomic<uint64_t> _misses{0};
+};
+
+struct ObServerAddr {
+  std::string host;
+  int port;
+};
+
+/*!
+ * @brief Process wide cache of cluster metadata and auth verdicts, shared by handshakes of clients, clog checks and
+ * binlog converter, so that clients reconnecting constantly do not repeat config url requests and auth round trips.
+ * Entries live for ob_meta_cache_ttl_s, failures for ob_meta_cache_negative_ttl_s, 0 disables either of them.
+ */
+class ObMetaCache {
+  OMS_SINGLETON(ObMetaCache);
+  OMS_AVOID_COPY(ObMetaCache);
+
+public:
+  /*!
+   * @brief Server list of a cluster url, keyed by the url
+   */
+  int servers(const std::string& cluster_url, std::vector<ObServerAddr>& servers,
+      const std::function<int(std::vector<ObServerAddr>&)>& loader);
+
+  /*!
+   * @brief Drop the server list when servers in it turn out to be unreachable
+   */
+  void invalidate_servers(const std::string& cluster_url);
+
+  /*!
+   * @brief Auth verdict, keyed by cluster, credentials, tenant and table whitelist
+   */
+  int auth(const std::string& key, const std::function<int()>& loader);
+
+  /*!
+   * @brief Observer version of a cluster, keyed by cluster and sys credentials
+   */
+  int ob_version(const std::string& key, std::string& ob_version, const std::function<int(std::string&)>& loader);
+
+  void clear();
+
+  /*!
+   * @brief Export hit and miss counters of caches as gauges
+   */
+  void register_metrics();
+
+  static std::string make_key(const std::vector<std::string>& parts);
+
+private:
+  TtlCache<std::vector<ObServerAddr>> _servers;
+  TtlCache<bool> _auths;
+  TtlCache<std::string> _ob_versions;
+};
+
+}  // namespace logproxy
+}  // namespace oceanbase
@@ -17,6 +17,7 @@
 #include "obcdc_factory.h"
 #include "fs_util.h"
 #include "str.h"
+#include "timer.h"
 
 #define INCOMPATIBLE_VERSION "4.2.1"
 
@@ -101,6 +102,27 @@ void ObCdcAccessFactory::unload(IObCdcAccess* obcdc)
   */
 }
 
+int ObCdcAccessFactory::preload(const std::string& ob_version)
+{
+  std::string obcdc_so_path;
+  if (OMS_OK != locate_obcdc_library(ob_version, obcdc_so_path)) {
+    OMS_ERROR("Failed to obtain the so library path of obcdc to preload, ob version: {}", ob_version);
+    return OMS_FAILED;
+  }
+
+  Timer timer;
+  void* so_handle = dlopen(obcdc_so_path.c_str(), RTLD_LAZY);
+  if (nullptr == so_handle) {
+    OMS_ERROR("Failed to preload so library: {}, error: {}", obcdc_so_path, dlerror());
+    return OMS_FAILED;
+  }
+  OMS_INFO("Preloaded the so library of obcdc for ob version: {}, path: {}, cost: {}us",
+      ob_version,
+      obcdc_so_path,
+      timer.elapsed());
+  return OMS_OK;
+}
+
 int ObCdcAccessFactory::locate_obcdc_library(const std::string& ob_version, std::string& obcdc_so_path)
 {
   uint8_t ob_major_version = atoi(ob_version.substr(0, 1).c_str());
@@ -32,6 +32,12 @@ public:
 
   static void unload(IObCdcAccess* cdc_access);
 
+  /*!
+   * @brief Load the obcdc library of an ob version ahead of clients, by standby oblogreaders.
+   * The library is never unloaded, so that load() of the same version later finds it loaded already.
+   */
+  static int preload(const std::string& ob_version);
+
 private:
   static int locate_obcdc_library(const std::string& ob_version, std::string& so_path);
 };
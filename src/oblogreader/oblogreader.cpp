@@ -12,6 +12,7 @@
 
 #include "log.h"
 #include "counter.h"
+#include "metric/metric_registry.h"
 #include "client_meta.h"
 #include "oblogreader/oblogreader.h"
 
@@ -27,7 +28,9 @@ ObLogReader::~ObLogReader()
 int ObLogReader::init(
     const std::string& id, MessageVersion packet_version, const ClientMeta& meta, const OblogConfig& config)
 {
+  MetricRegistry::instance().set_const_labels({{"client_id", id}});
   Counter::instance().register_gauge("NRecordQ", [this]() { return _queue.size(); });
+  Counter::instance().register_gauge("NRecordQBytes", [this]() { return _queue.bytes(); });
 
   // load different so library according to ob version
   int ret = ObCdcAccessFactory::load(config, _obcdc);
@@ -39,6 +42,12 @@ int ObLogReader::init(
   if (ret != OMS_OK) {
     return ret;
   }
+  _sender.track_start(meta.handshake_time_us, meta.prefork);
+  _sender.flow_control(meta.credit_bytes, meta.credit_records);
+  ret = _sender.filter(config.table_columns.val(), config.row_filters.val());
+  if (ret != OMS_OK) {
+    return ret;
+  }
   return _reader.init(config, _obcdc);
 }
 
@@ -13,6 +13,7 @@
 #pragma once
 
 #include "common.h"
+#include "admission.h"
 #include "communication/comm.h"
 #include "common/oblog_config.h"
 #include "obcdcaccess/obcdc_factory.h"
@@ -39,7 +40,7 @@ public:
 private:
   IObCdcAccess* _obcdc = nullptr;
 
-  BlockingQueue<ILogRecord*> _queue{Config::instance().record_queue_size.val()};
+  BlockingQueue<ILogRecord*> _queue{Config::instance().record_queue_size.val(), ResourceBudget::record_queue_bytes()};
   ReaderRoutine _reader{*this, _queue};
   SenderRoutine _sender{*this, _queue};
 };
@@ -18,24 +18,45 @@
 #include "client_meta.h"
 #include "trace_log.h"
 #include "oblogreader.h"
+#include "str.h"
+#include "communication/io.h"
+#include "obcdcaccess/obcdc_factory.h"
 
 using namespace oceanbase::logproxy;
-int init_configs(char** argv, OblogConfig& obLogConfig, ClientMeta& client);
+int init_configs(std::string& config_file, OblogConfig& obLogConfig, ClientMeta& client);
+int wait_client(int sock, std::string& config_file, std::string& work_path, int& client_fd);
 
+/**
+ * ./oblogreader <config file> <work path>
+ * ./oblogreader <standby config file> <standby path> --standby <unix socket fd>, started by ReaderPool of logproxy
+ */
 int main(int argc, char** argv)
 {
+  std::string config_file(argv[1]);
+  std::string work_path(argv[2]);
   // change work path
-  ::chdir(argv[2]);
+  ::chdir(work_path.c_str());
   replace_spdlog_default_logger();
 
+  bool standby = argc > 4 && strcmp(argv[3], "--standby") == 0;
+  int client_fd = -1;
+  if (standby && OMS_OK != wait_client(atoi(argv[4]), config_file, work_path, client_fd)) {
+    OMS_ERROR("!!! Exiting standby oblogreader process: {}, due to no client handed over.", getpid());
+    ::exit(-1);
+  }
+
   // init config
   OblogConfig config;
   ClientMeta client;
-  if (OMS_OK != init_configs(argv, config, client)) {
+  if (OMS_OK != init_configs(config_file, config, client)) {
     OMS_ERROR("!!! Exiting oblogreader process: {}, due to failed to init configs.", getpid());
     ::exit(-1);
   }
   config_password(config);
+  if (standby) {
+    client.peer.reset_fd(client_fd);
+    client.prefork = true;
+  }
 
   const char* child_process_name = argv[0];
   Config& conf = Config::instance();
@@ -73,9 +94,52 @@ int main(int argc, char** argv)
   return 0;
 }
 
-int init_configs(char** argv, OblogConfig& obLogConfig, ClientMeta& client)
+/**
+ * Load obcdc libraries ahead, then block until logproxy hands over a client
+ */
+int wait_client(int sock, std::string& config_file, std::string& work_path, int& client_fd)
+{
+  rapidjson::Document doc;
+  if (OMS_OK != load_configs(config_file, doc)) {
+    return OMS_FAILED;
+  }
+  if (!doc.HasMember(CONFIG) || !doc[CONFIG].IsObject() || OMS_OK != Config::instance().from_json(doc[CONFIG])) {
+    OMS_ERROR("Invalid json format: {}", config_file);
+    return OMS_FAILED;
+  }
+
+  std::vector<std::string> ob_versions;
+  split(Config::instance().oblogreader_prefork_ob_versions.val(), ',', ob_versions);
+  for (const std::string& ob_version : ob_versions) {
+    if (!ob_version.empty()) {
+      ObCdcAccessFactory::preload(ob_version);
+    }
+  }
+
+  OMS_INFO("Standby oblogreader process({}) waiting for client", getpid());
+  char buf[4096];
+  int ret = recv_fd(sock, buf, sizeof(buf) - 1, client_fd);
+  ::close(sock);
+  if (ret <= 0 || client_fd < 0) {
+    // logproxy exited or dropped the standby
+    return OMS_FAILED;
+  }
+  buf[ret] = '\0';
+
+  // <config name>\0<work path>
+  size_t name_len = strlen(buf);
+  if (name_len + 1 >= (size_t)ret) {
+    OMS_ERROR("Invalid message handed over to standby oblogreader");
+    return OMS_FAILED;
+  }
+  config_file.assign(buf, name_len);
+  work_path.assign(buf + name_len + 1);
+  ::chdir(work_path.c_str());
+  return OMS_OK;
+}
+
+int init_configs(std::string& config_file, OblogConfig& obLogConfig, ClientMeta& client)
 {
-  std::string config_file(argv[1]);
   rapidjson::Document doc;
   if (OMS_OK != load_configs(config_file, doc)) {
     return OMS_FAILED;
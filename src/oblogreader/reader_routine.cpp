@@ -10,11 +10,13 @@
  * See the Mulan PubL v2 for more details.
  */
 
+#include <unistd.h>
 #include "log.h"
 #include "common.h"
 #include "config.h"
 #include "counter.h"
 #include "trace_log.h"
+#include "metric/latency_tracer.h"
 #include "oblogreader/oblogreader.h"
 
 namespace oceanbase {
@@ -31,7 +33,12 @@ int ReaderRoutine::init(const OblogConfig& config, IObCdcAccess* obcdc)
   _obcdc = obcdc;
   std::map<std::string, std::string> configs;
   config.generate_configs(configs);
+  // applied by SenderRoutine rather than obcdc
+  configs.erase(config.table_columns.key());
+  configs.erase(config.row_filters.key());
 
+  // logproxy polls clog timestamps of the cluster once for all oblogreaders, see ClogMetaHub
+  _clog_meta.subscribe(ClogMetaShm::name(getppid(), config));
   int ret = _clog_meta.init(config);
   if (ret != OMS_OK) {
     OMS_ERROR("Failed to init clog check ,ret: {}", ret);
@@ -91,6 +98,9 @@ void ReaderRoutine::run()
       break;
     }
     record_us = record->getTimestamp() * 1000000 + record->getRecordUsec();
+    if (record->recordType() == ECOMMIT) {
+      LatencyTracer::instance().begin(record, record_us);
+    }
     int record_size = record->getRealSize();
     // once put record to queue, never access it
     stage_tm.reset();
@@ -98,8 +108,8 @@ void ReaderRoutine::run()
       TraceLog::info(record);
     }
 
-    while (!_queue.offer(record, _s_config.read_timeout_us.val())) {
-      OMS_WARN("reader transfer queue full({}), retry...", _queue.size(false));
+    while (!_queue.offer(record, record_size, _s_config.read_timeout_us.val())) {
+      OMS_WARN_EVERY(10, "reader transfer queue full({}), retry...", _queue.size(false));
     }
     int64_t offer_us = stage_tm.elapsed();
 
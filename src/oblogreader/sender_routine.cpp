@@ -10,6 +10,7 @@
  * See the Mulan PubL v2 for more details.
  */
 
+#include <poll.h>
 #include <cassert>
 
 #include "logmsg_buf.h"
@@ -18,8 +19,11 @@
 #include "log.h"
 #include "config.h"
 #include "counter.h"
+#include "metric/latency_tracer.h"
+#include "metric/metric_registry.h"
 #include "codec/encoder.h"
 #include "communication/comm.h"
+#include "communication/io.h"
 #include "oblogreader/oblogreader.h"
 
 namespace oceanbase {
@@ -47,6 +51,7 @@ int SenderRoutine::init(MessageVersion packet_version, const Peer& peer, IObCdcA
   _obcdc = obcdc;
   _packet_version = packet_version;
   _client_peer = peer;
+  Counter::instance().register_gauge("SenderTargetBytes", [this]() { return _batcher.target_bytes(); });
 
   if (_s_config.readonly.val()) {
     return OMS_OK;
@@ -76,6 +81,76 @@ int SenderRoutine::init(MessageVersion packet_version, const Peer& peer, IObCdcA
   return OMS_OK;
 }
 
+void SenderRoutine::track_start(uint64_t handshake_time_us, bool prefork)
+{
+  _handshake_time_us = handshake_time_us;
+  _start_histogram = &MetricRegistry::instance().histogram(
+      "logproxy_oblogreader_first_byte_latency_us", {{"start", prefork ? "prefork" : "fork"}});
+}
+
+void SenderRoutine::flow_control(int64_t credit_bytes, int64_t credit_records)
+{
+  if (credit_bytes <= 0 && credit_records <= 0) {
+    return;
+  }
+  if (_s_config.readonly.val() || _packet_version != MessageVersion::V2) {
+    OMS_WARN("Ignored flow control of client: {}, which requires protocol V2", _client_peer.to_string());
+    return;
+  }
+
+  _credit.reset(credit_bytes, credit_records);
+  _comm.set_read_callback([this](const Peer& peer, const Message& msg) {
+    if (msg.type() != MessageType::CREDIT_CLIENT) {
+      OMS_WARN("Ignored unexpected message of type: {} from client: {}", (int)msg.type(), peer.to_string());
+      return EventResult::ER_SUCCESS;
+    }
+    const CreditMessage& credit = (const CreditMessage&)msg;
+    _credit.grant(credit.bytes, credit.records);
+    return EventResult::ER_SUCCESS;
+  });
+  Counter::instance().register_gauge("SenderCreditBytes", [this]() { return _credit.bytes(); });
+  OMS_INFO("Enabled flow control of client: {}, initial credit bytes: {}, records: {}",
+      _client_peer.to_string(),
+      credit_bytes,
+      credit_records);
+}
+
+int SenderRoutine::filter(const std::string& column_list, const std::string& row_filter)
+{
+  std::string errmsg;
+  if (_filter.init(column_list, row_filter, errmsg) != OMS_OK) {
+    OMS_ERROR("Failed to init filter of client: {}, {}", _client_peer.to_string(), errmsg);
+    return OMS_FAILED;
+  }
+  if (!_filter.enabled()) {
+    return OMS_OK;
+  }
+  Counter::instance().register_gauge("SenderFilteredRecords", [this]() { return _filtered_records; });
+  OMS_INFO("Enabled filter of client: {}, column list: {}, row filter: {}",
+      _client_peer.to_string(),
+      column_list,
+      row_filter);
+  return OMS_OK;
+}
+
+void SenderRoutine::wait_credit()
+{
+  struct pollfd pfd = {_client_peer.fd, POLLIN, 0};
+  int timeout_ms = (int)(_s_config.read_timeout_us.val() / 1000);
+  // each poll of comm reads one message
+  while (is_run() && ::poll(&pfd, 1, timeout_ms) > 0) {
+    if (_comm.poll() != OMS_OK || _comm.channel_count() == 0) {
+      OMS_ERROR("Client closed while waiting for credit: {}", _client_peer.to_string());
+      stop();
+      return;
+    }
+    if (!_credit.exhausted()) {
+      return;
+    }
+  }
+  OMS_INFO_EVERY(10, "Out of credit granted by client: {}, retry...", _client_peer.to_string());
+}
+
 void SenderRoutine::stop()
 {
   if (is_run()) {
@@ -93,6 +168,10 @@ void SenderRoutine::run()
 
   std::vector<ILogRecord*> records;
   records.reserve(_s_config.read_wait_num.val());
+  // records[0, converted) are converted but not sent, waiting for more to fill a packet
+  size_t converted = 0;
+  size_t pending_bytes = 0;
+  uint64_t pending_since_us = 0;
 
   while (is_run()) {
     if (!_s_config.readonly.val()) {
@@ -103,14 +182,44 @@ void SenderRoutine::run()
         break;
       }
     }
+    if (_credit.exhausted()) {
+      // records stay in queue until more credit granted, and reader stops fetching once it is full
+      wait_credit();
+      continue;
+    }
 
     _stage_timer.reset();
-    records.clear();
-    while (is_run() && (!_rqueue.poll(records, _s_config.read_timeout_us.val()) || records.empty())) {
-      OMS_INFO("Send transfer queue empty, retry...");
+    size_t polled = records.size();
+    if (records.empty()) {
+      while (is_run() && (!_rqueue.poll(records, _s_config.read_timeout_us.val()) || records.empty())) {
+        OMS_INFO_EVERY(10, "Send transfer queue empty, retry...");
+      }
+      pending_since_us = Timer::now();
+    } else {
+      uint64_t wait_us = _batcher.wait_us(pending_since_us, Timer::now());
+      if (wait_us > 0 && records.size() < records.capacity()) {
+        _rqueue.poll(records, wait_us);
+      }
     }
     int64_t poll_us = _stage_timer.elapsed();
     Counter::instance().count_key(Counter::SENDER_POLL_US, poll_us);
+    for (size_t i = polled; i < records.size(); ++i) {
+      LatencyTracer::instance().stamp(records[i], TRACE_QUEUE);
+    }
+    if (_filter.enabled()) {
+      // rows filtered out are released before converted
+      size_t kept = polled;
+      for (size_t i = polled; i < records.size(); ++i) {
+        if (_filter.accept(records[i])) {
+          records[kept++] = records[i];
+          continue;
+        }
+        LatencyTracer::instance().discard(records[i]);
+        _obcdc->release(records[i]);
+        ++_filtered_records;
+      }
+      records.resize(kept);
+    }
 
     if (_s_config.readonly.val()) {
       for (auto record : records) {
@@ -118,19 +227,29 @@ void SenderRoutine::run()
         Counter::instance().count_write(1);
         Counter::instance().mark_timestamp(record->getTimestamp() * 1000000 + record->getRecordUsec());
         Counter::instance().mark_checkpoint(record->getCheckpoint1() * 1000000 + record->getCheckpoint2());
+        LatencyTracer::instance().finish(record);
         _obcdc->release(record);
       }
+      records.clear();
       continue;
     }
 
-    size_t packet_size = 0;
+    size_t target_bytes = _batcher.target_bytes();
     size_t offset = 0;
-    size_t i = 0;
-    for (i = 0; i < records.size(); ++i) {
+    size_t i = converted;
+    bool failed = false;
+    for (; i < records.size(); ++i) {
+      if (_credit.exhausted()) {
+        // never convert records client is not ready for
+        break;
+      }
       ILogRecord* r = records[i];
       size_t size = 0;
+      // values of columns not projected are cleared only while serializing, which is kept by record
+      _filter.project(r);
       // #ifdef COMMUNITY_BUILD
       const char* rbuf = r->toString(&size, _t_s_lmb, true);
+      _filter.restore(r);
       // #else
       //       const char* rbuf = r->toString(&size, true);
       // #endif
@@ -139,50 +258,71 @@ void SenderRoutine::run()
         stop();
         break;
       }
+      LatencyTracer::instance().stamp(r, TRACE_CONVERT);
 
-      if (packet_size + size > _s_config.max_packet_bytes.val()) {
-        if (packet_size == 0) {
-          OMS_WARN("Huge package occurred with size of: {}, exceed max_packet_bytes: {}, try to send directly.",
-              size,
-              _s_config.max_packet_bytes.val());
-          if (do_send(records, i, 1) != OMS_OK) {
-            OMS_ERROR("Failed to write LogMessage to client: {}", _client_peer.to_string());
-            stop();
-            break;
-          }
-          offset = i + 1;
-        } else {
-          if (do_send(records, offset, i - offset) != OMS_OK) {
-            OMS_ERROR("Failed to write LogMessage to client: {}", _client_peer.to_string());
-            stop();
-            break;
-          }
-
-          offset = i;
+      if (size > _s_config.max_packet_bytes.val()) {
+        OMS_WARN("Huge package occurred with size of: {}, exceed max_packet_bytes: {}, try to send directly.",
+            size,
+            _s_config.max_packet_bytes.val());
+      }
+      // never exceed the target bytes or credit, unless by a single record
+      if (pending_bytes > 0 && (pending_bytes + size > _credit.limit_bytes(target_bytes) ||
+                                   i - offset >= _credit.limit_records(SIZE_MAX))) {
+        if (do_send(records, offset, i - offset, pending_bytes, pending_since_us) != OMS_OK) {
+          failed = true;
+          break;
         }
-        packet_size = 0;
-        continue;
+        offset = i;
+        pending_bytes = 0;
       }
-      packet_size += size;
+      pending_bytes += size;
     }
+    converted = i;
 
-    if (is_run() && packet_size > 0) {
-      if (do_send(records, offset, i - offset) != OMS_OK) {
-        OMS_ERROR("Failed to write LogMessage to client: {}", _client_peer.to_string());
-        stop();
+    // send the rest once due, or once no more records can be polled into the batch
+    if (is_run() && !failed && pending_bytes > 0 && !_credit.exhausted() &&
+        (pending_bytes >= _credit.limit_bytes(target_bytes) || converted - offset >= _credit.limit_records(SIZE_MAX) ||
+            records.size() >= records.capacity() || _batcher.wait_us(pending_since_us, Timer::now()) == 0)) {
+      if (do_send(records, offset, converted - offset, pending_bytes, pending_since_us) != OMS_OK) {
+        failed = true;
+      } else {
+        offset = converted;
+        pending_bytes = 0;
       }
     }
 
-    for (ILogRecord* r : records) {
-      _obcdc->release(r);
+    if (failed) {
+      OMS_ERROR("Failed to write LogMessage to client: {}", _client_peer.to_string());
+      stop();
+    }
+    if (!is_run()) {
+      break;
+    }
+
+    // records sent
+    for (size_t j = 0; j < offset; ++j) {
+      _obcdc->release(records[j]);
+    }
+    if (offset > 0) {
+      records.erase(records.begin(), records.begin() + offset);
+      converted -= offset;
+      // the rest were polled in the latest round at the earliest
+      pending_since_us = Timer::now() - poll_us;
     }
   }
 
+  for (ILogRecord* r : records) {
+    // traces of records failed to send
+    LatencyTracer::instance().discard(r);
+    _obcdc->release(r);
+  }
+
   LogMsgLocalDestroy;
   _reader.stop();
 }
 
-int SenderRoutine::do_send(std::vector<ILogRecord*>& records, size_t offset, size_t count)
+int SenderRoutine::do_send(
+    std::vector<ILogRecord*>& records, size_t offset, size_t count, size_t bytes, uint64_t pending_since_us)
 {
   if (_s_config.verbose.val()) {
     OMS_DEBUG("send record range[{}, {}]", offset, offset + count);
@@ -192,15 +332,39 @@ int SenderRoutine::do_send(std::vector<ILogRecord*>& records, size_t offset, siz
   msg.set_version(_packet_version);
   msg.compress_type = CompressType::LZ4;
   msg.idx = _msg_seq;
+  // throughput of the link is measured by the send queue drained, from before the packet written to after
+  size_t queued = 0;
+  if (send_queue_bytes(_client_peer.fd, queued) == OMS_OK) {
+    _batcher.on_queue_sampled(Timer::now(), queued);
+  }
+  uint64_t written_bytes = _comm.written_bytes();
   int ret = _comm.send_message(_client_peer, msg, true);
 
   _msg_seq += count;
 
   if (ret == OMS_OK) {
+    uint64_t now = Timer::now();
+    _batcher.on_sent(bytes, _comm.written_bytes() - written_bytes);
+    if (send_queue_bytes(_client_peer.fd, queued) == OMS_OK) {
+      _batcher.on_queue_sampled(now, queued);
+    }
+    _credit.consume(bytes, count);
+    _packet_records_histogram.record(count);
+    _packet_latency_histogram.record(now > pending_since_us ? now - pending_since_us : 0);
+
     ILogRecord* last = records[offset + count - 1];
     Counter::instance().count_write(count);
     Counter::instance().mark_timestamp(last->getTimestamp() * 1000000 + last->getRecordUsec());
     Counter::instance().mark_checkpoint(last->getCheckpoint1() * 1000000 + last->getCheckpoint2());
+    for (size_t i = offset; i < offset + count; ++i) {
+      LatencyTracer::instance().finish(records[i]);
+    }
+    if (_handshake_time_us != 0) {
+      uint64_t latency_us = now > _handshake_time_us ? now - _handshake_time_us : 0;
+      _start_histogram->record(latency_us);
+      OMS_INFO("Sent the first records to client {}us after handshake", latency_us);
+      _handshake_time_us = 0;
+    }
   } else {
     OMS_WARN("Failed to send record data message to client, peer: {}", _client_peer.id());
   }
@@ -12,9 +12,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include "thread.h"
 #include "timer.h"
 #include "blocking_queue.hpp"
+#include "adaptive_batcher.h"
+#include "credit_window.h"
+#include "record_filter.h"
+#include "metric/metric_registry.h"
 
 namespace oceanbase {
 namespace logproxy {
@@ -27,12 +32,36 @@ public:
 
   int init(MessageVersion packet_version, const Peer& peer, IObCdcAccess* obcdc);
 
+  /*!
+   * @brief Record latency from handshake to the first records sent, labeled by how oblogreader was started
+   */
+  void track_start(uint64_t handshake_time_us, bool prefork);
+
+  /*!
+   * @brief Send records only within credit granted by client, if any initial credit requested by handshake
+   */
+  void flow_control(int64_t credit_bytes, int64_t credit_records);
+
+  /*!
+   * @brief Send only columns and rows required by tb_column_list and tb_row_filter of handshake, if any
+   */
+  int filter(const std::string& column_list, const std::string& row_filter);
+
   void stop() override;
 
 private:
   void run() override;
 
-  int do_send(std::vector<ILogRecord*>& records, size_t offset, size_t count);
+  /*!
+   * @param bytes converted size of records sent, measuring throughput of the link
+   * @param pending_since_us when the oldest record sent was polled, measuring packet latency
+   */
+  int do_send(std::vector<ILogRecord*>& records, size_t offset, size_t count, size_t bytes, uint64_t pending_since_us);
+
+  /*!
+   * @brief Read credit granted by client until not exhausted, or up to read_timeout_us
+   */
+  void wait_credit();
 
 private:
   ObLogReader& _reader;
@@ -48,6 +77,17 @@ private:
   Timer _stage_timer;
 
   uint32_t _msg_seq = 0;
+
+  AdaptiveBatcher _batcher{Config::instance().sender_latency_target_us.val(),
+      std::min((size_t)Config::instance().sender_max_batch_bytes.val(), (size_t)Config::instance().max_packet_bytes.val())};
+  CreditWindow _credit;
+  RecordFilter _filter;
+  uint64_t _filtered_records = 0;
+  Histogram& _packet_records_histogram = MetricRegistry::instance().histogram("logproxy_sender_packet_records");
+  Histogram& _packet_latency_histogram = MetricRegistry::instance().histogram("logproxy_sender_packet_latency_us");
+
+  uint64_t _handshake_time_us = 0;
+  Histogram* _start_histogram = nullptr;
 };
 
 }  // namespace logproxy
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <algorithm>
+#include "gtest/gtest.h"
+#include "adaptive_batcher.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(AdaptiveBatcher, wait_for_latency_target)
+{
+  AdaptiveBatcher batcher(2000, 8 * 1024 * 1024);
+  ASSERT_EQ(2000, batcher.wait_us(1000, 1000));
+  ASSERT_EQ(500, batcher.wait_us(1000, 2500));
+  ASSERT_EQ(0, batcher.wait_us(1000, 3000));
+  ASSERT_EQ(0, batcher.wait_us(1000, 10000));
+}
+
+/*!
+ * @brief Packets of bytes written every interval_us to a link draining drain_bytes per interval_us meanwhile, with the
+ * send queue sampled before and after each
+ */
+static void send(AdaptiveBatcher& batcher, uint64_t& now_us, size_t& queued, int packets, size_t bytes,
+    size_t written, size_t drain_bytes, uint64_t interval_us)
+{
+  for (int i = 0; i < packets; ++i) {
+    batcher.on_queue_sampled(now_us, queued);
+    batcher.on_sent(bytes, written);
+    queued += written;
+    batcher.on_queue_sampled(now_us, queued);
+    now_us += interval_us;
+    queued -= std::min(queued, drain_bytes);
+  }
+}
+
+TEST(AdaptiveBatcher, follow_throughput)
+{
+  AdaptiveBatcher batcher(2000, 8 * 1024 * 1024);
+  ASSERT_EQ(AdaptiveBatcher::MIN_TARGET_BYTES, batcher.target_bytes());
+  ASSERT_EQ(0, batcher.throughput());
+
+  // 1GB/s link kept busy: 2ms worth of bytes is 2MB
+  uint64_t now_us = 1000;
+  size_t queued = 4 * 1000 * 1000;
+  send(batcher, now_us, queued, 50, 1000 * 1000, 1000 * 1000, 1000 * 1000, 1000);
+  ASSERT_EQ(1000 * 1000 * 1000, batcher.throughput());
+  ASSERT_EQ(2000 * 1000, batcher.target_bytes());
+
+  // faster than the bound
+  send(batcher, now_us, queued, 50, 10 * 1000 * 1000, 10 * 1000 * 1000, 10 * 1000 * 1000, 1000);
+  ASSERT_EQ(8 * 1024 * 1024, batcher.target_bytes());
+
+  // slow consumer shrinks packets down to the lower bound
+  send(batcher, now_us, queued, 100, 1000, 1000, 1000, 100000);
+  ASSERT_EQ(AdaptiveBatcher::MIN_TARGET_BYTES, batcher.target_bytes());
+}
+
+// writes returning at once into a large socket buffer tell nothing of the link, the bytes drained do
+TEST(AdaptiveBatcher, measured_by_queue_drained)
+{
+  AdaptiveBatcher batcher(2000, 8 * 1024 * 1024);
+  uint64_t now_us = 1000;
+  size_t queued = 0;
+  // 100MB/s link, bytes compressed to a quarter
+  send(batcher, now_us, queued, 200, 400 * 1000, 100 * 1000, 100 * 1000, 1000);
+  ASSERT_NEAR(400 * 1000 * 1000, batcher.throughput(), 4 * 1000 * 1000);
+  ASSERT_NEAR(800 * 1000, batcher.target_bytes(), 8 * 1000);
+
+  // the queue emptied waits for records rather than the link, so a lower throughput measured is ignored
+  queued = 0;
+  send(batcher, now_us, queued, 100, 4000, 1000, 100 * 1000, 1000);
+  ASSERT_NEAR(400 * 1000 * 1000, batcher.throughput(), 4 * 1000 * 1000);
+}
+
+TEST(AdaptiveBatcher, no_latency_target)
+{
+  AdaptiveBatcher batcher(0, 1024 * 1024);
+  ASSERT_EQ(1024 * 1024, batcher.target_bytes());
+  ASSERT_EQ(0, batcher.wait_us(1000, 1000));
+  uint64_t now_us = 1000;
+  size_t queued = 1000;
+  send(batcher, now_us, queued, 10, 1000, 1000, 10, 100000);
+  ASSERT_EQ(1024 * 1024, batcher.target_bytes());
+
+  AdaptiveBatcher small(2000, 1024);
+  ASSERT_EQ(1024, small.target_bytes());
+}
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "common.h"
+#include "config.h"
+#include "admission.h"
+#include "cgroup.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(Admission, admit_by_budget)
+{
+  ResourceBudget client;
+  client.memory_mb = 1024;
+  client.cpu_percent = 150;
+  ResourceBudget node;
+  node.memory_mb = 4096;
+  node.cpu_percent = 800;
+
+  std::string reason;
+  ASSERT_EQ(OMS_OK, Admission::admit(0, client, node, reason));
+  ASSERT_EQ(OMS_OK, Admission::admit(3, client, node, reason));
+  ASSERT_EQ(OMS_FAILED, Admission::admit(4, client, node, reason));
+  ASSERT_NE(std::string::npos, reason.find("memory"));
+
+  client.memory_mb = 0;
+  ASSERT_EQ(OMS_OK, Admission::admit(4, client, node, reason));
+  ASSERT_EQ(OMS_FAILED, Admission::admit(5, client, node, reason));
+  ASSERT_NE(std::string::npos, reason.find("cpu"));
+
+  // unlimited budgets never reject
+  ASSERT_EQ(OMS_OK, Admission::admit(10000, ResourceBudget(), node, reason));
+}
+
+TEST(Admission, node_capacity_detected)
+{
+  Config::instance().node_memory_capacity_mb.set(0);
+  Config::instance().node_cpu_capacity_percent.set(0);
+  ResourceBudget node = ResourceBudget::node();
+  ASSERT_GT(node.memory_mb, 0);
+  ASSERT_GE(node.cpu_percent, 100);
+
+  Config::instance().node_memory_capacity_mb.set(2048);
+  ASSERT_EQ(2048, ResourceBudget::node().memory_mb);
+  Config::instance().node_memory_capacity_mb.set(0);
+}
+
+TEST(Cgroup, limits)
+{
+  ASSERT_EQ("max 100000", Cgroup::cpu_max(0));
+  ASSERT_EQ("150000 100000", Cgroup::cpu_max(150));
+  ASSERT_EQ("max", Cgroup::memory_max(0));
+  ASSERT_EQ("1073741824", Cgroup::memory_max(1024));
+}
@@ -140,3 +140,25 @@ TEST(PreviousGtidsLogEvent, deserialize)
   OMS_INFO(pre_gtid_event.print_event_info());
   ASSERT_EQ("706348f0-07fc-11ed-a717-0242ac110002:1-10", pre_gtid_event.print_event_info());
 }
+
+TEST(PreviousGtidsLogEvent, serialize_merged_ranges)
+{
+  auto* gtid_message = new GtidMessage();
+  ASSERT_EQ(OMS_OK, gtid_message->set_gtid_uuid("706348f0-07fc-11ed-a717-0242ac110002"));
+  TxnRangeSet txn_ranges;
+  txn_ranges.add(1, 11);
+  txn_ranges.add(20, 31);
+  txn_ranges.add(40, 41);
+  gtid_message->set_txn_range(txn_ranges);
+  // stale count of intervals, e.g. set before ranges merged
+  gtid_message->set_gtid_txn_id_intervals(1);
+
+  PreviousGtidsLogEvent event(1, {gtid_message}, 0);
+  uint32_t event_length = event.get_header()->get_event_length();
+  std::vector<unsigned char> buff(event_length);
+  ASSERT_EQ(event_length, event.flush_to_buff(buff.data()));
+
+  PreviousGtidsLogEvent deserialized;
+  deserialized.deserialize(buff.data());
+  ASSERT_EQ("706348f0-07fc-11ed-a717-0242ac110002:1-10:20-30:40", deserialized.print_event_info());
+}
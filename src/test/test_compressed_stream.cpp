@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <random>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "gtest/gtest.h"
+#include "common.h"
+#include "communication/io.h"
+#include "compressed_stream.h"
+
+using namespace oceanbase::binlog;
+
+struct SocketPair {
+  int fds[2] = {-1, -1};
+
+  SocketPair()
+  {
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  }
+
+  ~SocketPair()
+  {
+    close(fds[0]);
+    close(fds[1]);
+  }
+};
+
+static void read_frame_header(int fd, uint32_t& payload_length, uint8_t& sequence, uint32_t& uncompressed_length)
+{
+  uint8_t header[CompressedStream::header_length];
+  ASSERT_EQ(OMS_OK, oceanbase::logproxy::readn(fd, header, sizeof(header)));
+  payload_length = header[0] | (header[1] << 8) | (header[2] << 16);
+  sequence = header[3];
+  uncompressed_length = header[4] | (header[5] << 8) | (header[6] << 16);
+}
+
+TEST(CompressedStream, small_packets_share_one_zlib_frame)
+{
+  SocketPair sp;
+  CompressedStream stream;
+  stream.enable(CompressionAlgorithm::ZLIB, 3, 64 * 1024);
+
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    std::string packet = "event " + std::to_string(i) + " of table t1 in database test, column values: abcdef";
+    expected += packet;
+    ASSERT_EQ(OMS_OK, stream.write(sp.fds[0], reinterpret_cast<const uint8_t*>(packet.data()), packet.size()));
+  }
+  ASSERT_EQ(OMS_OK, stream.flush(sp.fds[0]));
+  // short payloads are not compressed
+  ASSERT_EQ(OMS_OK, stream.write(sp.fds[0], reinterpret_cast<const uint8_t*>("ok"), 2));
+  ASSERT_EQ(OMS_OK, stream.flush(sp.fds[0]));
+
+  uint32_t payload_length = 0;
+  uint8_t sequence = 0;
+  uint32_t uncompressed_length = 0;
+  read_frame_header(sp.fds[1], payload_length, sequence, uncompressed_length);
+  ASSERT_EQ(0, sequence);
+  ASSERT_EQ(expected.size(), uncompressed_length);
+  ASSERT_LT(payload_length, expected.size() / 4);
+  std::string payload(payload_length, '\0');
+  ASSERT_EQ(OMS_OK, oceanbase::logproxy::readn(sp.fds[1], &payload[0], payload_length));
+  std::string uncompressed(uncompressed_length, '\0');
+  uLongf dest_len = uncompressed_length;
+  ASSERT_EQ(Z_OK,
+      uncompress(reinterpret_cast<Bytef*>(&uncompressed[0]),
+          &dest_len,
+          reinterpret_cast<const Bytef*>(payload.data()),
+          payload_length));
+  ASSERT_EQ(expected, uncompressed);
+
+  read_frame_header(sp.fds[1], payload_length, sequence, uncompressed_length);
+  ASSERT_EQ(1, sequence);
+  ASSERT_EQ(2, payload_length);
+  ASSERT_EQ(0, uncompressed_length);
+}
+
+TEST(CompressedStream, round_trip)
+{
+  for (auto algorithm : {CompressionAlgorithm::ZLIB, CompressionAlgorithm::ZSTD}) {
+    SocketPair sp;
+    std::mt19937 gen(11);
+    // compressible packets mixed with random ones sent as they are, larger ones spanning several frames
+    std::string expected;
+    std::vector<size_t> packets;
+    for (int i = 0; i < 300; ++i) {
+      size_t size = (i % 50 == 0) ? 200000 : gen() % 3000 + 1;
+      bool random = gen() % 3 == 0;
+      for (size_t j = 0; j < size; ++j) {
+        expected.push_back(random ? static_cast<char>(gen()) : static_cast<char>('a' + j % 7));
+      }
+      packets.push_back(size);
+    }
+
+    std::thread writer([&]() {
+      CompressedStream stream;
+      stream.enable(algorithm, 3, 16 * 1024);
+      size_t offset = 0;
+      for (size_t i = 0; i < packets.size(); ++i) {
+        ASSERT_EQ(OMS_OK,
+            stream.write(sp.fds[0], reinterpret_cast<const uint8_t*>(expected.data() + offset), packets[i]));
+        offset += packets[i];
+        if (i % 10 == 0) {
+          ASSERT_EQ(OMS_OK, stream.flush(sp.fds[0]));
+        }
+      }
+      ASSERT_EQ(OMS_OK, stream.flush(sp.fds[0]));
+    });
+
+    CompressedStream stream;
+    stream.enable(algorithm, 3, 16 * 1024);
+    std::string buf(expected.size(), '\0');
+    size_t offset = 0;
+    while (offset < expected.size()) {
+      size_t len = std::min<size_t>(gen() % 5000 + 1, expected.size() - offset);
+      ASSERT_EQ(OMS_OK, stream.read(sp.fds[1], reinterpret_cast<uint8_t*>(&buf[offset]), len));
+      offset += len;
+    }
+    writer.join();
+    ASSERT_EQ(expected, buf) << CompressedStream::name(algorithm);
+  }
+}
+
+TEST(CompressedStream, unexpected_sequence)
+{
+  SocketPair sp;
+  CompressedStream writer;
+  writer.enable(CompressionAlgorithm::ZSTD, 3, 1024);
+  ASSERT_EQ(OMS_OK, writer.write(sp.fds[0], reinterpret_cast<const uint8_t*>("quit"), 4));
+  ASSERT_EQ(OMS_OK, writer.flush(sp.fds[0]));
+  ASSERT_EQ(OMS_OK, writer.write(sp.fds[0], reinterpret_cast<const uint8_t*>("quit"), 4));
+  ASSERT_EQ(OMS_OK, writer.flush(sp.fds[0]));
+
+  CompressedStream reader;
+  reader.enable(CompressionAlgorithm::ZSTD, 3, 1024);
+  uint8_t buf[4];
+  ASSERT_EQ(OMS_OK, reader.read(sp.fds[1], buf, 4));
+  // the next command restarts from 0, which the frame written has not
+  reader.reset_sequence();
+  ASSERT_EQ(OMS_FAILED, reader.read(sp.fds[1], buf, 4));
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <random>
+#include <vector>
+#include <zlib.h>
+#include "gtest/gtest.h"
+#include "crc32.h"
+
+using namespace oceanbase::logproxy;
+
+static uint32_t zlib_crc32(const unsigned char* data, size_t len)
+{
+  return crc32(crc32(0L, Z_NULL, 0), data, len);
+}
+
+TEST(Crc32, same_as_zlib)
+{
+  std::mt19937 gen(42);
+  std::vector<unsigned char> data(8192 + 16);
+  for (auto& b : data) {
+    b = static_cast<unsigned char>(gen());
+  }
+  std::cout << "crc32 implementation: " << Crc32::implementation() << std::endl;
+
+  ASSERT_EQ(0, Crc32::compute(data.data(), 0));
+  ASSERT_EQ(0xCBF43926, Crc32::compute("123456789", 9));
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t len : {1, 7, 8, 15, 16, 19, 31, 63, 64, 65, 127, 128, 200, 1000, 4096, 8192}) {
+      uint32_t expected = zlib_crc32(data.data() + offset, len);
+      ASSERT_EQ(expected, Crc32::compute(data.data() + offset, len)) << offset << ", " << len;
+      ASSERT_EQ(expected, Crc32::update_slicing_by_8(0, data.data() + offset, len)) << offset << ", " << len;
+    }
+  }
+}
+
+TEST(Crc32, incremental)
+{
+  std::string data(5000, 'x');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i * 31 + 7);
+  }
+  uint32_t expected = Crc32::compute(data.data(), data.size());
+  for (size_t split : {0, 1, 63, 64, 100, 4999, 5000}) {
+    uint32_t crc = Crc32::update(0, data.data(), split);
+    crc = Crc32::update(crc, data.data() + split, data.size() - split);
+    ASSERT_EQ(expected, crc) << split;
+  }
+}
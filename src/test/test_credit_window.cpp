@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "credit_window.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(CreditWindow, disabled)
+{
+  CreditWindow credit;
+  credit.reset(0, 0);
+  ASSERT_FALSE(credit.enabled());
+  ASSERT_FALSE(credit.exhausted());
+  credit.consume(1024, 10);
+  ASSERT_FALSE(credit.exhausted());
+  ASSERT_EQ(4096, credit.limit_bytes(4096));
+  ASSERT_EQ(SIZE_MAX, credit.limit_records(SIZE_MAX));
+}
+
+TEST(CreditWindow, limit_by_bytes)
+{
+  CreditWindow credit;
+  credit.reset(4096, 0);
+  ASSERT_TRUE(credit.enabled());
+  ASSERT_EQ(1024, credit.limit_bytes(1024));
+  ASSERT_EQ(4096, credit.limit_bytes(8192));
+  // records unlimited
+  ASSERT_EQ(SIZE_MAX, credit.limit_records(SIZE_MAX));
+
+  credit.consume(3072, 3);
+  ASSERT_FALSE(credit.exhausted());
+  ASSERT_EQ(1024, credit.limit_bytes(8192));
+
+  // overdrawn by a record larger than credit left
+  credit.consume(2048, 1);
+  ASSERT_TRUE(credit.exhausted());
+  ASSERT_EQ(-1024, credit.bytes());
+  ASSERT_EQ(0, credit.limit_bytes(8192));
+
+  credit.grant(1024, 0);
+  ASSERT_TRUE(credit.exhausted());
+  credit.grant(2048, 0);
+  ASSERT_FALSE(credit.exhausted());
+  ASSERT_EQ(2048, credit.limit_bytes(8192));
+
+  // never revoked by negative grants
+  credit.grant(-4096, -1);
+  ASSERT_EQ(2048, credit.bytes());
+}
+
+TEST(CreditWindow, limit_by_records)
+{
+  CreditWindow credit;
+  credit.reset(0, 10);
+  ASSERT_TRUE(credit.enabled());
+  ASSERT_EQ(8192, credit.limit_bytes(8192));
+  ASSERT_EQ(10, credit.limit_records(SIZE_MAX));
+  ASSERT_EQ(5, credit.limit_records(5));
+
+  credit.consume(1 << 20, 10);
+  ASSERT_TRUE(credit.exhausted());
+  ASSERT_EQ(0, credit.limit_records(SIZE_MAX));
+  credit.grant(0, 1);
+  ASSERT_EQ(1, credit.limit_records(SIZE_MAX));
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "config.h"
+#include "ddl_converter.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(DdlConverter, cache)
+{
+  Config::instance().binlog_ddl_convert_cache_size.set(2);
+  DdlConverter::clear_cache();
+  DdlConverter::warm_up();
+  ASSERT_EQ(0, DdlConverter::cache_size());
+
+  std::string dest;
+  ASSERT_EQ(OMS_OK, DdlConverter::convert("ALTER TABLE `t1` ADD COLUMN `c1` int(11) NOT NULL DEFAULT '0'", dest));
+  ASSERT_FALSE(dest.empty());
+  std::string cached;
+  ASSERT_EQ(OMS_OK, DdlConverter::convert("ALTER TABLE  `t1`\n  ADD COLUMN `c1` int(11) NOT NULL DEFAULT '0';", cached));
+  ASSERT_EQ(dest, cached);
+  ASSERT_EQ(1, DdlConverter::cache_size());
+
+  // failures are cached too
+  ASSERT_EQ(OMS_FAILED, DdlConverter::convert("ALTER TABLE", dest));
+  ASSERT_EQ(OMS_FAILED, DdlConverter::convert("ALTER  TABLE", dest));
+  ASSERT_EQ(2, DdlConverter::cache_size());
+
+  ASSERT_EQ(OMS_OK, DdlConverter::convert("DROP TABLE `t1`", dest));
+  ASSERT_EQ(2, DdlConverter::cache_size());
+
+  Config::instance().binlog_ddl_convert_cache_size.set(0);
+  DdlConverter::clear_cache();
+  ASSERT_EQ(OMS_OK, DdlConverter::convert("DROP TABLE `t1`", dest));
+  ASSERT_EQ(0, DdlConverter::cache_size());
+  Config::instance().binlog_ddl_convert_cache_size.set(1024);
+}
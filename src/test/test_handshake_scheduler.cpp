@@ -0,0 +1,304 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <condition_variable>
+#include <mutex>
+#include "gtest/gtest.h"
+#include "common.h"
+#include "config.h"
+#include "timer.h"
+#include "arranger/handshake_worker.h"
+
+using namespace oceanbase::logproxy;
+
+static PendingHandshakePtr make_handshake(int fd, uint64_t timeout_us = 10000000)
+{
+  ClientMeta client;
+  client.peer = Peer(0, 2983, fd);
+  return std::make_shared<PendingHandshake>(client, Timer::now() + timeout_us);
+}
+
+static int admit_all(size_t, std::string&)
+{
+  return OMS_OK;
+}
+
+/*!
+ * @brief Checks done by workers, which the event loop takes in turn
+ */
+struct VerifiedHandshakes {
+  void verify(const PendingHandshakePtr& handshake)
+  {
+    if (handshake->client.peer.fd % 2 == 1) {
+      handshake->ret = OMS_FAILED;
+      handshake->code = ErrorCode::NO_AUTH;
+      handshake->errmsg = "Failed to auth";
+    }
+    done.offer(handshake, 0);
+  }
+
+  PendingHandshakePtr take()
+  {
+    PendingHandshakePtr handshake;
+    done.poll(handshake, 5000000);
+    return handshake;
+  }
+
+  BlockingQueue<PendingHandshakePtr> done{16};
+};
+
+TEST(HandshakeScheduler, verified)
+{
+  VerifiedHandshakes verified;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, admit_all, 16);
+  scheduler.start(2);
+
+  std::string reason;
+  ASSERT_EQ(OMS_OK, scheduler.submit(make_handshake(10), reason));
+  ASSERT_EQ(OMS_OK, scheduler.submit(make_handshake(11), reason));
+  ASSERT_TRUE(scheduler.contains(Peer(0, 2983, 10).id()));
+  ASSERT_EQ(2, scheduler.admitted());
+
+  for (int i = 0; i < 2; ++i) {
+    PendingHandshakePtr handshake = verified.take();
+    ASSERT_NE(nullptr, handshake);
+    ASSERT_TRUE(scheduler.complete(handshake));
+    if (handshake->client.peer.fd == 10) {
+      ASSERT_EQ(OMS_OK, handshake->ret);
+    } else {
+      ASSERT_EQ(OMS_FAILED, handshake->ret);
+      ASSERT_EQ(ErrorCode::NO_AUTH, handshake->code);
+    }
+    // taken only once
+    ASSERT_FALSE(scheduler.complete(handshake));
+  }
+  ASSERT_EQ(0, scheduler.size());
+}
+
+TEST(HandshakeScheduler, closed_before_verified)
+{
+  VerifiedHandshakes verified;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, admit_all, 16);
+  scheduler.start(1);
+
+  std::string reason;
+  PendingHandshakePtr handshake = make_handshake(10);
+  ASSERT_EQ(OMS_OK, scheduler.submit(handshake, reason));
+  scheduler.remove(handshake->client.peer.id());
+  ASSERT_EQ(handshake, verified.take());
+  ASSERT_FALSE(scheduler.complete(handshake));
+  ASSERT_EQ(0, scheduler.size());
+}
+
+// a worker blocked by an observer past the deadline is replaced, and its result dropped once returned
+TEST(HandshakeScheduler, timeout_replaces_stuck_worker)
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool blocked = true;
+  VerifiedHandshakes verified;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) {
+        if (handshake->client.peer.fd == 10) {
+          std::unique_lock<std::mutex> lock(mutex);
+          cond.wait(lock, [&] { return !blocked; });
+        }
+        verified.verify(handshake);
+      },
+      admit_all,
+      16);
+  scheduler.start(1);
+
+  std::string reason;
+  PendingHandshakePtr stuck = make_handshake(10, 50000);
+  ASSERT_EQ(OMS_OK, scheduler.submit(stuck, reason));
+  std::vector<PendingHandshakePtr> expired;
+  auto on_expired = [&](const PendingHandshakePtr& handshake) { expired.push_back(handshake); };
+  scheduler.expire(Timer::now(), on_expired);
+  ASSERT_TRUE(expired.empty());
+
+  usleep(100000);
+  scheduler.expire(Timer::now(), on_expired);
+  ASSERT_EQ(1, expired.size());
+  ASSERT_EQ(stuck, expired[0]);
+  ASSERT_EQ(0, scheduler.size());
+
+  // checked by the replacement while the stuck one still waits
+  PendingHandshakePtr next = make_handshake(12);
+  ASSERT_EQ(OMS_OK, scheduler.submit(next, reason));
+  ASSERT_EQ(next, verified.take());
+  ASSERT_TRUE(scheduler.complete(next));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    blocked = false;
+  }
+  cond.notify_all();
+  ASSERT_EQ(stuck, verified.take());
+  ASSERT_FALSE(scheduler.complete(stuck));
+}
+
+/*!
+ * @brief Admits handshakes as long as ones admitted and not done stay within the budget, like clients of a tenant
+ */
+struct Budget {
+  HandshakeScheduler::AdmitFunc admit()
+  {
+    return [this](size_t admitted, std::string& reason) {
+      if (admitted >= clients) {
+        reason = "budgets used up by " + std::to_string(admitted) + " clients";
+        return OMS_FAILED;
+      }
+      return OMS_OK;
+    };
+  }
+
+  size_t clients = 1;
+};
+
+TEST(HandshakeScheduler, rejected_without_admission_wait)
+{
+  uint32_t admission_wait_s = Config::instance().admission_wait_s.val();
+  Config::instance().admission_wait_s.set(0);
+  VerifiedHandshakes verified;
+  Budget budget;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, budget.admit(), 16);
+  scheduler.start(1);
+
+  std::string reason;
+  ASSERT_EQ(OMS_OK, scheduler.submit(make_handshake(10), reason));
+  ASSERT_EQ(OMS_FAILED, scheduler.submit(make_handshake(12), reason));
+  ASSERT_FALSE(reason.empty());
+  ASSERT_FALSE(scheduler.contains(Peer(0, 2983, 12).id()));
+  ASSERT_EQ(1, scheduler.size());
+  ASSERT_EQ(0, scheduler.waiting());
+  Config::instance().admission_wait_s.set(admission_wait_s);
+}
+
+// handshakes waiting for budgets are admitted in arrival order as running ones release budgets
+TEST(HandshakeScheduler, admitted_in_arrival_order)
+{
+  uint32_t admission_wait_s = Config::instance().admission_wait_s.val();
+  Config::instance().admission_wait_s.set(10);
+  VerifiedHandshakes verified;
+  Budget budget;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, budget.admit(), 16);
+  scheduler.start(2);
+
+  std::string reason;
+  PendingHandshakePtr first = make_handshake(10);
+  ASSERT_EQ(OMS_OK, scheduler.submit(first, reason));
+  std::vector<PendingHandshakePtr> waiting = {make_handshake(12), make_handshake(14)};
+  for (const PendingHandshakePtr& handshake : waiting) {
+    reason.clear();
+    ASSERT_EQ(OMS_OK, scheduler.submit(handshake, reason));
+    ASSERT_FALSE(handshake->admitted);
+  }
+  ASSERT_EQ(1, scheduler.admitted());
+  ASSERT_EQ(2, scheduler.waiting());
+
+  // queued behind the ones waiting, though budgets allow
+  budget.clients = 3;
+  PendingHandshakePtr later = make_handshake(16);
+  reason.clear();
+  ASSERT_EQ(OMS_OK, scheduler.submit(later, reason));
+  ASSERT_FALSE(later->admitted);
+  ASSERT_EQ(3, scheduler.waiting());
+  waiting.push_back(later);
+
+  ASSERT_EQ(first, verified.take());
+  ASSERT_TRUE(scheduler.complete(first));
+  budget.clients = 1;
+  for (const PendingHandshakePtr& handshake : waiting) {
+    scheduler.admit_waiting();
+    ASSERT_TRUE(handshake->admitted);
+    ASSERT_EQ(1, scheduler.admitted());
+    ASSERT_EQ(handshake, verified.take());
+    // nothing more admitted before the budget held by the one checked released
+    scheduler.admit_waiting();
+    ASSERT_EQ(1, scheduler.admitted());
+    ASSERT_TRUE(scheduler.complete(handshake));
+  }
+  ASSERT_EQ(0, scheduler.size());
+  Config::instance().admission_wait_s.set(admission_wait_s);
+}
+
+TEST(HandshakeScheduler, released_while_waiting)
+{
+  uint32_t admission_wait_s = Config::instance().admission_wait_s.val();
+  Config::instance().admission_wait_s.set(10);
+  VerifiedHandshakes verified;
+  Budget budget;
+  budget.clients = 0;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, budget.admit(), 16);
+  scheduler.start(1);
+
+  std::string reason;
+  PendingHandshakePtr closed = make_handshake(10);
+  PendingHandshakePtr next = make_handshake(12);
+  ASSERT_EQ(OMS_OK, scheduler.submit(closed, reason));
+  reason.clear();
+  ASSERT_EQ(OMS_OK, scheduler.submit(next, reason));
+  ASSERT_EQ(2, scheduler.waiting());
+
+  // closed by the client before admitted, never checked
+  scheduler.remove(closed->client.peer.id());
+  ASSERT_FALSE(scheduler.contains(closed->client.peer.id()));
+  ASSERT_EQ(1, scheduler.waiting());
+  budget.clients = 1;
+  scheduler.admit_waiting();
+  ASSERT_FALSE(closed->admitted);
+  ASSERT_TRUE(next->admitted);
+  ASSERT_EQ(next, verified.take());
+  ASSERT_TRUE(scheduler.complete(next));
+  ASSERT_EQ(0, scheduler.size());
+  Config::instance().admission_wait_s.set(admission_wait_s);
+}
+
+TEST(HandshakeScheduler, expired_while_waiting)
+{
+  uint32_t admission_wait_s = Config::instance().admission_wait_s.val();
+  Config::instance().admission_wait_s.set(1);
+  VerifiedHandshakes verified;
+  Budget budget;
+  budget.clients = 0;
+  HandshakeScheduler scheduler(
+      [&](const PendingHandshakePtr& handshake) { verified.verify(handshake); }, budget.admit(), 16);
+  scheduler.start(1);
+
+  std::string reason;
+  PendingHandshakePtr handshake = make_handshake(10);
+  ASSERT_EQ(OMS_OK, scheduler.submit(handshake, reason));
+  std::vector<PendingHandshakePtr> expired;
+  auto on_expired = [&](const PendingHandshakePtr& handshake) { expired.push_back(handshake); };
+  scheduler.expire(Timer::now(), on_expired);
+  ASSERT_TRUE(expired.empty());
+
+  scheduler.expire(Timer::now() + 2000000, on_expired);
+  ASSERT_EQ(1, expired.size());
+  ASSERT_EQ(handshake, expired[0]);
+  // told apart from handshakes timed out in checks by the state
+  ASSERT_FALSE(expired[0]->admitted);
+  ASSERT_EQ(0, scheduler.size());
+  ASSERT_EQ(0, scheduler.waiting());
+
+  // budgets released later admit nothing expired
+  budget.clients = 1;
+  scheduler.admit_waiting();
+  ASSERT_EQ(0, scheduler.admitted());
+  Config::instance().admission_wait_s.set(admission_wait_s);
+}
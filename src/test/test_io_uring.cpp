@@ -0,0 +1,238 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <cstdio>
+#include <random>
+#include <sys/vfs.h>
+#include "gtest/gtest.h"
+#include "fs_util.h"
+#include "io_uring.h"
+#include "timer.h"
+
+using namespace oceanbase::logproxy;
+
+static std::string append_chunks(AppendFile& appender, const std::string& file, std::mt19937& gen, size_t count)
+{
+  std::string expected;
+  MsgBuf content;
+  for (size_t i = 0; i < count; ++i) {
+    size_t size = gen() % 300 + 1;
+    char* buf = static_cast<char*>(malloc(size));
+    for (size_t j = 0; j < size; ++j) {
+      buf[j] = static_cast<char>(gen());
+    }
+    expected.append(buf, size);
+    content.push_back(buf, size);
+  }
+  EXPECT_EQ(OMS_OK, appender.append(file, content));
+  return expected;
+}
+
+TEST(IoUring, append_and_read_ahead)
+{
+  std::string dir = "./test_io_uring";
+  FsUtil::remove(dir);
+  FsUtil::mkdir(dir);
+  std::mt19937 gen(7);
+  for (bool use_io_uring : {false, true}) {
+    std::string file = dir + "/binlog." + std::to_string(use_io_uring);
+    AppendFile appender(use_io_uring);
+
+    // more chunks than IOV_MAX are written by linked requests
+    std::string expected = append_chunks(appender, file, gen, 3000);
+    ASSERT_EQ(expected.size(), FsUtil::file_size(file));
+    std::cout << "io_uring: " << use_io_uring << ", appender: " << appender.is_io_uring() << std::endl;
+
+    ReadAheadFile reader(4096, 4, use_io_uring);
+    ASSERT_EQ(OMS_OK, reader.open(file));
+    reader.set_limit(expected.size());
+    std::string buf(20000, '\0');
+    uint64_t offset = 0;
+    while (offset < expected.size()) {
+      size_t len = std::min<size_t>(gen() % 600 + 1, expected.size() - offset);
+      ASSERT_EQ(OMS_OK, reader.read(offset, reinterpret_cast<unsigned char*>(&buf[0]), len)) << offset;
+      ASSERT_EQ(expected.substr(offset, len), buf.substr(0, len)) << offset;
+      offset += len;
+    }
+    // backwards and larger than the read-ahead window
+    ASSERT_EQ(OMS_OK, reader.read(100, reinterpret_cast<unsigned char*>(&buf[0]), 20000));
+    ASSERT_EQ(expected.substr(100, 20000), buf);
+    ASSERT_EQ(OMS_FAILED, reader.read(expected.size() - 10, reinterpret_cast<unsigned char*>(&buf[0]), 20));
+
+    // bytes appended later are read, though the chunk holding them was read short before
+    expected += append_chunks(appender, file, gen, 10);
+    reader.set_limit(expected.size());
+    size_t len = expected.size() - offset;
+    ASSERT_EQ(OMS_OK, reader.read(offset - 10, reinterpret_cast<unsigned char*>(&buf[0]), len + 10));
+    ASSERT_EQ(expected.substr(offset - 10), buf.substr(0, len + 10));
+    reader.close();
+  }
+  FsUtil::remove(dir);
+}
+
+TEST(IoUring, read_appended_tail_only)
+{
+  std::string dir = "./test_io_uring_tail";
+  FsUtil::remove(dir);
+  FsUtil::mkdir(dir);
+  std::mt19937 gen(13);
+  for (bool use_io_uring : {false, true}) {
+    std::string file = dir + "/binlog." + std::to_string(use_io_uring);
+    AppendFile appender(use_io_uring);
+    ReadAheadFile reader(4096, 4, use_io_uring);
+    std::string expected = append_chunks(appender, file, gen, 1);
+    ASSERT_EQ(OMS_OK, reader.open(file));
+
+    // as a dumper following the converter, each event is read right after appended
+    std::string buf(300, '\0');
+    uint64_t offset = 0;
+    for (int i = 0; i < 2000; ++i) {
+      reader.set_limit(expected.size());
+      size_t len = expected.size() - offset;
+      ASSERT_EQ(OMS_OK, reader.read(offset, reinterpret_cast<unsigned char*>(&buf[0]), len)) << offset;
+      ASSERT_EQ(expected.substr(offset, len), buf.substr(0, len)) << offset;
+      offset += len;
+      expected += append_chunks(appender, file, gen, 1);
+    }
+    std::cout << "io_uring: " << reader.is_io_uring() << ", file bytes: " << expected.size()
+              << ", bytes read: " << reader.bytes_read() << std::endl;
+    // chunks read short are topped up rather than read again from their beginning
+    ASSERT_LE(reader.bytes_read(), expected.size());
+    reader.close();
+  }
+  FsUtil::remove(dir);
+}
+
+static const char* fs_name(const std::string& dir)
+{
+  struct statfs st {};
+  if (statfs(dir.c_str(), &st) != 0) {
+    return "unknown";
+  }
+  switch (st.f_type) {
+    case 0x01021994:
+      return "tmpfs";
+    case 0xEF53:
+      return "ext4";
+    case 0x58465342:
+      return "xfs";
+    case 0x794c7630:
+      return "overlayfs";
+    default:
+      return "other";
+  }
+}
+
+static void report(const char* fs, const char* path, uint64_t bytes, int64_t cost_us)
+{
+  // bytes per us is MB/s
+  std::cout << fs << ", " << path << ": " << (double)bytes / std::max<int64_t>(cost_us, 1) / 1000 << " GB/s" << std::endl;
+}
+
+// ./test_base --gtest_also_run_disabled_tests --gtest_filter=IoUring.DISABLED_throughput
+// throughput of appending and reading binlogs with the page cache warm, on tmpfs and on the fs of working directory
+TEST(IoUring, DISABLED_throughput)
+{
+  const size_t events = 800000;
+  // events flushed at a time by BinlogStorage
+  const size_t flush_events = 1000;
+  const size_t header_len = 19;
+  std::mt19937 gen(17);
+  std::vector<uint32_t> sizes(events);
+  uint64_t total = 0;
+  for (uint32_t& size : sizes) {
+    size = gen() % 901 + 100;
+    total += size;
+  }
+  std::string payload(1000, '\0');
+  for (char& c : payload) {
+    c = static_cast<char>(gen());
+  }
+  auto batch = [&](size_t begin, MsgBuf& content) {
+    for (size_t i = begin; i < std::min(begin + flush_events, events); ++i) {
+      char* buf = static_cast<char*>(malloc(sizes[i]));
+      memcpy(buf, payload.data(), sizes[i]);
+      content.push_back(buf, sizes[i]);
+    }
+  };
+
+  for (const std::string& dir : {std::string("/dev/shm/test_io_uring_bench"), std::string("./test_io_uring_bench")}) {
+    FsUtil::remove(dir);
+    if (!FsUtil::mkdir(dir)) {
+      continue;
+    }
+    const char* fs = fs_name(dir);
+    std::string file = dir + "/binlog";
+
+    // append
+    ::remove(file.c_str());
+    Timer timer;
+    for (size_t i = 0; i < events; i += flush_events) {
+      MsgBuf content;
+      batch(i, content);
+      FILE* fp = fopen(file.c_str(), "ab");
+      ASSERT_NE(nullptr, fp);
+      for (const auto& chunk : content) {
+        ASSERT_EQ(chunk.size(), fwrite(chunk.buffer(), 1, chunk.size(), fp));
+      }
+      fclose(fp);
+    }
+    report(fs, "append by fopen/fwrite", total, timer.elapsed());
+
+    for (bool use_io_uring : {false, true}) {
+      ::remove(file.c_str());
+      AppendFile appender(use_io_uring);
+      timer.reset();
+      for (size_t i = 0; i < events; i += flush_events) {
+        MsgBuf content;
+        batch(i, content);
+        ASSERT_EQ(OMS_OK, appender.append(file, content));
+      }
+      appender.close();
+      report(fs, appender.is_io_uring() ? "append by io_uring" : "append by writev", total, timer.elapsed());
+    }
+    ASSERT_EQ(total, FsUtil::file_size(file));
+
+    // read, each event by its header checked, its header and its body as dumpers did by fseek/fread
+    std::vector<unsigned char> buf(1000);
+    FILE* fp = fopen(file.c_str(), "rb");
+    ASSERT_NE(nullptr, fp);
+    timer.reset();
+    uint64_t offset = 0;
+    for (uint32_t size : sizes) {
+      fseek(fp, offset, SEEK_SET);
+      ASSERT_EQ(header_len, fread(buf.data(), 1, header_len, fp));
+      fseek(fp, offset, SEEK_SET);
+      ASSERT_EQ(header_len, fread(buf.data(), 1, header_len, fp));
+      ASSERT_EQ(size - header_len, fread(buf.data() + header_len, 1, size - header_len, fp));
+      offset += size;
+    }
+    report(fs, "read by fseek/fread", total, timer.elapsed());
+    fclose(fp);
+
+    for (bool use_io_uring : {false, true}) {
+      ReadAheadFile reader(256 * 1024, 4, use_io_uring);
+      ASSERT_EQ(OMS_OK, reader.open(file));
+      reader.set_limit(total);
+      timer.reset();
+      offset = 0;
+      for (uint32_t size : sizes) {
+        ASSERT_EQ(OMS_OK, reader.read(offset, buf.data(), header_len));
+        ASSERT_EQ(OMS_OK, reader.read(offset, buf.data(), size));
+        offset += size;
+      }
+      report(fs, reader.is_io_uring() ? "read ahead by io_uring" : "read ahead by pread", total, timer.elapsed());
+      reader.close();
+    }
+    FsUtil::remove(dir);
+  }
+}
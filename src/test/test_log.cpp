@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <filesystem>
+#include "gtest/gtest.h"
+#include "log.h"
+#include "timer.h"
+
+using namespace oceanbase;
+using namespace oceanbase::logproxy;
+
+static int _s_evaluated = 0;
+
+static int evaluate()
+{
+  return ++_s_evaluated;
+}
+
+TEST(Log, stream_skip_disabled_level)
+{
+  spdlog::level::level_enum level = Logger::instance().logger()->level();
+  Logger::instance().logger()->set_level(spdlog::level::info);
+
+  _s_evaluated = 0;
+  OMS_STREAM_DEBUG << "never formatted: " << evaluate();
+  ASSERT_EQ(0, _s_evaluated);
+
+  OMS_STREAM_INFO << "formatted: " << evaluate();
+  ASSERT_EQ(1, _s_evaluated);
+
+  Logger::instance().logger()->set_level(level);
+}
+
+TEST(Log, rate_limit)
+{
+  LogRateLimiter limiter;
+  uint64_t suppressed = 0;
+  ASSERT_TRUE(limiter.allow(10, suppressed));
+  ASSERT_EQ(0, suppressed);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_FALSE(limiter.allow(10, suppressed));
+  }
+  ASSERT_TRUE(limiter.allow(0, suppressed));
+  ASSERT_EQ(100, suppressed);
+
+  for (int i = 0; i < 100; ++i) {
+    OMS_INFO_EVERY(10, "retry loop: {}", i);
+  }
+}
+
+static std::shared_ptr<spdlog::logger> async_logger(const std::string& name,
+    std::shared_ptr<spdlog::details::thread_pool> pool, spdlog::async_overflow_policy policy)
+{
+  std::filesystem::path path = std::filesystem::temp_directory_path() / (name + ".log");
+  auto sink = std::make_shared<rotating_file_with_compress_sink_mt>(path.string(), 512 * 1024 * 1024, 168, 1 << 19);
+  return std::make_shared<spdlog::async_logger>(name, std::move(sink), std::move(pool), policy);
+}
+
+static int64_t log_cost(std::shared_ptr<spdlog::logger> logger, int count)
+{
+  std::filesystem::path path = std::filesystem::temp_directory_path() / (logger->name() + ".log");
+  logger->set_pattern("[%Y-%m-%d %H:%M:%S] [%^%l%$] %s(%#): %v");
+  // same as Logger::init, which flushes every record at log_level
+  logger->flush_on(spdlog::level::info);
+
+  Timer timer;
+  for (int i = 0; i < count; ++i) {
+    logger->info("Send transfer queue empty, retry... {}", i);
+  }
+  int64_t cost = timer.elapsed();
+
+  spdlog::drop(logger->name());
+  logger.reset();
+  std::filesystem::remove(path);
+  return cost;
+}
+
+TEST(Log, async_cost)
+{
+  // fewer records than the queue holds, it is the latency of callers that matters for hot paths
+  const int count = 5000;
+  int64_t sync_us = log_cost(rotating_with_compress_logger_mt("test_log_sync",
+                                 (std::filesystem::temp_directory_path() / "test_log_sync.log").string()),
+      count);
+  // a pool of the test's own, the global one serves the default logger installed by Logger::init
+  auto pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+  int64_t async_us = log_cost(async_logger("test_log_async", pool, spdlog::async_overflow_policy::block), count);
+  int64_t overrun_us =
+      log_cost(async_logger("test_log_overrun", pool, spdlog::async_overflow_policy::overrun_oldest), count);
+
+  spdlog::level::level_enum level = Logger::instance().logger()->level();
+  Logger::instance().logger()->set_level(spdlog::level::info);
+  Timer timer;
+  for (int i = 0; i < count; ++i) {
+    OMS_STREAM_DEBUG << "filtered record: " << i;
+  }
+  int64_t filtered_us = timer.elapsed();
+  Logger::instance().logger()->set_level(level);
+
+  OMS_INFO("cost of {} records in us, sync: {}, async(block): {}, async(overrun oldest): {}, filtered stream: {}",
+      count,
+      sync_us,
+      async_us,
+      overrun_us,
+      filtered_us);
+}
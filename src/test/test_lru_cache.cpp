@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <string>
+#include "gtest/gtest.h"
+#include "lru_cache.hpp"
+
+using namespace oceanbase::logproxy;
+
+TEST(LruCache, evict_least_recently_used)
+{
+  LruCache<std::string, int> cache;
+  int value = 0;
+  ASSERT_FALSE(cache.get("a", value));
+
+  cache.put("a", 1, 2);
+  cache.put("b", 2, 2);
+  // a becomes the most recently used, so b is evicted
+  ASSERT_TRUE(cache.get("a", value));
+  ASSERT_EQ(1, value);
+  cache.put("c", 3, 2);
+  ASSERT_EQ(2, cache.size());
+  ASSERT_FALSE(cache.get("b", value));
+  ASSERT_TRUE(cache.get("c", value));
+  ASSERT_EQ(3, value);
+
+  // cached ones are kept
+  cache.put("a", 10, 2);
+  ASSERT_TRUE(cache.get("a", value));
+  ASSERT_EQ(1, value);
+
+  // capacity shrunk evicts down to it
+  cache.put("d", 4, 1);
+  ASSERT_EQ(1, cache.size());
+  ASSERT_TRUE(cache.get("d", value));
+  cache.put("e", 5, 0);
+  ASSERT_FALSE(cache.get("e", value));
+
+  cache.clear();
+  ASSERT_EQ(0, cache.size());
+  ASSERT_FALSE(cache.get("d", value));
+}
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "metric/histogram.h"
+#include "metric/metric_registry.h"
+#include "metric/latency_tracer.h"
+#include "config.h"
+#include "timer.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(Histogram, bucket_index)
+{
+  for (uint64_t v : {0UL, 1UL, 63UL, 64UL, 100UL, 1000UL, 123456789UL, UINT64_MAX}) {
+    int index = Histogram::bucket_index(v);
+    ASSERT_LT(index, Histogram::BUCKET_COUNT);
+    ASSERT_GE(Histogram::bucket_upper_bound(index), v);
+    if (index > 0) {
+      ASSERT_LT(Histogram::bucket_upper_bound(index - 1), v);
+    }
+  }
+}
+
+TEST(Histogram, percentile)
+{
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram] {
+      for (uint64_t v = 1; v <= 10000; ++v) {
+        histogram.record(v);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  HistogramSnapshot snapshot;
+  histogram.snapshot(snapshot);
+  ASSERT_EQ(40000, snapshot.count);
+  ASSERT_EQ(10000, snapshot.max);
+  // relative error is bounded by 1/SUB_BUCKET_COUNT
+  ASSERT_NEAR(5000, snapshot.value_at(50), 5000 / Histogram::SUB_BUCKET_COUNT);
+  ASSERT_NEAR(9900, snapshot.value_at(99), 9900 / Histogram::SUB_BUCKET_COUNT);
+  ASSERT_EQ(10000, snapshot.value_at(100));
+
+  HistogramSnapshot prev = snapshot;
+  histogram.record(1);
+  histogram.snapshot(snapshot);
+  HistogramSnapshot window = snapshot.delta(prev);
+  ASSERT_EQ(1, window.count);
+  ASSERT_EQ(1, window.value_at(99));
+}
+
+TEST(MetricRegistry, merge)
+{
+  MetricRegistry& registry = MetricRegistry::instance();
+  registry.histogram("test_stage_us", {{"client_id", "c1"}}).record(100);
+  registry.register_gauge("test_queue_depth", [] { return 7; }, {{"client_id", "c1"}});
+
+  MetricFamilies families;
+  registry.roll();
+  registry.collect(families);
+  std::string child;
+  MetricRegistry::format(families, child);
+  ASSERT_NE(std::string::npos, child.find("test_queue_depth{client_id=\"c1\"} 7"));
+  ASSERT_NE(std::string::npos, child.find("test_stage_us_count{client_id=\"c1\"} 1"));
+
+  // metrics of another process are grouped into the same family
+  MetricFamilies merged;
+  MetricRegistry::parse(child, merged);
+  MetricRegistry::parse("# TYPE test_queue_depth gauge\ntest_queue_depth{client_id=\"c2\"} 3\n", merged);
+  ASSERT_EQ("gauge", merged["test_queue_depth"].type);
+  ASSERT_EQ(2, merged["test_queue_depth"].samples.size());
+  ASSERT_EQ("summary", merged["test_stage_us"].type);
+
+  registry.unregister_gauge("test_queue_depth", {{"client_id", "c1"}});
+}
+
+TEST(MetricRegistry, render_keeps_window)
+{
+  MetricRegistry& registry = MetricRegistry::instance();
+  registry.histogram("test_render_us").record(500);
+  registry.roll();
+
+  // scrapes and exports in between rolls read the same window
+  std::string first;
+  std::string second;
+  registry.render({}, first);
+  registry.render({}, second);
+  ASSERT_NE(std::string::npos, first.find("test_render_us{quantile=\"0.99\"} 5"));
+  ASSERT_EQ(first, second);
+}
+
+TEST(MetricRegistry, roll_by_quantile_window)
+{
+  uint32_t window_s = Config::instance().metric_quantile_window_s.val();
+  Config::instance().metric_quantile_window_s.set(10);
+  MetricRegistry& registry = MetricRegistry::instance();
+  Histogram& histogram = registry.histogram("test_window_us");
+  uint64_t now_us = Timer::now();
+  registry.roll_if_due(now_us + 10000000);
+
+  // spikes leave quantiles once their window passed, long before metric_interval_s
+  histogram.record(50000);
+  registry.roll_if_due(now_us + 15000000);
+  std::string text;
+  registry.render({}, text);
+  ASSERT_EQ(std::string::npos, text.find("test_window_us{quantile=\"0.99\"} 5"));
+  registry.roll_if_due(now_us + 20000000);
+  text.clear();
+  registry.render({}, text);
+  ASSERT_NE(std::string::npos, text.find("test_window_us{quantile=\"0.99\"} 5"));
+
+  histogram.record(100);
+  registry.roll_if_due(now_us + 30000000);
+  text.clear();
+  registry.render({}, text);
+  ASSERT_EQ(std::string::npos, text.find("test_window_us{quantile=\"0.99\"} 5"));
+  Config::instance().metric_quantile_window_s.set(window_s);
+}
+
+TEST(LatencyTracer, breakdown)
+{
+  Config::instance().latency_trace_sample_interval.set(1);
+  LatencyTracer& tracer = LatencyTracer::instance();
+  int record = 0;
+  int event = 0;
+  tracer.begin(&record, Timer::now() - 1000);
+  tracer.stamp(&record, TRACE_QUEUE);
+  tracer.stamp(&record, TRACE_CONVERT);
+  tracer.move(&record, &event);
+  TxnTrace trace;
+  ASSERT_FALSE(tracer.detach(&record, trace));
+  ASSERT_TRUE(tracer.detach(&event, trace));
+  ASSERT_FALSE(tracer.detach(&event, trace));
+  tracer.finish(trace);
+
+  MetricRegistry& registry = MetricRegistry::instance();
+  MetricFamilies families;
+  registry.roll();
+  registry.collect(families);
+  std::string text;
+  MetricRegistry::format(families, text);
+
+  Json::Value breakdown;
+  LatencyTracer::serialize_breakdown(text, breakdown);
+  for (const char* stage : {"upstream", "queue", "convert", "deliver", "total"}) {
+    ASSERT_TRUE(breakdown.isMember(stage));
+    ASSERT_TRUE(breakdown[stage].isMember("0.99"));
+  }
+  ASSERT_GE(breakdown["total"]["0.99"].asUInt64(), 1000);
+}
+
+TEST(LatencyTracer, evict_leaked_traces)
+{
+  Config::instance().latency_trace_sample_interval.set(1);
+  LatencyTracer& tracer = LatencyTracer::instance();
+  // records released on failure paths without finishing nor discarding their traces
+  int leaked[LatencyTracer::SLOT_COUNT];
+  for (auto& record : leaked) {
+    tracer.begin(&record, Timer::now());
+  }
+
+  int record = 0;
+  tracer.begin(&record, Timer::now());
+  TxnTrace trace;
+  ASSERT_TRUE(tracer.detach(&record, trace));
+  ASSERT_FALSE(tracer.detach(&leaked[0], trace));
+  for (auto& r : leaked) {
+    tracer.discard(&r);
+  }
+}
+
+// stamps of evicted traces racing with eviction never land on traces taking their slots over
+TEST(LatencyTracer, stamp_while_evicted)
+{
+  Config::instance().latency_trace_sample_interval.set(1);
+  LatencyTracer& tracer = LatencyTracer::instance();
+  std::atomic<bool> stopped{false};
+  std::vector<std::thread> stampers;
+  for (int t = 0; t < 4; ++t) {
+    stampers.emplace_back([&] {
+      // more traces than slots, evicting each other all the time
+      int records[LatencyTracer::SLOT_COUNT / 2];
+      while (!stopped) {
+        for (auto& record : records) {
+          tracer.begin(&record, Timer::now());
+        }
+        for (int i = 0; i < 10; ++i) {
+          for (auto& record : records) {
+            tracer.stamp(&record, TRACE_CONVERT);
+          }
+        }
+        for (auto& record : records) {
+          tracer.discard(&record);
+        }
+      }
+    });
+  }
+
+  uint64_t traced = 0;
+  uint64_t end_us = Timer::now() + 300000;
+  while (Timer::now() < end_us) {
+    int record = 0;
+    tracer.begin(&record, Timer::now());
+    // long enough for stampers to race with taking the slot over
+    usleep(50);
+    TxnTrace trace;
+    if (tracer.detach(&record, trace)) {
+      ++traced;
+      ASSERT_NE(0, trace.stamps[TRACE_UPSTREAM]);
+      ASSERT_EQ(0, trace.stamps[TRACE_CONVERT]);
+    }
+  }
+  stopped = true;
+  for (auto& stamper : stampers) {
+    stamper.join();
+  }
+  ASSERT_GT(traced, 0);
+}
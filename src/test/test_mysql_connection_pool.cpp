@@ -0,0 +1,347 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "config.h"
+#include "obaccess/mysql_connection_pool.h"
+#include "obaccess/clog_meta_routine.h"
+#include "obaccess/clog_meta_shm.h"
+
+using namespace oceanbase::logproxy;
+
+/*!
+ * @brief Minimal MySQL protocol server accepting any credentials, answering any query with one row of one column
+ */
+class MysqlStubServer {
+public:
+  explicit MysqlStubServer(const std::string& value) : _value(value)
+  {
+    // as logproxy does, writing to connections closed by server must not kill the process
+    signal(SIGPIPE, SIG_IGN);
+    _listenfd = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(_listenfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(_listenfd, (sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(_listenfd, (sockaddr*)&addr, &len);
+    _port = ntohs(addr.sin_port);
+    listen(_listenfd, 16);
+    _acceptor = std::thread([this] { accept_loop(); });
+  }
+
+  ~MysqlStubServer()
+  {
+    _stopped = true;
+    shutdown(_listenfd, SHUT_RDWR);
+    close(_listenfd);
+    _acceptor.join();
+    close_sessions();
+  }
+
+  int port() const
+  {
+    return _port;
+  }
+
+  int accepted() const
+  {
+    return _accepted.load();
+  }
+
+  int queries() const
+  {
+    return _queries.load();
+  }
+
+  /*!
+   * @brief Close established connections, as observers do for connections idle longer than wait_timeout
+   */
+  void close_sessions()
+  {
+    std::vector<std::thread> sessions;
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      for (int fd : _fds) {
+        shutdown(fd, SHUT_RDWR);
+      }
+      sessions.swap(_sessions);
+    }
+    for (std::thread& session : sessions) {
+      session.join();
+    }
+  }
+
+private:
+  void accept_loop()
+  {
+    while (!_stopped) {
+      int fd = accept(_listenfd, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      _accepted.fetch_add(1);
+      int nodelay = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+      std::lock_guard<std::mutex> guard(_lock);
+      _fds.push_back(fd);
+      _sessions.emplace_back([this, fd] { serve(fd); });
+    }
+  }
+
+  static bool send_packet(int fd, uint8_t seq, const std::string& payload)
+  {
+    std::string packet;
+    packet.push_back(payload.size() & 0xff);
+    packet.push_back((payload.size() >> 8) & 0xff);
+    packet.push_back((payload.size() >> 16) & 0xff);
+    packet.push_back(seq);
+    packet.append(payload);
+    return write(fd, packet.data(), packet.size()) == (ssize_t)packet.size();
+  }
+
+  static bool recv_packet(int fd, std::string& payload)
+  {
+    unsigned char header[4];
+    if (recv(fd, header, 4, MSG_WAITALL) != 4) {
+      return false;
+    }
+    size_t len = header[0] | (header[1] << 8) | (header[2] << 16);
+    payload.resize(len);
+    return len == 0 || recv(fd, &payload[0], len, MSG_WAITALL) == (ssize_t)len;
+  }
+
+  static std::string lenenc_str(const std::string& str)
+  {
+    return std::string(1, (char)str.size()) + str;
+  }
+
+  void serve(int fd)
+  {
+    // protocol 10, version, connection id, 8 bytes scramble, filler, lower capabilities
+    std::string handshake("\x0a"
+                          "5.7.25\0"
+                          "\x01\0\0\0"
+                          "abcdefgh\0"
+                          "\xff\xf7",
+        23);
+    std::string ok("\0\0\0\x02\0\0\0", 7);
+    std::string eof("\xfe\0\0\x02\0", 5);
+    std::string payload;
+    if (send_packet(fd, 0, handshake) && recv_packet(fd, payload) && send_packet(fd, 2, ok)) {
+      while (recv_packet(fd, payload) && !payload.empty() && payload[0] == 0x03) {
+        _queries.fetch_add(1);
+        std::string column = lenenc_str("def") + lenenc_str("") + lenenc_str("") + lenenc_str("") + lenenc_str("v") +
+                             lenenc_str("v") + std::string("\x0c\x21\0\xff\0\0\0\xfd\0\0\0\0\0", 13);
+        if (!send_packet(fd, 1, std::string(1, '\x01')) || !send_packet(fd, 2, column) || !send_packet(fd, 3, eof) ||
+            !send_packet(fd, 4, lenenc_str(_value)) || !send_packet(fd, 5, eof)) {
+          break;
+        }
+      }
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    for (auto iter = _fds.begin(); iter != _fds.end(); ++iter) {
+      if (*iter == fd) {
+        _fds.erase(iter);
+        break;
+      }
+    }
+    close(fd);
+  }
+
+private:
+  std::string _value;
+  int _listenfd = -1;
+  int _port = 0;
+  std::atomic<bool> _stopped{false};
+  std::atomic<int> _accepted{0};
+  std::atomic<int> _queries{0};
+  std::thread _acceptor;
+  std::mutex _lock;
+  std::vector<int> _fds;
+  std::vector<std::thread> _sessions;
+};
+
+static const std::string _s_passwd_sha1(20, 'p');
+
+TEST(MysqlConnectionPool, reuse)
+{
+  MysqlStubServer server("1");
+  MysqlConnectionPool& pool = MysqlConnectionPool::instance();
+  pool.clear();
+
+  for (int i = 0; i < 10; ++i) {
+    MysqlConnectionPool::Connection conn;
+    ASSERT_EQ(OMS_OK, pool.acquire("127.0.0.1", server.port(), "root@sys", _s_passwd_sha1, conn));
+    ASSERT_EQ(i != 0, conn.reused());
+    MySQLResultSet rs;
+    ASSERT_EQ(OMS_OK, conn.query("SELECT 1", rs));
+    ASSERT_EQ(1, rs.rows.size());
+    ASSERT_EQ("1", rs.rows.front().fields().front());
+  }
+  ASSERT_EQ(1, server.accepted());
+  ASSERT_EQ(10, server.queries());
+  ASSERT_EQ(1, pool.idle_count());
+
+  // other credentials never share connections
+  {
+    MysqlConnectionPool::Connection conn;
+    ASSERT_EQ(OMS_OK, pool.acquire("127.0.0.1", server.port(), "other@sys", _s_passwd_sha1, conn));
+    ASSERT_FALSE(conn.reused());
+  }
+  ASSERT_EQ(2, server.accepted());
+  ASSERT_EQ(2, pool.idle_count());
+  pool.clear();
+}
+
+TEST(MysqlConnectionPool, reconnect_closed_idle)
+{
+  MysqlStubServer server("2");
+  MysqlConnectionPool& pool = MysqlConnectionPool::instance();
+  pool.clear();
+
+  {
+    MysqlConnectionPool::Connection conn;
+    ASSERT_EQ(OMS_OK, pool.acquire("127.0.0.1", server.port(), "root@sys", _s_passwd_sha1, conn));
+  }
+  server.close_sessions();
+
+  MysqlConnectionPool::Connection conn;
+  ASSERT_EQ(OMS_OK, pool.acquire("127.0.0.1", server.port(), "root@sys", _s_passwd_sha1, conn));
+  ASSERT_TRUE(conn.reused());
+  MySQLResultSet rs;
+  ASSERT_EQ(OMS_OK, conn.query("SELECT 2", rs));
+  ASSERT_EQ("2", rs.rows.front().fields().front());
+  ASSERT_EQ(2, server.accepted());
+
+  conn.discard();
+  ASSERT_EQ(0, pool.idle_count());
+}
+
+TEST(ClogMetaShm, publish_and_subscribe)
+{
+  OblogConfig config("rootserver_list=127.0.0.1:2882:2881");
+  std::string name = ClogMetaShm::name(getpid(), config);
+
+  ClogMetaShm subscriber;
+  ASSERT_NE(OMS_OK, subscriber.open(name));
+
+  ClogMetaShm publisher;
+  ASSERT_EQ(OMS_OK, publisher.create(name));
+  ASSERT_EQ(OMS_OK, subscriber.open(name));
+
+  uint64_t min_clog_timestamp_us = 0;
+  ASSERT_FALSE(subscriber.read(min_clog_timestamp_us, 1000000));
+  publisher.publish(1700000000000000);
+  ASSERT_TRUE(subscriber.read(min_clog_timestamp_us, 1000000));
+  ASSERT_EQ(1700000000000000, min_clog_timestamp_us);
+
+  publisher.close();
+  subscriber.close();
+  ASSERT_NE(OMS_OK, subscriber.open(name));
+}
+
+TEST(ClogMetaShm, remove_stale)
+{
+  OblogConfig config("rootserver_list=127.0.0.1:2882:2881");
+  int dead = fork();
+  if (dead == 0) {
+    _exit(0);
+  }
+  ASSERT_EQ(dead, waitpid(dead, nullptr, 0));
+
+  ClogMetaShm stale;
+  ASSERT_EQ(OMS_OK, stale.create(ClogMetaShm::name(dead, config)));
+  ClogMetaShm alive;
+  ASSERT_EQ(OMS_OK, alive.create(ClogMetaShm::name(getpid(), config)));
+
+  ClogMetaShm::remove_stale();
+  ClogMetaShm subscriber;
+  ASSERT_NE(OMS_OK, subscriber.open(ClogMetaShm::name(dead, config)));
+  ASSERT_EQ(OMS_OK, subscriber.open(ClogMetaShm::name(getpid(), config)));
+}
+
+TEST(ClogMetaRoutine, subscribe_without_query)
+{
+  MysqlStubServer server("1700000000000000");
+  MysqlConnectionPool::instance().clear();
+  Config::instance().check_clog_enable.set(true);
+  Config::instance().ob_sys_username.set("root");
+
+  OblogConfig config("rootserver_list=127.0.0.1:2882:" + std::to_string(server.port()) + " cluster_user=u@t");
+  config.password_sha1 = _s_passwd_sha1;
+  config.sys_password_sha1 = _s_passwd_sha1;
+  std::string name = ClogMetaShm::name(getpid(), config);
+
+  // poller of logproxy process
+  ClogMetaRoutine poller;
+  ASSERT_EQ(OMS_OK, poller.publish(name));
+  ASSERT_EQ(OMS_OK, poller.init(config));
+  ASSERT_EQ(OMS_OK, poller.poll_once());
+  ASSERT_EQ(1700000000000000, poller.min_clog_timestamp_us());
+  int queries = server.queries();
+
+  // oblogreaders of the same cluster
+  for (int i = 0; i < 8; ++i) {
+    ClogMetaRoutine reader;
+    ASSERT_EQ(OMS_OK, reader.subscribe(name));
+    ASSERT_EQ(OMS_OK, reader.init(config));
+    uint64_t min_clog_timestamp_us = 0;
+    ASSERT_EQ(OMS_OK, reader.fetch_once(min_clog_timestamp_us));
+    ASSERT_EQ(1700000000000000, min_clog_timestamp_us);
+  }
+  ASSERT_EQ(queries, server.queries());
+  ASSERT_EQ(1, server.accepted());
+  MysqlConnectionPool::instance().clear();
+}
+
+TEST(ClogMetaRoutine, subscribe_before_publish)
+{
+  MysqlStubServer server("1700000000000000");
+  MysqlConnectionPool::instance().clear();
+  Config::instance().check_clog_enable.set(true);
+  Config::instance().ob_sys_username.set("root");
+
+  OblogConfig config("rootserver_list=127.0.0.1:2882:" + std::to_string(server.port()) + " cluster_user=u@t");
+  config.password_sha1 = _s_passwd_sha1;
+  config.sys_password_sha1 = _s_passwd_sha1;
+  std::string name = ClogMetaShm::name(getpid(), config);
+
+  // the oblogreader subscribes before the segment exists, and polls by itself meanwhile
+  ClogMetaRoutine reader;
+  ASSERT_NE(OMS_OK, reader.subscribe(name));
+  ASSERT_EQ(OMS_OK, reader.init(config));
+
+  ClogMetaRoutine poller;
+  ASSERT_EQ(OMS_OK, poller.publish(name));
+  ASSERT_EQ(OMS_OK, poller.init(config));
+  ASSERT_EQ(OMS_OK, poller.poll_once());
+  int queries = server.queries();
+
+  uint64_t min_clog_timestamp_us = 0;
+  ASSERT_EQ(OMS_OK, reader.fetch_once(min_clog_timestamp_us));
+  ASSERT_EQ(1700000000000000, min_clog_timestamp_us);
+  ASSERT_EQ(queries, server.queries());
+  MysqlConnectionPool::instance().clear();
+}
@@ -11,11 +11,24 @@
  */
 
 #include <thread>
+#include <algorithm>
+#include <unordered_map>
 #include "sys/socket.h"
+#include "sys/epoll.h"
+#include "sys/resource.h"
+#include "sys/wait.h"
+#include "poll.h"
 #include "netinet/in.h"
+#include "arpa/inet.h"
 
 #include "gtest/gtest.h"
 #include "communication/io.h"
+#include "communication/comm.h"
+#include "codec/encoder.h"
+#include "codec/message.h"
+#include "oblogreader/oblogreader.h"
+#include "logmsg_factory.h"
+#include "timer.h"
 #include "log.h"
 
 using namespace oceanbase::logproxy;
@@ -67,4 +80,366 @@ TEST(NET, fork_fd)
   });
 
   thd1.join();
-}
\ No newline at end of file
+}
+// time from connect to handshake response of concurrent clients, the accepter replies directly
+TEST(NET, handshake_latency)
+{
+  const int nof_clients = 1000;
+  const uint16_t port = 9112;
+
+  // both ends of all connections live in this process
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < nof_clients * 2 + 64) {
+    GTEST_SKIP() << "open files limit too small: " << limit.rlim_cur;
+  }
+
+  ASSERT_EQ(OMS_OK, ChannelFactory::instance().init(Config::instance()));
+  Comm comm;
+  ASSERT_EQ(OMS_OK, comm.init());
+  ASSERT_EQ(OMS_OK, comm.listen(port));
+  comm.set_read_callback([&comm](const Peer& peer, const Message&) {
+    ClientHandshakeResponseMessage response(0, "127.0.0.1", "test");
+    response.set_version(MessageVersion::V2);
+    comm.send_message(peer, response, true);
+    return EventResult::ER_SUCCESS;
+  });
+  std::atomic<bool> done(false);
+  comm.set_routine_callback([&] {
+    if (done) {
+      comm.stop();
+    }
+  });
+  std::thread server([&comm] { comm.start(); });
+
+  ClientHandshakeRequestMessage request((int)LogType::OCEANBASE, "127.0.0.1", "test", "1.0.0", false, "");
+  MsgBuf buffer;
+  size_t raw_len = 0;
+  ASSERT_EQ(OMS_OK, ProtobufEncoder::instance().encode(request, buffer, raw_len));
+  std::string packet;
+  for (const auto& chunk : buffer) {
+    packet.append(chunk.buffer(), chunk.size());
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+  int epfd = epoll_create1(0);
+  std::unordered_map<int, uint64_t> begin_us;
+  for (int i = 0; i < nof_clients; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    ASSERT_GT(fd, 0);
+    begin_us[fd] = Timer::now();
+    connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    struct epoll_event ev;
+    ev.events = EPOLLOUT;
+    ev.data.fd = fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+  }
+
+  std::vector<uint64_t> latencies;
+  struct epoll_event events[128];
+  Timer timer;
+  while (latencies.size() < (size_t)nof_clients && timer.elapsed() < 60 * 1000000L) {
+    int n = epoll_wait(epfd, events, 128, 100);
+    for (int i = 0; i < n; ++i) {
+      int fd = events[i].data.fd;
+      if (events[i].events & EPOLLOUT) {
+        EXPECT_EQ((ssize_t)packet.size(), write(fd, packet.data(), packet.size()));
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev);
+      } else if (events[i].events & EPOLLIN) {
+        char buf[256];
+        if (read(fd, buf, sizeof(buf)) > 0) {
+          latencies.push_back(Timer::now() - begin_us[fd]);
+        }
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+      }
+    }
+  }
+  for (auto& entry : begin_us) {
+    close(entry.first);
+  }
+  close(epfd);
+  done = true;
+  server.join();
+
+  ASSERT_EQ((size_t)nof_clients, latencies.size());
+  std::sort(latencies.begin(), latencies.end());
+  OMS_INFO("{} concurrent handshakes, response latency(us) p50: {}, p90: {}, p99: {}, max: {}",
+      nof_clients,
+      latencies[nof_clients / 2],
+      latencies[nof_clients * 9 / 10],
+      latencies[nof_clients * 99 / 100],
+      latencies.back());
+}
+
+TEST(NET, send_fd)
+{
+  int channel[2];
+  int conn[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, channel));
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, conn));
+
+  std::string payload("oblogreader.conf");
+  payload.push_back('\0');
+  payload.append("./run/client");
+  ASSERT_EQ(OMS_OK, send_fd(channel[0], payload.data(), payload.size(), conn[1]));
+  close(conn[1]);
+
+  char buf[64];
+  int fd = -1;
+  ASSERT_EQ((int)payload.size(), recv_fd(channel[1], buf, sizeof(buf), fd));
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(payload, std::string(buf, payload.size()));
+
+  // the received fd is the same connection
+  ASSERT_EQ(1, write(fd, "x", 1));
+  ASSERT_EQ(1, read(conn[0], buf, 1));
+  ASSERT_EQ('x', buf[0]);
+
+  Peer peer(inet_addr("127.0.0.1"), 2983, 7);
+  Peer received = peer;
+  received.reset_fd(fd);
+  ASSERT_EQ(fd, received.fd);
+  ASSERT_EQ(peer.id() >> 16, received.id() >> 16);
+  ASSERT_EQ((uint64_t)(fd & UINT16_MAX), received.id() & UINT16_MAX);
+
+  // closed channel wakes up the waiting one
+  close(channel[0]);
+  ASSERT_EQ(0, recv_fd(channel[1], buf, sizeof(buf), fd));
+  close(channel[1]);
+  close(conn[0]);
+}
+
+TEST(NET, writev)
+{
+  int conn[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, conn));
+  // a reader draining the socket, so that writev is cut short by the socket buffer
+  std::string received;
+  std::thread reader([&]() {
+    char buf[4096];
+    int ret;
+    while ((ret = read(conn[0], buf, sizeof(buf))) > 0) {
+      received.append(buf, ret);
+    }
+  });
+
+  std::string expected;
+  MsgBuf buffer;
+  for (int i = 0; i < 3000; ++i) {
+    std::string chunk(i % 97 + 1, static_cast<char>('a' + i % 26));
+    expected += chunk;
+    buffer.push_back_copy(&chunk[0], chunk.size());
+  }
+  PlainChannel channel(Peer(inet_addr("127.0.0.1"), 2983, conn[1]));
+  channel.disable_owned_fd();
+  ASSERT_EQ(OMS_OK, channel.writev(buffer));
+  close(conn[1]);
+  reader.join();
+  close(conn[0]);
+  ASSERT_EQ(expected, received);
+}
+
+// latency from handing over a client to the first byte it receives, by fork and exec vs. a pre-started process
+TEST(NET, handover_first_byte_latency)
+{
+  const int rounds = 20;
+  std::vector<int64_t> fork_latencies;
+  std::vector<int64_t> prefork_latencies;
+  char buf[1];
+
+  for (int i = 0; i < rounds; ++i) {
+    int conn[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, conn));
+    uint64_t begin_us = Timer::now();
+    int pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+      dup2(conn[1], 3);
+      char* argv[] = {const_cast<char*>("sh"), const_cast<char*>("-c"), const_cast<char*>("printf x >&3"), nullptr};
+      execv("/bin/sh", argv);
+      ::_exit(-1);
+    }
+    close(conn[1]);
+    ASSERT_EQ(1, read(conn[0], buf, 1));
+    fork_latencies.push_back(Timer::now() - begin_us);
+    close(conn[0]);
+    waitpid(pid, nullptr, 0);
+  }
+
+  for (int i = 0; i < rounds; ++i) {
+    int channel[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, channel));
+    int pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+      close(channel[0]);
+      int fd = -1;
+      char msg[16];
+      if (recv_fd(channel[1], msg, sizeof(msg), fd) > 0 && fd >= 0) {
+        (void)!write(fd, "x", 1);
+      }
+      ::_exit(0);
+    }
+    close(channel[1]);
+
+    int conn[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, conn));
+    uint64_t begin_us = Timer::now();
+    ASSERT_EQ(OMS_OK, send_fd(channel[0], "c", 1, conn[1]));
+    close(conn[1]);
+    ASSERT_EQ(1, read(conn[0], buf, 1));
+    prefork_latencies.push_back(Timer::now() - begin_us);
+    close(conn[0]);
+    close(channel[0]);
+    waitpid(pid, nullptr, 0);
+  }
+
+  std::sort(fork_latencies.begin(), fork_latencies.end());
+  std::sort(prefork_latencies.begin(), prefork_latencies.end());
+  OMS_INFO("Handover first byte latency(us) of fork and exec p50: {}, max: {}; of prefork p50: {}, max: {}",
+      fork_latencies[rounds / 2],
+      fork_latencies.back(),
+      prefork_latencies[rounds / 2],
+      prefork_latencies.back());
+  ASSERT_LT(prefork_latencies[rounds / 2], fork_latencies[rounds / 2]);
+}
+
+/*!
+ * @brief Obcdc of a sender driven by records offered to its queue directly, which only takes them back once sent
+ */
+class ReleaseOnlyObCdc : public IObCdcAccess {
+public:
+  int init(const std::map<std::string, std::string>&, uint64_t) override
+  {
+    return OMS_OK;
+  }
+
+  int init_with_us(const std::map<std::string, std::string>&, uint64_t) override
+  {
+    return OMS_OK;
+  }
+
+  int start() override
+  {
+    return OMS_OK;
+  }
+
+  void stop() override
+  {}
+
+  int fetch(ILogRecord*&) override
+  {
+    return OMS_FAILED;
+  }
+
+  int fetch(ILogRecord*&, uint64_t) override
+  {
+    return OMS_FAILED;
+  }
+
+  void release(ILogRecord* record) override
+  {
+    delete record;
+    ++released;
+  }
+
+  std::atomic<int> released{0};
+};
+
+// sender sends only within credit granted by a client slower than it, instead of buffering packets ahead
+TEST(NET, credit_throttled_consumer)
+{
+  Config& conf = Config::instance();
+  uint32_t read_wait_num = conf.read_wait_num.val();
+  uint64_t read_timeout_us = conf.read_timeout_us.val();
+  // a record per packet, so that the client grants credit by packets read
+  conf.read_wait_num.set(1);
+  conf.read_timeout_us.set(100000);
+
+  ASSERT_EQ(OMS_OK, ChannelFactory::instance().init(conf));
+  int conn[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, conn));
+
+  const int records = 50;
+  const int64_t window = 4;
+  const uint64_t consume_us = 2000;
+
+  ReleaseOnlyObCdc obcdc;
+  int64_t max_outstanding = 0;
+  std::thread client([&] {
+    int64_t granted = 0;
+    for (int i = 0; i < records; ++i) {
+      // [2] version [1] type [4] payload size
+      char header[PACKET_VERSION_SIZE + 1 + 4];
+      if (readn(conn[1], header, sizeof(header)) != OMS_OK) {
+        return;
+      }
+      EXPECT_EQ((int8_t)MessageType::DATA_CLIENT, header[PACKET_VERSION_SIZE]);
+      uint32_t size = 0;
+      memcpy(&size, header + PACKET_VERSION_SIZE + 1, sizeof(size));
+      std::string payload(be_to_cpu(size), '\0');
+      if (readn(conn[1], (char*)payload.data(), payload.size()) != OMS_OK) {
+        return;
+      }
+      usleep(consume_us);
+      // records sent but not granted yet, which a sender ignoring credit would have pushed all by now
+      max_outstanding = std::max(max_outstanding, obcdc.released - granted);
+
+      CreditMessage credit(0, 1);
+      MsgBuf buffer;
+      size_t raw_len = 0;
+      ProtobufEncoder::instance().encode(credit, buffer, raw_len);
+      for (const auto& chunk : buffer) {
+        writen(conn[1], chunk.buffer(), chunk.size());
+      }
+      ++granted;
+    }
+  });
+
+  ObLogReader reader;
+  BlockingQueue<ILogRecord*> queue;
+  SenderRoutine sender(reader, queue);
+  set_non_block(conn[0]);
+  Peer peer(inet_addr("127.0.0.1"), 2983, conn[0]);
+  ASSERT_EQ(OMS_OK, sender.init(MessageVersion::V2, peer, &obcdc));
+  sender.flow_control(0, window);
+
+  for (int i = 0; i < records; ++i) {
+    ILogRecord* record = LogMsgFactory::createLogRecord(_s_logmsg_type, true);
+    record->setTimestamp(1700000000 + i);
+    record->setDbname("test");
+    record->setTbname("t1");
+    ASSERT_TRUE(queue.offer(record, 1000000));
+  }
+  uint64_t begin_us = Timer::now();
+  sender.start();
+  client.join();
+  uint64_t elapsed_us = Timer::now() - begin_us;
+  while (obcdc.released < records && Timer::now() - begin_us < 10000000) {
+    usleep(1000);
+  }
+  sender.stop();
+  sender.join();
+  close(conn[1]);
+  conf.read_wait_num.set(read_wait_num);
+  conf.read_timeout_us.set(read_timeout_us);
+
+  OMS_INFO("Sent {} records to throttled client in {}us, max outstanding records: {}",
+      records,
+      elapsed_us,
+      max_outstanding);
+  ASSERT_EQ(records, obcdc.released);
+  ASSERT_LE(max_outstanding, window);
+  // the sender runs at the pace of the client
+  ASSERT_GE(elapsed_us, (records - window) * consume_us);
+}
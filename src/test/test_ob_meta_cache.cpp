@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "obaccess/ob_meta_cache.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(ObMetaCache, hit_and_expire)
+{
+  TtlCache<std::string> cache;
+  int loads = 0;
+  auto loader = [&](std::string& value) {
+    value = "4.2.1." + std::to_string(++loads);
+    return OMS_OK;
+  };
+
+  std::string value;
+  ASSERT_EQ(OMS_OK, cache.get("c1", value, 1000000, 0, loader));
+  ASSERT_EQ("4.2.1.1", value);
+  ASSERT_EQ(OMS_OK, cache.get("c1", value, 1000000, 0, loader));
+  ASSERT_EQ("4.2.1.1", value);
+  ASSERT_EQ(1, loads);
+  ASSERT_EQ(1, cache.hits());
+  ASSERT_EQ(1, cache.misses());
+
+  // expired entry is reloaded
+  ASSERT_EQ(OMS_OK, cache.get("c2", value, 1, 0, loader));
+  Timer timer;
+  timer.sleep(1000);
+  ASSERT_EQ(OMS_OK, cache.get("c2", value, 1, 0, loader));
+  ASSERT_EQ("4.2.1.3", value);
+
+  cache.invalidate("c1");
+  ASSERT_EQ(OMS_OK, cache.get("c1", value, 1000000, 0, loader));
+  ASSERT_EQ(4, loads);
+}
+
+TEST(ObMetaCache, negative)
+{
+  TtlCache<bool> cache;
+  int loads = 0;
+  auto failed = [&](bool& value) {
+    ++loads;
+    return OMS_FAILED;
+  };
+
+  bool value = true;
+  ASSERT_EQ(OMS_FAILED, cache.get("bad_password", value, 1000000, 1000000, failed));
+  ASSERT_EQ(OMS_FAILED, cache.get("bad_password", value, 1000000, 1000000, failed));
+  ASSERT_EQ(1, loads);
+
+  // failures are not cached without negative ttl
+  ASSERT_EQ(OMS_FAILED, cache.get("no_negative", value, 1000000, 0, failed));
+  ASSERT_EQ(OMS_FAILED, cache.get("no_negative", value, 1000000, 0, failed));
+  ASSERT_EQ(3, loads);
+}
+
+TEST(ObMetaCache, make_key)
+{
+  ASSERT_NE(ObMetaCache::make_key({"a", "bc"}), ObMetaCache::make_key({"ab", "c"}));
+  ASSERT_EQ(ObMetaCache::make_key({"a", "bc"}), ObMetaCache::make_key({"a", "bc"}));
+}
@@ -35,3 +35,36 @@ TEST(BlockingQueue, offset_get)
   ret = bq.poll(element, timeout_us);
   ASSERT_EQ(ret, false);
 }
+
+TEST(BlockingQueue, bounded_by_bytes)
+{
+  BlockingQueue<int> bq(100, 1000);
+  uint64_t timeout_us = 1000;
+
+  ASSERT_TRUE(bq.offer(1, 400, timeout_us));
+  ASSERT_TRUE(bq.offer(2, 600, timeout_us));
+  ASSERT_EQ(1000, bq.bytes());
+  ASSERT_FALSE(bq.offer(3, 1, timeout_us));
+
+  int element = -1;
+  ASSERT_TRUE(bq.poll(element, timeout_us));
+  ASSERT_EQ(1, element);
+  ASSERT_EQ(600, bq.bytes());
+  ASSERT_TRUE(bq.offer(3, 400, timeout_us));
+
+  // a large element still gets through an empty queue
+  std::vector<int> elements;
+  elements.reserve(10);
+  ASSERT_TRUE(bq.poll(elements, timeout_us));
+  ASSERT_EQ(2, elements.size());
+  ASSERT_EQ(0, bq.bytes());
+  ASSERT_TRUE(bq.offer(4, 4000, timeout_us));
+  ASSERT_FALSE(bq.offer(5, 1, timeout_us));
+  ASSERT_EQ(4000, bq.bytes());
+
+  // elements without size are bounded by count only
+  BlockingQueue<int> count_only(2);
+  ASSERT_TRUE(count_only.offer(1, 1UL << 40, timeout_us));
+  ASSERT_TRUE(count_only.offer(2, timeout_us));
+  ASSERT_FALSE(count_only.offer(3, timeout_us));
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "gtest/gtest.h"
+#include "common.h"
+#include "timer.h"
+#include "spawner.h"
+
+using namespace oceanbase::logproxy;
+
+TEST(Spawner, inherit_listed_fds_only)
+{
+  int conn[2];
+  int leaked[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, conn));
+  ASSERT_EQ(0, pipe(leaked));
+
+  // the child reports on the inherited fd, then holds it until the parent closes its end
+  std::string fd = std::to_string(conn[1]);
+  std::string script = "printf x >&" + fd + "; read line <&" + fd + "; exit 0";
+  int pid = spawn_process("/bin/sh", {"sh", "-c", script}, {conn[1]});
+  ASSERT_GT(pid, 0);
+  close(conn[1]);
+
+  char buf[1];
+  ASSERT_EQ(1, read(conn[0], buf, 1));
+  ASSERT_EQ('x', buf[0]);
+
+  // the pipe is closed in the child though not close-on-exec, so its read end sees eof once the parent closes it
+  close(leaked[1]);
+  struct pollfd pfd = {leaked[0], POLLIN, 0};
+  ASSERT_EQ(1, poll(&pfd, 1, 3000));
+  ASSERT_EQ(0, read(leaked[0], buf, 1));
+  close(leaked[0]);
+
+  close(conn[0]);
+  int status = 0;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+}
+
+TEST(Spawner, exec_failure)
+{
+  ASSERT_EQ(OMS_FAILED, spawn_process("/not/existing/oblogreader", {"./oblogreader"}, {}));
+}
+
+TEST(Spawner, launch_latency)
+{
+  const int rounds = 20;
+  uint64_t begin_us = Timer::now();
+  for (int i = 0; i < rounds; ++i) {
+    int pid = spawn_process("/bin/true", {"true"}, {});
+    ASSERT_GT(pid, 0);
+    waitpid(pid, nullptr, 0);
+  }
+  std::cout << "average launch latency of spawner(us): " << (Timer::now() - begin_us) / rounds << std::endl;
+}
@@ -15,6 +15,8 @@
 #include "blocking_queue.hpp"
 #include "sql_parser.h"
 #include "sql_cmd_processor.h"
+#include "config.h"
+#include "env.h"
 #include "sql/SelectStatement.h"
 #include "sql/show_binlog_events.h"
 #include "sql/set_statement.h"
@@ -462,4 +464,115 @@ TEST(SQLParser, show_binlog_events_in_file_limit)
 
   ASSERT_EQ(1, atoll(limit_str.c_str()));
   ASSERT_EQ("binlog.000001", binlog_file);
-}
\ No newline at end of file
+}
+
+TEST(SqlParseCache, normalize)
+{
+  ASSERT_EQ("select @@version_comment limit 1", SqlParseCache::normalize("  select  @@version_comment\n\tlimit 1 ;; "));
+  ASSERT_EQ("select 'a  b', \"c \\\"  d\"", SqlParseCache::normalize("select   'a  b',  \"c \\\"  d\""));
+  ASSERT_EQ("select 1 -- x\n  from dual", SqlParseCache::normalize(" select 1 -- x\n  from dual;"));
+  ASSERT_EQ("", SqlParseCache::normalize(" ; "));
+}
+
+TEST(SqlParseCache, parse)
+{
+  oceanbase::logproxy::Config::instance().binlog_sql_parse_cache_size.set(2);
+  SqlParseCache& cache = SqlParseCache::instance();
+  cache.clear();
+
+  auto first = cache.parse("show binary logs");
+  ASSERT_TRUE(first->isValid());
+  ASSERT_EQ(first, cache.parse("show binary logs"));
+  ASSERT_EQ(1, cache.size());
+
+  // invalid queries are not cached
+  ASSERT_FALSE(cache.parse("show binary")->isValid());
+  ASSERT_EQ(1, cache.size());
+
+  // least recently used one is evicted
+  cache.parse("show master status");
+  cache.parse("show binary logs");
+  cache.parse("show binlog status");
+  ASSERT_EQ(2, cache.size());
+  ASSERT_EQ(first, cache.parse("show binary logs"));
+  ASSERT_EQ(2, cache.size());
+
+  oceanbase::logproxy::Config::instance().binlog_sql_parse_cache_size.set(0);
+  cache.clear();
+  ASSERT_NE(cache.parse("show binary logs"), cache.parse("show binary logs"));
+  ASSERT_EQ(0, cache.size());
+  oceanbase::logproxy::Config::instance().binlog_sql_parse_cache_size.set(1024);
+}
+
+static std::shared_ptr<const ImmutableResultSet> build_result_set(const std::string& query)
+{
+  auto result = SqlParseCache::instance().parse(SqlParseCache::normalize(query));
+  if (!result->isValid() || result->size() != 1) {
+    return nullptr;
+  }
+  return ImmutableResultCache::build(result->getStatement(0));
+}
+
+TEST(ImmutableResultCache, build)
+{
+  SysVar sys_var;
+  SysVar* global_sys_var = g_sys_var;
+  g_sys_var = &sys_var;
+
+  auto result_set = build_result_set("select @@autocommit");
+  ASSERT_NE(nullptr, result_set);
+  ASSERT_EQ(1, result_set->columns.size());
+  ASSERT_EQ("@@autocommit", result_set->columns[0].get_name());
+  ASSERT_EQ(std::vector<std::string>{"ON"}, result_set->row);
+
+  result_set = build_result_set("show global variables like 'AUTOCOMMIT'");
+  ASSERT_NE(nullptr, result_set);
+  ASSERT_EQ(2, result_set->columns.size());
+  ASSERT_EQ("Variable_name", result_set->columns[0].get_name());
+  ASSERT_EQ("Value", result_set->columns[1].get_name());
+  ASSERT_EQ(std::vector<std::string>({"autocommit", "ON"}), result_set->row);
+
+  // neither of global variables only nor known
+  ASSERT_EQ(nullptr, build_result_set("select @@session.autocommit"));
+  ASSERT_EQ(nullptr, build_result_set("select @@autocommit, @@completion_type"));
+  ASSERT_EQ(nullptr, build_result_set("select @@no_such_variable"));
+  ASSERT_EQ(nullptr, build_result_set("show global variables like 'no_such_variable'"));
+  ASSERT_EQ(nullptr, build_result_set("show binary logs"));
+
+  g_sys_var = global_sys_var;
+}
+
+TEST(ImmutableResultCache, invalidated_by_global_var_version)
+{
+  SysVar sys_var;
+  SysVar* global_sys_var = g_sys_var;
+  g_sys_var = &sys_var;
+  oceanbase::logproxy::Config::instance().binlog_sql_parse_cache_size.set(1);
+  ImmutableResultCache& cache = ImmutableResultCache::instance();
+  cache.clear();
+
+  std::string query = SqlParseCache::normalize("select @@autocommit");
+  ASSERT_EQ(nullptr, cache.get(query));
+  auto result_set = build_result_set(query);
+  cache.put(query, result_set);
+  ASSERT_EQ(result_set, cache.get(query));
+
+  // no more cached beyond binlog_sql_parse_cache_size
+  std::string other = SqlParseCache::normalize("select @@completion_type");
+  cache.put(other, build_result_set(other));
+  ASSERT_EQ(nullptr, cache.get(other));
+
+  // outdated once any global variable changed, and built again of the value changed
+  sys_var.add_global_var("autocommit", "OFF");
+  ASSERT_EQ(nullptr, cache.get(query));
+  result_set = build_result_set(query);
+  ASSERT_EQ(std::vector<std::string>{"OFF"}, result_set->row);
+  cache.put(query, result_set);
+  ASSERT_EQ(result_set, cache.get(query));
+  sys_var.add_global_var("completion_type", "CHAIN");
+  ASSERT_EQ(nullptr, cache.get(query));
+
+  cache.clear();
+  oceanbase::logproxy::Config::instance().binlog_sql_parse_cache_size.set(1024);
+  g_sys_var = global_sys_var;
+}
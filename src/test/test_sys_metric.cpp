@@ -10,8 +10,13 @@
  * See the Mulan PubL v2 for more details.
  */
 
+#include <csignal>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
 #include "gtest/gtest.h"
 #include "common.h"
+#include "timer.h"
 #include "metric/sys_metric.h"
 
 using namespace oceanbase::logproxy;
@@ -23,4 +28,61 @@ TEST(SysMetric, get_network_stat)
   printf("%lu\n", network_status.network_rx_bytes);
   printf("%lu\n", network_status.network_wx_bytes);
   ASSERT_TRUE(network_status.network_rx_bytes >= 0 && network_status.network_wx_bytes >= 0);
-}
\ No newline at end of file
+}
+TEST(SysMetric, collect_process_metric_cost)
+{
+  ProcessGroupMetric proc_group_metric;
+  proc_group_metric.item_names[0] = "test_base";
+  collect_process_metric(proc_group_metric);
+  ASSERT_EQ(1, proc_group_metric.metric_group.size());
+  ASSERT_EQ(getpid(), proc_group_metric.metric_group.begin()->second->pid);
+
+  // only tracked processes are collected, /proc is scanned only by the first round
+  int rounds = 1000;
+  Timer timer;
+  for (int i = 0; i < rounds; ++i) {
+    collect_process_metric(proc_group_metric);
+  }
+  printf("collect_process_metric cost: %ld us per round\n", timer.elapsed() / rounds);
+  ASSERT_EQ(1, proc_group_metric.metric_group.size());
+
+  for (auto& entry : proc_group_metric.metric_group) {
+    delete entry.second;
+  }
+}
+
+TEST(SysMetric, collect_process_with_long_name)
+{
+  int ready[2];
+  ASSERT_EQ(0, pipe(ready));
+  int pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    // cut to "binlog_converte" by kernel
+    prctl(PR_SET_NAME, "binlog_converter");
+    (void)!write(ready[1], "x", 1);
+    pause();
+    ::_exit(0);
+  }
+  char buf[1];
+  ASSERT_EQ(1, read(ready[0], buf, 1));
+  close(ready[0]);
+  close(ready[1]);
+
+  ProcessGroupMetric proc_group_metric;
+  for (auto& item_name : proc_group_metric.item_names) {
+    item_name = "";
+  }
+  proc_group_metric.item_names[0] = "binlog_converter";
+  track_process(pid);
+  collect_process_metric(proc_group_metric);
+  collect_process_metric(proc_group_metric);
+
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+  ASSERT_EQ(1, proc_group_metric.metric_group.size());
+  ASSERT_EQ(pid, proc_group_metric.metric_group.begin()->second->pid);
+  for (auto& entry : proc_group_metric.metric_group) {
+    delete entry.second;
+  }
+}
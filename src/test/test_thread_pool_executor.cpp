@@ -14,6 +14,11 @@
 
 #include <thread>
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
 #include <iostream>
 #include "gtest/gtest.h"
 
@@ -162,3 +167,88 @@ TEST(ThreadPoolExecutor, ThreadPoolExecutor)
     //      cout << "f_string_f2.get() = " << f_string_f2.get() << endl;
     //    }
 }
+
+static std::atomic<int> _s_done{0};
+
+static void count_task()
+{
+  _s_done.fetch_add(1, std::memory_order_relaxed);
+}
+
+// a task forking another one, which is pushed to the deque of the current work thread
+static void fork_task(ThreadPoolExecutor* executor)
+{
+  executor->execute(count_task);
+  count_task();
+}
+
+TEST(ThreadPoolExecutor, execute)
+{
+  _s_done = 0;
+  {
+    ThreadPoolExecutor executor(4);
+    for (int i = 0; i < 1000; ++i) {
+      executor.execute(fork_task, &executor);
+    }
+  }
+  // all tasks are done before the executor is destroyed
+  ASSERT_EQ(2000, _s_done.load());
+}
+
+TEST(ThreadPoolExecutor, tasks_per_second)
+{
+  const int nof_tasks = 200000;
+  const int nof_submitters = 4;
+  for (unsigned int nof_threads = 1; nof_threads <= 64; nof_threads *= 2) {
+    _s_done = 0;
+    ThreadPoolExecutor executor(nof_threads);
+    auto begin = std::chrono::steady_clock::now();
+    // submitters play the role of event loops of connections
+    std::vector<std::thread> submitters;
+    for (int i = 0; i < nof_submitters; ++i) {
+      submitters.emplace_back([&]() {
+        for (int j = 0; j < nof_tasks / nof_submitters; ++j) {
+          executor.execute(count_task);
+        }
+      });
+    }
+    for (auto& submitter : submitters) {
+      submitter.join();
+    }
+    while (_s_done.load() < nof_tasks) {
+      std::this_thread::yield();
+    }
+    auto cost_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin);
+    cout << "threads: " << nof_threads << ", tasks/sec: " << (int64_t)nof_tasks * 1000000 / std::max<int64_t>(cost_us.count(), 1)
+         << endl;
+  }
+}
+
+// tasks submitted from outside run in the order submitted
+TEST(ThreadPoolExecutor, injected_in_order)
+{
+  std::mutex mutex;
+  std::vector<int> order;
+  std::promise<void> started;
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  {
+    ThreadPoolExecutor executor(1);
+    executor.execute([&] {
+      started.set_value();
+      released.wait();
+    });
+    started.get_future().wait();
+    for (int i = 0; i < 100; ++i) {
+      executor.execute([&, i] {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(i);
+      });
+    }
+    release.set_value();
+  }
+  ASSERT_EQ(100, order.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i, order[i]);
+  }
+}
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "common.h"
+#include "config.h"
+#include "ob_log_event.h"
+#include "crc32.h"
+
+using namespace oceanbase::logproxy;
+
+static const uint32_t XID_EVENT_LEN = COMMON_HEADER_LENGTH + XID_HEADER_LEN + XID_LEN;
+
+// events inside a transaction payload are laid out as MySQL does: positioned at 0 and without checksum
+static std::string serialize_xid_events(int count, uint8_t checksum_flag)
+{
+  std::string events;
+  for (int i = 0; i < count; ++i) {
+    XidEvent event;
+    event.set_checksum_flag(checksum_flag);
+    event.set_xid(i + 1);
+    uint32_t event_len = XID_EVENT_LEN + event.get_checksum_len();
+    event.set_header(new OblogEventHeader(XID_EVENT, 1700000000, event_len, 0));
+    size_t offset = events.size();
+    events.resize(offset + event_len);
+    events.resize(offset + event.flush_without_checksum(reinterpret_cast<unsigned char*>(&events[offset])));
+  }
+  return events;
+}
+
+static std::string compress_to_buff(const std::string& events, uint8_t checksum_flag)
+{
+  TransactionPayloadEvent event;
+  event.set_checksum_flag(checksum_flag);
+  uint32_t event_len = event.compress(reinterpret_cast<const unsigned char*>(events.data()), events.size(), 3);
+  event.set_header(new OblogEventHeader(TRANSACTION_PAYLOAD_EVENT, 1700000000, event_len, 1000 + event_len));
+  std::string buff(event_len, '\0');
+  event.flush_to_buff(reinterpret_cast<unsigned char*>(&buff[0]));
+  return buff;
+}
+
+TEST(TransactionPayloadEvent, inner_events_without_checksum)
+{
+  for (uint8_t checksum_flag : {OFF, CRC32}) {
+    std::string events = serialize_xid_events(3, checksum_flag);
+    ASSERT_EQ(3 * XID_EVENT_LEN, events.size());
+
+    for (int i = 0; i < 3; ++i) {
+      auto* buff = reinterpret_cast<unsigned char*>(&events[i * XID_EVENT_LEN]);
+      // timestamp, type, server_id, event_len, log_pos, flags, xid
+      unsigned char expected[XID_EVENT_LEN];
+      int4store(expected, 1700000000);
+      int1store(expected + TYPE_CODE_OFFSET, XID_EVENT);
+      int4store(expected + SERVER_ID_OFFSET, SERVER_ID);
+      int4store(expected + EVENT_LEN_OFFSET, XID_EVENT_LEN);
+      int4store(expected + LOG_POS_OFFSET, 0);
+      int2store(expected + FLAGS_OFFSET, 1);
+      int8store(expected + COMMON_HEADER_LENGTH, i + 1);
+      ASSERT_EQ(0, memcmp(expected, buff, XID_EVENT_LEN));
+    }
+  }
+}
+
+TEST(TransactionPayloadEvent, round_trip)
+{
+  for (uint8_t checksum_flag : {OFF, CRC32}) {
+    std::string events = serialize_xid_events(1000, checksum_flag);
+    std::string buff = compress_to_buff(events, checksum_flag);
+    ASSERT_LT(buff.size(), events.size() / 2);
+
+    // only the payload event itself carries the checksum
+    if (checksum_flag == CRC32) {
+      size_t crc_offset = buff.size() - COMMON_CHECKSUM_LENGTH;
+      ASSERT_EQ(Crc32::compute(reinterpret_cast<unsigned char*>(&buff[0]), crc_offset),
+          int4load(reinterpret_cast<unsigned char*>(&buff[crc_offset])));
+    }
+
+    TransactionPayloadEvent deserialized;
+    deserialized.set_checksum_flag(checksum_flag);
+    deserialized.deserialize(reinterpret_cast<unsigned char*>(&buff[0]));
+    ASSERT_EQ(TRANSACTION_PAYLOAD_EVENT, deserialized.get_header()->get_type_code());
+    ASSERT_EQ(buff.size(), deserialized.get_header()->get_event_length());
+    ASSERT_EQ(TransactionPayloadEvent::ZSTD, deserialized.get_compression_type());
+    ASSERT_EQ(events.size(), deserialized.get_uncompressed_size());
+
+    std::string decompressed;
+    ASSERT_EQ(OMS_OK, deserialized.decompress(decompressed));
+    ASSERT_EQ(events, decompressed);
+    ASSERT_EQ("compression='ZSTD', decompressed_size=" + std::to_string(events.size()) + " bytes",
+        deserialized.print_event_info());
+
+    // inner events are walked by their lengths up to the end of the payload
+    size_t pos = 0;
+    int count = 0;
+    while (pos < decompressed.size()) {
+      OblogEventHeader header;
+      header.deserialize(reinterpret_cast<unsigned char*>(&decompressed[pos]));
+      ASSERT_EQ(XID_EVENT, header.get_type_code());
+      ASSERT_EQ(XID_EVENT_LEN, header.get_event_length());
+      XidEvent xid_event;
+      xid_event.set_checksum_flag(OFF);
+      xid_event.deserialize(reinterpret_cast<unsigned char*>(&decompressed[pos]));
+      ASSERT_EQ(++count, xid_event.get_xid());
+      pos += header.get_event_length();
+    }
+    ASSERT_EQ(decompressed.size(), pos);
+    ASSERT_EQ(1000, count);
+  }
+}
+
+TEST(TransactionPayloadEvent, corrupted_payload)
+{
+  std::string events = serialize_xid_events(10, OFF);
+  std::string buff = compress_to_buff(events, OFF);
+  // truncate the zstd frame
+  buff[EVENT_LEN_OFFSET] = static_cast<char>(buff.size() - 4);
+
+  TransactionPayloadEvent deserialized;
+  deserialized.set_checksum_flag(OFF);
+  deserialized.deserialize(reinterpret_cast<unsigned char*>(&buff[0]));
+  std::string decompressed;
+  ASSERT_EQ(OMS_FAILED, deserialized.decompress(decompressed));
+}
+
+TEST(FormatDescriptionEvent, event_types_of_old_files)
+{
+  for (uint8_t checksum_flag : {OFF, CRC32}) {
+    Config::instance().binlog_checksum.set(checksum_flag == CRC32);
+    FormatDescriptionEvent event(1700000000, 1);
+    uint32_t event_len = event.get_header()->get_event_length();
+    std::string buff(event_len, '\0');
+    event.flush_to_buff(reinterpret_cast<unsigned char*>(&buff[0]));
+
+    FormatDescriptionEvent deserialized;
+    deserialized.deserialize(reinterpret_cast<unsigned char*>(&buff[0]));
+    ASSERT_EQ(LOG_EVENT_TYPES, deserialized.get_event_type_header_len().size());
+    ASSERT_EQ(checksum_flag, deserialized.get_checksum_flag());
+
+    // files written before PARTIAL_UPDATE_ROWS_EVENT and TRANSACTION_PAYLOAD_EVENT describe 2 types less
+    size_t types_end = event_len - 1 - event.get_checksum_len();
+    std::string old_buff = buff.substr(0, types_end - 2) + buff.substr(types_end);
+    int4store(reinterpret_cast<unsigned char*>(&old_buff[EVENT_LEN_OFFSET]), event_len - 2);
+    FormatDescriptionEvent old_deserialized;
+    old_deserialized.deserialize(reinterpret_cast<unsigned char*>(&old_buff[0]));
+    ASSERT_EQ(LOG_EVENT_TYPES - 2, old_deserialized.get_event_type_header_len().size());
+    ASSERT_EQ(checksum_flag, old_deserialized.get_checksum_flag());
+  }
+  Config::instance().binlog_checksum.set(true);
+}
@@ -0,0 +1,194 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include <random>
+#include <set>
+#include "gtest/gtest.h"
+#include "log.h"
+#include "timer.h"
+#include "txn_range_set.h"
+
+using namespace oceanbase::logproxy;
+
+static std::set<uint64_t> to_ids(const TxnRangeSet& set)
+{
+  std::set<uint64_t> ids;
+  for (const txn_range& range : set) {
+    for (uint64_t id = range.first; id < range.second; ++id) {
+      ids.insert(id);
+    }
+  }
+  return ids;
+}
+
+static TxnRangeSet random_set(std::mt19937& rand, uint64_t max_id, size_t count)
+{
+  std::vector<txn_range> ranges;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t first = rand() % max_id + 1;
+    ranges.emplace_back(first, first + rand() % 8 + 1);
+  }
+  return TxnRangeSet(ranges);
+}
+
+// every other id in [1, 2 * count + offset), the most fragmented set
+static TxnRangeSet fragmented_set(size_t count, uint64_t offset)
+{
+  std::vector<txn_range> ranges;
+  ranges.reserve(count);
+  for (uint64_t i = 0; i < count; ++i) {
+    ranges.emplace_back(2 * i + 1 + offset, 2 * i + 2 + offset);
+  }
+  return TxnRangeSet(ranges);
+}
+
+TEST(TxnRangeSet, normalize)
+{
+  TxnRangeSet set({{10, 12}, {1, 3}, {3, 5}, {11, 20}, {7, 7}, {30, 31}});
+  std::vector<txn_range> expected = {{1, 5}, {10, 20}, {30, 31}};
+  ASSERT_EQ(expected, set.ranges());
+  ASSERT_EQ(15, set.count());
+
+  ASSERT_TRUE(set.contains(1));
+  ASSERT_TRUE(set.contains(4));
+  ASSERT_FALSE(set.contains(5));
+  ASSERT_FALSE(set.contains(0));
+  ASSERT_TRUE(set.contains(30));
+  ASSERT_FALSE(set.contains(31));
+}
+
+TEST(TxnRangeSet, add)
+{
+  TxnRangeSet set;
+  set.add(1, 5);
+  set.add(5, 6);
+  set.add(10, 12);
+  set.add(8, 9);
+  std::vector<txn_range> expected = {{1, 6}, {8, 9}, {10, 12}};
+  ASSERT_EQ(expected, set.ranges());
+
+  set.add(6, 10);
+  expected = {{1, 12}};
+  ASSERT_EQ(expected, set.ranges());
+
+  set.add(TxnRangeSet({{0, 1}, {12, 13}, {20, 30}}));
+  expected = {{0, 13}, {20, 30}};
+  ASSERT_EQ(expected, set.ranges());
+}
+
+TEST(TxnRangeSet, subtract)
+{
+  TxnRangeSet set({{1, 51775}, {60000, 70000}});
+  set.subtract(TxnRangeSet({{1, 51776}}));
+  std::vector<txn_range> expected = {{60000, 70000}};
+  ASSERT_EQ(expected, set.ranges());
+
+  set.subtract(TxnRangeSet({{60001, 60002}, {65000, 65100}, {69999, 80000}}));
+  expected = {{60000, 60001}, {60002, 65000}, {65100, 69999}};
+  ASSERT_EQ(expected, set.ranges());
+}
+
+TEST(TxnRangeSet, subset)
+{
+  TxnRangeSet set({{1, 100}, {200, 300}});
+  ASSERT_TRUE(TxnRangeSet().is_subset_of(set));
+  ASSERT_TRUE(set.is_subset_of(set));
+  ASSERT_TRUE(TxnRangeSet({{1, 2}, {50, 100}, {250, 300}}).is_subset_of(set));
+  ASSERT_FALSE(TxnRangeSet({{1, 101}}).is_subset_of(set));
+  ASSERT_FALSE(TxnRangeSet({{99, 201}}).is_subset_of(set));
+  ASSERT_FALSE(TxnRangeSet({{1, 2}, {300, 301}}).is_subset_of(set));
+  ASSERT_FALSE(set.is_subset_of(TxnRangeSet()));
+}
+
+TEST(TxnRangeSet, random)
+{
+  std::mt19937 rand(42);
+  for (int round = 0; round < 200; ++round) {
+    TxnRangeSet left = random_set(rand, 200, rand() % 30);
+    TxnRangeSet right = random_set(rand, 200, rand() % 30);
+    std::set<uint64_t> left_ids = to_ids(left);
+    std::set<uint64_t> right_ids = to_ids(right);
+
+    TxnRangeSet merged = left;
+    merged.add(right);
+    std::set<uint64_t> merged_ids = left_ids;
+    merged_ids.insert(right_ids.begin(), right_ids.end());
+    ASSERT_EQ(merged_ids, to_ids(merged));
+    ASSERT_EQ(merged_ids.size(), merged.count());
+
+    TxnRangeSet diff = left;
+    diff.subtract(right);
+    std::set<uint64_t> diff_ids;
+    std::set_difference(left_ids.begin(),
+        left_ids.end(),
+        right_ids.begin(),
+        right_ids.end(),
+        std::inserter(diff_ids, diff_ids.end()));
+    ASSERT_EQ(diff_ids, to_ids(diff));
+
+    bool subset = std::includes(right_ids.begin(), right_ids.end(), left_ids.begin(), left_ids.end());
+    ASSERT_EQ(subset, left.is_subset_of(right));
+    ASSERT_TRUE(diff.is_subset_of(left));
+    ASSERT_TRUE(left.is_subset_of(merged));
+
+    // normalized, so equal sets have equal ranges
+    for (size_t i = 1; i < merged.size(); ++i) {
+      ASSERT_LT(merged.ranges()[i - 1].second, merged.ranges()[i].first);
+    }
+    for (uint64_t id = 0; id < 210; ++id) {
+      ASSERT_EQ(left_ids.count(id) != 0, left.contains(id));
+    }
+  }
+}
+
+TEST(TxnRangeSet, fragmented_benchmark)
+{
+  const size_t count = 100000;
+  TxnRangeSet executed = fragmented_set(count, 0);
+  TxnRangeSet purged = fragmented_set(count, 1);
+  TxnRangeSet previous = fragmented_set(count / 2, 0);
+
+  Timer timer;
+  TxnRangeSet merged = executed;
+  merged.add(purged);
+  uint64_t add_us = timer.elapsed();
+  ASSERT_EQ(1, merged.size());
+  ASSERT_EQ(2 * count, merged.count());
+
+  timer.reset();
+  TxnRangeSet diff = merged;
+  diff.subtract(executed);
+  uint64_t subtract_us = timer.elapsed();
+  ASSERT_EQ(count, diff.size());
+  ASSERT_EQ(purged, diff);
+
+  timer.reset();
+  bool subset = previous.is_subset_of(executed) && !purged.is_subset_of(executed);
+  uint64_t subset_us = timer.elapsed();
+  ASSERT_TRUE(subset);
+
+  timer.reset();
+  uint64_t found = 0;
+  for (uint64_t id = 1; id <= 2 * count; ++id) {
+    found += executed.contains(id) ? 1 : 0;
+  }
+  uint64_t contains_us = timer.elapsed();
+  ASSERT_EQ(count, found);
+
+  OMS_INFO("Sets of {} ranges, add: {}us, subtract: {}us, subset: {}us, {} contains: {}us",
+      count,
+      add_us,
+      subtract_us,
+      subset_us,
+      2 * count,
+      contains_us);
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2023 OceanBase
+ * OceanBase Migration Service LogProxy is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#include "gtest/gtest.h"
+#include "writeset_tracker.h"
+
+using namespace oceanbase::logproxy;
+
+static std::pair<int64_t, int64_t> commit(WritesetTracker& tracker, std::vector<uint64_t> rows, bool isolated = false)
+{
+  for (uint64_t row : rows) {
+    tracker.add_row(row);
+  }
+  int64_t last_committed = 0;
+  int64_t sequence_number = 0;
+  tracker.commit(isolated, last_committed, sequence_number);
+  return {last_committed, sequence_number};
+}
+
+TEST(WritesetTracker, independent_and_conflicting)
+{
+  WritesetTracker tracker(100);
+  ASSERT_EQ(std::make_pair(0L, 1L), commit(tracker, {1, 2}));
+  ASSERT_EQ(std::make_pair(0L, 2L), commit(tracker, {3}));
+  ASSERT_EQ(std::make_pair(0L, 3L), commit(tracker, {4, 5}));
+  // the last one wrote row 2 and 5
+  ASSERT_EQ(std::make_pair(3L, 4L), commit(tracker, {2, 5}));
+  ASSERT_EQ(std::make_pair(2L, 5L), commit(tracker, {3, 6}));
+  ASSERT_EQ(std::make_pair(1L, 6L), commit(tracker, {1}));
+  ASSERT_EQ(std::make_pair(4L, 7L), commit(tracker, {2}));
+}
+
+TEST(WritesetTracker, keyless_and_isolated)
+{
+  WritesetTracker tracker(100);
+  ASSERT_EQ(std::make_pair(0L, 1L), commit(tracker, {1}));
+
+  tracker.add_keyless_row();
+  ASSERT_EQ(std::make_pair(1L, 2L), commit(tracker, {2}));
+  // writesets of keyless transactions still count
+  ASSERT_EQ(std::make_pair(2L, 3L), commit(tracker, {2}));
+  ASSERT_EQ(std::make_pair(0L, 4L), commit(tracker, {7}));
+
+  // e.g. DDL
+  ASSERT_EQ(std::make_pair(4L, 5L), commit(tracker, {}, true));
+  ASSERT_EQ(0, tracker.history_size());
+  ASSERT_EQ(std::make_pair(5L, 6L), commit(tracker, {1}));
+  ASSERT_EQ(std::make_pair(5L, 7L), commit(tracker, {8}));
+
+  // nothing written tells nothing either
+  ASSERT_EQ(std::make_pair(7L, 8L), commit(tracker, {}));
+  ASSERT_EQ(std::make_pair(8L, 9L), commit(tracker, {1}));
+}
+
+TEST(WritesetTracker, history_exceeded)
+{
+  WritesetTracker tracker(4);
+  ASSERT_EQ(std::make_pair(0L, 1L), commit(tracker, {1, 2}));
+  ASSERT_EQ(std::make_pair(0L, 2L), commit(tracker, {3, 4}));
+  ASSERT_EQ(4, tracker.history_size());
+  // still depends on what it conflicts with, but rows of later ones are unknown
+  ASSERT_EQ(std::make_pair(1L, 3L), commit(tracker, {1, 5}));
+  ASSERT_EQ(0, tracker.history_size());
+  ASSERT_EQ(std::make_pair(3L, 4L), commit(tracker, {6}));
+  ASSERT_EQ(std::make_pair(3L, 5L), commit(tracker, {7}));
+  ASSERT_EQ(std::make_pair(4L, 6L), commit(tracker, {6}));
+}
+
+TEST(WritesetTracker, commit_order)
+{
+  WritesetTracker tracker(0);
+  for (int64_t i = 1; i <= 10; ++i) {
+    ASSERT_EQ(std::make_pair(i - 1, i), commit(tracker, {(uint64_t)i}));
+  }
+  ASSERT_EQ(0, tracker.history_size());
+}
+
+TEST(WritesetTracker, reset)
+{
+  WritesetTracker tracker(100);
+  commit(tracker, {1});
+  commit(tracker, {2});
+  tracker.reset();
+  ASSERT_EQ(std::make_pair(0L, 1L), commit(tracker, {1}));
+
+  // resumed from the last transaction of a binlog file, of which rows are unknown
+  tracker.reset(20);
+  ASSERT_EQ(std::make_pair(20L, 21L), commit(tracker, {2}));
+  ASSERT_EQ(std::make_pair(20L, 22L), commit(tracker, {3}));
+  ASSERT_EQ(22, tracker.sequence_number());
+}